@@ -17,6 +17,10 @@
 
 #include "kudu/cfile/binary_dict_block.h"
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include <functional>
 #include <limits>
 #include <ostream>
@@ -39,9 +43,11 @@
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/cpu.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/strings/stringpiece.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/alignment.h"
 #include "kudu/util/bitmap.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/coding-inl.h"
@@ -214,6 +220,79 @@ bool BinaryDictBlockBuilder::IsBlockFullMasked() const {
 // Decoding
 ////////////////////////////////////////////////////////////
 
+namespace {
+
+const bool kHasAvx2 = base::CPU().has_avx2();
+
+// Return the number of codewords matched through an AVX2-optimized
+// implementation. The implementation handles a multiple of 8 codewords,
+// leaving the tail to the scalar implementation.
+//
+// This is disabled on GCC4 because it doesn't support per-function
+// enabling of intrinsics.
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+__attribute__((target("avx2")))
+int MatchCodeWordAvx2(const uint32_t* __restrict__ codewords,
+                      int n,
+                      uint32_t target,
+                      uint8_t* __restrict__ match_bitmap) {
+  const __m256i target_vec = _mm256_set1_epi32(static_cast<int32_t>(target));
+  int iters = n / 8;
+  while (iters--) {
+    // Compare 8x32-bit codewords against the target, and pack the
+    // per-lane results into a single byte of the output bitmap.
+    __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(codewords));
+    __m256i eq = _mm256_cmpeq_epi32(words, target_vec);
+    *match_bitmap++ = static_cast<uint8_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+    codewords += 8;
+  }
+  return KUDU_ALIGN_DOWN(n, 8);
+}
+#else
+int MatchCodeWordAvx2(const uint32_t* __restrict__ /* codewords */,
+                      int /* n */,
+                      uint32_t /* target */,
+                      uint8_t* __restrict__ /* match_bitmap */) {
+  return 0;
+}
+#endif
+
+// Set the i-th bit of 'match_bitmap' iff 'codewords[i]' equals 'target'.
+void MatchCodeWord(const uint32_t* __restrict__ codewords,
+                   int n,
+                   uint32_t target,
+                   uint8_t* __restrict__ match_bitmap) {
+  int i = 0;
+  if (kHasAvx2) {
+    i = MatchCodeWordAvx2(codewords, n, target, match_bitmap);
+  }
+  for (; i < n; i += 8) {
+    uint8_t bits = 0;
+    for (int j = 0; j < 8 && i + j < n; j++) {
+      bits |= static_cast<uint8_t>(codewords[i + j] == target) << j;
+    }
+    match_bitmap[i / 8] = bits;
+  }
+}
+
+// Set the i-th bit of 'match_bitmap' iff 'codewords[i]' is set in
+// 'codeword_set'. The loop is branch-free so it can't be derailed by
+// mispredictions on selective predicates.
+void MatchCodeWordSet(const uint32_t* __restrict__ codewords,
+                      int n,
+                      const uint8_t* __restrict__ codeword_set,
+                      uint8_t* __restrict__ match_bitmap) {
+  for (int i = 0; i < n; i += 8) {
+    uint8_t bits = 0;
+    for (int j = 0; j < 8 && i + j < n; j++) {
+      bits |= static_cast<uint8_t>(BitmapTest(codeword_set, codewords[i + j])) << j;
+    }
+    match_bitmap[i / 8] = bits;
+  }
+}
+
+} // anonymous namespace
+
 BinaryDictBlockDecoder::BinaryDictBlockDecoder(scoped_refptr<BlockHandle> block,
                                                CFileIterator* iter)
     : block_(std::move(block)),
@@ -293,10 +372,15 @@ Status BinaryDictBlockDecoder::CopyNextAndEval(size_t* n,
     return data_decoder_->CopyNextAndEval(n, ctx, sel, dst);
   }
 
-  // Predicates that have no matching words should return no data.
-  SelectionVector* codewords_matching_pred = parent_cfile_iter_->GetCodeWordsMatchingPredicate();
+  // The predicate is translated into a set of matching codewords once per
+  // CFile by the parent iterator: from here on, only codewords are compared.
+  const SelectionVector* codewords_matching_pred =
+      parent_cfile_iter_->GetCodeWordsMatchingPredicate();
   DCHECK(codewords_matching_pred != nullptr);
-  if (!codewords_matching_pred->AnySelected()) {
+  const size_t num_matching = parent_cfile_iter_->GetNumCodeWordsMatchingPredicate();
+
+  // Predicates that have no matching words should return no data.
+  if (num_matching == 0) {
     // If nothing is selected, move the data_decoder_ pointer forward and clear
     // the corresponding bits in the selection vector.
     int skip = static_cast<int>(*n);
@@ -306,35 +390,47 @@ Status BinaryDictBlockDecoder::CopyNextAndEval(size_t* n,
     return Status::OK();
   }
 
-  // IsNotNull predicates should return all data.
-  if (ctx->pred()->predicate_type() == PredicateType::IsNotNull) {
+  // IsNotNull predicates, as well as predicates matching every word in the
+  // dictionary, should return all data.
+  if (ctx->pred()->predicate_type() == PredicateType::IsNotNull ||
+      num_matching == dict_decoder_->Count()) {
     return CopyNextDecodeStrings(n, dst);
   }
 
-  bool retain_dict = false;
-
   // Load the rows' codeword values into a buffer for scanning.
   BShufBlockDecoder<UINT32>* d_bptr = down_cast<BShufBlockDecoder<UINT32>*>(data_decoder_.get());
   codeword_buf_.resize(*n * sizeof(uint32_t));
   RETURN_NOT_OK(d_bptr->CopyNextValuesToArray(n, codeword_buf_.data()));
+  const uint32_t* codewords = reinterpret_cast<const uint32_t*>(codeword_buf_.data());
+  const int nrows = static_cast<int>(*n);
+
+  // Filter the codewords in bulk into a bitmap of matching rows. A single
+  // matching codeword (e.g. an equality predicate) is a plain comparison
+  // which is vectorized; otherwise, probe the set of matching codewords.
+  match_buf_.resize(BitmapSize(nrows));
+  uint8_t* match_bitmap = match_buf_.data();
+  if (num_matching == 1) {
+    MatchCodeWord(codewords, nrows, parent_cfile_iter_->GetSingleCodeWordMatchingPredicate(),
+                  match_bitmap);
+  } else {
+    MatchCodeWordSet(codewords, nrows, codewords_matching_pred->bitmap(), match_bitmap);
+  }
+
+  // Mark the rows that will not be returned, and materialize only the
+  // matching rows which haven't been cleared by a prior evaluation.
+  ForEachUnsetBit(match_bitmap, nrows, [&](int i) {
+    sel->ClearBit(i);
+  });
+  bool retain_dict = false;
   Slice* out = reinterpret_cast<Slice*>(dst->data());
-  for (size_t i = 0; i < *n; i++, out++) {
-    // Check with the SelectionVectorView to see whether the data has already
-    // been cleared, in which case we can skip evaluation.
-    if (!sel->TestBit(i)) {
-      continue;
-    }
-    uint32_t codeword = *reinterpret_cast<uint32_t*>(&codeword_buf_[i * sizeof(uint32_t)]);
-    if (BitmapTest(codewords_matching_pred->bitmap(), codeword)) {
+  ForEachSetBit(match_bitmap, nrows, [&](int i) {
+    if (sel->TestBit(i)) {
       // Row is included in predicate: point the cell in the block
       // to the entry in the dictionary.
-      *out = dict_decoder_->string_at_index(codeword);
+      out[i] = dict_decoder_->string_at_index(codewords[i]);
       retain_dict = true;
-    } else {
-      // Mark that the row will not be returned.
-      sel->ClearBit(i);
     }
-  }
+  });
   if (retain_dict) {
     dst->memory()->RetainReference(dict_decoder_->block_handle());
   }
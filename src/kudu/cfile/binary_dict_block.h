@@ -190,6 +190,10 @@ class BinaryDictBlockDecoder final : public BlockDecoder {
   // buffer to hold the codewords, needed by CopyNextDecodeStrings()
   faststring codeword_buf_;
 
+  // Bitmap of the rows whose codewords match the predicate, used by
+  // CopyNextAndEval().
+  faststring match_buf_;
+
 };
 
 } // namespace cfile
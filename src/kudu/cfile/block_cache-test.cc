@@ -17,6 +17,7 @@
 
 #include "kudu/cfile/block_cache.h"
 
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <ostream>
@@ -29,11 +30,14 @@
 
 #include "kudu/gutil/singleton.h"
 #include "kudu/util/cache.h"
+#include "kudu/util/env.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/string_case.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_bool(block_manager_direct_reads);
+DECLARE_int64(block_cache_compressed_capacity_mb);
 DECLARE_string(block_cache_eviction_policy);
 DECLARE_double(cache_memtracker_approximation_ratio);
 
@@ -56,7 +60,7 @@ class BlockCacheTest :
 };
 
 INSTANTIATE_TEST_SUITE_P(EvictionPolicyTypes, BlockCacheTest,
-                         ::testing::Values("LRU", "SLRU"));
+                         ::testing::Values("LRU", "SLRU", "CLOCK", "TINYLFU"));
 
 TEST_P(BlockCacheTest, TestBasics) {
   // Disable approximate tracking of cache memory since we make specific
@@ -110,6 +114,78 @@ TEST_P(BlockCacheTest, TestBasics) {
   ASSERT_FALSE(cache->Lookup(key1, Cache::EXPECT_IN_CACHE, &retrieved_handle));
 }
 
+TEST_P(BlockCacheTest, TestCompressedTier) {
+  FLAGS_block_cache_compressed_capacity_mb = 1;
+
+  size_t data_size = strlen(kDataToCache) + 1;
+  BlockCache* cache = BlockCache::GetSingleton();
+  ASSERT_TRUE(cache->has_compressed_tier());
+  BlockCache::CacheKey key(BlockCache::FileId(1234), 1);
+
+  {
+    BlockCacheHandle handle;
+    ASSERT_FALSE(cache->LookupCompressed(key, &handle));
+    ASSERT_FALSE(handle.valid());
+  }
+
+  BlockCache::PendingEntry data = cache->AllocateCompressed(key, data_size);
+  memcpy(data.val_ptr(), kDataToCache, data_size);
+  BlockCacheHandle inserted_handle;
+  cache->InsertCompressed(&data, &inserted_handle);
+  ASSERT_FALSE(data.valid());
+  ASSERT_TRUE(inserted_handle.valid());
+
+  // The tiers are separate: the block is only in the compressed tier.
+  BlockCacheHandle retrieved_handle;
+  ASSERT_FALSE(cache->Lookup(key, Cache::EXPECT_IN_CACHE, &retrieved_handle));
+  ASSERT_TRUE(cache->LookupCompressed(key, &retrieved_handle));
+  ASSERT_EQ(0, memcmp(retrieved_handle.data().data(), kDataToCache, data_size));
+
+  // The compressed tier has a memory tracker of its own.
+  if (BlockCache::GetConfiguredCacheMemoryTypeOrDie() == Cache::MemoryType::DRAM) {
+    std::shared_ptr<MemTracker> mem_tracker;
+    ASSERT_TRUE(MemTracker::FindTracker("block_cache_compressed-sharded_lru_cache",
+                                        &mem_tracker));
+  }
+}
+
+TEST_P(BlockCacheTest, TestCompressedTierDisabledByDefault) {
+  ASSERT_FALSE(BlockCache::GetSingleton()->has_compressed_tier());
+}
+
+// With direct reads, blocks read from files are placed at the same offset
+// within a page of memory as they are within a page of their CFile.
+TEST_P(BlockCacheTest, TestAlignedValues) {
+  FLAGS_block_manager_direct_reads = true;
+
+  size_t data_size = strlen(kDataToCache) + 1;
+  BlockCache* cache = BlockCache::GetSingleton();
+  for (uint64_t offset : { 0, 1, 4095, 4096, 12345 }) {
+    SCOPED_TRACE(offset);
+    for (bool read_from_file : { true, false }) {
+      BlockCache::CacheKey key(BlockCache::FileId(read_from_file ? 1 : 2), offset);
+      BlockCache::PendingEntry data = cache->Allocate(key, data_size, read_from_file);
+      ASSERT_TRUE(data.valid());
+      if (read_from_file) {
+        ASSERT_EQ(offset % kDirectReadAlignment,
+                  reinterpret_cast<uintptr_t>(data.val_ptr()) % kDirectReadAlignment);
+      }
+      memcpy(data.val_ptr(), kDataToCache, data_size);
+      uint8_t* val_ptr = data.val_ptr();
+
+      BlockCacheHandle inserted_handle;
+      cache->Insert(&data, &inserted_handle);
+      ASSERT_EQ(val_ptr, inserted_handle.data().data());
+      ASSERT_EQ(data_size, inserted_handle.data().size());
+
+      BlockCacheHandle retrieved_handle;
+      ASSERT_TRUE(cache->Lookup(key, Cache::EXPECT_IN_CACHE, &retrieved_handle));
+      ASSERT_EQ(val_ptr, retrieved_handle.data().data());
+      ASSERT_EQ(Slice(kDataToCache, data_size), retrieved_handle.data());
+    }
+  }
+}
+
 
 } // namespace cfile
 } // namespace kudu
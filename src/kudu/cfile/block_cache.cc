@@ -20,31 +20,45 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/cfile/persistent_block_cache.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/block_cache_metrics.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/cache_metrics.h"
+#include "kudu/util/env.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/flag_validators.h"
 #include "kudu/util/process_memory.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/slru_cache.h"
+#include "kudu/util/status.h"
 #include "kudu/util/string_case.h"
+#include "kudu/util/tinylfu_cache.h"
 
 DEFINE_int64(block_cache_capacity_mb, 512, "block cache capacity in MB");
 TAG_FLAG(block_cache_capacity_mb, stable);
 
 DEFINE_string(block_cache_eviction_policy, "LRU",
               "Eviction policy used for block cache. "
-              "Either 'LRU' (default) or 'SLRU' (experimental).");
+              "Either 'LRU' (default), 'SLRU' (experimental), 'CLOCK' (experimental) or "
+              "'TINYLFU' (experimental). 'CLOCK' approximates 'LRU' with lookups which "
+              "don't contend with each other, which helps read-heavy workloads with many "
+              "concurrent scanners, at the price of inserts which get more expensive with "
+              "the number of CPUs, so it may be slower than 'LRU' for workloads which "
+              "mostly miss the cache. 'TINYLFU' admits blocks into the cache only if they "
+              "are accessed more frequently than the blocks they would displace, which "
+              "keeps large scans from flushing the frequently accessed blocks. "
+              "'CLOCK' and 'TINYLFU' are supported only with the 'DRAM' block cache type.");
 TAG_FLAG(block_cache_eviction_policy, advanced);
 TAG_FLAG(block_cache_eviction_policy, experimental);
 
@@ -60,6 +74,38 @@ DEFINE_uint32(block_cache_lookups_before_upgrade, 2,
              "Must be > 0.");
 TAG_FLAG(block_cache_lookups_before_upgrade, experimental);
 
+DEFINE_double(block_cache_tinylfu_window_percentage, 0.01,
+              "Percentage of 'block_cache_capacity_mb' that's the capacity of the window "
+              "which new blocks are inserted into when using the 'TINYLFU' eviction policy. "
+              "Blocks evicted from the window are admitted into the rest of the cache based "
+              "on their access frequency. Must be >= 0 and <= 1.");
+TAG_FLAG(block_cache_tinylfu_window_percentage, experimental);
+
+DEFINE_int64(block_cache_compressed_capacity_mb, 0,
+             "Capacity of the block cache tier which holds compressed CFile blocks, in MB. "
+             "Blocks of compressed columns which are read from disk are also kept in this "
+             "tier in their compressed form, so that a block evicted from the rest of the "
+             "block cache can be decompressed from memory rather than read from disk again. "
+             "This tier is in addition to 'block_cache_capacity_mb'. "
+             "If 0, the compressed tier is disabled.");
+TAG_FLAG(block_cache_compressed_capacity_mb, advanced);
+TAG_FLAG(block_cache_compressed_capacity_mb, experimental);
+
+DEFINE_string(block_cache_persistent_path, "",
+              "Directory of the block cache tier which is stored in a local file, "
+              "preferably on an SSD, and which survives restarts of the tablet server. "
+              "Blocks read from disk are also written to this tier, and blocks missing "
+              "from the rest of the block cache are read from it rather than from the "
+              "data directories. If empty, the persistent tier is disabled.");
+TAG_FLAG(block_cache_persistent_path, advanced);
+TAG_FLAG(block_cache_persistent_path, experimental);
+
+DEFINE_int64(block_cache_persistent_capacity_mb, 10240,
+             "Capacity of the persistent tier of the block cache, in MB. Changing the "
+             "capacity discards the blocks cached before the restart.");
+TAG_FLAG(block_cache_persistent_capacity_mb, advanced);
+TAG_FLAG(block_cache_persistent_capacity_mb, experimental);
+
 
 // Yes, it's strange: the default value is 'true' but that's intentional.
 // The idea is to avoid the corresponding group flag validator striking
@@ -78,6 +124,7 @@ DEFINE_string(block_cache_type, "DRAM",
               "libmemkind 1.8.0 or newer must be available on the system; "
               "otherwise Kudu will crash.");
 
+DECLARE_bool(block_manager_direct_reads);
 #if !defined(NO_ROCKSDB)
 DECLARE_uint32(log_container_rdb_block_cache_capacity_mb);
 #endif
@@ -102,6 +149,15 @@ string ToUpper(const string& input) {
   return temp;
 }
 
+// The header of the values of the main tier if they're aligned for direct
+// reads. It's a multiple of 8 bytes so that unpadded blocks stay as aligned
+// as they'd be without it.
+struct AlignedValueHeader {
+  uint32_t data_offset;
+  uint32_t data_size;
+};
+static_assert(sizeof(AlignedValueHeader) == 8, "unexpected aligned value header size");
+
 } // anonymous namespace
 
 bool ValidateBlockCacheCapacity() {
@@ -151,7 +207,7 @@ GROUP_FLAG_VALIDATOR(block_cache_capacity_mb, ValidateBlockCacheCapacity);
 bool ValidateBlockCacheSegmentCapacity() {
   if (FLAGS_force_block_cache_capacity ||
       ToUpper(FLAGS_block_cache_type) != "DRAM" ||
-      ToUpper(FLAGS_block_cache_eviction_policy) == "LRU") {
+      ToUpper(FLAGS_block_cache_eviction_policy) != "SLRU") {
     return true;
   }
 
@@ -165,8 +221,46 @@ bool ValidateBlockCacheSegmentCapacity() {
 }
 GROUP_FLAG_VALIDATOR(block_cache_protected_segment_percentage, ValidateBlockCacheSegmentCapacity);
 
+bool ValidateBlockCacheWindowCapacity() {
+  if (ToUpper(FLAGS_block_cache_eviction_policy) != "TINYLFU") {
+    return true;
+  }
+
+  const auto& percentage = FLAGS_block_cache_tinylfu_window_percentage;
+  if (percentage < 0 || percentage > 1) {
+    LOG(ERROR) << Substitute("FLAGS_block_cache_tinylfu_window_percentage must be >= 0 "
+                             "and <= 1. It's $0.", percentage);
+    return false;
+  }
+  return true;
+}
+GROUP_FLAG_VALIDATOR(block_cache_tinylfu_window_percentage, ValidateBlockCacheWindowCapacity);
+
+bool ValidateBlockCacheCompressedCapacity() {
+  if (FLAGS_block_cache_compressed_capacity_mb < 0) {
+    LOG(ERROR) << Substitute("FLAGS_block_cache_compressed_capacity_mb must be >= 0. It's $0.",
+                             FLAGS_block_cache_compressed_capacity_mb);
+    return false;
+  }
+  return true;
+}
+GROUP_FLAG_VALIDATOR(block_cache_compressed_capacity_mb, ValidateBlockCacheCompressedCapacity);
+
+bool ValidateBlockCachePersistentCapacity() {
+  if (FLAGS_block_cache_persistent_path.empty()) {
+    return true;
+  }
+  if (FLAGS_block_cache_persistent_capacity_mb <= 0) {
+    LOG(ERROR) << Substitute("FLAGS_block_cache_persistent_capacity_mb must be > 0. It's $0.",
+                             FLAGS_block_cache_persistent_capacity_mb);
+    return false;
+  }
+  return true;
+}
+GROUP_FLAG_VALIDATOR(block_cache_persistent_capacity_mb, ValidateBlockCachePersistentCapacity);
+
 bool ValidateLookups() {
-  if (ToUpper(FLAGS_block_cache_eviction_policy) == "LRU") {
+  if (ToUpper(FLAGS_block_cache_eviction_policy) != "SLRU") {
     return true;
   }
 
@@ -181,7 +275,8 @@ GROUP_FLAG_VALIDATOR(block_cache_lookups_before_upgrade, ValidateLookups);
 
 bool ValidateEvictionPolicy() {
   const auto& eviction_policy = ToUpper(FLAGS_block_cache_eviction_policy);
-  return eviction_policy == "LRU" || eviction_policy == "SLRU";
+  return eviction_policy == "LRU" || eviction_policy == "SLRU" ||
+      eviction_policy == "CLOCK" || eviction_policy == "TINYLFU";
 }
 GROUP_FLAG_VALIDATOR(block_cache_eviction_policy, ValidateEvictionPolicy);
 
@@ -214,6 +309,45 @@ Cache* BlockCache::CreateCache(int64_t probationary_segment_capacity,
   }
 }
 
+Cache* BlockCache::CreateClockCache(int64_t capacity) {
+  const auto& mem_type = BlockCache::GetConfiguredCacheMemoryTypeOrDie();
+  switch (mem_type) {
+    case Cache::MemoryType::DRAM:
+      return NewCache<Cache::EvictionPolicy::CLOCK, Cache::MemoryType::DRAM>(
+          capacity, "block_cache");
+    default:
+      LOG(FATAL) << "unsupported CLOCK cache memory type: " << mem_type;
+      return nullptr;
+  }
+}
+
+Cache* BlockCache::CreateTinyLFUCache(int64_t window_capacity, int64_t main_capacity) {
+  const auto& mem_type = BlockCache::GetConfiguredCacheMemoryTypeOrDie();
+  switch (mem_type) {
+    case Cache::MemoryType::DRAM:
+      return NewTinyLFUCache<Cache::MemoryType::DRAM>(
+          window_capacity, main_capacity, "block_cache");
+    default:
+      LOG(FATAL) << "unsupported TinyLFU cache memory type: " << mem_type;
+      return nullptr;
+  }
+}
+
+Cache* BlockCache::CreateCompressedCache(int64_t capacity) {
+  const auto& mem_type = BlockCache::GetConfiguredCacheMemoryTypeOrDie();
+  switch (mem_type) {
+    case Cache::MemoryType::DRAM:
+      return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::DRAM>(
+          capacity, "block_cache_compressed");
+    case Cache::MemoryType::NVM:
+      return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::NVM>(
+          capacity, "block_cache_compressed");
+    default:
+      LOG(FATAL) << "unsupported compressed cache memory type: " << mem_type;
+      return nullptr;
+  }
+}
+
 Cache::MemoryType BlockCache::GetConfiguredCacheMemoryTypeOrDie() {
   const auto& memory_type = ToUpper(FLAGS_block_cache_type);
   if (memory_type == "NVM") {
@@ -236,18 +370,34 @@ Cache::EvictionPolicy BlockCache::GetCacheEvictionPolicyOrDie() {
   if (eviction_policy == "SLRU") {
     return Cache::EvictionPolicy::SLRU;
   }
+  if (eviction_policy == "CLOCK") {
+    return Cache::EvictionPolicy::CLOCK;
+  }
+  if (eviction_policy == "TINYLFU") {
+    return Cache::EvictionPolicy::TINYLFU;
+  }
 
   LOG(FATAL) << "Unknown block cache eviction policy: '" << eviction_policy
-             << "' (expected 'LRU' or 'SLRU')";
+             << "' (expected 'LRU', 'SLRU', 'CLOCK' or 'TINYLFU')";
   __builtin_unreachable();
 }
 
-BlockCache::BlockCache() {
+BlockCache::BlockCache()
+    : aligned_values_(FLAGS_block_manager_direct_reads) {
   const auto& eviction_policy = GetCacheEvictionPolicyOrDie();
   int64_t capacity = FLAGS_block_cache_capacity_mb * 1024 * 1024;
   if (eviction_policy == Cache::EvictionPolicy::LRU) {
     unique_ptr<Cache> lru_cache(CreateCache(capacity));
     cache_ = std::move(lru_cache);
+  } else if (eviction_policy == Cache::EvictionPolicy::CLOCK) {
+    unique_ptr<Cache> clock_cache(CreateClockCache(capacity));
+    cache_ = std::move(clock_cache);
+  } else if (eviction_policy == Cache::EvictionPolicy::TINYLFU) {
+    int64_t window_capacity = static_cast<int64_t>(
+        std::round(FLAGS_block_cache_tinylfu_window_percentage * capacity));
+    unique_ptr<Cache> tinylfu_cache(CreateTinyLFUCache(window_capacity,
+                                                       capacity - window_capacity));
+    cache_ = std::move(tinylfu_cache);
   } else {
     DCHECK(eviction_policy == Cache::EvictionPolicy::SLRU);
     int64_t probationary_capacity = static_cast<int64_t>(
@@ -259,21 +409,60 @@ BlockCache::BlockCache() {
                                              FLAGS_block_cache_lookups_before_upgrade));
     cache_ = std::move(slru_cache);
   }
+  if (FLAGS_block_cache_compressed_capacity_mb > 0) {
+    compressed_cache_.reset(CreateCompressedCache(
+        FLAGS_block_cache_compressed_capacity_mb * 1024 * 1024));
+  }
 }
 
+BlockCache::~BlockCache() = default;
+
 BlockCache::BlockCache(size_t capacity)
-    : cache_(CreateCache(capacity)) {
+    : cache_(CreateCache(capacity)),
+      aligned_values_(FLAGS_block_manager_direct_reads) {
 }
 
 BlockCache::BlockCache(size_t probationary_segment_capacity,
                        size_t protected_segment_capacity,
                        size_t lookups)
-    : cache_(CreateCache(probationary_segment_capacity, protected_segment_capacity, lookups)) {
+    : cache_(CreateCache(probationary_segment_capacity, protected_segment_capacity, lookups)),
+      aligned_values_(FLAGS_block_manager_direct_reads) {
 }
 
-BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t block_size) {
+BlockCache::PendingEntry BlockCache::Allocate(const CacheKey& key, size_t block_size,
+                                              bool read_from_file) {
   Slice key_slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key));
-  return PendingEntry(cache_->Allocate(key_slice, block_size));
+  if (!aligned_values_) {
+    return PendingEntry(cache_->Allocate(key_slice, block_size));
+  }
+  // CFiles start at a page boundary of the files of the block manager, so the
+  // block's offset within a page of its CFile is its offset within a page of
+  // the file it's read from.
+  const size_t padding = read_from_file ? kDirectReadAlignment - 1 : 0;
+  auto h(cache_->Allocate(key_slice, sizeof(AlignedValueHeader) + padding + block_size));
+  if (!h) {
+    return PendingEntry();
+  }
+  uint8_t* val = cache_->MutableValue(&h);
+  uint8_t* data = val + sizeof(AlignedValueHeader);
+  if (read_from_file) {
+    data += (key.offset_ - reinterpret_cast<uintptr_t>(data)) % kDirectReadAlignment;
+  }
+  AlignedValueHeader header = { static_cast<uint32_t>(data - val),
+                                static_cast<uint32_t>(block_size) };
+  memcpy(val, &header, sizeof(header));
+  return PendingEntry(std::move(h), header.data_offset);
+}
+
+Slice BlockCache::BlockData(const Cache::UniqueHandle& handle) const {
+  Slice value = cache_->Value(handle);
+  if (!aligned_values_) {
+    return value;
+  }
+  AlignedValueHeader header;
+  memcpy(&header, value.data(), sizeof(header));
+  DCHECK_LE(header.data_offset + header.data_size, value.size());
+  return Slice(value.data() + header.data_offset, header.data_size);
 }
 
 bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
@@ -281,7 +470,8 @@ bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
   auto h(cache_->Lookup(
       Slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key)), behavior));
   if (h) {
-    handle->SetHandle(std::move(h));
+    Slice data = BlockData(h);
+    handle->SetHandle(std::move(h), data);
     return true;
   }
   return false;
@@ -290,20 +480,94 @@ bool BlockCache::Lookup(const CacheKey& key, Cache::CacheBehavior behavior,
 void BlockCache::Insert(BlockCache::PendingEntry* entry, BlockCacheHandle* inserted) {
   auto h(cache_->Insert(std::move(entry->handle_),
                         /* eviction_callback= */ nullptr));
-  inserted->SetHandle(std::move(h));
+  Slice data = BlockData(h);
+  inserted->SetHandle(std::move(h), data);
+}
+
+bool BlockCache::LookupCompressed(const CacheKey& key, BlockCacheHandle* handle) {
+  DCHECK(has_compressed_tier());
+  auto h(compressed_cache_->Lookup(
+      Slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key)), Cache::EXPECT_IN_CACHE));
+  if (h) {
+    Slice data = compressed_cache_->Value(h);
+    handle->SetHandle(std::move(h), data);
+    return true;
+  }
+  return false;
+}
+
+BlockCache::PendingEntry BlockCache::AllocateCompressed(const CacheKey& key, size_t block_size) {
+  DCHECK(has_compressed_tier());
+  Slice key_slice(reinterpret_cast<const uint8_t*>(&key), sizeof(key));
+  return PendingEntry(compressed_cache_->Allocate(key_slice, block_size));
+}
+
+void BlockCache::InsertCompressed(PendingEntry* entry, BlockCacheHandle* inserted) {
+  DCHECK(has_compressed_tier());
+  auto h(compressed_cache_->Insert(std::move(entry->handle_),
+                                   /* eviction_callback= */ nullptr));
+  Slice data = compressed_cache_->Value(h);
+  inserted->SetHandle(std::move(h), data);
+}
+
+Status BlockCache::OpenPersistentTier(Env* env,
+                                      fs::BlockManager* block_manager,
+                                      const scoped_refptr<MetricEntity>& metric_entity) {
+  if (FLAGS_block_cache_persistent_path.empty()) {
+    return Status::OK();
+  }
+  std::lock_guard l(persistent_cache_lock_);
+  if (persistent_cache_) {
+    // The tier is shared by all the servers of the process.
+    return Status::OK();
+  }
+  unique_ptr<PersistentBlockCache> persistent_cache;
+  RETURN_NOT_OK(PersistentBlockCache::Open(
+      env, FLAGS_block_cache_persistent_path,
+      FLAGS_block_cache_persistent_capacity_mb * 1024 * 1024,
+      block_manager, metric_entity, &persistent_cache));
+  persistent_cache_ = std::move(persistent_cache);
+  has_persistent_tier_.store(true, std::memory_order_release);
+  return Status::OK();
+}
+
+bool BlockCache::LookupPersistent(const CacheKey& key, Slice block) {
+  DCHECK(has_persistent_tier());
+  return persistent_cache_->Lookup(key, block).ok();
+}
+
+void BlockCache::InsertPersistent(const CacheKey& key, const Slice& block) {
+  DCHECK(has_persistent_tier());
+  persistent_cache_->Insert(key, block);
+}
+
+Status BlockCache::CheckpointPersistentTier() {
+  if (!has_persistent_tier()) {
+    return Status::OK();
+  }
+  return persistent_cache_->Checkpoint();
 }
 
 void BlockCache::StartInstrumentation(const scoped_refptr<MetricEntity>& metric_entity,
                                       Cache::ExistingMetricsPolicy metrics_policy) {
   const auto& eviction_policy = GetCacheEvictionPolicyOrDie();
-  if (eviction_policy == Cache::EvictionPolicy::LRU) {
+  if (eviction_policy == Cache::EvictionPolicy::LRU ||
+      eviction_policy == Cache::EvictionPolicy::CLOCK) {
     unique_ptr<BlockCacheMetrics> metrics(new BlockCacheMetrics(metric_entity));
     cache_->SetMetrics(std::move(metrics), metrics_policy);
+  } else if (eviction_policy == Cache::EvictionPolicy::TINYLFU) {
+    unique_ptr<TinyLFUCacheMetrics> metrics(new TinyLFUCacheMetrics(metric_entity));
+    cache_->SetMetrics(std::move(metrics), metrics_policy);
   } else {
     DCHECK(eviction_policy == Cache::EvictionPolicy::SLRU);
     unique_ptr<SLRUCacheMetrics> metrics(new SLRUCacheMetrics(metric_entity));
     cache_->SetMetrics(std::move(metrics), metrics_policy);
   }
+  if (compressed_cache_) {
+    unique_ptr<CompressedBlockCacheMetrics> metrics(
+        new CompressedBlockCacheMetrics(metric_entity));
+    compressed_cache_->SetMetrics(std::move(metrics), metrics_policy);
+  }
 }
 
 } // namespace cfile
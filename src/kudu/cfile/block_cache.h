@@ -16,9 +16,11 @@
 // under the License.
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 #include <gtest/gtest_prod.h>
@@ -29,16 +31,23 @@
 #include "kudu/gutil/singleton.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/slice.h"
+#include "kudu/util/status.h"
 
 template <class T> class scoped_refptr;
 
 namespace kudu {
 
+class Env;
 class MetricEntity;
 
+namespace fs {
+class BlockManager;
+} // namespace fs
+
 namespace cfile {
 
 class BlockCacheHandle;
+class PersistentBlockCache;
 
 // Wrapper around kudu::Cache specifically for caching blocks of CFiles.
 // Provides a singleton and LRU cache for CFile blocks.
@@ -77,8 +86,9 @@ class BlockCache {
         : handle_(Cache::UniquePendingHandle(nullptr,
                                              Cache::PendingHandleDeleter(nullptr))) {
     }
-    explicit PendingEntry(Cache::UniquePendingHandle handle)
-        : handle_(std::move(handle)) {
+    explicit PendingEntry(Cache::UniquePendingHandle handle, size_t data_offset = 0)
+        : handle_(std::move(handle)),
+          data_offset_(data_offset) {
     }
     PendingEntry(PendingEntry&& other) noexcept : PendingEntry() {
       *this = std::move(other);
@@ -102,13 +112,16 @@ class BlockCache {
 
     // Return the pointer into which the value should be written.
     uint8_t* val_ptr() {
-      return handle_.get_deleter().cache()->MutableValue(&handle_);
+      return handle_.get_deleter().cache()->MutableValue(&handle_) + data_offset_;
     }
 
    private:
     friend class BlockCache;
 
     Cache::UniquePendingHandle handle_;
+
+    // The offset of the block within the cache entry's value.
+    size_t data_offset_ = 0;
   };
 
   static BlockCache* GetSingleton() {
@@ -121,6 +134,8 @@ class BlockCache {
              size_t protected_segment_capacity,
              size_t lookups);
 
+  ~BlockCache();
+
   // Lookup the given block in the cache.
   //
   // If the entry is found, then sets *handle to refer to the entry.
@@ -158,12 +173,76 @@ class BlockCache {
   //   cache->Insert(&entry, &bch);
 
   // Allocate a new entry to be inserted into the cache.
-  PendingEntry Allocate(const CacheKey& key, size_t block_size);
+  //
+  // If 'read_from_file' is true, the block is to be read from its CFile
+  // straight into the entry. If the block manager reads data blocks with
+  // direct I/O (see --block_manager_direct_reads), the entry's memory is then
+  // placed at the same offset within a page of memory as the block is within
+  // a page of the file, so that the pages wholly inside the block are read
+  // straight into it rather than through an intermediate buffer. That costs
+  // up to a page of memory per entry.
+  PendingEntry Allocate(const CacheKey& key, size_t block_size,
+                        bool read_from_file = false);
 
   // Insert the given block into the cache. 'inserted' is set to refer to the
   // entry in the cache.
   void Insert(PendingEntry* entry, BlockCacheHandle* inserted);
 
+  // Compressed tier
+  // --------------------
+  // If --block_cache_compressed_capacity_mb is set, the block cache has a
+  // second tier which holds blocks of compressed CFiles as they're stored on
+  // disk. It has a separate capacity and metrics, and its entries are
+  // allocated and inserted the same way as above. Since compressed blocks
+  // take less memory, the tier can hold many more blocks than the main tier
+  // for the same amount of memory, and a block missing from the main tier
+  // can be decompressed from it rather than read from disk.
+
+  // Return true if the block cache has a compressed tier.
+  bool has_compressed_tier() const {
+    return compressed_cache_ != nullptr;
+  }
+
+  // Like Lookup(), but in the compressed tier.
+  bool LookupCompressed(const CacheKey& key, BlockCacheHandle* handle);
+
+  // Like Allocate(), but in the compressed tier.
+  PendingEntry AllocateCompressed(const CacheKey& key, size_t block_size);
+
+  // Like Insert(), but into the compressed tier. 'entry' must have been
+  // allocated with AllocateCompressed().
+  void InsertCompressed(PendingEntry* entry, BlockCacheHandle* inserted);
+
+  // Persistent tier
+  // --------------------
+  // If --block_cache_persistent_path is set, the block cache has a tier in a
+  // local file which survives restarts, so that the blocks read before a
+  // restart don't have to be read from the data directories again. It holds
+  // blocks as they're stored in CFiles, and it's opened once the block
+  // manager is, since the blocks cached before the restart are validated
+  // against the block manager. See PersistentBlockCache for details.
+
+  // Open the persistent tier, if it's enabled. A no-op if it's already open.
+  Status OpenPersistentTier(Env* env,
+                            fs::BlockManager* block_manager,
+                            const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Return true if the persistent tier is open.
+  bool has_persistent_tier() const {
+    return has_persistent_tier_.load(std::memory_order_acquire);
+  }
+
+  // Read the block with the given key from the persistent tier into 'block',
+  // whose size must be the size of the block. Returns false if the block
+  // isn't in the persistent tier.
+  bool LookupPersistent(const CacheKey& key, Slice block);
+
+  // Write the block with the given key into the persistent tier.
+  void InsertPersistent(const CacheKey& key, const Slice& block);
+
+  // Write the index of the persistent tier to disk, if it's open.
+  Status CheckpointPersistentTier();
+
  private:
   friend class Singleton<BlockCache>;
   FRIEND_TEST(BlockCacheTest, TestBasics);
@@ -179,10 +258,29 @@ class BlockCache {
   static Cache* CreateCache(int64_t probationary_segment_capacity,
                             int64_t protected_segment_capacity,
                             uint32_t lookups);
+  static Cache* CreateClockCache(int64_t capacity);
+  static Cache* CreateTinyLFUCache(int64_t window_capacity, int64_t main_capacity);
+  static Cache* CreateCompressedCache(int64_t capacity);
+
+  // Return the block held by the given entry of the main tier.
+  Slice BlockData(const Cache::UniqueHandle& handle) const;
 
   DISALLOW_COPY_AND_ASSIGN(BlockCache);
 
   std::unique_ptr<Cache> cache_;
+
+  // Whether the values of the main tier may be padded to align their blocks
+  // for direct reads. If so, each value starts with a header locating the
+  // block within it.
+  const bool aligned_values_;
+
+  // The compressed tier, or null if it's disabled.
+  std::unique_ptr<Cache> compressed_cache_;
+
+  // The persistent tier, set at most once by OpenPersistentTier().
+  std::mutex persistent_cache_lock_;
+  std::unique_ptr<PersistentBlockCache> persistent_cache_;
+  std::atomic<bool> has_persistent_tier_ { false };
 };
 
 // Scoped reference to a block from the block cache.
@@ -192,9 +290,13 @@ class BlockCacheHandle {
       : handle_(Cache::UniqueHandle(nullptr, Cache::HandleDeleter(nullptr))) {
   }
 
-  BlockCacheHandle(BlockCacheHandle&& other) noexcept : handle_(std::move(other.handle_)) {}
+  BlockCacheHandle(BlockCacheHandle&& other) noexcept
+      : handle_(std::move(other.handle_)),
+        data_(other.data_) {
+  }
   BlockCacheHandle& operator=(BlockCacheHandle&& other) noexcept {
     handle_ = std::move(other.handle_);
+    data_ = other.data_;
     return *this;
   }
 
@@ -203,6 +305,7 @@ class BlockCacheHandle {
   // with an empty BlockCacheHandle.
   void swap(BlockCacheHandle* dst) {
     std::swap(handle_, dst->handle_);
+    std::swap(data_, dst->data_);
   }
 
   // Return the data in the cached block.
@@ -210,7 +313,7 @@ class BlockCacheHandle {
   // NOTE: this slice is only valid until the block cache handle is
   // destructed or explicitly Released().
   Slice data() const {
-    return handle_.get_deleter().cache()->Value(handle_);
+    return data_;
   }
 
   bool valid() const {
@@ -221,11 +324,15 @@ class BlockCacheHandle {
   DISALLOW_COPY_AND_ASSIGN(BlockCacheHandle);
   friend class BlockCache;
 
-  void SetHandle(Cache::UniqueHandle handle) {
+  void SetHandle(Cache::UniqueHandle handle, Slice data) {
     handle_ = std::move(handle);
+    data_ = data;
   }
 
   Cache::UniqueHandle handle_;
+
+  // The block within the value of 'handle_'.
+  Slice data_;
 };
 
 
@@ -233,6 +340,7 @@ inline BlockCache::PendingEntry& BlockCache::PendingEntry::operator=(
     BlockCache::PendingEntry&& other) noexcept {
   reset();
   handle_ = std::move(other.handle_);
+  data_offset_ = other.data_offset_;
   return *this;
 }
 
@@ -248,6 +356,9 @@ bool ValidateBlockCacheCapacity();
 // Does same as ValidateBlockCacheCapacity() except for block caches with SLRU eviction policy.
 bool ValidateBlockCacheSegmentCapacity();
 
+// Validates the capacity of the compressed tier of the block cache. Must be >= 0.
+bool ValidateBlockCacheCompressedCapacity();
+
 // Validates number of lookups before upgrade for block cache of SLRU eviction policy. Must be > 0.
 bool ValidateLookups();
 
@@ -70,7 +70,7 @@ void BloomFileTestBase::AppendBlooms(BloomFileWriter* bfw) {
   }
 }
 
-void BloomFileTestBase::WriteTestBloomFile() {
+void BloomFileTestBase::WriteTestBloomFile(bool use_block_bloom) {
   unique_ptr<fs::WritableBlock> sink;
   ASSERT_OK(fs_manager_->CreateNewBlock({}, &sink));
   block_id_ = sink->id();
@@ -83,7 +83,7 @@ void BloomFileTestBase::WriteTestBloomFile() {
       << "Invalid parameters: --n_keys isn't set large enough to fill even "
       << "one bloom filter of the requested --bloom_size_bytes";
 
-  BloomFileWriter bfw(std::move(sink), sizing);
+  BloomFileWriter bfw(std::move(sink), sizing, use_block_bloom);
 
   ASSERT_OK(bfw.Start());
   AppendBlooms(&bfw);
@@ -34,8 +34,9 @@ class BloomFileTestBase : public KuduTest {
 
   void SetUp() override;
 
-  // Creates a test bloomfile on disk. The block ID is written to block_id_.
-  void WriteTestBloomFile();
+  // Creates a test bloomfile on disk, of block bloom filters if
+  // 'use_block_bloom' is true. The block ID is written to block_id_.
+  void WriteTestBloomFile(bool use_block_bloom = false);
 
   // Opens the bloomfile with block id block_id_ for reading.
   // WriteTestBloomFile() must have been called. The reader is written to bfr_.
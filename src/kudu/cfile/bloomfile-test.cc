@@ -34,7 +34,9 @@
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs-test-util.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/bits.h"
 #include "kudu/gutil/endian.h"
+#include "kudu/util/block_bloom_filter.h"
 #include "kudu/util/bloom_filter.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/slice.h"
@@ -58,7 +60,9 @@ namespace cfile {
 class BloomFileTest : public BloomFileTestBase {
 
  protected:
-  void VerifyBloomFile() {
+  // Verify the bloom file's lookups, whose false positive rate should be
+  // at most 'expected_fp_rate', with some tolerance.
+  void VerifyBloomFile(double expected_fp_rate) {
     // Verify all the keys that we inserted probe as present.
     for (uint64_t i = 0; i < FLAGS_n_keys; i++) {
       uint64_t i_byteswapped = BigEndian::FromHost64(i << kKeyShift);
@@ -84,7 +88,7 @@ class BloomFileTest : public BloomFileTestBase {
 
     double fp_rate = static_cast<double>(positive_count) / FLAGS_n_keys;
     LOG(INFO) << "fp_rate: " << fp_rate << "(" << positive_count << "/" << FLAGS_n_keys << ")";
-    ASSERT_LT(fp_rate, FLAGS_fp_rate + FLAGS_fp_rate * 0.20f)
+    ASSERT_LT(fp_rate, expected_fp_rate + expected_fp_rate * 0.20f)
       << "Should be no more than 1.2x the expected FP rate";
   }
 };
@@ -93,7 +97,19 @@ class BloomFileTest : public BloomFileTestBase {
 TEST_F(BloomFileTest, TestWriteAndRead) {
   NO_FATALS(WriteTestBloomFile());
   ASSERT_OK(OpenBloomFile());
-  VerifyBloomFile();
+  NO_FATALS(VerifyBloomFile(FLAGS_fp_rate));
+}
+
+TEST_F(BloomFileTest, TestWriteAndReadBlockBloom) {
+  NO_FATALS(WriteTestBloomFile(/*use_block_bloom=*/true));
+  ASSERT_OK(OpenBloomFile());
+
+  // Block bloom filters hold as many keys as the classic ones of the same
+  // size, at a somewhat higher false positive rate.
+  BloomFilterSizing sizing = BloomFilterSizing::BySizeAndFPRate(
+      FLAGS_bloom_size_bytes, FLAGS_fp_rate);
+  NO_FATALS(VerifyBloomFile(BlockBloomFilter::FalsePositiveProb(
+      sizing.expected_count(), Bits::Log2Ceiling64(sizing.n_bytes()))));
 }
 
 #ifdef NDEBUG
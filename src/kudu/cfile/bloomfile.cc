@@ -36,11 +36,13 @@
 #include "kudu/common/types.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/gutil/atomicops.h"
+#include "kudu/gutil/bits.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/compression/compression.pb.h"
+#include "kudu/util/hash.pb.h"
 #include "kudu/util/hexdump.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/malloc.h"
@@ -75,7 +77,9 @@ class BloomCacheItem {
  public:
   explicit BloomCacheItem(const IOContext* io_context, CFileReader* reader)
       : index_iter(io_context, reader, reader->validx_root()),
-        cur_block_pointer(0, 0) {
+        cur_block_pointer(0, 0),
+        cur_block_bloom(DefaultBlockBloomFilterBufferAllocator::GetSingleton()),
+        cur_is_block_bloom(false) {
   }
 
   // The IndexTreeIterator used to seek the BloomFileReader last time it was accessed.
@@ -86,6 +90,9 @@ class BloomCacheItem {
   // The block handle and parsed BloomFilter corresponding to cur_block_pointer.
   scoped_refptr<BlockHandle> cur_block_handle;
   BloomFilter cur_bloom;
+  // Used instead of 'cur_bloom' if the block holds a block bloom filter.
+  BlockBloomFilter cur_block_bloom;
+  bool cur_is_block_bloom;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(BloomCacheItem);
@@ -100,19 +107,31 @@ using BloomCacheTLC = ThreadLocalCache<uint64_t, BloomCacheItem>;
 // For bloom filters' storage, never use compression regardless of the default
 // settings: bloom filters are high-entropy data structures by their nature.
 BloomFileWriter::BloomFileWriter(unique_ptr<WritableBlock> block,
-                                 const BloomFilterSizing& sizing)
+                                 const BloomFilterSizing& sizing,
+                                 bool use_block_bloom)
     : writer_(WriterOptionsBuilder()
                   .write_posidx(false)
                   .write_validx(true)
                   .storage_attributes({ PLAIN_ENCODING, NO_COMPRESSION })
+                  .incompatible_features(use_block_bloom ? IncompatibleFeatures::BLOCK_BLOOM_FILTER
+                                                         : IncompatibleFeatures::NONE)
                   .Build(),
               GetTypeInfo(BINARY),
               false,
               std::move(block)),
-      bloom_builder_(sizing) {
+      use_block_bloom_(use_block_bloom),
+      bloom_builder_(sizing),
+      block_bloom_(DefaultBlockBloomFilterBufferAllocator::GetSingleton()),
+      block_bloom_log_space_bytes_(Bits::Log2Ceiling64(sizing.n_bytes())),
+      block_bloom_count_(0) {
 }
 
 Status BloomFileWriter::Start() {
+  if (use_block_bloom_) {
+    // The keys are inserted by their precomputed hashes, so the hash algorithm
+    // of the filter is never used.
+    RETURN_NOT_OK(block_bloom_.Init(block_bloom_log_space_bytes_, FAST_HASH, 0));
+  }
   return writer_.Start();
 }
 
@@ -124,7 +143,7 @@ Status BloomFileWriter::Finish() {
 }
 
 Status BloomFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction) {
-  if (bloom_builder_.count() > 0) {
+  if (cur_block_count() > 0) {
     RETURN_NOT_OK(FinishCurrentBloomBlock());
   }
   return writer_.FinishAndReleaseBlock(transaction);
@@ -136,16 +155,24 @@ size_t BloomFileWriter::written_size() const {
 
 Status BloomFileWriter::AppendKeys(const Slice* keys, size_t n_keys) {
   // If this is the call on a new bloom, copy the first key.
-  if (bloom_builder_.count() == 0 && n_keys > 0) {
+  if (cur_block_count() == 0 && n_keys > 0) {
     first_key_.assign_copy(keys[0].data(), keys[0].size());
   }
 
   for (size_t i = 0; i < n_keys; i++) {
 
-    bloom_builder_.AddKey(BloomKeyProbe(keys[i]));
+    BloomKeyProbe probe(keys[i]);
+    if (use_block_bloom_) {
+      // Insert the same hash which BloomFileReader::CheckKeyPresent() probes
+      // the filter with, so it's computed only once per key probe.
+      block_bloom_.Insert(probe.initial_hash());
+      block_bloom_count_++;
+    } else {
+      bloom_builder_.AddKey(probe);
+    }
 
     // Bloom has reached optimal occupancy: flush it to the file
-    if (PREDICT_FALSE(bloom_builder_.count() >= bloom_builder_.expected_count())) {
+    if (PREDICT_FALSE(cur_block_count() >= bloom_builder_.expected_count())) {
       RETURN_NOT_OK(FinishCurrentBloomBlock());
 
       // Update the last key and set the next key as the first key of the next block.
@@ -167,13 +194,19 @@ Status BloomFileWriter::FinishCurrentBloomBlock() {
 
   // Encode the header.
   BloomBlockHeaderPB hdr;
-  hdr.set_num_hash_functions(bloom_builder_.n_hashes());
+  if (use_block_bloom_) {
+    hdr.set_num_hash_functions(0);
+    hdr.set_filter_type(BloomBlockHeaderPB::BLOCK);
+  } else {
+    hdr.set_num_hash_functions(bloom_builder_.n_hashes());
+  }
   faststring hdr_str;
   PutFixed32(&hdr_str, static_cast<uint32_t>(hdr.ByteSizeLong()));
   pb_util::AppendToString(hdr, &hdr_str);
 
   // The data is the concatenation of the header and the bloom itself.
-  vector<Slice> slices { Slice(hdr_str), bloom_builder_.slice() };
+  vector<Slice> slices { Slice(hdr_str),
+                         use_block_bloom_ ? block_bloom_.directory() : bloom_builder_.slice() };
 
   // Append to the file.
   Slice start_key(first_key_);
@@ -181,7 +214,12 @@ Status BloomFileWriter::FinishCurrentBloomBlock() {
   RETURN_NOT_OK(writer_.AppendRawBlock(
       std::move(slices), 0, &start_key, last_key, "bloom block"));
 
-  bloom_builder_.Clear();
+  if (use_block_bloom_) {
+    RETURN_NOT_OK(block_bloom_.Init(block_bloom_log_space_bytes_, FAST_HASH, 0));
+    block_bloom_count_ = 0;
+  } else {
+    bloom_builder_.Clear();
+  }
 
   #ifndef NDEBUG
   first_key_.assign_copy("POST_RESET");
@@ -328,14 +366,32 @@ Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe& probe,
     Slice bloom_data;
     RETURN_NOT_OK(ParseBlockHeader(dblk_data->data(), &hdr, &bloom_data));
 
-    // Save the data back into our threadlocal cache.
-    bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
+    // Save the data back into our threadlocal cache. A block bloom filter
+    // is copied into a buffer of its own, which its lookups expect to be
+    // aligned.
+    bci->cur_is_block_bloom = hdr.filter_type() == BloomBlockHeaderPB::BLOCK;
+    if (bci->cur_is_block_bloom) {
+      // Reset the cached block pointer first, so that a failure doesn't leave
+      // the cache pointing at a block whose filter wasn't loaded.
+      bci->cur_block_pointer = BlockPointer(0, 0);
+      if (PREDICT_FALSE(bloom_data.empty() ||
+                        (bloom_data.size() & (bloom_data.size() - 1)) != 0)) {
+        return Status::Corruption(
+            StringPrintf("Invalid block bloom filter size %ld", bloom_data.size()));
+      }
+      RETURN_NOT_OK_PREPEND(bci->cur_block_bloom.InitFromDirectory(
+          Bits::Log2Floor64(bloom_data.size()), bloom_data, false, FAST_HASH, 0),
+                            "Invalid block bloom filter");
+    } else {
+      bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
+    }
     bci->cur_block_pointer = bblk_ptr;
     bci->cur_block_handle = std::move(dblk_data);
   }
 
   // Actually check the bloom filter.
-  *maybe_present = bci->cur_bloom.MayContainKey(probe);
+  *maybe_present = bci->cur_is_block_bloom ? bci->cur_block_bloom.Find(probe.initial_hash())
+                                           : bci->cur_bloom.MayContainKey(probe);
   return Status::OK();
 }
 
@@ -24,6 +24,7 @@
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_writer.h"
 #include "kudu/gutil/macros.h"
+#include "kudu/util/block_bloom_filter.h"
 #include "kudu/util/bloom_filter.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/mem_tracker.h"
@@ -47,8 +48,13 @@ struct ReaderOptions;
 
 class BloomFileWriter {
  public:
+  // If 'use_block_bloom' is true, every block of the file holds a block bloom
+  // filter of 'sizing.n_bytes()' rounded up to a power of two, which can be
+  // probed by touching a single cache line, rather than a classic bloom
+  // filter. Such files can't be read by versions which predate the format.
   BloomFileWriter(std::unique_ptr<fs::WritableBlock> block,
-                  const BloomFilterSizing& sizing);
+                  const BloomFilterSizing& sizing,
+                  bool use_block_bloom = false);
 
   Status Start();
   Status AppendKeys(const Slice* keys, size_t n_keys);
@@ -68,10 +74,25 @@ class BloomFileWriter {
 
   Status FinishCurrentBloomBlock();
 
+  // Return the number of keys inserted into the current bloom block.
+  size_t cur_block_count() const {
+    return use_block_bloom_ ? block_bloom_count_ : bloom_builder_.count();
+  }
+
   cfile::CFileWriter writer_;
 
+  const bool use_block_bloom_;
+
+  // Used if 'use_block_bloom_' is false. Its expected count is the number
+  // of keys per bloom block in either case.
   BloomFilterBuilder bloom_builder_;
 
+  // Used if 'use_block_bloom_' is true, along with the log2 of its size
+  // and the number of keys inserted into it.
+  BlockBloomFilter block_bloom_;
+  const int block_bloom_log_space_bytes_;
+  size_t block_bloom_count_;
+
   // first key inserted in the current block.
   faststring first_key_;
 
@@ -79,17 +79,22 @@
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/threadpool.h"
 
 DECLARE_bool(cfile_support_arrays);
 DECLARE_bool(cfile_write_checksums);
+DECLARE_int32(cfile_readahead_blocks);
+DECLARE_int32(cfile_zstd_dictionary_size);
 DECLARE_bool(cfile_verify_checksums);
 DECLARE_string(block_cache_eviction_policy);
 DECLARE_string(block_cache_type);
 DECLARE_bool(force_block_cache_capacity);
 DECLARE_int64(block_cache_capacity_mb);
+DECLARE_int64(block_cache_compressed_capacity_mb);
 DECLARE_string(nvm_cache_path);
 DECLARE_bool(nvm_cache_simulate_allocation_failure);
 
+METRIC_DECLARE_counter(block_cache_compressed_hits_caching);
 METRIC_DECLARE_counter(block_cache_hits_caching);
 METRIC_DECLARE_entity(server);
 
@@ -229,7 +234,8 @@ Status TimeReadFile(FsManager* fs_manager,
 class TestCFile : public CFileTestBase {
  protected:
   template <class DataGeneratorType>
-  void TestReadWriteFixedSizeTypes(EncodingType encoding) {
+  void TestReadWriteFixedSizeTypes(EncodingType encoding,
+                                   ThreadPool* readahead_pool = nullptr) {
     BlockId block_id;
     DataGeneratorType generator;
 
@@ -241,7 +247,7 @@ class TestCFile : public CFileTestBase {
     ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
 
     unique_ptr<CFileIterator> iter;
-    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr));
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr, readahead_pool));
 
     ASSERT_OK(iter->SeekToOrdinal(5000));
     ASSERT_EQ(5000u, iter->GetCurrentOrdinal());
@@ -408,6 +414,9 @@ class TestCFile : public CFileTestBase {
     ASSERT_OK(CFileReader::Open(std::move(source), ReaderOptions(), &reader));
 
     ASSERT_EQ(reader->footer().compression(), compression);
+    ASSERT_EQ(compression == ZSTD,
+              (reader->footer().incompatible_features() &
+               IncompatibleFeatures::ZSTD_COMPRESSION) != 0);
     if (FLAGS_cfile_write_checksums) {
       ASSERT_TRUE(reader->footer().incompatible_features() & IncompatibleFeatures::CHECKSUM);
     } else {
@@ -543,6 +552,12 @@ class TestCFileBothCacheMemoryTypes :
           case Cache::EvictionPolicy::SLRU:
             FLAGS_block_cache_eviction_policy = "SLRU";
             break;
+          case Cache::EvictionPolicy::CLOCK:
+            FLAGS_block_cache_eviction_policy = "CLOCK";
+            break;
+          case Cache::EvictionPolicy::TINYLFU:
+            FLAGS_block_cache_eviction_policy = "TINYLFU";
+            break;
           default:
             LOG(FATAL) << "Block cache does not support FIFO eviction policy";
         }
@@ -571,6 +586,10 @@ INSTANTIATE_TEST_SUITE_P(CacheMemoryTypes, TestCFileBothCacheMemoryTypes,
                                                           Cache::EvictionPolicy::LRU),
                                            std::make_pair(Cache::MemoryType::DRAM,
                                                           Cache::EvictionPolicy::SLRU),
+                                           std::make_pair(Cache::MemoryType::DRAM,
+                                                          Cache::EvictionPolicy::CLOCK),
+                                           std::make_pair(Cache::MemoryType::DRAM,
+                                                          Cache::EvictionPolicy::TINYLFU),
                                            std::make_pair(Cache::MemoryType::NVM,
                                                           Cache::EvictionPolicy::LRU)));
 
@@ -708,6 +727,44 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteInt128) {
   TestReadWriteFixedSizeTypes<Int128DataGenerator<false>>(PLAIN_ENCODING);
 }
 
+// Reading the data blocks ahead of the scan, across seeks and batches which
+// end at any row of a block, returns the same values.
+TEST_P(TestCFileBothCacheMemoryTypes, TestReadWriteWithReadahead) {
+  RETURN_IF_NO_NVM_CACHE(GetParam().first);
+  FLAGS_cfile_readahead_blocks = 4;
+  unique_ptr<ThreadPool> readahead_pool;
+  ASSERT_OK(ThreadPoolBuilder("cfile-readahead").Build(&readahead_pool));
+  for (auto enc : { PLAIN_ENCODING, RLE, BIT_SHUFFLE }) {
+    TestReadWriteFixedSizeTypes<Int64DataGenerator<false>>(enc, readahead_pool.get());
+  }
+
+  // Seeking reads the following blocks ahead, but not those past the upper
+  // bound of the scan.
+  BlockId block_id;
+  Int64DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, 10000, SMALL_BLOCKSIZE, &block_id);
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+
+  ScopedColumnBlock<INT64> out(1);
+  SelectionVector sel(1);
+  ColumnMaterializationContext out_ctx = CreateNonDecoderEvalContext(&out, &sel);
+  for (rowid_t upper_bound : { 10000, 1 }) {
+    SCOPED_TRACE(upper_bound);
+    unique_ptr<CFileIterator> iter;
+    ASSERT_OK(reader->NewIterator(&iter, CFileReader::CACHE_BLOCK, nullptr,
+                                  readahead_pool.get()));
+    iter->SetReadaheadUpperBound(upper_bound);
+    ASSERT_OK(iter->SeekToOrdinal(0));
+    size_t n = 1;
+    ASSERT_OK(iter->CopyNextValues(&n, &out_ctx));
+    ASSERT_EQ(1, n);
+    ASSERT_EQ(upper_bound > 1 ? 4 : 0, iter->num_blocks_read_ahead());
+  }
+}
+
 TEST_P(TestCFileBothCacheMemoryTypes, TestFixedSizeReadWritePlainEncodingFloat) {
   RETURN_IF_NO_NVM_CACHE(GetParam().first);
   TestReadWriteFixedSizeTypes<FPDataGenerator<FLOAT, false>>(PLAIN_ENCODING);
@@ -1006,6 +1063,17 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestAppendRaw) {
   TestReadWriteRawBlocks(SNAPPY, 1000);
   TestReadWriteRawBlocks(LZ4, 1000);
   TestReadWriteRawBlocks(ZLIB, 1000);
+  TestReadWriteRawBlocks(ZSTD, 1000);
+}
+
+// Test writing and reading back ZSTD-compressed blocks using a dictionary
+// trained on the data being written, including the case when there is
+// not enough data to collect all the training samples.
+TEST_P(TestCFileBothCacheMemoryTypes, TestAppendRawZstdDictionary) {
+  RETURN_IF_NO_NVM_CACHE(GetParam().first);
+  FLAGS_cfile_zstd_dictionary_size = 1024;
+  TestReadWriteRawBlocks(ZSTD, 100);
+  TestReadWriteRawBlocks(ZSTD, 10000);
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestChecksumFlags) {
@@ -1211,6 +1279,62 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestCacheKeysAreStable) {
   }
 }
 
+// Tests that blocks of compressed CFiles which are evicted from the block cache
+// are read from its compressed tier rather than from disk.
+TEST_P(TestCFileBothCacheMemoryTypes, TestCompressedBlockCacheTier) {
+  if (GetParam().first != Cache::MemoryType::DRAM) {
+    GTEST_SKIP();
+  }
+
+  // Leave no room in the main tier, so that every decompressed block is
+  // evicted as soon as it's released.
+  FLAGS_block_cache_capacity_mb = 0;
+  FLAGS_block_cache_compressed_capacity_mb = 16;
+
+  MetricRegistry registry;
+  scoped_refptr<MetricEntity> entity(METRIC_ENTITY_server.Instantiate(&registry, "test_entity"));
+  BlockCache* cache = BlockCache::GetSingleton();
+  cache->StartInstrumentation(entity);
+
+  BlockId block_id;
+  {
+    const int nrows = 1000;
+    StringDataGenerator<false> generator("hello %04d");
+    WriteTestFile(&generator, PREFIX_ENCODING, LZ4, nrows,
+                  SMALL_BLOCKSIZE | WRITE_VALIDX, &block_id);
+  }
+
+  string first_block;
+  for (int i = 0; i < 2; i++) {
+    unique_ptr<ReadableBlock> source;
+    ASSERT_OK(fs_manager_->OpenBlock(block_id, &source));
+    unique_ptr<CFileReader> reader;
+    ASSERT_OK(CFileReader::Open(std::move(source), ReaderOptions(), &reader));
+
+    unique_ptr<IndexTreeIterator> iter;
+    iter.reset(IndexTreeIterator::Create(nullptr, reader.get(), reader->posidx_root()));
+    ASSERT_OK(iter->SeekToFirst());
+
+    scoped_refptr<BlockHandle> bh;
+    ASSERT_OK(reader->ReadBlock(nullptr, iter->GetCurrentBlockPointer(),
+                                CFileReader::CACHE_BLOCK,
+                                &bh));
+    if (i == 0) {
+      first_block = bh->data().ToString();
+    } else {
+      ASSERT_EQ(first_block, bh->data().ToString());
+    }
+
+    // The first time through, both the seek and the ReadBlock() read from disk.
+    // The second time through, both miss in the main tier but hit in the
+    // compressed tier.
+    ASSERT_EQ(0, down_cast<Counter*>(
+        entity->FindOrNull(METRIC_block_cache_hits_caching).get())->value());
+    ASSERT_EQ(i * 2, down_cast<Counter*>(
+        entity->FindOrNull(METRIC_block_cache_compressed_hits_caching).get())->value());
+  }
+}
+
 // Inject failures in nvm allocation and ensure that we can still read a file.
 TEST_P(TestCFileBothCacheMemoryTypes, TestNvmAllocationFailure) {
   if (GetParam().first != Cache::MemoryType::NVM) {
@@ -1245,7 +1369,7 @@ class TestCFileDifferentCodecs : public TestCFile,
 };
 
 INSTANTIATE_TEST_SUITE_P(Codecs, TestCFileDifferentCodecs,
-                         ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB));
+                         ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD));
 
 // Read/write a file with uncompressible data (random int32s)
 TEST_P(TestCFileDifferentCodecs, TestUncompressible) {
@@ -1305,7 +1429,7 @@ class TestCFileIntegerArrayValues : public TestCFileArrayValues {
 INSTANTIATE_TEST_SUITE_P(ArrayBasics, TestCFileIntegerArrayValues,
                          ::testing::Combine(
                              ::testing::Values(PLAIN_ENCODING, RLE, BIT_SHUFFLE),
-                             ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB)));
+                             ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD)));
 
 // Write/read a file with random int8 values in array cells, where there might
 // be empty array cells and empty array elements themselves.
@@ -1374,7 +1498,7 @@ class TestCFileBinaryArrayValues : public TestCFileArrayValues {
 INSTANTIATE_TEST_SUITE_P(ArrayBasics, TestCFileBinaryArrayValues,
                          ::testing::Combine(
                              ::testing::Values(PLAIN_ENCODING, PREFIX_ENCODING, DICT_ENCODING),
-                             ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB)));
+                             ::testing::Values(NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD)));
 
 // Write/read a file with random string values in array cells.
 TEST_P(TestCFileBinaryArrayValues, ReadWriteStrings) {
@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <deque>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <ostream>
@@ -39,6 +41,7 @@
 #include "kudu/cfile/cfile_writer.h" // for kMagicString
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/array_type_serdes.h"
 #include "kudu/common/column_materialization_context.h"
 #include "kudu/common/column_predicate.h"
@@ -58,9 +61,11 @@
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/array_view.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/cache.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/compression/compression_codec.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/crc.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/fault_injection.h"
@@ -74,6 +79,7 @@
 #include "kudu/util/rle-encoding.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
+#include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
 
 DEFINE_bool(cfile_lazy_open, true,
@@ -90,6 +96,26 @@ DEFINE_double(cfile_inject_corruption, 0,
               "with a corruption status");
 TAG_FLAG(cfile_inject_corruption, hidden);
 
+DEFINE_int32(cfile_lazy_materialization_min_skip_rows, 16,
+             "Minimum number of consecutive rows deselected by the scan's "
+             "selection vector for a column iterator to seek over them in a "
+             "data block instead of decoding them. Shorter runs are decoded "
+             "along with the surrounding selected rows, since a seek may cost "
+             "more than decoding a few values. Set to 0 to always decode "
+             "every row of a batch.");
+TAG_FLAG(cfile_lazy_materialization_min_skip_rows, advanced);
+TAG_FLAG(cfile_lazy_materialization_min_skip_rows, runtime);
+
+DEFINE_int32(cfile_readahead_blocks, 0,
+             "Number of data blocks following the one being decoded which a "
+             "CFile scan reads ahead of the decoder, in parallel on a "
+             "dedicated thread pool of the tablet server. Read-ahead hides the "
+             "latency of reading blocks which aren't in the block cache from "
+             "slow devices, at the cost of reading blocks which a scan may end "
+             "up skipping. Set to 0 to disable read-ahead.");
+TAG_FLAG(cfile_readahead_blocks, experimental);
+TAG_FLAG(cfile_readahead_blocks, runtime);
+
 DECLARE_bool(cfile_support_arrays);
 
 using kudu::fault_injection::MaybeTrue;
@@ -97,6 +123,7 @@ using kudu::fs::ErrorHandlerType;
 using kudu::fs::IOContext;
 using kudu::fs::ReadableBlock;
 using kudu::pb_util::SecureDebugString;
+using std::shared_ptr;
 using std::string;
 using std::to_string;
 using std::unique_ptr;
@@ -146,11 +173,14 @@ CFileReader::CFileReader(ReaderOptions options,
   block_(std::move(block)),
   file_size_(file_size),
   codec_(nullptr),
+  dict_size_(0),
   do_verify_checksum_(false),
   mem_consumption_(std::move(options.parent_mem_tracker),
                    memory_footprint()) {
 }
 
+CFileReader::~CFileReader() = default;
+
 Status CFileReader::Open(unique_ptr<ReadableBlock> block,
                          ReaderOptions options,
                          unique_ptr<CFileReader>* reader) {
@@ -343,6 +373,16 @@ Status CFileReader::ReadAndParseFooter() {
   if (footer_->compression() != NO_COMPRESSION) {
     RETURN_NOT_OK_PREPEND(GetCompressionCodec(footer_->compression(), &codec_),
                           "failed to load CFile compression codec");
+    if (footer_->has_compression_dictionary()) {
+      RETURN_NOT_OK_PREPEND(NewCompressionCodecWithDictionary(
+                                footer_->compression(),
+                                footer_->compression_dictionary(),
+                                &dict_codec_),
+                            "failed to load CFile compression dictionary");
+      codec_ = dict_codec_.get();
+      dict_size_ = footer_->compression_dictionary().size();
+      footer_->clear_compression_dictionary();
+    }
   }
   VLOG(2) << "Read footer: " << SecureDebugString(*footer_);
 
@@ -394,11 +434,12 @@ class ScratchMemory {
   // Try to allocate 'size' bytes from the cache. If the cache has
   // no capacity and cannot evict to make room, this will fall back
   // to allocating from the heap. In that case, IsFromCache() will
-  // return false.
-  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size) {
+  // return false. See BlockCache::Allocate() for 'read_from_file'.
+  void TryAllocateFromCache(BlockCache* cache, const BlockCache::CacheKey& key, int size,
+                            bool read_from_file) {
     DCHECK(!from_cache_.valid());
     DCHECK(!ptr_);
-    from_cache_ = cache->Allocate(key, size);
+    from_cache_ = cache->Allocate(key, size, read_from_file);
     if (!from_cache_.valid()) {
       return AllocateFromHeap(size);
     }
@@ -495,34 +536,72 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
     data_size -= kChecksumSize;
   }
 
+  // If the block cache has a compressed tier, the compressed block may
+  // still be there even though the decompressed block was evicted.
+  const bool use_compressed_tier =
+      codec_ != nullptr && cache_control == CACHE_BLOCK && cache->has_compressed_tier();
+  BlockCacheHandle compressed_handle;
   ScratchMemory scratch;
-  // If we are reading uncompressed data and plan to cache the result,
-  // then we should allocate our scratch memory directly from the cache.
-  // This avoids an extra memory copy in the case of an NVM cache.
-  if (codec_ == nullptr && cache_control == CACHE_BLOCK) {
-    scratch.TryAllocateFromCache(cache, key, data_size);
+  uint8_t* buf = nullptr;
+  Slice block;
+  if (use_compressed_tier && cache->LookupCompressed(key, &compressed_handle)) {
+    TRACE_COUNTER_INCREMENT("cfile_compressed_cache_hit", 1);
+    // The block was verified against its checksum when it was read from disk.
+    block = compressed_handle.data();
   } else {
-    scratch.AllocateFromHeap(data_size);
-  }
-  uint8_t* buf = scratch.get();
-  Slice block(buf, data_size);
-  uint8_t checksum_scratch[kChecksumSize];
-  Slice checksum(checksum_scratch, kChecksumSize);
+    // If we are reading uncompressed data and plan to cache the result,
+    // then we should allocate our scratch memory directly from the cache.
+    // This avoids an extra memory copy in the case of an NVM cache.
+    if (codec_ == nullptr && cache_control == CACHE_BLOCK) {
+      scratch.TryAllocateFromCache(cache, key, data_size, /*read_from_file=*/true);
+    } else {
+      scratch.AllocateFromHeap(data_size);
+    }
+    buf = scratch.get();
+    block = Slice(buf, data_size);
+
+    // Blocks in the persistent tier were verified against their checksums
+    // when they were read from the data directories, and they're validated
+    // against checksums of their own when they're read back.
+    const bool use_persistent_tier =
+        cache_control == CACHE_BLOCK && cache->has_persistent_tier();
+    if (use_persistent_tier && cache->LookupPersistent(key, block)) {
+      TRACE_COUNTER_INCREMENT("cfile_persistent_cache_hit", 1);
+    } else {
+      uint8_t checksum_scratch[kChecksumSize];
+      Slice checksum(checksum_scratch, kChecksumSize);
+
+      // Read the data and checksum if needed.
+      Slice results_backing[] = { block, checksum };
+      ArrayView<Slice> results(results_backing, do_verify_checksum() ? 2 : 1);
+      RETURN_NOT_OK_PREPEND(block_->ReadV(ptr.offset(), results),
+                            Substitute("failed to read CFile block $0 at $1",
+                                       block_id().ToString(), ptr.ToString()));
+
+      if (do_verify_checksum()) {
+        if (auto s = VerifyChecksum(ArrayView<const Slice>(&block, 1), checksum);
+            PREDICT_FALSE(!s.ok())) {
+          RETURN_NOT_OK_HANDLE_CORRUPTION(
+              s.CloneAndPrepend(Substitute("checksum error on CFile block $0 at $1",
+                                           block_id().ToString(), ptr.ToString())),
+              HandleCorruption(io_context));
+        }
+      }
 
-  // Read the data and checksum if needed.
-  Slice results_backing[] = { block, checksum };
-  ArrayView<Slice> results(results_backing, do_verify_checksum() ? 2 : 1);
-  RETURN_NOT_OK_PREPEND(block_->ReadV(ptr.offset(), results),
-                        Substitute("failed to read CFile block $0 at $1",
-                                   block_id().ToString(), ptr.ToString()));
+      if (use_persistent_tier) {
+        cache->InsertPersistent(key, block);
+      }
+    }
 
-  if (do_verify_checksum()) {
-    if (auto s = VerifyChecksum(ArrayView<const Slice>(&block, 1), checksum);
-        PREDICT_FALSE(!s.ok())) {
-      RETURN_NOT_OK_HANDLE_CORRUPTION(
-          s.CloneAndPrepend(Substitute("checksum error on CFile block $0 at $1",
-                                       block_id().ToString(), ptr.ToString())),
-          HandleCorruption(io_context));
+    // Keep a copy of the block in the compressed tier. The copy is cheap
+    // compared to reading the block from disk again once the decompressed
+    // block is evicted.
+    if (use_compressed_tier) {
+      BlockCache::PendingEntry compressed_entry = cache->AllocateCompressed(key, data_size);
+      if (compressed_entry.valid()) {
+        memcpy(compressed_entry.val_ptr(), block.data(), data_size);
+        cache->InsertCompressed(&compressed_entry, &compressed_handle);
+      }
     }
   }
 
@@ -542,7 +621,8 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
     // decompress directly into the cache's memory (to avoid a memcpy for NVM).
     ScratchMemory decompressed_scratch;
     if (cache_control == CACHE_BLOCK) {
-      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size);
+      decompressed_scratch.TryAllocateFromCache(cache, key, uncompressed_size,
+                                                /*read_from_file=*/false);
     } else {
       decompressed_scratch.AllocateFromHeap(uncompressed_size);
     }
@@ -560,6 +640,7 @@ Status CFileReader::ReadBlock(const IOContext* io_context,
     scratch.Swap(&decompressed_scratch);
 
     // Set the result block to our decompressed data.
+    buf = scratch.get();
     block = Slice(buf, uncompressed_size);
   }
 
@@ -610,8 +691,9 @@ bool CFileReader::GetMetadataEntry(const string& key, string* val) const {
 
 Status CFileReader::NewIterator(unique_ptr<CFileIterator>* iter,
                                 CacheControl cache_control,
-                                const IOContext* io_context) {
-  iter->reset(new CFileIterator(this, cache_control, io_context));
+                                const IOContext* io_context,
+                                ThreadPool* readahead_pool) {
+  iter->reset(new CFileIterator(this, cache_control, io_context, readahead_pool));
   return Status::OK();
 }
 
@@ -639,6 +721,7 @@ size_t CFileReader::memory_footprint() const {
   if (footer_) {
     size += footer_->SpaceUsedLong();
   }
+  size += dict_size_;
   return size;
 }
 
@@ -710,19 +793,46 @@ Status DefaultColumnValueIterator::FinishBatch() {
 ////////////////////////////////////////////////////////////
 // Iterator
 ////////////////////////////////////////////////////////////
+
+struct CFileIterator::ReadaheadBlock {
+  explicit ReadaheadBlock(const BlockPointer& ptr)
+      : ptr(ptr),
+        done(1) {
+  }
+
+  const BlockPointer ptr;
+
+  // Counted down once the read completes, and guards 'status' and 'handle'.
+  CountDownLatch done;
+  Status status;
+  scoped_refptr<BlockHandle> handle;
+};
+
 CFileIterator::CFileIterator(CFileReader* reader,
                              CFileReader::CacheControl cache_control,
-                             const IOContext* io_context)
+                             const IOContext* io_context,
+                             ThreadPool* readahead_pool)
   : reader_(reader),
+    num_codewords_matching_pred_(0),
+    single_codeword_matching_pred_(0),
+    zone_map_loaded_(false),
     seeked_(nullptr),
     prepared_(false),
     cache_control_(cache_control),
     last_prepare_idx_(-1),
     last_prepare_count_(-1),
-    io_context_(io_context) {
+    io_context_(io_context),
+    readahead_pool_(readahead_pool),
+    num_blocks_read_ahead_(0) {
 }
 
 CFileIterator::~CFileIterator() {
+  for (const auto& block : readahead_blocks_) {
+    block->done.Wait();
+  }
+  for (const auto& block : abandoned_readahead_blocks_) {
+    block->done.Wait();
+  }
 }
 
 Status CFileIterator::SeekToOrdinal(rowid_t ord_idx) {
@@ -835,6 +945,68 @@ void CFileIterator::SeekToPositionInBlock(PreparedBlock* pb, uint32_t idx_in_blo
   pb->idx_in_block_ = idx_in_block;
 }
 
+Status CFileIterator::CopyNextSelectedValues(PreparedBlock* pb,
+                                             const SelectionVector& sel,
+                                             size_t sel_offset,
+                                             size_t* n,
+                                             ColumnDataView* dst) {
+  BlockDecoder* dblk = pb->dblk_.get();
+  const size_t start_idx = dblk->GetCurrentIndex();
+  const size_t count = std::min<size_t>(*n, dblk->Count() - start_idx);
+  const size_t sel_end = sel_offset + count;
+  const size_t min_skip = std::max(FLAGS_cfile_lazy_materialization_min_skip_rows, 1);
+  DCHECK_LE(sel_end, sel.nrows());
+
+  ColumnDataView run_dst(*dst);
+  auto copy_values = [&](size_t num) -> Status {
+    if (num == 0) {
+      return Status::OK();
+    }
+    size_t copied = num;
+    RETURN_NOT_OK(dblk->CopyNextValues(&copied, &run_dst));
+    if (PREDICT_FALSE(copied != num)) {
+      return Status::Corruption(Substitute(
+          "data block yielded $0 values, expected $1", copied, num));
+    }
+    run_dst.Advance(num);
+    return Status::OK();
+  };
+
+  // 'decoded_end' is the first row which has neither been decoded nor skipped.
+  size_t decoded_end = sel_offset;
+  size_t pos = sel_offset;
+  while (pos < sel_end) {
+    size_t skip_start;
+    if (!BitmapFindFirstZero(sel.bitmap(), pos, sel_end, &skip_start)) {
+      break;
+    }
+    size_t skip_end;
+    if (!BitmapFindFirstSet(sel.bitmap(), skip_start, sel_end, &skip_end)) {
+      skip_end = sel_end;
+    }
+    size_t skip_len = skip_end - skip_start;
+    if (skip_len >= min_skip) {
+      RETURN_NOT_OK(copy_values(skip_start - decoded_end));
+      size_t target_idx = start_idx + skip_end - sel_offset;
+      if (target_idx == dblk->Count()) {
+        // Not all decoders support seeking past their last value: stop one
+        // short of the end and decode the final value instead.
+        target_idx--;
+        skip_len--;
+      }
+      dblk->SeekToPositionInBlock(target_idx);
+      run_dst.Advance(skip_len);
+      io_stats_.cells_skipped += skip_len;
+      decoded_end = skip_start + skip_len;
+    }
+    pos = skip_end;
+  }
+  RETURN_NOT_OK(copy_values(sel_end - decoded_end));
+
+  *n = count;
+  return Status::OK();
+}
+
 Status CFileIterator::SeekToFirst() {
   RETURN_NOT_OK(PrepareForNewSeek());
   IndexTreeIterator* idx_iter = nullptr;
@@ -1045,8 +1217,7 @@ Status DecodeArrayInfo(scoped_refptr<BlockHandle>* data_block_handle,
 Status CFileIterator::ReadCurrentDataBlock(const IndexTreeIterator& idx_iter,
                                            PreparedBlock* prep_block) {
   prep_block->dblk_ptr_ = idx_iter.GetCurrentBlockPointer();
-  RETURN_NOT_OK(reader_->ReadBlock(
-      io_context_, prep_block->dblk_ptr_, cache_control_, &prep_block->dblk_handle_));
+  RETURN_NOT_OK(ReadDataBlock(idx_iter, prep_block->dblk_ptr_, &prep_block->dblk_handle_));
 
   uint32_t num_rows_in_block = 0;
   scoped_refptr<BlockHandle> data_block = prep_block->dblk_handle_;
@@ -1130,6 +1301,103 @@ Status CFileIterator::QueueCurrentDataBlock(const IndexTreeIterator& idx_iter) {
   return Status::OK();
 }
 
+Status CFileIterator::ReadDataBlock(const IndexTreeIterator& idx_iter,
+                                    const BlockPointer& ptr,
+                                    scoped_refptr<BlockHandle>* handle) {
+  // Seeks through the value index read a single block, so only scans through
+  // the positional index read ahead.
+  if (!readahead_pool_ || FLAGS_cfile_readahead_blocks <= 0 ||
+      &idx_iter != posidx_iter_.get()) {
+    AbandonReadahead();
+    return reader_->ReadBlock(io_context_, ptr, cache_control_, handle);
+  }
+
+  shared_ptr<ReadaheadBlock> block;
+  while (!readahead_blocks_.empty()) {
+    shared_ptr<ReadaheadBlock> next = std::move(readahead_blocks_.front());
+    readahead_blocks_.pop_front();
+    if (next->ptr == ptr) {
+      block = std::move(next);
+      break;
+    }
+    abandoned_readahead_blocks_.emplace_back(std::move(next));
+  }
+
+  if (block) {
+    block->done.Wait();
+  } else {
+    // The scan seeked away from the blocks being read ahead, if any: restart
+    // the read-ahead from the block being read.
+    AbandonReadahead();
+    if (!readahead_iter_) {
+      BlockPointer root(reader_->footer().posidx_info().root_block());
+      readahead_iter_.reset(IndexTreeIterator::Create(io_context_, reader_, root));
+    }
+    Status s = readahead_iter_->SeekAtOrBefore(idx_iter.GetCurrentKey());
+    if (PREDICT_FALSE(!s.ok())) {
+      readahead_iter_.reset();
+    }
+  }
+  StartReadahead();
+
+  // Errors reading ahead are surfaced by reading the block again.
+  if (block && block->status.ok()) {
+    *handle = std::move(block->handle);
+    return Status::OK();
+  }
+  return reader_->ReadBlock(io_context_, ptr, cache_control_, handle);
+}
+
+void CFileIterator::StartReadahead() {
+  if (!readahead_iter_) {
+    return;
+  }
+  const size_t max_blocks = std::max(0, FLAGS_cfile_readahead_blocks);
+  while (readahead_blocks_.size() < max_blocks &&
+         readahead_iter_->HasNext()) {
+    if (PREDICT_FALSE(!readahead_iter_->Next().ok())) {
+      readahead_iter_.reset();
+      return;
+    }
+    // The positional index is keyed by the first ordinal of each block.
+    if (!readahead_upper_bound_.empty() &&
+        readahead_iter_->GetCurrentKey().compare(Slice(readahead_upper_bound_)) >= 0) {
+      readahead_iter_.reset();
+      return;
+    }
+    auto block = std::make_shared<ReadaheadBlock>(readahead_iter_->GetCurrentBlockPointer());
+    CFileReader* reader = reader_;
+    const IOContext* io_context = io_context_;
+    const CFileReader::CacheControl cache_control = cache_control_;
+    Status s = readahead_pool_->Submit([reader, io_context, cache_control, block]() {
+      block->status = reader->ReadBlock(io_context, block->ptr, cache_control, &block->handle);
+      block->done.CountDown();
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      // The skipped block restarts the read-ahead once it's read.
+      return;
+    }
+    readahead_blocks_.emplace_back(std::move(block));
+    num_blocks_read_ahead_++;
+  }
+}
+
+void CFileIterator::SetReadaheadUpperBound(rowid_t ord_idx) {
+  readahead_upper_bound_.clear();
+  KeyEncoderTraits<UINT32, faststring>::Encode(ord_idx, &readahead_upper_bound_);
+}
+
+void CFileIterator::AbandonReadahead() {
+  for (auto& block : readahead_blocks_) {
+    abandoned_readahead_blocks_.emplace_back(std::move(block));
+  }
+  readahead_blocks_.clear();
+  abandoned_readahead_blocks_.erase(
+      std::remove_if(abandoned_readahead_blocks_.begin(), abandoned_readahead_blocks_.end(),
+                     [](const shared_ptr<ReadaheadBlock>& b) { return b->done.count() == 0; }),
+      abandoned_readahead_blocks_.end());
+}
+
 bool CFileIterator::HasNext() const {
   DCHECK(seeked_) << "not seeked";
   DCHECK(!prepared_) << "Cannot call HasNext() mid-batch";
@@ -1249,16 +1517,33 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
   if (dict_decoder_ && ctx->DecoderEvalNotDisabled() && !codewords_matching_pred_) {
     size_t nwords = dict_decoder_->Count();
     if (nwords > 0) {
+      const ColumnPredicate* pred = ctx->pred();
+      // Dictionary entries are unique, so at most one entry can satisfy an
+      // equality predicate, and at most one entry per value of an IN-list.
+      size_t max_matches = nwords;
+      if (pred->predicate_type() == PredicateType::Equality) {
+        max_matches = 1;
+      } else if (pred->predicate_type() == PredicateType::InList) {
+        max_matches = pred->raw_values().size();
+      }
       codewords_matching_pred_.reset(new SelectionVector(nwords));
       codewords_matching_pred_->SetAllFalse();
-      for (size_t i = 0; i < nwords; i++) {
+      num_codewords_matching_pred_ = 0;
+      for (size_t i = 0; i < nwords && num_codewords_matching_pred_ < max_matches; i++) {
         Slice cur_string = dict_decoder_->string_at_index(i);
-        if (ctx->pred()->EvaluateCell<BINARY>(static_cast<const void*>(&cur_string))) {
+        if (pred->EvaluateCell<BINARY>(static_cast<const void*>(&cur_string))) {
           BitmapSet(codewords_matching_pred_->mutable_bitmap(), i);
+          single_codeword_matching_pred_ = i;
+          num_codewords_matching_pred_++;
         }
       }
     }
   }
+  // Unless the decoders are to evaluate a predicate, the values of rows which
+  // the caller has already deselected needn't be decoded at all.
+  const bool copy_selected_only = ctx->SkipDeselectedRows() &&
+      !ctx->DecoderEvalNotDisabled() &&
+      FLAGS_cfile_lazy_materialization_min_skip_rows > 0;
   for (PreparedBlock* pb : prepared_blocks_) {
     if (pb->needs_rewind_) {
       // Seek back to the saved position.
@@ -1418,6 +1703,9 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
                                                      ctx,
                                                      &remaining_sel,
                                                      &remaining_dst));
+          } else if (copy_selected_only) {
+            RETURN_NOT_OK(CopyNextSelectedValues(pb, *ctx->sel(), last_prepare_count_ - rem,
+                                                 &this_batch, &remaining_dst));
           } else {
             RETURN_NOT_OK(pb->dblk_->CopyNextValues(&this_batch, &remaining_dst));
           }
@@ -1449,6 +1737,9 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
 
       if (ctx->DecoderEvalNotDisabled()) {
         RETURN_NOT_OK(pb->dblk_->CopyNextAndEval(&this_batch, ctx, &remaining_sel, &remaining_dst));
+      } else if (copy_selected_only) {
+        RETURN_NOT_OK(CopyNextSelectedValues(pb, *ctx->sel(), last_prepare_count_ - rem,
+                                             &this_batch, &remaining_dst));
       } else {
         RETURN_NOT_OK(pb->dblk_->CopyNextValues(&this_batch, &remaining_dst));
       }
@@ -1480,6 +1771,78 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
   return Status::OK();
 }
 
+Status CFileIterator::PruneWithZoneMap(const ColumnPredicate& pred,
+                                       rowid_t first_row,
+                                       SelectionVector* sel) {
+  if (!zone_map_loaded_) {
+    RETURN_NOT_OK(reader_->Init(io_context_));
+    if (reader_->footer().has_zone_map_block_ptr()) {
+      BlockPointer bp(reader_->footer().zone_map_block_ptr());
+      scoped_refptr<BlockHandle> zone_map_block;
+      RETURN_NOT_OK_PREPEND(reader_->ReadBlock(io_context_, bp, cache_control_, &zone_map_block),
+                            "couldn't read zone map block");
+      RETURN_NOT_OK_PREPEND(ZoneMap::Parse(reader_->type_info(),
+                                           zone_map_block->data(),
+                                           reader_->footer().num_values(),
+                                           &zone_map_),
+                            Substitute("couldn't parse zone map in block $0 ($1)",
+                                       reader_->block_id().ToString(),
+                                       bp.ToString()));
+    }
+    zone_map_loaded_ = true;
+  }
+  if (zone_map_) {
+    zone_map_->Prune(pred, first_row, sel);
+  }
+  return Status::OK();
+}
+
+Status CFileIterator::CheckBloomFilter(const ColumnPredicate& pred, bool* may_match) {
+  *may_match = true;
+  if (pred.predicate_type() != PredicateType::Equality &&
+      pred.predicate_type() != PredicateType::InList) {
+    return Status::OK();
+  }
+  RETURN_NOT_OK(reader_->Init(io_context_));
+  if (!reader_->footer().has_bloom_filter_block_ptr()) {
+    return Status::OK();
+  }
+
+  BlockPointer bp(reader_->footer().bloom_filter_block_ptr());
+  scoped_refptr<BlockHandle> bloom_block;
+  RETURN_NOT_OK_PREPEND(reader_->ReadBlock(io_context_, bp, cache_control_, &bloom_block),
+                        "couldn't read bloom filter block");
+  Slice data = bloom_block->data();
+  if (PREDICT_FALSE(data.size() < sizeof(uint32_t))) {
+    return Status::Corruption("bloom filter block too short", bp.ToString());
+  }
+  const uint32_t hdr_len = DecodeFixed32(data.data());
+  data.remove_prefix(sizeof(uint32_t));
+  BloomBlockHeaderPB hdr;
+  if (PREDICT_FALSE(hdr_len > data.size() || !hdr.ParseFromArray(data.data(), hdr_len))) {
+    return Status::Corruption("invalid bloom filter block header", bp.ToString());
+  }
+  data.remove_prefix(hdr_len);
+  if (PREDICT_FALSE(hdr.filter_type() != BloomBlockHeaderPB::CLASSIC)) {
+    // Column bloom filters are only written as classic bloom filters.
+    return Status::Corruption("unexpected bloom filter type in column bloom filter block",
+                              bp.ToString());
+  }
+  BloomFilter bloom(data, hdr.num_hash_functions());
+
+  const TypeInfo* type_info = reader_->type_info();
+  auto may_contain = [&](const void* value) {
+    uint64_t scratch;
+    return bloom.MayContainKey(BloomKeyProbe(ColumnBloomFilterKey(type_info, value, &scratch)));
+  };
+  if (pred.predicate_type() == PredicateType::Equality) {
+    *may_match = may_contain(pred.raw_lower());
+  } else {
+    *may_match = std::any_of(pred.raw_values().begin(), pred.raw_values().end(), may_contain);
+  }
+  return Status::OK();
+}
+
 Status CFileIterator::CopyNextValues(size_t* n, ColumnMaterializationContext* ctx) {
   RETURN_NOT_OK(PrepareBatch(n));
   RETURN_NOT_OK(Scan(ctx));
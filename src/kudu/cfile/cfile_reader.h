@@ -18,6 +18,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -45,10 +46,13 @@
 
 namespace kudu {
 
+class ColumnDataView;
 class ColumnMaterializationContext;
+class ColumnPredicate;
 class CompressionCodec;
 class EncodedKey;
 class SelectionVector;
+class ThreadPool;
 class TypeInfo;
 
 namespace fs {
@@ -63,6 +67,7 @@ class BinaryPlainBlockDecoder;
 class CFileIterator;
 class IndexTreeIterator;
 class TypeEncodingInfo;
+class ZoneMap;
 struct ReaderOptions;
 
 class CFileReader {
@@ -84,6 +89,8 @@ class CFileReader {
                            ReaderOptions options,
                            std::unique_ptr<CFileReader>* reader);
 
+  ~CFileReader();
+
   // Fully opens a previously lazily opened cfile, parsing and validating
   // its contents.
   //
@@ -96,9 +103,13 @@ class CFileReader {
   };
 
   // Can be called before Init().
+  //
+  // If 'readahead_pool' is set, the iterator reads data blocks ahead of the
+  // scan on it. See --cfile_readahead_blocks.
   Status NewIterator(std::unique_ptr<CFileIterator>* iter,
                      CacheControl cache_control,
-                     const fs::IOContext* io_context);
+                     const fs::IOContext* io_context,
+                     ThreadPool* readahead_pool = nullptr);
 
   // Reads the data block pointed to by `ptr`. Will pull the data block from
   // the block cache if it exists, and reads from the filesystem block
@@ -221,6 +232,11 @@ class CFileReader {
   std::unique_ptr<CFileHeaderPB> header_;
   std::unique_ptr<CFileFooterPB> footer_;
   const CompressionCodec* codec_;
+  // Codec primed with the compression dictionary stored in the footer, if any.
+  // When set, 'codec_' points to it. The codec holds the only copy of the
+  // dictionary, which is released from the footer, and 'dict_size_' is its size.
+  std::unique_ptr<CompressionCodec> dict_codec_;
+  size_t dict_size_;
   const TypeInfo* type_info_;
   const TypeEncodingInfo* type_encoding_info_;
 
@@ -328,7 +344,8 @@ class CFileIterator final : public ColumnIterator {
  public:
   CFileIterator(CFileReader* reader,
                 CFileReader::CacheControl cache_control,
-                const fs::IOContext* io_context);
+                const fs::IOContext* io_context,
+                ThreadPool* readahead_pool = nullptr);
   ~CFileIterator();
 
   // Seek to the first entry in the file. This works for both
@@ -400,6 +417,15 @@ class CFileIterator final : public ColumnIterator {
     return io_stats_;
   }
 
+  // Don't read ahead the data blocks starting at or after ordinal 'ord_idx',
+  // the end of the range of rows which the scan will read.
+  void SetReadaheadUpperBound(rowid_t ord_idx);
+
+  // The number of data blocks which were read ahead of the scan so far.
+  size_t num_blocks_read_ahead() const {
+    return num_blocks_read_ahead_;
+  }
+
   // If the column is dictionary-coded, returns the decoder
   // for the cfile's dictionary block. This is called by the
   // BinaryDictBlockDecoder.
@@ -414,6 +440,36 @@ class CFileIterator final : public ColumnIterator {
     return codewords_matching_pred_.get();
   }
 
+  // Returns the number of codewords set in GetCodeWordsMatchingPredicate().
+  size_t GetNumCodeWordsMatchingPredicate() const {
+    return num_codewords_matching_pred_;
+  }
+
+  // If exactly one codeword matches the predicate, returns that codeword.
+  uint32_t GetSingleCodeWordMatchingPredicate() const {
+    DCHECK_EQ(1, num_codewords_matching_pred_);
+    return single_codeword_matching_pred_;
+  }
+
+  // Clear the bits in 'sel', which describes the rows starting at ordinal
+  // 'first_row', of the rows whose data blocks can't contain a cell that
+  // satisfies 'pred' according to the CFile's zone map. The zone map is
+  // read on first use; this is a no-op if the CFile doesn't have one.
+  //
+  // The zone map describes the data as it was written, so the caller must
+  // not use this for rows which may have been updated since.
+  Status PruneWithZoneMap(const ColumnPredicate& pred,
+                          rowid_t first_row,
+                          SelectionVector* sel);
+
+  // Check the values of an equality or IN-list predicate against the bloom
+  // filter of the CFile's values. Sets '*may_match' to false if none of the
+  // values are present in the CFile, and to true otherwise, including if
+  // the CFile has no bloom filter or 'pred' is of a different type.
+  //
+  // As with zone maps, the bloom filter describes the data as it was written.
+  Status CheckBloomFilter(const ColumnPredicate& pred, bool* may_match);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(CFileIterator);
 
@@ -472,6 +528,19 @@ class CFileIterator final : public ColumnIterator {
   // Seek the given PreparedBlock to the given index within it.
   void SeekToPositionInBlock(PreparedBlock* pb, uint32_t idx_in_block);
 
+  // Copy up to '*n' of the next values in the data block of 'pb' into 'dst',
+  // decoding only the values of rows which are selected in 'sel', starting
+  // at row 'sel_offset'. Runs of deselected rows which are long enough to be
+  // worth a seek are skipped within the data block without being decoded,
+  // leaving the corresponding cells of 'dst' unset.
+  //
+  // On return, '*n' is set to the number of rows consumed from the block.
+  Status CopyNextSelectedValues(PreparedBlock* pb,
+                                const SelectionVector& sel,
+                                size_t sel_offset,
+                                size_t* n,
+                                ColumnDataView* dst);
+
   // Read the data block currently pointed to by idx_iter_
   // into the given PreparedBlock structure.
   //
@@ -483,6 +552,21 @@ class CFileIterator final : public ColumnIterator {
   // it onto the end of the prepared_blocks_ deque.
   Status QueueCurrentDataBlock(const IndexTreeIterator& idx_iter);
 
+  // Read the data block at 'ptr', which 'idx_iter' currently points to,
+  // into 'handle'. When reading through the positional index with
+  // read-ahead enabled, the block is taken from the blocks read ahead if
+  // it's one of them, and the blocks following it are read ahead.
+  Status ReadDataBlock(const IndexTreeIterator& idx_iter,
+                       const BlockPointer& ptr,
+                       scoped_refptr<BlockHandle>* handle);
+
+  // Start reading the blocks following the one 'readahead_iter_' points to
+  // until --cfile_readahead_blocks blocks are being read ahead.
+  void StartReadahead();
+
+  // Stop waiting for the blocks being read ahead.
+  void AbandonReadahead();
+
   // Fully initialize the underlying cfile reader if needed, and clear any
   // seek-related state.
   Status PrepareForNewSeek();
@@ -498,6 +582,12 @@ class CFileIterator final : public ColumnIterator {
 
   // Set containing the codewords that match the predicate in a dictionary.
   std::unique_ptr<SelectionVector> codewords_matching_pred_;
+  size_t num_codewords_matching_pred_;
+  uint32_t single_codeword_matching_pred_;
+
+  // The zone map of the CFile, if it has one and it's been loaded.
+  std::unique_ptr<ZoneMap> zone_map_;
+  bool zone_map_loaded_;
 
   // The currently in-use index iterator. This is equal to either
   // posidx_iter_.get(), validx_iter_.get(), or NULL if not seeked.
@@ -529,6 +619,31 @@ class CFileIterator final : public ColumnIterator {
 
   const fs::IOContext* io_context_;
 
+  // The pool on which data blocks are read ahead of the scan, or null if
+  // they aren't. It's owned by the server.
+  ThreadPool* const readahead_pool_;
+
+  // A block read ahead of the scan on 'readahead_pool_'.
+  struct ReadaheadBlock;
+
+  // Iterator over the positional index pointing at the last block being
+  // read ahead, if read-ahead has started since the last seek.
+  std::unique_ptr<IndexTreeIterator> readahead_iter_;
+
+  // The blocks being read ahead, in order.
+  std::deque<std::shared_ptr<ReadaheadBlock>> readahead_blocks_;
+
+  // The encoded ordinal at which to stop reading ahead, if any. See
+  // SetReadaheadUpperBound().
+  faststring readahead_upper_bound_;
+
+  size_t num_blocks_read_ahead_;
+
+  // Blocks which were read ahead but skipped by a seek, which may still be
+  // being read. They refer to 'reader_' and 'io_context_', so they're
+  // waited for before destroying the iterator.
+  std::vector<std::shared_ptr<ReadaheadBlock>> abandoned_readahead_blocks_;
+
   // a temporary buffer for encoding
   faststring tmp_buf_;
 };
@@ -18,7 +18,10 @@
 #include "kudu/cfile/cfile_util.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <optional>
 #include <string>
 
@@ -46,6 +49,7 @@ constexpr const size_t kIndexBlockSize = 32 * 1024;
 constexpr const int kBlockRestartInterval = 16;
 constexpr const bool kWritePosIdxEnabled = false;
 constexpr const bool kWriteValIdxEnabled = false;
+constexpr const bool kWriteZoneMapEnabled = false;
 constexpr const bool kOptimizeIndexKeysEnabled = true;
 } // anonymous namespace
 
@@ -54,8 +58,10 @@ WriterOptions::WriterOptions()
       block_restart_interval(kBlockRestartInterval),
       write_posidx(kWritePosIdxEnabled),
       write_validx(kWriteValIdxEnabled),
+      write_zone_map(kWriteZoneMapEnabled),
       optimize_index_keys(kOptimizeIndexKeysEnabled),
-      validx_key_encoder(std::nullopt) {
+      validx_key_encoder(std::nullopt),
+      incompatible_features(IncompatibleFeatures::NONE) {
 }
 
 WriterOptionsBuilder::WriterOptionsBuilder() noexcept
@@ -63,8 +69,10 @@ WriterOptionsBuilder::WriterOptionsBuilder() noexcept
       block_restart_interval_(kBlockRestartInterval),
       write_posidx_(kWritePosIdxEnabled),
       write_validx_(kWriteValIdxEnabled),
+      write_zone_map_(kWriteZoneMapEnabled),
       optimize_index_keys_(kOptimizeIndexKeysEnabled),
-      validx_key_encoder_(std::nullopt) {
+      validx_key_encoder_(std::nullopt),
+      incompatible_features_(IncompatibleFeatures::NONE) {
 }
 
 WriterOptionsBuilder& WriterOptionsBuilder::index_block_size(size_t size) noexcept {
@@ -87,6 +95,11 @@ WriterOptionsBuilder& WriterOptionsBuilder::write_validx(bool is_enabled) noexce
   return *this;
 }
 
+WriterOptionsBuilder& WriterOptionsBuilder::write_zone_map(bool is_enabled) noexcept {
+  write_zone_map_ = is_enabled;
+  return *this;
+}
+
 WriterOptionsBuilder& WriterOptionsBuilder::optimize_index_keys(bool is_enabled) noexcept {
   optimize_index_keys_ = is_enabled;
   return *this;
@@ -103,15 +116,22 @@ WriterOptionsBuilder& WriterOptionsBuilder::validx_key_encoder(ValidxKeyEncoder
   return *this;
 }
 
+WriterOptionsBuilder& WriterOptionsBuilder::incompatible_features(uint32_t features) noexcept {
+  incompatible_features_ = features;
+  return *this;
+}
+
 WriterOptions WriterOptionsBuilder::Build() noexcept {
   WriterOptions opt;
   opt.index_block_size = index_block_size_;
   opt.block_restart_interval = block_restart_interval_;
   opt.write_posidx = write_posidx_;
   opt.write_validx = write_validx_;
+  opt.write_zone_map = write_zone_map_;
   opt.optimize_index_keys = optimize_index_keys_;
   opt.storage_attributes = storage_attributes_;
   opt.validx_key_encoder = validx_key_encoder_;
+  opt.incompatible_features = incompatible_features_;
   return opt;
 }
 
@@ -215,5 +235,36 @@ void GetSeparatingKey(const Slice& left, Slice* right) {
   right->truncate(cpl == right->size() ? cpl : cpl + 1);
 }
 
+namespace {
+
+template<typename T>
+Slice CanonicalFloatKey(const void* cell, uint64_t* scratch) {
+  static_assert(sizeof(T) <= sizeof(*scratch), "scratch too small");
+  T val = UnalignedLoad<T>(cell);
+  if (std::isnan(val)) {
+    val = std::numeric_limits<T>::quiet_NaN();
+  } else if (val == 0) {
+    // Maps -0.0 to +0.0.
+    val = 0;
+  }
+  memcpy(scratch, &val, sizeof(T));
+  return Slice(reinterpret_cast<const uint8_t*>(scratch), sizeof(T));
+}
+
+} // anonymous namespace
+
+Slice ColumnBloomFilterKey(const TypeInfo* type_info, const void* cell, uint64_t* scratch) {
+  switch (type_info->physical_type()) {
+    case BINARY:
+      return *reinterpret_cast<const Slice*>(cell);
+    case FLOAT:
+      return CanonicalFloatKey<float>(cell, scratch);
+    case DOUBLE:
+      return CanonicalFloatKey<double>(cell, scratch);
+    default:
+      return Slice(reinterpret_cast<const uint8_t*>(cell), type_info->size());
+  }
+}
+
 } // namespace cfile
 } // namespace kudu
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <optional>
@@ -29,6 +30,7 @@
 namespace kudu {
 
 class MemTracker;
+class TypeInfo;
 class faststring;
 
 namespace fs {
@@ -50,7 +52,16 @@ enum IncompatibleFeatures {
   // Support for reading/writing array data blocks
   ARRAY_DATA_BLOCK = 1 << 1,
 
-  SUPPORTED = NONE | CHECKSUM | ARRAY_DATA_BLOCK
+  // Blocks are compressed with ZSTD, possibly using a dictionary stored
+  // in the footer. Older readers don't recognize the ZSTD codec type and
+  // would otherwise mistake the blocks for uncompressed ones.
+  ZSTD_COMPRESSION = 1 << 2,
+
+  // The blocks of a bloom file hold block bloom filters rather than classic
+  // ones. Older readers would otherwise probe them as classic bloom filters.
+  BLOCK_BLOOM_FILTER = 1 << 3,
+
+  SUPPORTED = NONE | CHECKSUM | ARRAY_DATA_BLOCK | ZSTD_COMPRESSION | BLOCK_BLOOM_FILTER
 };
 
 typedef std::function<void(const void*, faststring*)> ValidxKeyEncoder;
@@ -76,6 +87,10 @@ struct WriterOptions {
   // Whether the file needs a value index
   bool write_validx;
 
+  // Whether to write a zone map with the statistics of each data block,
+  // allowing scans to skip blocks which can't match their predicates.
+  bool write_zone_map;
+
   // Whether to optimize index keys by storing shortest separating prefixes
   // instead of entire keys.
   bool optimize_index_keys;
@@ -90,6 +105,12 @@ struct WriterOptions {
   // encodes the entire value.
   std::optional<ValidxKeyEncoder> validx_key_encoder;
 
+  // Incompatible features of the blocks appended by the writer's client,
+  // which are set in the footer in addition to the writer's own.
+  //
+  // Default: NONE
+  uint32_t incompatible_features;
+
   WriterOptions();
 };
 
@@ -102,9 +123,11 @@ class WriterOptionsBuilder final {
   WriterOptionsBuilder& block_restart_interval(int interval) noexcept;
   WriterOptionsBuilder& write_posidx(bool is_enabled) noexcept;
   WriterOptionsBuilder& write_validx(bool is_enabled) noexcept;
+  WriterOptionsBuilder& write_zone_map(bool is_enabled) noexcept;
   WriterOptionsBuilder& optimize_index_keys(bool is_enabled) noexcept;
   WriterOptionsBuilder& storage_attributes(const ColumnStorageAttributes& attrs) noexcept;
   WriterOptionsBuilder& validx_key_encoder(ValidxKeyEncoder enc) noexcept;
+  WriterOptionsBuilder& incompatible_features(uint32_t features) noexcept;
 
   WriterOptions Build() noexcept;
 
@@ -113,9 +136,11 @@ class WriterOptionsBuilder final {
   int block_restart_interval_;
   bool write_posidx_;
   bool write_validx_;
+  bool write_zone_map_;
   bool optimize_index_keys_;
   ColumnStorageAttributes storage_attributes_;
   std::optional<ValidxKeyEncoder> validx_key_encoder_;
+  uint32_t incompatible_features_;
 };
 
 struct ReaderOptions {
@@ -146,5 +171,11 @@ size_t CommonPrefixLength(const Slice& a, const Slice& b);
 // Truncate right to give a shortest key satisfying left <= key <= right.
 void GetSeparatingKey(const Slice& left, Slice* right);
 
+// Return the key under which the given cell is added to or probed in a
+// column bloom filter. Floating point values are canonicalized into
+// 'scratch' first, so that values which compare equal (e.g. -0.0 and 0.0,
+// or NaNs with different payloads) hash the same.
+Slice ColumnBloomFilterKey(const TypeInfo* type_info, const void* cell, uint64_t* scratch);
+
 }  // namespace cfile
 }  // namespace kudu
@@ -19,6 +19,7 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <functional>
 #include <iterator>
 #include <numeric>
@@ -36,6 +37,7 @@
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/array_cell_view.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/key_encoder.h"
@@ -44,6 +46,7 @@
 #include "kudu/gutil/port.h"
 #include "kudu/util/array_view.h" // IWYU pragma: keep
 #include "kudu/util/bitmap.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/coding.h"
 #include "kudu/util/coding-inl.h"
 #include "kudu/util/compression/compression_codec.h"
@@ -62,10 +65,37 @@ DEFINE_string(cfile_default_compression_codec, "no_compression",
               "Default cfile block compression codec.");
 TAG_FLAG(cfile_default_compression_codec, advanced);
 
+DEFINE_int32(cfile_zstd_dictionary_size, 0,
+             "Maximum size (in bytes) of the compression dictionary to train "
+             "for each CFile written with the ZSTD codec. The dictionary is "
+             "trained on the first data blocks of the CFile, up to 8 MiB of "
+             "them, and stored in its footer, which improves the compression "
+             "ratio of small blocks. "
+             "If 0, dictionaries are not used.");
+TAG_FLAG(cfile_zstd_dictionary_size, experimental);
+
 DEFINE_bool(cfile_write_checksums, true,
             "Write CRC32 checksums for each block");
 TAG_FLAG(cfile_write_checksums, evolving);
 
+DEFINE_bool(cfile_write_zone_maps, true,
+            "Write a zone map with the minimum, maximum and null count of each "
+            "data block into CFiles which request one, so scans can skip the "
+            "data blocks which can't satisfy their predicates.");
+TAG_FLAG(cfile_write_zone_maps, evolving);
+
+DEFINE_int32(cfile_bloom_filter_max_size, 4 * 1024 * 1024,
+             "Size in bytes of the bloom filter of a column's values while a CFile "
+             "of a column with the bloom filter storage attribute is being written. "
+             "Once the CFile is finished, the filter is shrunk to fit the values "
+             "which were written; beyond the capacity of a filter of this size, "
+             "its false positive rate grows.");
+TAG_FLAG(cfile_bloom_filter_max_size, advanced);
+
+DEFINE_double(cfile_bloom_filter_fp_rate, 0.01,
+              "Target false positive rate of the bloom filters of column values");
+TAG_FLAG(cfile_bloom_filter_fp_rate, advanced);
+
 DEFINE_bool(cfile_support_arrays, true,
             "Support encoding/decoding of arrays in CFile data blocks");
 TAG_FLAG(cfile_support_arrays, experimental);
@@ -79,6 +109,20 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 
+// The amount of sample data collected to train a compression dictionary,
+// relative to the size of the dictionary. ZSTD recommends about 100x.
+static constexpr size_t kDictTrainingSampleRatio = 100;
+
+// The maximum amount of sample data buffered per CFile to train a compression
+// dictionary, whatever the size of the dictionary, since the data blocks are
+// held in memory until the dictionary is trained.
+static constexpr size_t kMaxDictTrainingBytes = 8 * 1024 * 1024;
+
+// The training samples are cut into pieces of at most this size: ZSTD
+// needs a decent number of samples to build a useful dictionary, while
+// data blocks are usually few and large.
+static constexpr size_t kDictTrainingSampleSize = 4 * 1024;
+
 namespace kudu {
 namespace cfile {
 
@@ -176,6 +220,8 @@ CFileWriter::CFileWriter(WriterOptions options,
       is_nullable_(is_nullable),
       typeinfo_(typeinfo),
       is_array_(typeinfo->is_array()),
+      dict_training_pending_(false),
+      pending_bytes_(0),
       state_(kWriterInitialized) {
   const EncodingType encoding = options_.storage_attributes.encoding;
   if (auto s = TypeEncodingInfo::Get(typeinfo_, encoding, &type_encoding_info_);
@@ -238,6 +284,7 @@ Status CFileWriter::Start() {
     const CompressionCodec* codec;
     RETURN_NOT_OK(GetCompressionCodec(compression_, &codec));
     block_compressor_.reset(new CompressedBlockBuilder(codec));
+    dict_training_pending_ = compression_ == ZSTD && FLAGS_cfile_zstd_dictionary_size > 0;
   }
 
   CFileHeaderPB header;
@@ -265,6 +312,16 @@ Status CFileWriter::Start() {
   RETURN_NOT_OK_PREPEND(WriteRawData(header_slices), "Couldn't write header");
   data_block_ = type_encoding_info_->CreateBlockBuilder(&options_);
 
+  // Zone maps aren't collected for array columns: predicates on arrays
+  // aren't supported.
+  if (options_.write_zone_map && FLAGS_cfile_write_zone_maps && !is_array_) {
+    zone_map_builder_.reset(new ZoneMapBuilder(typeinfo_));
+  }
+  if (options_.storage_attributes.bloom_filter && !is_array_) {
+    bloom_builder_.reset(new BloomFilterBuilder(BloomFilterSizing::BySizeAndFPRate(
+        FLAGS_cfile_bloom_filter_max_size, FLAGS_cfile_bloom_filter_fp_rate)));
+  }
+
   if (is_array_) {
     // Array data blocks allows for nullable elements in array cells and
     // the cells themselves, so both non_null_bitmap_builder_ and
@@ -301,16 +358,31 @@ Status CFileWriter::Finish() {
 }
 
 Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction) {
-  TRACE_EVENT0("cfile", "CFileWriter::FinishAndReleaseBlock");
+  RETURN_NOT_OK(FinishAndFinalizeBlock());
+  ReleaseBlock(transaction);
+  return Status::OK();
+}
+
+void CFileWriter::ReleaseBlock(BlockCreationTransaction* transaction) {
+  DCHECK(state_ == kWriterFinished) << "Bad state for ReleaseBlock(): " << state_;
+  DCHECK(block_);
+  transaction->AddCreatedBlock(std::move(block_));
+}
+
+Status CFileWriter::FinishAndFinalizeBlock() {
+  TRACE_EVENT0("cfile", "CFileWriter::FinishAndFinalizeBlock");
   DCHECK(state_ == kWriterWriting) << "Bad state for Finish(): " << state_;
 
-  uint32_t incompatible_features = IncompatibleFeatures::NONE;
+  uint32_t incompatible_features = options_.incompatible_features;
   if (FLAGS_cfile_write_checksums) {
     incompatible_features |= IncompatibleFeatures::CHECKSUM;
   }
   if (is_array_) {
     incompatible_features |= IncompatibleFeatures::ARRAY_DATA_BLOCK;
   }
+  if (compression_ == ZSTD) {
+    incompatible_features |= IncompatibleFeatures::ZSTD_COMPRESSION;
+  }
 
   // Write out any pending values as the last data block.
   if (is_array_) {
@@ -319,6 +391,12 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
     RETURN_NOT_OK(FinishCurDataBlock());
   }
 
+  // If there isn't enough data to collect all the samples, train
+  // the dictionary with whatever has been buffered.
+  if (dict_training_pending_) {
+    RETURN_NOT_OK(FinishDictionaryTraining());
+  }
+
   state_ = kWriterFinished;
 
   // Start preparing the footer.
@@ -342,6 +420,9 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
   footer.set_encoding(type_encoding_info_->encoding_type());
   footer.set_num_values(value_count_);
   footer.set_compression(compression_);
+  if (!compression_dict_.empty()) {
+    footer.set_compression_dictionary(compression_dict_.ToString());
+  }
   footer.set_incompatible_features(incompatible_features);
 
   // Write out any pending positional index blocks.
@@ -358,6 +439,21 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
     footer.mutable_validx_info()->CopyFrom(validx_info);
   }
 
+  if (zone_map_builder_) {
+    faststring zone_map;
+    zone_map_builder_->Finish(&zone_map);
+    BlockPointer ptr;
+    RETURN_NOT_OK_PREPEND(AddBlock({ Slice(zone_map) }, &ptr, "zone map block"),
+                          "Couldn't write zone map");
+    ptr.CopyToPB(footer.mutable_zone_map_block_ptr());
+  }
+
+  if (bloom_builder_) {
+    BlockPointer ptr;
+    RETURN_NOT_OK_PREPEND(WriteBloomFilter(&ptr), "Couldn't write bloom filter");
+    ptr.CopyToPB(footer.mutable_bloom_filter_block_ptr());
+  }
+
   // Optionally append extra information to the end of cfile.
   // Example: dictionary block for dictionary encoding
   RETURN_NOT_OK(data_block_->AppendExtraInfo(this, &footer));
@@ -384,9 +480,7 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
   RETURN_NOT_OK_PREPEND(WriteRawData(footer_slices), "Couldn't write footer");
 
   // Done with this block.
-  RETURN_NOT_OK(block_->Finalize());
-  transaction->AddCreatedBlock(std::move(block_));
-  return Status::OK();
+  return block_->Finalize();
 }
 
 void CFileWriter::AddMetadataPair(const Slice& key, const Slice& value) {
@@ -424,6 +518,10 @@ Status CFileWriter::AppendEntries(const void* entries, size_t count) {
   while (rem > 0) {
     int n = data_block_->Add(ptr, rem);
     DCHECK_GE(n, 0);
+    if (zone_map_builder_) {
+      zone_map_builder_->AddValues(ptr, n);
+    }
+    AddToBloomFilter(ptr, n);
 
     ptr += typeinfo_->size() * n;
     rem -= n;
@@ -455,6 +553,10 @@ Status CFileWriter::AppendNullableEntries(const uint8_t* bitmap,
       do {
         int n = data_block_->Add(ptr, rem);
         DCHECK_GE(n, 0);
+        if (zone_map_builder_) {
+          zone_map_builder_->AddValues(ptr, n);
+        }
+        AddToBloomFilter(ptr, n);
 
         non_null_bitmap_builder_->AddRun(true, n);
         ptr += n * typeinfo_->size();
@@ -468,6 +570,9 @@ Status CFileWriter::AppendNullableEntries(const uint8_t* bitmap,
       } while (rem > 0);
     } else {
       non_null_bitmap_builder_->AddRun(false, nitems);
+      if (zone_map_builder_) {
+        zone_map_builder_->AddNulls(nitems);
+      }
       ptr += nitems * typeinfo_->size();
       value_count_ += nitems;
     }
@@ -583,6 +688,33 @@ Status CFileWriter::AppendNullableArrayEntries(const uint8_t* bitmap,
   return Status::OK();
 }
 
+void CFileWriter::AddToBloomFilter(const uint8_t* cells, size_t count) {
+  if (!bloom_builder_) {
+    return;
+  }
+  const size_t cell_size = typeinfo_->size();
+  uint64_t scratch;
+  for (size_t i = 0; i < count; i++, cells += cell_size) {
+    bloom_builder_->AddKey(BloomKeyProbe(ColumnBloomFilterKey(typeinfo_, cells, &scratch)));
+  }
+}
+
+Status CFileWriter::WriteBloomFilter(BlockPointer* block_ptr) {
+  bloom_builder_->ShrinkToFPRate(FLAGS_cfile_bloom_filter_fp_rate);
+
+  // The block has the same layout as the blocks of a BloomFile: the length
+  // of the header, the header, and the bloom filter itself.
+  BloomBlockHeaderPB hdr;
+  hdr.set_num_hash_functions(bloom_builder_->n_hashes());
+  faststring hdr_str;
+  PutFixed32(&hdr_str, static_cast<uint32_t>(hdr.ByteSizeLong()));
+  pb_util::AppendToString(hdr, &hdr_str);
+
+  VLOG(1) << "Appending bloom filter of " << bloom_builder_->n_bytes()
+          << " bytes for " << bloom_builder_->count() << " values";
+  return AddBlock({ Slice(hdr_str), bloom_builder_->slice() }, block_ptr, "bloom filter block");
+}
+
 Status CFileWriter::FinishCurDataBlock() {
   DCHECK(!is_array_);
   const uint32_t num_elems_in_block =
@@ -596,6 +728,10 @@ Status CFileWriter::FinishCurDataBlock() {
   VLOG(1) << "Appending data block for values " <<
     first_elem_ord << "-" << value_count_;
 
+  if (zone_map_builder_) {
+    zone_map_builder_->FinishBlock(first_elem_ord);
+  }
+
   // The current data block is full, need to push it
   // into the file, and add to index
   vector<Slice> data_slices;
@@ -743,6 +879,30 @@ Status CFileWriter::AppendRawBlock(vector<Slice> data_slices,
                                    const char* name_for_log) {
   DCHECK_EQ(state_, kWriterWriting);
 
+  Slice validx_key;
+  if (validx_builder_ != nullptr) {
+    DCHECK(validx_curr != nullptr) <<
+      "must pass a key for raw block if validx is configured";
+
+    (*options_.validx_key_encoder)(validx_curr, &validx_key_buf_);
+    validx_key = Slice(validx_key_buf_);
+    if (options_.optimize_index_keys) {
+      GetSeparatingKey(validx_prev, &validx_key);
+    }
+  }
+
+  if (PREDICT_FALSE(dict_training_pending_)) {
+    return BufferBlockForDictionary(
+        std::move(data_slices), ordinal_pos, validx_key, name_for_log);
+  }
+  return AppendBlockAndIndexEntries(
+      std::move(data_slices), ordinal_pos, validx_key, name_for_log);
+}
+
+Status CFileWriter::AppendBlockAndIndexEntries(vector<Slice> data_slices,
+                                               size_t ordinal_pos,
+                                               const Slice& validx_key,
+                                               const char* name_for_log) {
   BlockPointer ptr;
   Status s = AddBlock(std::move(data_slices), &ptr, name_for_log);
   if (PREDICT_FALSE(!s.ok())) {
@@ -758,16 +918,8 @@ Status CFileWriter::AppendRawBlock(vector<Slice> data_slices,
   }
 
   if (validx_builder_ != nullptr) {
-    DCHECK(validx_curr != nullptr) <<
-      "must pass a key for raw block if validx is configured";
-
-    (*options_.validx_key_encoder)(validx_curr, &tmp_buf_);
-    Slice idx_key = Slice(tmp_buf_);
-    if (options_.optimize_index_keys) {
-      GetSeparatingKey(validx_prev, &idx_key);
-    }
-    VLOG(1) << "Appending validx entry\n" << kudu::HexDump(idx_key);
-    Status s = validx_builder_->Append(idx_key, ptr);
+    VLOG(1) << "Appending validx entry\n" << kudu::HexDump(validx_key);
+    Status s = validx_builder_->Append(validx_key, ptr);
     if (PREDICT_FALSE(!s.ok())) {
       LOG(ERROR) << "Unable to append to value index: " << s.ToString();
       return s;
@@ -777,6 +929,64 @@ Status CFileWriter::AppendRawBlock(vector<Slice> data_slices,
   return Status::OK();
 }
 
+Status CFileWriter::BufferBlockForDictionary(vector<Slice> data_slices,
+                                             size_t ordinal_pos,
+                                             const Slice& validx_key,
+                                             const char* name_for_log) {
+  DCHECK(dict_training_pending_);
+  PendingBlock block;
+  for (const Slice& data : data_slices) {
+    block.data.append(data.data(), data.size());
+  }
+  block.ordinal_pos = ordinal_pos;
+  block.validx_key.append(validx_key.data(), validx_key.size());
+  block.name_for_log = name_for_log;
+  pending_bytes_ += block.data.size();
+  pending_blocks_.emplace_back(std::move(block));
+
+  if (pending_bytes_ >= std::min(FLAGS_cfile_zstd_dictionary_size * kDictTrainingSampleRatio,
+                                 kMaxDictTrainingBytes)) {
+    return FinishDictionaryTraining();
+  }
+  return Status::OK();
+}
+
+Status CFileWriter::FinishDictionaryTraining() {
+  DCHECK(dict_training_pending_);
+  dict_training_pending_ = false;
+
+  vector<Slice> samples;
+  samples.reserve(pending_bytes_ / kDictTrainingSampleSize + pending_blocks_.size());
+  for (const auto& block : pending_blocks_) {
+    for (size_t off = 0; off < block.data.size(); off += kDictTrainingSampleSize) {
+      samples.emplace_back(block.data.data() + off,
+                           std::min(kDictTrainingSampleSize, block.data.size() - off));
+    }
+  }
+
+  faststring dict;
+  if (auto s = TrainCompressionDictionary(
+          compression_, samples, FLAGS_cfile_zstd_dictionary_size, &dict);
+      PREDICT_TRUE(s.ok())) {
+    RETURN_NOT_OK(NewCompressionCodecWithDictionary(compression_, Slice(dict), &dict_codec_));
+    block_compressor_.reset(new CompressedBlockBuilder(dict_codec_.get()));
+    compression_dict_ = std::move(dict);
+  } else {
+    // Not enough data to train a dictionary isn't an error: the blocks
+    // are simply compressed without one.
+    VLOG(1) << "Not using a compression dictionary for " << ToString()
+            << ": " << s.ToString();
+  }
+
+  for (auto& block : pending_blocks_) {
+    RETURN_NOT_OK(AppendBlockAndIndexEntries(
+        { Slice(block.data) }, block.ordinal_pos, Slice(block.validx_key), block.name_for_log));
+  }
+  pending_blocks_.clear();
+  pending_bytes_ = 0;
+  return Status::OK();
+}
+
 Status CFileWriter::AddBlock(vector<Slice> data_slices,
                              BlockPointer* block_ptr,
                              const char* name_for_log) {
@@ -35,6 +35,8 @@
 
 namespace kudu {
 
+class BloomFilterBuilder;
+class CompressionCodec;
 class TypeInfo;
 
 namespace cfile {
@@ -45,6 +47,7 @@ class CompressedBlockBuilder;
 class FileMetadataPairPB;
 class IndexTreeBuilder;
 class TypeEncodingInfo;
+class ZoneMapBuilder;
 
 // Magic used in header/footer
 extern const char kMagicStringV1[];
@@ -74,6 +77,15 @@ class CFileWriter final {
   // it to 'transaction'.
   Status FinishAndReleaseBlock(fs::BlockCreationTransaction* transaction);
 
+  // Close the CFile and finalize the underlying block, keeping the block until
+  // it's released by ReleaseBlock(). Unlike FinishAndReleaseBlock(), this may
+  // be called for several writers concurrently, since it doesn't touch the
+  // transaction which the blocks are released to.
+  Status FinishAndFinalizeBlock();
+
+  // Release the block finalized by FinishAndFinalizeBlock() to 'transaction'.
+  void ReleaseBlock(fs::BlockCreationTransaction* transaction);
+
   bool finished() const noexcept {
     return state_ == kWriterFinished;
   }
@@ -170,9 +182,39 @@ class CFileWriter final {
 
   Status WriteRawData(const std::vector<Slice>& data);
 
+  // Append the given block into the file and add the corresponding entries
+  // into the positional and value indexes. 'validx_key' is the already
+  // encoded value index key, ignored if the value index isn't written.
+  Status AppendBlockAndIndexEntries(std::vector<Slice> data_slices,
+                                    size_t ordinal_pos,
+                                    const Slice& validx_key,
+                                    const char* name_for_log);
+
+  // Keep a copy of the given block in memory instead of writing it out,
+  // so it can be used as a sample to train the compression dictionary.
+  // Once enough samples are collected, trains the dictionary and writes
+  // out all the buffered blocks.
+  Status BufferBlockForDictionary(std::vector<Slice> data_slices,
+                                  size_t ordinal_pos,
+                                  const Slice& validx_key,
+                                  const char* name_for_log);
+
+  // Train the compression dictionary out of the buffered blocks, switch
+  // the block compressor to use it, and write out the buffered blocks.
+  // If training fails, the blocks are compressed without a dictionary.
+  Status FinishDictionaryTraining();
+
   Status FinishCurDataBlock();
   Status FinishCurArrayDataBlock();
 
+  // Add the 'count' non-null cells stored contiguously at 'cells' to the
+  // bloom filter of the column's values.
+  void AddToBloomFilter(const uint8_t* cells, size_t count);
+
+  // Shrink the bloom filter of the column's values to fit the values
+  // added to it, and append it to the file.
+  Status WriteBloomFilter(BlockPointer* block_ptr);
+
   // Flush the current unflushed_metadata_ entries into the given protobuf
   // field, clearing the buffer.
   void FlushMetadataToPB(google::protobuf::RepeatedPtrField<FileMetadataPairPB>* field);
@@ -203,6 +245,29 @@ class CFileWriter final {
   // a temporary buffer for encoding
   faststring tmp_buf_;
 
+  // a buffer for the encoded value index key of the block being appended
+  faststring validx_key_buf_;
+
+  // A data block held in memory while collecting samples to train
+  // the compression dictionary.
+  struct PendingBlock {
+    faststring data;
+    size_t ordinal_pos;
+    faststring validx_key;
+    const char* name_for_log;
+  };
+
+  // Whether data blocks are being buffered to train the compression
+  // dictionary, and the buffered blocks themselves.
+  bool dict_training_pending_;
+  std::vector<PendingBlock> pending_blocks_;
+  size_t pending_bytes_;
+
+  // The trained compression dictionary and the codec which uses it,
+  // if any. The codec must outlive 'block_compressor_'.
+  faststring compression_dict_;
+  std::unique_ptr<CompressionCodec> dict_codec_;
+
   // Metadata which has been added to the writer but not yet flushed.
   std::vector<std::pair<std::string, std::string>> unflushed_metadata_;
 
@@ -213,6 +278,8 @@ class CFileWriter final {
   std::unique_ptr<NonNullBitmapBuilder> array_non_null_bitmap_builder_;
   std::unique_ptr<ArrayElemNumBuilder> array_elem_num_builder_;
   std::unique_ptr<CompressedBlockBuilder> block_compressor_;
+  std::unique_ptr<ZoneMapBuilder> zone_map_builder_;
+  std::unique_ptr<BloomFilterBuilder> bloom_builder_;
 
   enum State {
     kWriterInitialized,
@@ -41,9 +41,12 @@
 #include "kudu/cfile/block_handle.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock-test-util.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
@@ -936,6 +939,94 @@ TEST_F(TestEncoding, TestRleIntBlockEncoder) {
   ASSERT_EQ(14UL, block->data().size());
 }
 
+TEST_F(TestEncoding, TestFrameOfReferenceIntBlockEncoder) {
+  constexpr const int kNumInts = 10000;
+  auto ibb = CreateBlockBuilderOrDie(UINT64, FRAME_OF_REFERENCE);
+
+  // Values clustered in a narrow range should pack into a few bits each,
+  // regardless of their magnitude.
+  Random rand(SeedRandom());
+  auto ints = CreateRandomIntegersInRange<uint64_t>(kNumInts, 1ULL << 40, (1ULL << 40) + 100,
+                                                    &rand);
+  ASSERT_EQ(kNumInts, ibb->Add(reinterpret_cast<const uint8_t*>(ints.data()), kNumInts));
+  scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(ibb.get(), 12345);
+  LOG(INFO) << "FRAME_OF_REFERENCE Encoded size for 10k clustered ints: "
+            << block->data().size();
+  ASSERT_LT(block->data().size(), kNumInts);
+
+  // A block of identical values stores no packed data at all: just the
+  // header, one directory entry and the padding.
+  ibb->Reset();
+  ints.assign(100, 0);
+  ibb->Add(reinterpret_cast<const uint8_t*>(ints.data()), 100);
+  block = FinishAndMakeContiguous(ibb.get(), 12345);
+  ASSERT_EQ(8UL + 17UL + 9UL, block->data().size());
+}
+
+// Verify that decoder-level predicate evaluation for FRAME_OF_REFERENCE blocks,
+// which skips mini-blocks based on their min/max, matches evaluating the
+// predicate on every cell.
+TEST_F(TestEncoding, TestFrameOfReferenceCopyNextAndEval) {
+  constexpr const int kNumInts = 1000;
+  vector<int32_t> ints(kNumInts);
+  for (int i = 0; i < kNumInts; i++) {
+    ints[i] = i * 3 - 1000;
+  }
+  auto ibb = CreateBlockBuilderOrDie(INT32, FRAME_OF_REFERENCE);
+  ASSERT_EQ(kNumInts, ibb->Add(reinterpret_cast<const uint8_t*>(ints.data()), kNumInts));
+  scoped_refptr<BlockHandle> block = FinishAndMakeContiguous(ibb.get(), 0);
+
+  ColumnSchema col("c", INT32);
+  const int32_t lower = -500;
+  const int32_t upper = 901;
+  const int32_t value = 302;
+  const int32_t in_list[] = { -1000, -998, 5, 1997, 5000 };
+  vector<const void*> in_list_values;
+  for (const auto& v : in_list) {
+    in_list_values.push_back(&v);
+  }
+  vector<ColumnPredicate> preds = {
+    ColumnPredicate::Range(col, &lower, &upper),
+    ColumnPredicate::Range(col, &lower, nullptr),
+    ColumnPredicate::Range(col, nullptr, &upper),
+    ColumnPredicate::Equality(col, &value),
+    ColumnPredicate::InList(col, &in_list_values),
+    ColumnPredicate::IsNotNull(col),
+  };
+  for (const auto& pred : preds) {
+    SCOPED_TRACE(pred.ToString());
+    auto ibd = CreateBlockDecoderOrDie(INT32, FRAME_OF_REFERENCE, block);
+    ASSERT_OK(ibd->ParseHeader());
+
+    vector<int32_t> decoded(kNumInts);
+    ColumnBlock cb(GetTypeInfo(INT32), nullptr, decoded.data(), kNumInts, &memory_);
+    SelectionVector sel(kNumInts);
+    sel.SetAllTrue();
+    ColumnMaterializationContext ctx(0, &pred, &cb, &sel);
+    SelectionVectorView sel_view(&sel);
+
+    // Decode in uneven batches so that they straddle mini-block boundaries.
+    int dec_count = 0;
+    while (ibd->HasNext()) {
+      size_t n = std::min(kNumInts - dec_count, 77);
+      ColumnDataView dst(&cb, dec_count);
+      ASSERT_OK(ibd->CopyNextAndEval(&n, &ctx, &sel_view, &dst));
+      sel_view.Advance(n);
+      dec_count += n;
+    }
+    ASSERT_EQ(kNumInts, dec_count);
+    ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+
+    for (int i = 0; i < kNumInts; i++) {
+      const bool expected = pred.EvaluateCell<INT32>(&ints[i]);
+      ASSERT_EQ(expected, sel.IsRowSelected(i)) << "at index " << i;
+      if (expected) {
+        ASSERT_EQ(ints[i], decoded[i]) << "at index " << i;
+      }
+    }
+  }
+}
+
 TEST_F(TestEncoding, TestPlainBitMapRoundTrip) {
   TestBoolBlockRoundTrip(PLAIN_ENCODING);
 }
@@ -1030,8 +1121,8 @@ TEST_F(TestEncoding, BlockFullMaskingInt) {
   // Run the scenario for a few generic integer types and all the suitable
   // encodings and compression types.
   Random rng(SeedRandom());
-  for (const auto encoding : { PLAIN_ENCODING, RLE, BIT_SHUFFLE }) {
-    for (const auto compression : { NO_COMPRESSION, SNAPPY, LZ4, ZLIB }) {
+  for (const auto encoding : { PLAIN_ENCODING, RLE, BIT_SHUFFLE, FRAME_OF_REFERENCE }) {
+    for (const auto compression : { NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD }) {
       SCOPED_TRACE(Substitute("encoding: $0 compression: $1",
                               EncodingType_Name(encoding),
                               CompressionType_Name(compression)));
@@ -1046,7 +1137,7 @@ TEST_F(TestEncoding, BlockFullBitMaskingBin) {
   // encodings and compression types.
   Random rng(SeedRandom());
   for (const auto encoding : { PLAIN_ENCODING, PREFIX_ENCODING, DICT_ENCODING, }) {
-    for (const auto compression : { NO_COMPRESSION, SNAPPY, LZ4, ZLIB }) {
+    for (const auto compression : { NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD }) {
       SCOPED_TRACE(Substitute("encoding: $0 compression: $1",
                               EncodingType_Name(encoding),
                               CompressionType_Name(compression)));
@@ -1076,7 +1167,7 @@ class IntEncodingTest : public TestEncoding, public ::testing::WithParamInterfac
   }
 };
 INSTANTIATE_TEST_SUITE_P(Encodings, IntEncodingTest,
-                         ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE));
+                         ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE, FRAME_OF_REFERENCE));
 
 TEST_P(IntEncodingTest, TestSeekAllTypes) {
   this->template DoIntSeekTest<UINT8>(100, 1000, true);
@@ -0,0 +1,578 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Frame-of-reference ("FRAME_OF_REFERENCE") encoding for integer types.
+//
+// Values are grouped into mini-blocks of kForMiniBlockSize entries. Each
+// mini-block stores its minimum and maximum value, and every entry is
+// bit-packed as its (unsigned) offset from the minimum using the smallest bit
+// width able to represent the mini-block's range. Clustered or slowly drifting
+// data (timestamps, sequence numbers, foreign keys) packs into a few bits per
+// value, while the per-mini-block min/max lets the decoder seek and skip the
+// mini-blocks which can't match a predicate without unpacking them. Entries of
+// the other mini-blocks are unpacked before they're evaluated.
+//
+// There's no delta or delta-of-delta step between consecutive values. That
+// keeps every entry decodable on its own, which seeking relies on, at the cost
+// of a larger bit width for steadily increasing values than delta coding
+// would need.
+//
+// Block layout:
+//
+//   Header (kForHeaderSize bytes):
+//     num_elems    fixed32
+//     ordinal_pos  fixed32
+//   Directory (one entry per mini-block):
+//     min          CppType
+//     max          CppType
+//     bit_width    uint8_t
+//   Packed offsets:
+//     ceil(n * bit_width / 8) bytes per mini-block, back to back
+//   Padding:
+//     kForPaddingSize zero bytes so that the decoder can always do
+//     unaligned 64-bit loads followed by one extra byte.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/block_handle.h"
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+struct WriterOptions;
+
+enum {
+  kForHeaderSize = 8,
+  kForMiniBlockSize = 128,
+  kForPaddingSize = 9
+};
+
+namespace frame_of_reference {
+
+// Return the number of bits required to represent 'v'.
+inline uint8_t BitWidth(uint64_t v) {
+  return v == 0 ? 0 : 64 - __builtin_clzll(v);
+}
+
+// Return the number of bytes used to pack 'n' values of 'bit_width' bits.
+inline size_t PackedSize(size_t n, uint8_t bit_width) {
+  return (n * bit_width + 7) / 8;
+}
+
+// Bit-pack the low 'bit_width' bits of each of 'vals[0..n)' and append
+// the result to 'buf'. Exactly PackedSize(n, bit_width) bytes are appended.
+inline void PackValues(const uint64_t* vals, size_t n, uint8_t bit_width,
+                       faststring* buf) {
+  if (bit_width == 0) {
+    return;
+  }
+  uint64_t acc = 0;
+  int acc_bits = 0;
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t v = vals[i];
+    acc |= v << acc_bits;
+    acc_bits += bit_width;
+    if (acc_bits >= 64) {
+      uint8_t word[8];
+      memcpy(word, &acc, sizeof(acc));
+      buf->append(word, sizeof(word));
+      acc_bits -= 64;
+      // The bits of 'v' which did not fit in the flushed word. Shifting
+      // a 64-bit value by 64 is undefined, hence the explicit check.
+      acc = acc_bits == 0 ? 0 : v >> (bit_width - acc_bits);
+    }
+  }
+  if (acc_bits > 0) {
+    uint8_t word[8];
+    memcpy(word, &acc, sizeof(acc));
+    buf->append(word, (acc_bits + 7) / 8);
+  }
+}
+
+// Extract the 'idx'-th value of 'bit_width' bits from 'data'. Requires
+// at least 9 readable bytes starting from the byte containing the value.
+inline uint64_t UnpackValue(const uint8_t* data, size_t idx, uint8_t bit_width) {
+  const size_t bit_pos = idx * bit_width;
+  const uint8_t* p = data + (bit_pos >> 3);
+  const int shift = bit_pos & 7;
+  uint64_t v = UnalignedLoad<uint64_t>(p) >> shift;
+  if (shift + bit_width > 64) {
+    v |= static_cast<uint64_t>(p[8]) << (64 - shift);
+  }
+  if (bit_width < 64) {
+    v &= (1ULL << bit_width) - 1;
+  }
+  return v;
+}
+
+} // namespace frame_of_reference
+
+//
+// Frame-of-reference builder for integer types.
+//
+template <DataType IntType>
+class FrameOfReferenceBlockBuilder final : public BlockBuilder {
+ public:
+  explicit FrameOfReferenceBlockBuilder(const WriterOptions* options)
+      : options_(options) {
+    pending_.reserve(kForMiniBlockSize);
+    Reset();
+  }
+
+  bool IsBlockFullImpl() const override {
+    // Values of the not-yet-flushed mini-block are accounted for at their
+    // full width: that's an upper bound of their encoded size.
+    return kForHeaderSize + directory_.size() + packed_.size() +
+        pending_.size() * sizeof(CppType) > options_->storage_attributes.cfile_block_size;
+  }
+
+  int Add(const uint8_t* vals_void, size_t count) override {
+    DCHECK_EQ(reinterpret_cast<uintptr_t>(vals_void) & (alignof(CppType) - 1), 0)
+        << "Pointer passed to Add() must be naturally-aligned";
+
+    const CppType* vals = reinterpret_cast<const CppType*>(vals_void);
+    size_t added = 0;
+    while (added < count && !IsBlockFull()) {
+      pending_.push_back(vals[added++]);
+      if (pending_.size() == kForMiniBlockSize) {
+        FlushMiniBlock();
+      }
+    }
+    if (added > 0) {
+      if (PREDICT_FALSE(count_ == 0)) {
+        first_key_ = vals[0];
+      }
+      last_key_ = vals[added - 1];
+      count_ += added;
+    }
+    return added;
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) override {
+    FlushMiniBlock();
+    InlineEncodeFixed32(&header_[0], count_);
+    InlineEncodeFixed32(&header_[4], ordinal_pos);
+    const uint8_t padding[kForPaddingSize] = { 0 };
+    packed_.append(padding, sizeof(padding));
+    *slices = { Slice(header_), Slice(directory_), Slice(packed_) };
+  }
+
+  void Reset() override {
+    count_ = 0;
+    pending_.clear();
+    header_.resize(kForHeaderSize);
+    directory_.clear();
+    packed_.clear();
+  }
+
+  size_t Count() const override {
+    return count_;
+  }
+
+  Status GetFirstKey(void* key) const override {
+    if (PREDICT_FALSE(count_ == 0)) {
+      return Status::NotFound("No keys in the block");
+    }
+    UnalignedStore<CppType>(key, first_key_);
+    return Status::OK();
+  }
+
+  Status GetLastKey(void* key) const override {
+    if (PREDICT_FALSE(count_ == 0)) {
+      return Status::NotFound("No keys in the block");
+    }
+    UnalignedStore<CppType>(key, last_key_);
+    return Status::OK();
+  }
+
+ private:
+  typedef typename TypeTraits<IntType>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedType;
+
+  // Encode the pending values as a mini-block and append it to the
+  // directory and packed data buffers.
+  void FlushMiniBlock() {
+    if (pending_.empty()) {
+      return;
+    }
+    const auto minmax = std::minmax_element(pending_.begin(), pending_.end());
+    const CppType min = *minmax.first;
+    const CppType max = *minmax.second;
+    const uint8_t bit_width = frame_of_reference::BitWidth(
+        static_cast<UnsignedType>(static_cast<UnsignedType>(max) -
+                                  static_cast<UnsignedType>(min)));
+
+    directory_.append(&min, sizeof(min));
+    directory_.append(&max, sizeof(max));
+    directory_.push_back(bit_width);
+
+    uint64_t offsets[kForMiniBlockSize];
+    for (size_t i = 0; i < pending_.size(); i++) {
+      offsets[i] = static_cast<UnsignedType>(static_cast<UnsignedType>(pending_[i]) -
+                                             static_cast<UnsignedType>(min));
+    }
+    frame_of_reference::PackValues(offsets, pending_.size(), bit_width, &packed_);
+    pending_.clear();
+  }
+
+  const WriterOptions* const options_;
+  CppType first_key_;
+  CppType last_key_;
+  size_t count_;
+  std::vector<CppType> pending_;
+  faststring header_;
+  faststring directory_;
+  faststring packed_;
+};
+
+//
+// Frame-of-reference decoder for integer types.
+//
+template <DataType IntType>
+class FrameOfReferenceBlockDecoder final : public BlockDecoder {
+ public:
+  explicit FrameOfReferenceBlockDecoder(scoped_refptr<BlockHandle> block)
+      : block_(std::move(block)),
+        data_(block_->data()),
+        parsed_(false),
+        num_elems_(0),
+        ordinal_pos_base_(0),
+        cur_idx_(0),
+        packed_(nullptr) {
+  }
+
+  Status ParseHeader() override {
+    DCHECK(!parsed_);
+
+    if (PREDICT_FALSE(data_.size() < kForHeaderSize)) {
+      return Status::Corruption(
+          "not enough bytes for header in FrameOfReferenceBlockDecoder");
+    }
+
+    num_elems_ = DecodeFixed32(&data_[0]);
+    ordinal_pos_base_ = DecodeFixed32(&data_[4]);
+
+    const size_t num_mini_blocks =
+        (static_cast<size_t>(num_elems_) + kForMiniBlockSize - 1) / kForMiniBlockSize;
+    const size_t dir_size = num_mini_blocks * kDirEntrySize;
+    if (PREDICT_FALSE(data_.size() < kForHeaderSize + dir_size)) {
+      return Status::Corruption(strings::Substitute(
+          "not enough bytes for $0 mini-blocks in FrameOfReferenceBlockDecoder: $1",
+          num_mini_blocks, data_.size()));
+    }
+
+    const uint8_t* dir = data_.data() + kForHeaderSize;
+    mini_blocks_.resize(num_mini_blocks);
+    size_t offset = 0;
+    for (size_t i = 0; i < num_mini_blocks; i++) {
+      MiniBlock* mb = &mini_blocks_[i];
+      const uint8_t* entry = dir + i * kDirEntrySize;
+      mb->min = UnalignedLoad<CppType>(entry);
+      mb->max = UnalignedLoad<CppType>(entry + sizeof(CppType));
+      mb->bit_width = entry[2 * sizeof(CppType)];
+      if (PREDICT_FALSE(mb->bit_width > sizeof(CppType) * 8 || mb->max < mb->min)) {
+        return Status::Corruption(strings::Substitute(
+            "invalid mini-block $0 in FrameOfReferenceBlockDecoder", i));
+      }
+      mb->offset = offset;
+      offset += frame_of_reference::PackedSize(MiniBlockCount(i), mb->bit_width);
+    }
+    if (PREDICT_FALSE(data_.size() <
+                      kForHeaderSize + dir_size + offset + kForPaddingSize)) {
+      return Status::Corruption(strings::Substitute(
+          "not enough bytes for packed data in FrameOfReferenceBlockDecoder: $0",
+          data_.size()));
+    }
+    packed_ = dir + dir_size;
+
+    parsed_ = true;
+    SeekToPositionInBlock(0);
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) override {
+    DCHECK(parsed_) << "Must call ParseHeader()";
+    DCHECK_LE(pos, num_elems_)
+        << "Tried to seek to " << pos << " which is > number of elements ("
+        << num_elems_ << ") in the block!";
+    cur_idx_ = pos;
+  }
+
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact_match) override {
+    DCHECK(parsed_);
+    const CppType target = UnalignedLoad<CppType>(value_void);
+
+    // Find the first mini-block which may contain a value >= target.
+    auto mb_iter = std::lower_bound(
+        mini_blocks_.begin(), mini_blocks_.end(), target,
+        [](const MiniBlock& mb, CppType t) { return mb.max < t; });
+    if (mb_iter == mini_blocks_.end()) {
+      return Status::NotFound("not in block");
+    }
+
+    // Binary search within the mini-block.
+    const size_t mb_idx = mb_iter - mini_blocks_.begin();
+    size_t lo = mb_idx * kForMiniBlockSize;
+    size_t hi = lo + MiniBlockCount(mb_idx);
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (ValueAt(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    // The mini-block's max is >= target, so a match must have been found.
+    DCHECK_LT(lo, num_elems_);
+    cur_idx_ = lo;
+    *exact_match = ValueAt(lo) == target;
+    return Status::OK();
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) override {
+    DCHECK(parsed_);
+
+    DCHECK_LE(*n, dst->nrows());
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    const size_t to_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    DecodeRange(cur_idx_, to_fetch, reinterpret_cast<CppType*>(dst->data()));
+    cur_idx_ += to_fetch;
+    *n = to_fetch;
+    return Status::OK();
+  }
+
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override {
+    DCHECK(parsed_);
+
+    DCHECK_LE(*n, dst->nrows());
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+
+    ctx->SetDecoderEvalSupported();
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    const ColumnPredicate* pred = ctx->pred();
+    const size_t to_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    CppType* out = reinterpret_cast<CppType*>(dst->data());
+    size_t row_offset = 0;
+    while (row_offset < to_fetch) {
+      const size_t idx = cur_idx_ + row_offset;
+      const size_t mb_idx = idx / kForMiniBlockSize;
+      const size_t run = std::min(
+          to_fetch - row_offset,
+          (mb_idx + 1) * kForMiniBlockSize - idx);
+
+      switch (ClassifyMiniBlock(*pred, mini_blocks_[mb_idx])) {
+        case MatchType::kNone:
+          // None of the values in the mini-block can match: skip decoding.
+          sel->ClearBits(run, row_offset);
+          break;
+        case MatchType::kAll:
+          DecodeRange(idx, run, out + row_offset);
+          break;
+        case MatchType::kSome:
+          DecodeRange(idx, run, out + row_offset);
+          for (size_t row_idx = row_offset; row_idx < row_offset + run; ++row_idx) {
+            // Skip evaluating if the row has already been cleared.
+            if (!sel->TestBit(row_idx)) {
+              continue;
+            }
+            if (!pred->EvaluateCell<IntType>(static_cast<const void*>(&out[row_idx]))) {
+              sel->ClearBit(row_idx);
+            }
+          }
+          break;
+      }
+      row_offset += run;
+    }
+
+    cur_idx_ += to_fetch;
+    *n = to_fetch;
+    return Status::OK();
+  }
+
+  bool HasNext() const override {
+    return cur_idx_ < num_elems_;
+  }
+
+  size_t Count() const override {
+    return num_elems_;
+  }
+
+  size_t GetCurrentIndex() const override {
+    return cur_idx_;
+  }
+
+  rowid_t GetFirstRowId() const override {
+    return ordinal_pos_base_;
+  }
+
+ private:
+  typedef typename TypeTraits<IntType>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedType;
+
+  enum {
+    kDirEntrySize = 2 * sizeof(CppType) + 1
+  };
+
+  struct MiniBlock {
+    CppType min;
+    CppType max;
+    uint8_t bit_width;
+    // Offset of the mini-block's packed data relative to 'packed_'.
+    size_t offset;
+  };
+
+  // The result of comparing a predicate against a mini-block's value range.
+  enum class MatchType {
+    kNone,
+    kAll,
+    kSome
+  };
+
+  // Return the number of values stored in the given mini-block.
+  size_t MiniBlockCount(size_t mb_idx) const {
+    return std::min(static_cast<size_t>(kForMiniBlockSize),
+                    num_elems_ - mb_idx * kForMiniBlockSize);
+  }
+
+  CppType ValueAt(size_t idx) const {
+    const MiniBlock& mb = mini_blocks_[idx / kForMiniBlockSize];
+    if (mb.bit_width == 0) {
+      return mb.min;
+    }
+    return FromOffset(mb.min, frame_of_reference::UnpackValue(
+        packed_ + mb.offset, idx % kForMiniBlockSize, mb.bit_width));
+  }
+
+  // Decode 'n' values starting at position 'start' into 'out'.
+  void DecodeRange(size_t start, size_t n, CppType* out) const {
+    size_t idx = start;
+    const size_t end = start + n;
+    while (idx < end) {
+      const size_t mb_idx = idx / kForMiniBlockSize;
+      const MiniBlock& mb = mini_blocks_[mb_idx];
+      const size_t mb_end = std::min(end, (mb_idx + 1) * kForMiniBlockSize);
+      if (mb.bit_width == 0) {
+        std::fill(out, out + (mb_end - idx), mb.min);
+        out += mb_end - idx;
+      } else {
+        const uint8_t* data = packed_ + mb.offset;
+        for (size_t i = idx % kForMiniBlockSize; idx < mb_end; ++idx, ++i) {
+          *out++ = FromOffset(mb.min, frame_of_reference::UnpackValue(data, i, mb.bit_width));
+        }
+      }
+      idx = mb_end;
+    }
+  }
+
+  static CppType FromOffset(CppType min, uint64_t offset) {
+    return static_cast<CppType>(static_cast<UnsignedType>(
+        static_cast<UnsignedType>(min) + static_cast<UnsignedType>(offset)));
+  }
+
+  // Determine whether none, all, or only some of the values in the range
+  // [mb.min, mb.max] may satisfy 'pred'.
+  static MatchType ClassifyMiniBlock(const ColumnPredicate& pred, const MiniBlock& mb) {
+    switch (pred.predicate_type()) {
+      case PredicateType::None:
+      case PredicateType::IsNull:
+        return MatchType::kNone;
+      case PredicateType::IsNotNull:
+        return MatchType::kAll;
+      case PredicateType::Equality: {
+        const CppType v = UnalignedLoad<CppType>(pred.raw_lower());
+        if (v < mb.min || v > mb.max) {
+          return MatchType::kNone;
+        }
+        return mb.min == mb.max ? MatchType::kAll : MatchType::kSome;
+      }
+      case PredicateType::Range: {
+        const bool has_lower = pred.raw_lower() != nullptr;
+        const bool has_upper = pred.raw_upper() != nullptr;
+        const CppType lower = has_lower ? UnalignedLoad<CppType>(pred.raw_lower()) : 0;
+        const CppType upper = has_upper ? UnalignedLoad<CppType>(pred.raw_upper()) : 0;
+        if ((has_lower && mb.max < lower) || (has_upper && mb.min >= upper)) {
+          return MatchType::kNone;
+        }
+        if ((!has_lower || mb.min >= lower) && (!has_upper || mb.max < upper)) {
+          return MatchType::kAll;
+        }
+        return MatchType::kSome;
+      }
+      case PredicateType::InList: {
+        // The values are sorted: find the first one that is >= mb.min.
+        const auto& values = pred.raw_values();
+        auto iter = std::lower_bound(
+            values.begin(), values.end(), mb.min,
+            [](const void* v, CppType t) { return UnalignedLoad<CppType>(v) < t; });
+        if (iter == values.end() || UnalignedLoad<CppType>(*iter) > mb.max) {
+          return MatchType::kNone;
+        }
+        return mb.min == mb.max ? MatchType::kAll : MatchType::kSome;
+      }
+      default:
+        return MatchType::kSome;
+    }
+  }
+
+  scoped_refptr<BlockHandle> block_;
+  Slice data_;
+  bool parsed_;
+  uint32_t num_elems_;
+  rowid_t ordinal_pos_base_;
+  size_t cur_idx_;
+  // Start of the packed offsets, right after the mini-block directory.
+  const uint8_t* packed_;
+  std::vector<MiniBlock> mini_blocks_;
+};
+
+} // namespace cfile
+} // namespace kudu
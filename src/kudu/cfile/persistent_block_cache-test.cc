@@ -0,0 +1,263 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/persistent_block_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/cfile/block_cache.h"
+#include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
+#include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/env.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/path_util.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int32(block_cache_persistent_checkpoint_interval_secs);
+DECLARE_int32(block_cache_persistent_max_pending_write_mb);
+
+using std::string;
+using std::unique_ptr;
+
+namespace kudu {
+namespace cfile {
+
+class PersistentBlockCacheTest : public KuduTest {
+ public:
+  void SetUp() override {
+    KuduTest::SetUp();
+    fs_manager_.reset(new FsManager(env_, FsManagerOpts(GetTestPath("fs_root"))));
+    ASSERT_OK(fs_manager_->CreateInitialFileSystemLayout());
+    ASSERT_OK(fs_manager_->Open());
+    cache_dir_ = GetTestPath("block_cache");
+  }
+
+ protected:
+  Status OpenCache(uint64_t capacity) {
+    cache_.reset();
+    return PersistentBlockCache::Open(env_, cache_dir_, capacity,
+                                      fs_manager_->block_manager().get(),
+                                      /*metric_entity=*/nullptr, &cache_);
+  }
+
+  // Create a block in the block manager, and return its ID.
+  BlockId CreateBlock() {
+    unique_ptr<fs::WritableBlock> block;
+    CHECK_OK(fs_manager_->CreateNewBlock({}, &block));
+    CHECK_OK(block->Append("data"));
+    CHECK_OK(block->Close());
+    return block->id();
+  }
+
+  // Return the contents of a block of the given size, unique to 'seed'.
+  static string BlockData(int seed, int size) {
+    string data(size, '\0');
+    for (int i = 0; i < size; i++) {
+      data[i] = static_cast<char>(seed * 31 + i);
+    }
+    return data;
+  }
+
+  // Look up the block with the given key and size, returning its contents
+  // in 'data'.
+  Status Lookup(const BlockCache::CacheKey& key, int size, string* data) {
+    faststring buf;
+    buf.resize(size);
+    RETURN_NOT_OK(cache_->Lookup(key, Slice(buf.data(), size)));
+    *data = buf.ToString();
+    return Status::OK();
+  }
+
+  unique_ptr<FsManager> fs_manager_;
+  string cache_dir_;
+  unique_ptr<PersistentBlockCache> cache_;
+};
+
+TEST_F(PersistentBlockCacheTest, TestInsertAndLookup) {
+  ASSERT_OK(OpenCache(1024 * 1024));
+  const BlockId id = CreateBlock();
+  const BlockCache::CacheKey key(id, 100);
+  const string block = BlockData(1, 1000);
+  string data;
+  ASSERT_TRUE(Lookup(key, block.size(), &data).IsNotFound());
+
+  cache_->Insert(key, block);
+  cache_->WaitForPendingWrites();
+  ASSERT_OK(Lookup(key, block.size(), &data));
+  ASSERT_EQ(block, data);
+  ASSERT_EQ(1, cache_->num_blocks());
+
+  // Lookups for other offsets and sizes miss.
+  ASSERT_TRUE(Lookup(BlockCache::CacheKey(id, 200), block.size(), &data).IsNotFound());
+  ASSERT_TRUE(Lookup(key, block.size() - 1, &data).IsNotFound());
+}
+
+// Tests that the oldest blocks are overwritten once the data file is full.
+TEST_F(PersistentBlockCacheTest, TestWrapAround) {
+  constexpr int kCapacity = 16 * 1024;
+  constexpr int kBlockSize = 1000;
+  constexpr int kNumBlocks = 100;
+  ASSERT_OK(OpenCache(kCapacity));
+  const BlockId id = CreateBlock();
+  for (int i = 0; i < kNumBlocks; i++) {
+    cache_->Insert(BlockCache::CacheKey(id, i), BlockData(i, kBlockSize));
+  }
+  cache_->WaitForPendingWrites();
+  ASSERT_LT(cache_->num_blocks(), kCapacity / kBlockSize);
+  ASSERT_GT(cache_->num_blocks(), 0);
+
+  string data;
+  ASSERT_TRUE(Lookup(BlockCache::CacheKey(id, 0), kBlockSize, &data).IsNotFound());
+  for (int i = kNumBlocks - cache_->num_blocks(); i < kNumBlocks; i++) {
+    ASSERT_OK(Lookup(BlockCache::CacheKey(id, i), kBlockSize, &data));
+    ASSERT_EQ(BlockData(i, kBlockSize), data);
+  }
+
+  // Blocks larger than the cache are skipped.
+  cache_->Insert(BlockCache::CacheKey(id, kNumBlocks), BlockData(0, kCapacity));
+  cache_->WaitForPendingWrites();
+  ASSERT_TRUE(Lookup(BlockCache::CacheKey(id, kNumBlocks), kCapacity, &data).IsNotFound());
+}
+
+// Tests that the cached blocks survive reopening the cache, except for the
+// blocks of files which no longer exist.
+TEST_F(PersistentBlockCacheTest, TestReopen) {
+  ASSERT_OK(OpenCache(1024 * 1024));
+  const BlockId live_id = CreateBlock();
+  const BlockId deleted_id(live_id.id() + 1000);
+  const BlockCache::CacheKey live_key(live_id, 1);
+  const BlockCache::CacheKey deleted_key(deleted_id, 1);
+  cache_->Insert(live_key, BlockData(1, 100));
+  cache_->Insert(deleted_key, BlockData(2, 100));
+  cache_->WaitForPendingWrites();
+  ASSERT_EQ(2, cache_->num_blocks());
+
+  // Destroying the cache checkpoints it.
+  ASSERT_OK(OpenCache(1024 * 1024));
+  ASSERT_EQ(1, cache_->num_blocks());
+  string data;
+  ASSERT_OK(Lookup(live_key, 100, &data));
+  ASSERT_EQ(BlockData(1, 100), data);
+  ASSERT_TRUE(Lookup(deleted_key, 100, &data).IsNotFound());
+
+  // Blocks inserted after reopening don't overwrite the ones cached before.
+  cache_->Insert(BlockCache::CacheKey(live_id, 2), BlockData(3, 100));
+  cache_->WaitForPendingWrites();
+  ASSERT_OK(Lookup(live_key, 100, &data));
+  ASSERT_EQ(BlockData(1, 100), data);
+
+  // Changing the capacity empties the cache.
+  ASSERT_OK(OpenCache(2 * 1024 * 1024));
+  ASSERT_EQ(0, cache_->num_blocks());
+}
+
+// Tests that a background thread checkpoints the index once blocks are
+// inserted.
+TEST_F(PersistentBlockCacheTest, TestBackgroundCheckpoint) {
+  FLAGS_block_cache_persistent_checkpoint_interval_secs = 1;
+  ASSERT_OK(OpenCache(1024 * 1024));
+  const string index_path = JoinPathSegments(cache_dir_, "block_cache.index");
+  const BlockCache::CacheKey key(CreateBlock(), 1);
+  cache_->Insert(key, BlockData(1, 100));
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_TRUE(env_->FileExists(index_path));
+  });
+}
+
+// Tests that blocks which don't match their headers are cache misses.
+TEST_F(PersistentBlockCacheTest, TestCorruption) {
+  ASSERT_OK(OpenCache(1024 * 1024));
+  const BlockCache::CacheKey key(CreateBlock(), 1);
+  cache_->Insert(key, BlockData(1, 100));
+  cache_->WaitForPendingWrites();
+  ASSERT_OK(cache_->Checkpoint());
+
+  // Overwrite a byte of the block.
+  {
+    unique_ptr<RWFile> file;
+    RWFileOptions opts;
+    opts.mode = Env::MUST_EXIST;
+    ASSERT_OK(env_->NewRWFile(opts, JoinPathSegments(cache_dir_, "block_cache.data"), &file));
+    ASSERT_OK(file->Write(file->GetEncryptionHeaderSize() + 50, "x"));
+    ASSERT_OK(file->Close());
+  }
+  string data;
+  ASSERT_TRUE(Lookup(key, 100, &data).IsCorruption());
+  ASSERT_EQ(0, cache_->num_blocks());
+  ASSERT_TRUE(Lookup(key, 100, &data).IsNotFound());
+}
+
+// Tests that blocks aren't inserted while too many bytes are waiting to be
+// written, rather than piling up in memory.
+TEST_F(PersistentBlockCacheTest, TestMaxPendingWrites) {
+  FLAGS_block_cache_persistent_max_pending_write_mb = 0;
+  ASSERT_OK(OpenCache(1024 * 1024));
+  const BlockCache::CacheKey key(CreateBlock(), 1);
+  cache_->Insert(key, BlockData(1, 100));
+  cache_->WaitForPendingWrites();
+  ASSERT_EQ(0, cache_->num_blocks());
+  string data;
+  ASSERT_TRUE(Lookup(key, 100, &data).IsNotFound());
+}
+
+class EncryptedPersistentBlockCacheTest : public PersistentBlockCacheTest {
+ public:
+  void SetUp() override {
+    SetEncryptionFlags(true);
+    PersistentBlockCacheTest::SetUp();
+  }
+};
+
+// Tests that the blocks are read back from an encrypted data file, at their
+// offsets past its encryption header, including after reopening the cache.
+TEST_F(EncryptedPersistentBlockCacheTest, TestInsertAndLookup) {
+  constexpr int kCapacity = 16 * 1024;
+  constexpr int kBlockSize = 1000;
+  constexpr int kNumBlocks = 100;
+  ASSERT_OK(OpenCache(kCapacity));
+  const BlockId id = CreateBlock();
+  for (int i = 0; i < kNumBlocks; i++) {
+    cache_->Insert(BlockCache::CacheKey(id, i), BlockData(i, kBlockSize));
+  }
+  cache_->WaitForPendingWrites();
+  const int num_blocks = cache_->num_blocks();
+  ASSERT_GT(num_blocks, 0);
+
+  // The first block written after wrapping around is at the start of the
+  // data file, right after the encryption header.
+  ASSERT_OK(OpenCache(kCapacity));
+  ASSERT_EQ(num_blocks, cache_->num_blocks());
+  string data;
+  for (int i = kNumBlocks - num_blocks; i < kNumBlocks; i++) {
+    ASSERT_OK(Lookup(BlockCache::CacheKey(id, i), kBlockSize, &data));
+    ASSERT_EQ(BlockData(i, kBlockSize), data);
+  }
+}
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,440 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/persistent_block_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/cfile/cfile.pb.h"
+#include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/alignment.h"
+#include "kudu/util/array_view.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/crc.h"
+#include "kudu/util/env.h"
+#include "kudu/util/env_util.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/path_util.h"
+#include "kudu/util/pb_util.h"
+#include "kudu/util/thread.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(block_cache_persistent_checkpoint_interval_secs, 60,
+             "How often the index of the persistent block cache is written to disk "
+             "by a background thread, in seconds, if blocks were inserted. Blocks "
+             "inserted since the last checkpoint aren't found in the cache after a "
+             "crash.");
+TAG_FLAG(block_cache_persistent_checkpoint_interval_secs, advanced);
+TAG_FLAG(block_cache_persistent_checkpoint_interval_secs, experimental);
+
+DEFINE_int32(block_cache_persistent_max_pending_write_mb, 64,
+             "The maximum amount of memory taken up by blocks waiting to be written "
+             "to the persistent block cache by its background writer, in MiB. Blocks "
+             "read while this much is pending aren't written to the persistent cache.");
+TAG_FLAG(block_cache_persistent_max_pending_write_mb, advanced);
+TAG_FLAG(block_cache_persistent_max_pending_write_mb, experimental);
+
+METRIC_DEFINE_counter(server, block_cache_persistent_hits,
+                      "Persistent Block Cache Hits", kudu::MetricUnit::kBlocks,
+                      "Number of blocks read from the persistent tier of the block cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_persistent_misses,
+                      "Persistent Block Cache Misses", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the persistent tier of the block cache that "
+                      "didn't yield a block, including blocks which failed validation",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_persistent_inserts,
+                      "Persistent Block Cache Inserts", kudu::MetricUnit::kBlocks,
+                      "Number of blocks written to the persistent tier of the block cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_persistent_evictions,
+                      "Persistent Block Cache Evictions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks overwritten in the persistent tier of the block cache",
+                      kudu::MetricLevel::kDebug);
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+const char* const kDataFileName = "block_cache.data";
+const char* const kIndexFileName = "block_cache.index";
+
+// Every block in the data file is preceded by a header of the following
+// fixed32/fixed64 fields:
+//   magic
+//   length of the block
+//   file ID of the block's key
+//   offset of the block's key
+//   CRC32C of the block
+//   CRC32C of the fields above
+constexpr uint32_t kHeaderMagic = 0x6b756462; // "kudb"
+constexpr size_t kHeaderSize = 32;
+
+// Blocks are written at 8-byte aligned offsets.
+constexpr uint64_t kAlignment = 8;
+
+void EncodeHeader(uint64_t file_id, uint64_t offset, const Slice& block, uint8_t* buf) {
+  InlineEncodeFixed32(buf, kHeaderMagic);
+  InlineEncodeFixed32(buf + 4, block.size());
+  InlineEncodeFixed64(buf + 8, file_id);
+  InlineEncodeFixed64(buf + 16, offset);
+  InlineEncodeFixed32(buf + 24, crc::Crc32c(block.data(), block.size()));
+  InlineEncodeFixed32(buf + 28, crc::Crc32c(buf, 28));
+}
+
+// Returns true if 'buf' is the header of the block with the given key and
+// contents.
+bool VerifyHeader(const uint8_t* buf, uint64_t file_id, uint64_t offset, const Slice& block) {
+  return DecodeFixed32(buf) == kHeaderMagic &&
+      DecodeFixed32(buf + 4) == block.size() &&
+      DecodeFixed64(buf + 8) == file_id &&
+      DecodeFixed64(buf + 16) == offset &&
+      DecodeFixed32(buf + 28) == crc::Crc32c(buf, 28) &&
+      DecodeFixed32(buf + 24) == crc::Crc32c(block.data(), block.size());
+}
+
+} // anonymous namespace
+
+size_t PersistentBlockCache::KeyHash::operator()(const Key& key) const {
+  return std::hash<uint64_t>()(key.file_id) * 31 + std::hash<uint64_t>()(key.offset);
+}
+
+PersistentBlockCache::PersistentBlockCache(Env* env, string dir, uint64_t capacity,
+                                           const scoped_refptr<MetricEntity>& metric_entity)
+    : env_(env),
+      dir_(std::move(dir)),
+      capacity_(capacity),
+      pending_write_bytes_(0),
+      write_position_(0),
+      dirty_(false),
+      stop_checkpoints_(1) {
+  if (metric_entity) {
+    hits_ = METRIC_block_cache_persistent_hits.Instantiate(metric_entity);
+    misses_ = METRIC_block_cache_persistent_misses.Instantiate(metric_entity);
+    inserts_ = METRIC_block_cache_persistent_inserts.Instantiate(metric_entity);
+    evictions_ = METRIC_block_cache_persistent_evictions.Instantiate(metric_entity);
+  }
+}
+
+PersistentBlockCache::~PersistentBlockCache() {
+  if (write_pool_) {
+    // Finish writing the blocks inserted so far, so that they're checkpointed.
+    write_pool_->Wait();
+    write_pool_->Shutdown();
+  }
+  stop_checkpoints_.CountDown();
+  if (checkpoint_thread_) {
+    checkpoint_thread_->Join();
+  }
+  if (data_file_) {
+    WARN_NOT_OK(Checkpoint(), "failed to checkpoint the persistent block cache");
+  }
+}
+
+Status PersistentBlockCache::Open(Env* env,
+                                  const string& dir,
+                                  uint64_t capacity,
+                                  fs::BlockManager* block_manager,
+                                  const scoped_refptr<MetricEntity>& metric_entity,
+                                  unique_ptr<PersistentBlockCache>* cache) {
+  unique_ptr<PersistentBlockCache> c(new PersistentBlockCache(env, dir, capacity, metric_entity));
+  RETURN_NOT_OK_PREPEND(c->Init(block_manager),
+                        Substitute("could not open the persistent block cache in $0", dir));
+  *cache = std::move(c);
+  return Status::OK();
+}
+
+Status PersistentBlockCache::Init(fs::BlockManager* block_manager) {
+  RETURN_NOT_OK(env_util::CreateDirIfMissing(env_, dir_));
+  RWFileOptions opts;
+  opts.mode = Env::CREATE_OR_OPEN;
+  // The cached blocks are user data.
+  opts.is_sensitive = true;
+  RETURN_NOT_OK(env_->NewRWFile(opts, data_path(), &data_file_));
+
+  Status s = LoadIndex(block_manager);
+  if (!s.ok() && !s.IsNotFound()) {
+    // The cache is only an optimization: start it empty rather than failing.
+    LOG(WARNING) << Substitute("could not load the index of the persistent block cache "
+                               "in $0, starting with an empty cache: $1",
+                               dir_, s.ToString());
+    std::lock_guard l(lock_);
+    write_position_ = 0;
+    index_.clear();
+    keys_by_position_.clear();
+  }
+  RETURN_NOT_OK(ThreadPoolBuilder("persistent-block-cache-writer")
+                .set_max_threads(1)
+                .Build(&write_pool_));
+  return Thread::Create("cache", "persistent-block-cache-checkpoint",
+                        [this]() { this->CheckpointThread(); }, &checkpoint_thread_);
+}
+
+Status PersistentBlockCache::LoadIndex(fs::BlockManager* block_manager) {
+  PersistentBlockCacheIndexPB pb;
+  RETURN_NOT_OK(pb_util::ReadPBContainerFromPath(env_, index_path(), &pb,
+                                                 pb_util::NOT_SENSITIVE));
+  if (pb.capacity() != capacity_) {
+    LOG(INFO) << Substitute("the capacity of the persistent block cache in $0 changed "
+                            "from $1 to $2 bytes, starting with an empty cache",
+                            dir_, pb.capacity(), capacity_);
+    return Status::OK();
+  }
+
+  // Only keep the blocks of the files which still exist.
+  vector<BlockId> block_ids;
+  RETURN_NOT_OK(block_manager->GetAllBlockIds(&block_ids));
+  const BlockIdSet live_block_ids(block_ids.begin(), block_ids.end());
+
+  std::lock_guard l(lock_);
+  write_position_ = pb.write_position();
+  int num_dropped = 0;
+  for (const auto& entry_pb : pb.entries()) {
+    if (!ContainsKey(live_block_ids, BlockId(entry_pb.file_id())) ||
+        IsOverwritten(entry_pb.position())) {
+      num_dropped++;
+      continue;
+    }
+    const Key key{ entry_pb.file_id(), entry_pb.offset() };
+    if (InsertIfNotPresent(&index_, key, Entry{ entry_pb.position(), entry_pb.length() })) {
+      InsertOrDie(&keys_by_position_, entry_pb.position(), key);
+    }
+  }
+  LOG(INFO) << Substitute("loaded $0 blocks into the persistent block cache in $1, "
+                          "dropped $2 blocks which no longer exist",
+                          index_.size(), dir_, num_dropped);
+  return Status::OK();
+}
+
+Status PersistentBlockCache::Lookup(const BlockCache::CacheKey& key, Slice block) {
+  const Key k{ key.file_id_, key.offset_ };
+  Entry entry;
+  {
+    std::lock_guard l(lock_);
+    const Entry* e = FindOrNull(index_, k);
+    if (e == nullptr || e->length != block.size()) {
+      if (misses_) misses_->Increment();
+      return Status::NotFound("block not in the persistent block cache");
+    }
+    entry = *e;
+  }
+
+  uint8_t header[kHeaderSize];
+  Slice results_backing[] = { Slice(header, kHeaderSize), block };
+  Status s = data_file_->ReadV(FileOffset(entry.position),
+                               ArrayView<Slice>(results_backing, 2));
+  if (PREDICT_FALSE(!s.ok() || !VerifyHeader(header, k.file_id, k.offset, block))) {
+    // The block was overwritten after a crash, or the data file is corrupt
+    // or was truncated.
+    Remove(k, entry.position);
+    if (misses_) misses_->Increment();
+    return s.ok() ? Status::Corruption("block in the persistent block cache failed validation")
+                  : s;
+  }
+  if (hits_) hits_->Increment();
+  return Status::OK();
+}
+
+void PersistentBlockCache::Insert(const BlockCache::CacheKey& key, const Slice& block) {
+  const Key k{ key.file_id_, key.offset_ };
+  if (KUDU_ALIGN_UP(kHeaderSize + block.size(), kAlignment) > capacity_) {
+    return;
+  }
+  {
+    std::lock_guard l(lock_);
+    if (ContainsKey(index_, k)) {
+      return;
+    }
+  }
+
+  // Rather than waiting for the write, which would slow down the read which
+  // missed the cache, hand a copy of the block over to the background writer.
+  // If it falls behind, skip the block instead of piling up copies.
+  const int64_t size = block.size();
+  const int64_t max_pending_bytes =
+      static_cast<int64_t>(FLAGS_block_cache_persistent_max_pending_write_mb) * 1024 * 1024;
+  if (pending_write_bytes_.fetch_add(size, std::memory_order_relaxed) + size >
+      max_pending_bytes) {
+    pending_write_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    return;
+  }
+  auto data = std::make_shared<string>(block.ToString());
+  Status s = write_pool_->Submit([this, k, data]() {
+    WriteBlock(k, *data);
+    pending_write_bytes_.fetch_sub(data->size(), std::memory_order_relaxed);
+  });
+  if (PREDICT_FALSE(!s.ok())) {
+    pending_write_bytes_.fetch_sub(size, std::memory_order_relaxed);
+  }
+}
+
+void PersistentBlockCache::WaitForPendingWrites() {
+  write_pool_->Wait();
+}
+
+void PersistentBlockCache::WriteBlock(const Key& k, const Slice& block) {
+  const uint64_t size = KUDU_ALIGN_UP(kHeaderSize + block.size(), kAlignment);
+  uint64_t position;
+  {
+    std::lock_guard l(lock_);
+    if (ContainsKey(index_, k)) {
+      return;
+    }
+    position = Reserve(size);
+  }
+
+  uint8_t header[kHeaderSize];
+  EncodeHeader(k.file_id, k.offset, block, header);
+  const Slice data[] = { Slice(header, kHeaderSize), block };
+  Status s = data_file_->WriteV(FileOffset(position), ArrayView<const Slice>(data, 2));
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(WARNING) << "failed to write a block to the persistent block cache: " << s.ToString();
+    return;
+  }
+
+  {
+    std::lock_guard l(lock_);
+    // Add the entry only once the block is written, unless later reservations
+    // have wrapped around the data file in the meantime.
+    if (IsOverwritten(position) ||
+        !InsertIfNotPresent(&index_, k, Entry{ position, static_cast<uint32_t>(block.size()) })) {
+      return;
+    }
+    InsertOrDie(&keys_by_position_, position, k);
+    dirty_ = true;
+  }
+  if (inserts_) inserts_->Increment();
+}
+
+uint64_t PersistentBlockCache::FileOffset(uint64_t position) const {
+  return data_file_->GetEncryptionHeaderSize() + position % capacity_;
+}
+
+uint64_t PersistentBlockCache::Reserve(uint64_t size) {
+  DCHECK_LE(size, capacity_);
+  uint64_t position = write_position_;
+  // Blocks don't wrap around the end of the data file.
+  if (position % capacity_ + size > capacity_) {
+    position += capacity_ - position % capacity_;
+  }
+  write_position_ = position + size;
+
+  // Evict the blocks which the reserved range overwrites: all the blocks
+  // before the last 'capacity_' bytes of the ring buffer.
+  while (!keys_by_position_.empty() && IsOverwritten(keys_by_position_.begin()->first)) {
+    index_.erase(keys_by_position_.begin()->second);
+    keys_by_position_.erase(keys_by_position_.begin());
+    if (evictions_) evictions_->Increment();
+  }
+  return position;
+}
+
+bool PersistentBlockCache::IsOverwritten(uint64_t position) const {
+  return write_position_ > capacity_ && position < write_position_ - capacity_;
+}
+
+void PersistentBlockCache::Remove(const Key& key, uint64_t position) {
+  std::lock_guard l(lock_);
+  const Entry* e = FindOrNull(index_, key);
+  if (e != nullptr && e->position == position) {
+    index_.erase(key);
+    keys_by_position_.erase(position);
+    dirty_ = true;
+  }
+}
+
+void PersistentBlockCache::CheckpointThread() {
+  while (!stop_checkpoints_.WaitFor(MonoDelta::FromSeconds(
+             std::max(1, FLAGS_block_cache_persistent_checkpoint_interval_secs)))) {
+    bool dirty;
+    {
+      std::lock_guard l(lock_);
+      dirty = dirty_;
+    }
+    if (dirty) {
+      WARN_NOT_OK(Checkpoint(), "failed to checkpoint the persistent block cache");
+    }
+  }
+}
+
+Status PersistentBlockCache::Checkpoint() {
+  std::lock_guard checkpoint_l(checkpoint_lock_);
+  PersistentBlockCacheIndexPB pb;
+  pb.set_capacity(capacity_);
+  {
+    std::lock_guard l(lock_);
+    pb.set_write_position(write_position_);
+    for (const auto& [position, key] : keys_by_position_) {
+      auto* entry_pb = pb.add_entries();
+      entry_pb->set_file_id(key.file_id);
+      entry_pb->set_offset(key.offset);
+      entry_pb->set_position(position);
+      entry_pb->set_length(FindOrDie(index_, key).length);
+    }
+    dirty_ = false;
+  }
+  // Every block in the index has been written, so syncing the data file
+  // before writing the index makes all of them durable.
+  Status s = data_file_->Sync();
+  if (s.ok()) {
+    s = pb_util::WritePBContainerToPath(env_, index_path(), pb, pb_util::OVERWRITE,
+                                        pb_util::SYNC, pb_util::NOT_SENSITIVE);
+  }
+  if (PREDICT_FALSE(!s.ok())) {
+    // Try again at the next checkpoint.
+    std::lock_guard l(lock_);
+    dirty_ = true;
+  }
+  return s;
+}
+
+size_t PersistentBlockCache::num_blocks() const {
+  std::lock_guard l(lock_);
+  return index_.size();
+}
+
+string PersistentBlockCache::data_path() const {
+  return JoinPathSegments(dir_, kDataFileName);
+}
+
+string PersistentBlockCache::index_path() const {
+  return JoinPathSegments(dir_, kIndexFileName);
+}
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,214 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "kudu/cfile/block_cache.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class Env;
+class RWFile;
+class Thread;
+class ThreadPool;
+
+namespace fs {
+class BlockManager;
+} // namespace fs
+
+namespace cfile {
+
+// A block cache tier in a local file, typically on an SSD, whose contents
+// survive restarts of the server.
+//
+// The blocks are stored in a data file of a fixed capacity which is used as
+// a ring buffer: every block is written after the most recently written one,
+// wrapping around to the beginning of the file and overwriting the oldest
+// blocks. Every block is preceded by a header with its key, its length and
+// its checksum, which are verified whenever the block is read back, so that
+// a block which was overwritten or corrupted is a cache miss rather than
+// bad data. Inserted blocks are written by a background thread, so that
+// reads which miss the cache don't wait for them to be written.
+//
+// The index of the blocks is kept in memory, and it's written to an index
+// file by Checkpoint(), which a background thread calls periodically if
+// blocks were inserted since the last checkpoint. On startup, the index is loaded
+// from the index file, dropping the entries of the blocks which no longer
+// exist in the block manager. Since block IDs are never reused and blocks
+// are immutable, the remaining entries are still valid.
+//
+// This class is thread-safe.
+class PersistentBlockCache {
+ public:
+  // Open the persistent block cache in the directory 'dir', creating it if
+  // it doesn't exist yet. The data file takes up to 'capacity' bytes.
+  //
+  // The index of the blocks cached by a previous instance is validated
+  // against the contents of 'block_manager'. If the index can't be read,
+  // or if the capacity has changed, the cache starts empty.
+  //
+  // 'metric_entity' may be null, in which case no metrics are recorded.
+  static Status Open(Env* env,
+                     const std::string& dir,
+                     uint64_t capacity,
+                     fs::BlockManager* block_manager,
+                     const scoped_refptr<MetricEntity>& metric_entity,
+                     std::unique_ptr<PersistentBlockCache>* cache);
+
+  ~PersistentBlockCache();
+
+  // Read the block with the given key into 'block', whose size must be the
+  // size of the cached block. Returns NotFound if the block isn't cached,
+  // and Corruption if it doesn't match its header anymore, in which case
+  // it's removed from the cache.
+  Status Lookup(const BlockCache::CacheKey& key, Slice block);
+
+  // Copy the block with the given key to be written into the cache by the
+  // background writer, overwriting the oldest blocks if needed. Blocks larger
+  // than the cache are skipped, as are blocks inserted while too many bytes
+  // are waiting to be written (see --block_cache_persistent_max_pending_write_mb).
+  // Write errors are logged and otherwise ignored.
+  void Insert(const BlockCache::CacheKey& key, const Slice& block);
+
+  // Wait until the blocks inserted so far have been written.
+  void WaitForPendingWrites();
+
+  // Sync the data file and write the index of the cached blocks to the
+  // index file, so that they're found in the cache after a restart.
+  Status Checkpoint();
+
+  // Return the number of blocks in the cache.
+  size_t num_blocks() const;
+
+ private:
+  // The key of a cached block: the ID of the file and the offset of the
+  // block within the file.
+  struct Key {
+    uint64_t file_id;
+    uint64_t offset;
+
+    bool operator==(const Key& other) const {
+      return file_id == other.file_id && offset == other.offset;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  // The location of a cached block in the data file.
+  struct Entry {
+    // The logical position of the block's header. Logical positions grow
+    // forever; the offset in the data file is the position modulo the
+    // capacity.
+    uint64_t position;
+
+    // The length of the block, not including the header.
+    uint32_t length;
+  };
+
+  PersistentBlockCache(Env* env, std::string dir, uint64_t capacity,
+                       const scoped_refptr<MetricEntity>& metric_entity);
+
+  Status Init(fs::BlockManager* block_manager);
+
+  // Load the index of the blocks from the index file.
+  Status LoadIndex(fs::BlockManager* block_manager);
+
+  // Write the block with the given key into the data file, and add it to the
+  // index. Called by the background writer.
+  void WriteBlock(const Key& key, const Slice& block);
+
+  // Return the offset in the data file of the given logical position, past
+  // the encryption header of the file, if any.
+  uint64_t FileOffset(uint64_t position) const;
+
+  // Reserve 'size' bytes in the data file, evicting the blocks which the
+  // reserved range overwrites, and return its logical position.
+  uint64_t Reserve(uint64_t size);
+
+  // Return true if the range at the given logical position has been
+  // overwritten by a later reservation.
+  bool IsOverwritten(uint64_t position) const;
+
+  // Remove the entry of the given key, if it's still at the given position.
+  void Remove(const Key& key, uint64_t position);
+
+  // Periodically call Checkpoint() if the index changed, until
+  // 'stop_checkpoints_' is counted down.
+  void CheckpointThread();
+
+  std::string data_path() const;
+  std::string index_path() const;
+
+  Env* const env_;
+  const std::string dir_;
+  const uint64_t capacity_;
+
+  std::unique_ptr<RWFile> data_file_;
+
+  // Runs the writes of the inserted blocks, one at a time and in order.
+  std::unique_ptr<ThreadPool> write_pool_;
+
+  // The number of bytes of the inserted blocks which are yet to be written.
+  std::atomic<int64_t> pending_write_bytes_;
+
+  // Protects 'write_position_', 'index_', 'keys_by_position_' and 'dirty_'.
+  mutable std::mutex lock_;
+
+  // The logical position at which the next block will be written.
+  uint64_t write_position_;
+
+  std::unordered_map<Key, Entry, KeyHash> index_;
+
+  // The keys of the cached blocks, ordered by their logical positions,
+  // oldest first.
+  std::map<uint64_t, Key> keys_by_position_;
+
+  // Whether the index changed since the last checkpoint.
+  bool dirty_;
+
+  // Serializes checkpoints.
+  std::mutex checkpoint_lock_;
+
+  CountDownLatch stop_checkpoints_;
+  scoped_refptr<Thread> checkpoint_thread_;
+
+  scoped_refptr<Counter> hits_;
+  scoped_refptr<Counter> misses_;
+  scoped_refptr<Counter> inserts_;
+  scoped_refptr<Counter> evictions_;
+
+  DISALLOW_COPY_AND_ASSIGN(PersistentBlockCache);
+};
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,283 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/zone_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/bitmap.h"
+#include "kudu/util/pb_util.h"
+
+using std::string;
+using std::unique_ptr;
+using strings::Substitute;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+bool IsNaN(DataType physical_type, const void* cell) {
+  if (physical_type == FLOAT) {
+    float f;
+    memcpy(&f, cell, sizeof(f));
+    return std::isnan(f);
+  }
+  DCHECK_EQ(DOUBLE, physical_type);
+  double d;
+  memcpy(&d, cell, sizeof(d));
+  return std::isnan(d);
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////
+// ZoneMapBuilder
+////////////////////////////////////////////////////////////
+
+ZoneMapBuilder::ZoneMapBuilder(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo),
+      is_binary_(typeinfo->physical_type() == BINARY),
+      is_floating_point_(typeinfo->physical_type() == FLOAT ||
+                         typeinfo->physical_type() == DOUBLE),
+      null_count_(0),
+      has_values_(false),
+      has_nan_(false) {
+  DCHECK_LE(typeinfo_->size(), sizeof(min_cell_));
+}
+
+void ZoneMapBuilder::CopyCell(const void* src, uint8_t* dst, faststring* buf) const {
+  if (is_binary_) {
+    const Slice* src_slice = reinterpret_cast<const Slice*>(src);
+    buf->assign_copy(src_slice->data(), src_slice->size());
+    Slice copy(buf->data(), buf->size());
+    memcpy(dst, &copy, sizeof(copy));
+  } else {
+    memcpy(dst, src, typeinfo_->size());
+  }
+}
+
+void ZoneMapBuilder::AddValues(const void* cells, size_t count) {
+  const uint8_t* cell = reinterpret_cast<const uint8_t*>(cells);
+  const size_t cell_size = typeinfo_->size();
+  for (size_t i = 0; i < count; i++, cell += cell_size) {
+    if (is_floating_point_ && IsNaN(typeinfo_->physical_type(), cell)) {
+      // NaN doesn't have a place in the ordering of the other values, so
+      // the block's bounds can't be relied upon.
+      has_nan_ = true;
+      continue;
+    }
+    if (PREDICT_FALSE(!has_values_)) {
+      CopyCell(cell, min_cell_, &min_buf_);
+      CopyCell(cell, max_cell_, &max_buf_);
+      has_values_ = true;
+    } else if (typeinfo_->Compare(cell, min_cell_) < 0) {
+      CopyCell(cell, min_cell_, &min_buf_);
+    } else if (typeinfo_->Compare(cell, max_cell_) > 0) {
+      CopyCell(cell, max_cell_, &max_buf_);
+    }
+  }
+}
+
+void ZoneMapBuilder::AddNulls(size_t count) {
+  null_count_ += count;
+}
+
+void ZoneMapBuilder::FinishBlock(rowid_t first_row) {
+  ZoneMapEntryPB* entry = pb_.add_entries();
+  entry->set_first_row(first_row);
+  if (null_count_ > 0) {
+    entry->set_null_count(null_count_);
+  }
+  if (has_values_ && !has_nan_) {
+    if (is_binary_) {
+      Slice min;
+      Slice max;
+      memcpy(&min, min_cell_, sizeof(min));
+      memcpy(&max, max_cell_, sizeof(max));
+      entry->set_min_value(min.data(), std::min(min.size(), kZoneMapMaxBinaryValueSize));
+      if (max.size() <= kZoneMapMaxBinaryValueSize) {
+        entry->set_max_value(max.data(), max.size());
+      }
+    } else {
+      entry->set_min_value(min_cell_, typeinfo_->size());
+      entry->set_max_value(max_cell_, typeinfo_->size());
+    }
+  }
+
+  null_count_ = 0;
+  has_values_ = false;
+  has_nan_ = false;
+}
+
+void ZoneMapBuilder::Finish(faststring* out) const {
+  pb_util::SerializeToString(pb_, out);
+}
+
+////////////////////////////////////////////////////////////
+// ZoneMap
+////////////////////////////////////////////////////////////
+
+ZoneMap::ZoneMap(const TypeInfo* typeinfo, unique_ptr<ZoneMapPB> pb)
+    : typeinfo_(typeinfo),
+      pb_(std::move(pb)) {
+}
+
+Status ZoneMap::Parse(const TypeInfo* typeinfo,
+                      const Slice& data,
+                      rowid_t num_rows,
+                      unique_ptr<ZoneMap>* zone_map) {
+  unique_ptr<ZoneMapPB> pb(new ZoneMapPB);
+  if (PREDICT_FALSE(!pb->ParseFromArray(data.data(), data.size()))) {
+    return Status::Corruption("could not parse zone map");
+  }
+  unique_ptr<ZoneMap> ret(new ZoneMap(typeinfo, std::move(pb)));
+
+  const bool is_binary = typeinfo->physical_type() == BINARY;
+  auto parse_cell = [&](const string& value, uint8_t* cell) {
+    if (is_binary) {
+      Slice s(value);
+      memcpy(cell, &s, sizeof(s));
+      return Status::OK();
+    }
+    if (PREDICT_FALSE(value.size() != typeinfo->size())) {
+      return Status::Corruption(Substitute("zone map value has bad size $0 (expected $1)",
+                                           value.size(), typeinfo->size()));
+    }
+    memcpy(cell, value.data(), value.size());
+    return Status::OK();
+  };
+
+  const auto& entries = ret->pb_->entries();
+  ret->zones_.resize(entries.size());
+  for (int i = 0; i < entries.size(); i++) {
+    const ZoneMapEntryPB& entry = entries.Get(i);
+    const rowid_t end_row = i + 1 < entries.size() ? entries.Get(i + 1).first_row() : num_rows;
+    if (PREDICT_FALSE(end_row < entry.first_row() || end_row > num_rows)) {
+      return Status::Corruption(Substitute("zone map entry $0 has bad row range [$1, $2)",
+                                           i, entry.first_row(), end_row));
+    }
+    Zone* zone = &ret->zones_[i];
+    zone->first_row = entry.first_row();
+    zone->num_rows = end_row - entry.first_row();
+    zone->null_count = entry.null_count();
+    if (PREDICT_FALSE(zone->null_count > zone->num_rows)) {
+      return Status::Corruption(Substitute("zone map entry $0 has $1 nulls in $2 rows",
+                                           i, zone->null_count, zone->num_rows));
+    }
+    zone->has_min = entry.has_min_value();
+    zone->has_max = entry.has_max_value();
+    if (zone->has_min) {
+      RETURN_NOT_OK(parse_cell(entry.min_value(), zone->min_cell));
+    }
+    if (zone->has_max) {
+      RETURN_NOT_OK(parse_cell(entry.max_value(), zone->max_cell));
+    }
+  }
+
+  *zone_map = std::move(ret);
+  return Status::OK();
+}
+
+bool ZoneMap::MayContain(const Zone& zone, const void* value) const {
+  if (zone.has_min && typeinfo_->Compare(value, zone.min_cell) < 0) {
+    return false;
+  }
+  if (zone.has_max && typeinfo_->Compare(value, zone.max_cell) > 0) {
+    return false;
+  }
+  return true;
+}
+
+bool ZoneMap::MayMatch(const ColumnPredicate& pred, size_t block_idx) const {
+  DCHECK_LT(block_idx, zones_.size());
+  const Zone& zone = zones_[block_idx];
+  const bool has_non_null = zone.null_count < zone.num_rows;
+  switch (pred.predicate_type()) {
+    case PredicateType::None:
+      return false;
+    case PredicateType::IsNull:
+      return zone.null_count > 0;
+    case PredicateType::IsNotNull:
+      return has_non_null;
+    case PredicateType::Equality:
+      return has_non_null && MayContain(zone, pred.raw_lower());
+    case PredicateType::Range:
+    case PredicateType::InBloomFilter: {
+      // A bloom filter predicate may carry range bounds as well.
+      if (!has_non_null) {
+        return false;
+      }
+      if (pred.raw_lower() != nullptr && zone.has_max &&
+          typeinfo_->Compare(zone.max_cell, pred.raw_lower()) < 0) {
+        return false;
+      }
+      if (pred.raw_upper() != nullptr && zone.has_min &&
+          typeinfo_->Compare(zone.min_cell, pred.raw_upper()) >= 0) {
+        return false;
+      }
+      return true;
+    }
+    case PredicateType::InList:
+      return has_non_null &&
+          std::any_of(pred.raw_values().begin(), pred.raw_values().end(),
+                      [&](const void* value) { return MayContain(zone, value); });
+  }
+  LOG(FATAL) << "unknown predicate type";
+}
+
+size_t ZoneMap::Prune(const ColumnPredicate& pred,
+                      rowid_t first_row,
+                      SelectionVector* sel) const {
+  const rowid_t end_row = first_row + sel->nrows();
+
+  // Find the zone containing 'first_row'.
+  auto it = std::upper_bound(zones_.begin(), zones_.end(), first_row,
+                             [](rowid_t row, const Zone& zone) {
+                               return row < zone.first_row;
+                             });
+  if (it != zones_.begin()) {
+    --it;
+  }
+
+  size_t num_pruned = 0;
+  for (; it != zones_.end() && it->first_row < end_row; ++it) {
+    const rowid_t start = std::max(it->first_row, first_row);
+    const rowid_t end = std::min(it->first_row + it->num_rows, end_row);
+    if (start >= end || MayMatch(pred, it - zones_.begin())) {
+      continue;
+    }
+    BitmapChangeBits(sel->mutable_bitmap(), start - first_row, end - start, false);
+    num_pruned++;
+  }
+  return num_pruned;
+}
+
+} // namespace cfile
+} // namespace kudu
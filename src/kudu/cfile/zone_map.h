@@ -0,0 +1,144 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kudu/cfile/cfile.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnPredicate;
+class SelectionVector;
+class TypeInfo;
+
+namespace cfile {
+
+// Zone maps hold per-data-block statistics of a CFile: the number of null
+// cells in each block and the smallest and largest of its non-null cells.
+// They're stored in a separate block of the CFile (see
+// CFileFooterPB::zone_map_block_ptr) as a serialized ZoneMapPB, and are used
+// by scans to rule out data blocks which can't contain any cell satisfying
+// a predicate, without reading those blocks.
+
+// Binary cells longer than this aren't stored whole in a zone map. A longer
+// minimum is truncated (a prefix is still a lower bound), while a longer
+// maximum is dropped altogether.
+constexpr size_t kZoneMapMaxBinaryValueSize = 64;
+
+// Collects the zone map of a CFile while its data blocks are being written.
+class ZoneMapBuilder {
+ public:
+  explicit ZoneMapBuilder(const TypeInfo* typeinfo);
+
+  // Account for 'count' non-null cells stored contiguously at 'cells'.
+  void AddValues(const void* cells, size_t count);
+
+  // Account for 'count' null cells.
+  void AddNulls(size_t count);
+
+  // Record the statistics of the data block whose first row is 'first_row'
+  // and which consists of all the cells added since the previous call, then
+  // start collecting the statistics of the next block.
+  void FinishBlock(rowid_t first_row);
+
+  // Serialize the zone map of all finished blocks into 'out'.
+  void Finish(faststring* out) const;
+
+ private:
+  // Copy the cell at 'src' into 'dst', making a private copy of the data of
+  // binary cells in 'buf'.
+  void CopyCell(const void* src, uint8_t* dst, faststring* buf) const;
+
+  const TypeInfo* typeinfo_;
+  const bool is_binary_;
+  const bool is_floating_point_;
+
+  ZoneMapPB pb_;
+
+  // Statistics of the block being written.
+  uint32_t null_count_;
+  bool has_values_;
+  bool has_nan_;
+  alignas(16) uint8_t min_cell_[16];
+  alignas(16) uint8_t max_cell_[16];
+  faststring min_buf_;
+  faststring max_buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZoneMapBuilder);
+};
+
+// A parsed zone map, used to skip data blocks while scanning a CFile.
+class ZoneMap {
+ public:
+  // Parse the serialized ZoneMapPB in 'data', describing the blocks of
+  // a CFile of type 'typeinfo' holding 'num_rows' rows.
+  static Status Parse(const TypeInfo* typeinfo,
+                      const Slice& data,
+                      rowid_t num_rows,
+                      std::unique_ptr<ZoneMap>* zone_map);
+
+  // Clear the bits of the rows in 'sel', which describes the rows starting
+  // at 'first_row', whose data blocks contain no cell that may satisfy 'pred'.
+  //
+  // Returns the number of data blocks which were ruled out, at least in part.
+  size_t Prune(const ColumnPredicate& pred, rowid_t first_row, SelectionVector* sel) const;
+
+  // Return true if the cells of the given data block may satisfy 'pred'.
+  // 'block_idx' is the index of the block in this zone map.
+  bool MayMatch(const ColumnPredicate& pred, size_t block_idx) const;
+
+  size_t num_blocks() const {
+    return zones_.size();
+  }
+
+ private:
+  struct Zone {
+    rowid_t first_row;
+    rowid_t num_rows;
+    uint32_t null_count;
+    bool has_min;
+    bool has_max;
+    alignas(16) uint8_t min_cell[16];
+    alignas(16) uint8_t max_cell[16];
+  };
+
+  ZoneMap(const TypeInfo* typeinfo, std::unique_ptr<ZoneMapPB> pb);
+
+  // Return true if 'value' may fall within the bounds of 'zone'.
+  bool MayContain(const Zone& zone, const void* value) const;
+
+  const TypeInfo* typeinfo_;
+
+  // The source of the data of binary cells in 'zones_'.
+  const std::unique_ptr<ZoneMapPB> pb_;
+
+  std::vector<Zone> zones_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZoneMap);
+};
+
+} // namespace cfile
+} // namespace kudu
@@ -1668,6 +1668,150 @@ TEST_F(ClientTest, TestScanEmptyProjection) {
   }
 }
 
+// Test scans which aggregate the rows of both tablets of the table.
+TEST_F(ClientTest, TestScanWithAggregation) {
+  // Rows with keys multiple of 3 belong to group "a", the others to group
+  // "b", so both groups have rows in both tablets.
+  constexpr int kNumRows = 30;
+  shared_ptr<KuduSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
+  for (int i = 0; i < kNumRows; i++) {
+    unique_ptr<KuduInsert> insert(client_table_->NewInsert());
+    KuduPartialRow* row = insert->mutable_row();
+    ASSERT_OK(row->SetInt32("key", i));
+    ASSERT_OK(row->SetInt32("int_val", i));
+    ASSERT_OK(row->SetStringCopy("string_val", i % 3 == 0 ? "a" : "b"));
+    ASSERT_OK(row->SetInt32("non_null_with_default", i));
+    ASSERT_OK(session->Apply(insert.release()));
+  }
+  ASSERT_OK(session->Flush());
+
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddGroupByColumn("string_val"));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::SUM, "int_val"));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::MAX, "key"));
+    vector<string> rows;
+    ASSERT_OK(ScanToStrings(&scanner, &rows));
+    std::sort(rows.begin(), rows.end());
+    ASSERT_EQ(vector<string>({
+        R"((string string_val="a", int64 count(*)=10, int64 sum(int_val)=135, )"
+        R"(int32 max(key)=27))",
+        R"((string string_val="b", int64 count(*)=20, int64 sum(int_val)=300, )"
+        R"(int32 max(key)=29))" }), rows);
+    ASSERT_EQ("count(*)", scanner.GetProjectionSchema().Column(1).name());
+  }
+
+  // Without grouping columns, there is always a single result row, even if no
+  // rows match the scan.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddConjunctPredicate(client_table_->NewComparisonPredicate(
+        "key", KuduPredicate::GREATER_EQUAL, KuduValue::FromInt(kNumRows))));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::MIN, "string_val"));
+    vector<string> rows;
+    ASSERT_OK(ScanToStrings(&scanner, &rows));
+    ASSERT_EQ(vector<string>{ "(int64 count(*)=0, string min(string_val)=NULL)" }, rows);
+  }
+
+  // Aggregation can't be combined with a limit, and the aggregated columns
+  // must be part of the projection.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.SetLimit(10));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "key" }));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::SUM, "int_val"));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  }
+}
+
+TEST_F(ClientTest, TestScanWithSortKeys) {
+  // The values of int_val are a permutation of the keys, and every fifth row
+  // has a null string_val.
+  constexpr int kNumRows = 30;
+  shared_ptr<KuduSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
+  for (int i = 0; i < kNumRows; i++) {
+    unique_ptr<KuduInsert> insert(client_table_->NewInsert());
+    KuduPartialRow* row = insert->mutable_row();
+    ASSERT_OK(row->SetInt32("key", i));
+    ASSERT_OK(row->SetInt32("int_val", (i * 7) % kNumRows));
+    if (i % 5 == 0) {
+      ASSERT_OK(row->SetNull("string_val"));
+    } else {
+      ASSERT_OK(row->SetStringCopy("string_val", "x"));
+    }
+    ASSERT_OK(row->SetInt32("non_null_with_default", i));
+    ASSERT_OK(session->Apply(insert.release()));
+  }
+  ASSERT_OK(session->Flush());
+
+  // The first rows are selected among those of both tablets, and returned in
+  // order.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "key", "int_val" }));
+    ASSERT_OK(scanner.AddSortKey("int_val", /*descending=*/true));
+    ASSERT_OK(scanner.SetLimit(3));
+    vector<string> rows;
+    ASSERT_OK(ScanToStrings(&scanner, &rows));
+    ASSERT_EQ(vector<string>({
+        "(int32 key=17, int32 int_val=29)",
+        "(int32 key=4, int32 int_val=28)",
+        "(int32 key=21, int32 int_val=27)" }), rows);
+  }
+
+  // Rows which are equal on the first sort key are ordered by the next one.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "key", "string_val" }));
+    ASSERT_OK(scanner.AddSortKey("string_val", /*descending=*/false, /*nulls_first=*/true));
+    ASSERT_OK(scanner.AddSortKey("key", /*descending=*/true));
+    ASSERT_OK(scanner.SetLimit(4));
+    vector<string> rows;
+    ASSERT_OK(ScanToStrings(&scanner, &rows));
+    ASSERT_EQ(vector<string>({
+        "(int32 key=25, string string_val=NULL)",
+        "(int32 key=20, string string_val=NULL)",
+        "(int32 key=15, string string_val=NULL)",
+        "(int32 key=10, string string_val=NULL)" }), rows);
+  }
+
+  // Sort keys require a limit, can't be used in a fault-tolerant scan, and
+  // must be part of the projection.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddSortKey("int_val"));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddSortKey("int_val"));
+    ASSERT_OK(scanner.SetLimit(3));
+    ASSERT_OK(scanner.SetFaultTolerant());
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "key" }));
+    ASSERT_OK(scanner.AddSortKey("int_val"));
+    ASSERT_OK(scanner.SetLimit(3));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  }
+}
+
 TEST_F(ClientTest, TestProjectInvalidColumn) {
   KuduScanner scanner(client_table_.get());
   Status s = scanner.SetProjectedColumnNames({ "column-doesnt-exist" });
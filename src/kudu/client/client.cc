@@ -1994,6 +1994,9 @@ Status KuduScanner::SetCacheBlocks(bool cache_blocks) {
 }
 
 KuduSchema KuduScanner::GetProjectionSchema() const {
+  if (data_->merger_) {
+    return data_->client_result_schema_;
+  }
   return KuduSchema::FromSchema(*data_->configuration().projection());
 }
 
@@ -2024,6 +2027,27 @@ Status KuduScanner::SetLimit(int64_t limit) {
   return data_->mutable_configuration()->SetLimit(limit);
 }
 
+Status KuduScanner::AddGroupByColumn(const string& col_name) {
+  if (data_->open_) {
+    return Status::IllegalState("Grouping columns must be set before Open()");
+  }
+  return data_->mutable_configuration()->AddGroupByColumn(col_name);
+}
+
+Status KuduScanner::AddAggregate(AggregateFunction function, const string& col_name) {
+  if (data_->open_) {
+    return Status::IllegalState("Aggregates must be set before Open()");
+  }
+  return data_->mutable_configuration()->AddAggregate(function, col_name);
+}
+
+Status KuduScanner::AddSortKey(const string& col_name, bool descending, bool nulls_first) {
+  if (data_->open_) {
+    return Status::IllegalState("Sort keys must be set before Open()");
+  }
+  return data_->mutable_configuration()->AddSortKey(col_name, descending, nulls_first);
+}
+
 const ResourceMetrics& KuduScanner::GetResourceMetrics() const {
   return data_->resource_metrics_;
 }
@@ -2061,6 +2085,12 @@ Status KuduScanner::Open() {
     RETURN_NOT_OK(data_->mutable_configuration()->AddIsDeletedColumn());
   }
   data_->mutable_configuration()->OptimizeScanSpec();
+  if (data_->configuration().has_aggregation()) {
+    RETURN_NOT_OK(data_->InitMerger());
+  }
+  if (data_->configuration().has_top_n()) {
+    RETURN_NOT_OK(data_->InitTopNMerger());
+  }
   data_->partition_pruner_.Init(*data_->table_->schema().schema_,
                                 data_->table_->partition_schema(),
                                 data_->configuration().spec());
@@ -2145,10 +2175,8 @@ void KuduScanner::Close() {
 
 bool KuduScanner::HasMoreRows() const {
   CHECK(data_->open_);
-  bool has_more = !data_->short_circuit_ &&        // The scan is not short circuited
-      (data_->data_in_open_ ||                     // more data in hand
-       data_->last_response_.has_more_results() || // more data in this tablet
-       data_->MoreTablets());                      // more tablets to scan, possibly with more data
+  bool has_more = data_->has_merger() ? !data_->merged_results_returned_
+                                      : data_->MoreResponses();
   if (!has_more) {
     data_->StopKeepAlivePeriodically();
   }
@@ -2167,6 +2195,9 @@ Status KuduScanner::NextBatch(vector<KuduRowResult>* rows) {
 }
 
 Status KuduScanner::NextBatch(KuduScanBatch* batch) {
+  if (data_->has_merger()) {
+    return NextMergedBatch(batch);
+  }
   return NextBatch(batch->data_);
 }
 
@@ -2194,8 +2225,8 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
     VLOG(2) << "Extracting data from " << data_->DebugString();
     data_->data_in_open_ = false;
     return batch_data->Reset(&data_->controller_,
-                             data_->configuration().projection(),
-                             data_->configuration().client_projection(),
+                             data_->response_projection(),
+                             data_->client_response_projection(),
                              data_->configuration().row_format_flags(),
                              &data_->last_response_);
   }
@@ -2219,8 +2250,8 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
         }
         data_->scan_attempts_ = 0;
         return batch_data->Reset(&data_->controller_,
-                                 data_->configuration().projection(),
-                                 data_->configuration().client_projection(),
+                                 data_->response_projection(),
+                                 data_->client_response_projection(),
                                  data_->configuration().row_format_flags(),
                                  &data_->last_response_);
       }
@@ -2273,6 +2304,18 @@ Status KuduScanner::NextBatch(internal::ScanBatchDataInterface* batch_data) {
   }
 }
 
+Status KuduScanner::NextMergedBatch(KuduScanBatch* batch) {
+  CHECK(data_->open_);
+  // All the responses of all the tablets must be merged before any result
+  // can be returned.
+  KuduScanBatch response_batch;
+  while (data_->MoreResponses()) {
+    RETURN_NOT_OK(NextBatch(response_batch.data_));
+    RETURN_NOT_OK(data_->MergeBatch(*response_batch.data_));
+  }
+  return data_->NextMergedResults(batch->data_);
+}
+
 Status KuduScanner::GetCurrentServer(KuduTabletServer** server) {
   CHECK(data_->open_);
   internal::RemoteTabletServer* rts = data_->ts_;
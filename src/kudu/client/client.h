@@ -2799,6 +2799,24 @@ class KUDU_EXPORT KuduScanner {
     ORDERED
   };
 
+  /// The aggregate functions which may be computed by a scanner.
+  ///
+  /// @see AddAggregate()
+  enum AggregateFunction {
+    /// The number of rows, or of non-null values of a column.
+    COUNT,
+
+    /// The sum of the non-null values of an integer or floating point column,
+    /// as an INT64 or a DOUBLE respectively.
+    SUM,
+
+    /// The minimum non-null value of a column.
+    MIN,
+
+    /// The maximum non-null value of a column.
+    MAX
+  };
+
   /// Default scanner timeout.
   /// This is set to 3x the default RPC timeout returned by
   /// KuduClientBuilder::default_rpc_timeout().
@@ -3160,7 +3178,8 @@ class KUDU_EXPORT KuduScanner {
   /// @return Operation result status.
   Status SetTimeoutMillis(int millis);
 
-  /// @return Schema of the projection being scanned.
+  /// @return Schema of the projection being scanned, or of the aggregates
+  ///   if the scanner is open and computes an aggregation.
   KuduSchema GetProjectionSchema() const;
 
   /// @return KuduTable being scanned.
@@ -3230,6 +3249,68 @@ class KUDU_EXPORT KuduScanner {
   /// @return Operation result status.
   Status SetLimit(int64_t limit) WARN_UNUSED_RESULT;
 
+  /// Group the rows by the values of a column when computing the aggregates
+  /// added with AddAggregate().
+  ///
+  /// Each result row then starts with the values of the grouping columns, in
+  /// the order they were added.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column, which must be part of the projection.
+  /// @return Operation result status.
+  Status AddGroupByColumn(const std::string& col_name) WARN_UNUSED_RESULT;
+
+  /// Return an aggregate of the scanned rows instead of the rows themselves.
+  ///
+  /// The tablet servers aggregate the rows they scan, and the scanner merges
+  /// the aggregates of all the tablets before returning any results. The
+  /// result rows have one column per grouping column, followed by one column
+  /// per aggregate named after it, e.g. "sum(col)" or "count(*)". Once the
+  /// scanner is open, GetProjectionSchema() returns their schema.
+  ///
+  /// An aggregation can't be combined with a limit or with row format flags,
+  /// and Open() returns InvalidArgument if it is. An integer sum which
+  /// overflows INT64 fails the scan.
+  ///
+  /// @note Older versions of the Kudu server do not support aggregation, in
+  ///   which case Open() returns NotSupported.
+  ///
+  /// @param [in] function
+  ///   The aggregate function to compute.
+  /// @param [in] col_name
+  ///   Name of the aggregated column, which must be part of the projection.
+  ///   May be empty for COUNT, to count the rows.
+  /// @return Operation result status.
+  Status AddAggregate(AggregateFunction function,
+                      const std::string& col_name) WARN_UNUSED_RESULT;
+
+  /// Return only the first rows in the order of a column, rather than all
+  /// the scanned rows in an arbitrary order.
+  ///
+  /// The number of rows to return is set with SetLimit(), which is required.
+  /// Rows which are equal on the first sort key are ordered by the following
+  /// ones, in the order they were added. Each tablet server keeps the first
+  /// rows of its tablet until the tablet is fully scanned, and the scanner
+  /// selects the first rows among those of all the tablets before returning
+  /// any results, in order.
+  ///
+  /// Sort keys can't be combined with an aggregation, row format flags or a
+  /// fault-tolerant scan, and Open() returns InvalidArgument if they are.
+  ///
+  /// @note Older versions of the Kudu server do not support sort keys, in
+  ///   which case Open() returns NotSupported.
+  ///
+  /// @param [in] col_name
+  ///   Name of the column to sort by, which must be part of the projection.
+  /// @param [in] descending
+  ///   Whether to sort in descending order of the column's values.
+  /// @param [in] nulls_first
+  ///   Whether null values come before the non-null ones.
+  /// @return Operation result status.
+  Status AddSortKey(const std::string& col_name,
+                    bool descending = false,
+                    bool nulls_first = false) WARN_UNUSED_RESULT;
+
   /// @return String representation of this scan.
   ///
   /// @internal
@@ -3242,6 +3323,10 @@ class KUDU_EXPORT KuduScanner {
 
   Status NextBatch(internal::ScanBatchDataInterface* batch);
 
+  // Returns the next batch of results merged from the results of all the
+  // tablets, for scans which compute an aggregation or select the first rows.
+  Status NextMergedBatch(KuduScanBatch* batch);
+
   friend class KuduScanToken;
   friend class FlexPartitioningTest;
   FRIEND_TEST(ClientTest, TestBlockScannerHijackingAttempts);
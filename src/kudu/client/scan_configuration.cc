@@ -222,6 +222,47 @@ Status ScanConfiguration::SetLimit(int64_t limit) {
   return Status::OK();
 }
 
+Status ScanConfiguration::AddGroupByColumn(const string& col_name) {
+  aggregation_.add_group_by_columns(col_name);
+  return Status::OK();
+}
+
+Status ScanConfiguration::AddAggregate(KuduScanner::AggregateFunction function,
+                                       const string& col_name) {
+  AggregationSpecPB::AggregatePB::Function function_pb;
+  switch (function) {
+    case KuduScanner::COUNT:
+      function_pb = AggregationSpecPB::AggregatePB::COUNT;
+      break;
+    case KuduScanner::SUM:
+      function_pb = AggregationSpecPB::AggregatePB::SUM;
+      break;
+    case KuduScanner::MIN:
+      function_pb = AggregationSpecPB::AggregatePB::MIN;
+      break;
+    case KuduScanner::MAX:
+      function_pb = AggregationSpecPB::AggregatePB::MAX;
+      break;
+    default:
+      return Status::InvalidArgument(strings::Substitute(
+          "Invalid aggregate function: $0", function));
+  }
+  AggregationSpecPB::AggregatePB* agg = aggregation_.add_aggregates();
+  agg->set_function(function_pb);
+  if (!col_name.empty()) {
+    agg->set_column(col_name);
+  }
+  return Status::OK();
+}
+
+Status ScanConfiguration::AddSortKey(const string& col_name, bool descending, bool nulls_first) {
+  TopNSpecPB::SortKeyPB* sort_key = top_n_.add_order_by();
+  sort_key->set_column(col_name);
+  sort_key->set_descending(descending);
+  sort_key->set_nulls_first(nulls_first);
+  return Status::OK();
+}
+
 Status ScanConfiguration::AddIsDeletedColumn() {
   CHECK(has_start_timestamp());
   CHECK(has_snapshot_timestamp());
@@ -28,6 +28,7 @@
 #include "kudu/client/client.h"
 #include "kudu/client/scan_predicate.h"
 #include "kudu/client/schema.h"
+#include "kudu/common/common.pb.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/gutil/port.h"
@@ -99,6 +100,12 @@ class ScanConfiguration {
 
   Status SetLimit(int64_t limit);
 
+  Status AddGroupByColumn(const std::string& col_name);
+
+  Status AddAggregate(KuduScanner::AggregateFunction function, const std::string& col_name);
+
+  Status AddSortKey(const std::string& col_name, bool descending, bool nulls_first);
+
   // Adds an IS_DELETED virtual column to the projection.
   //
   // Can only be used with diff scans.
@@ -184,6 +191,24 @@ class ScanConfiguration {
     return row_format_flags_;
   }
 
+  // Whether the scan computes an aggregation.
+  bool has_aggregation() const {
+    return aggregation_.group_by_columns_size() > 0 || aggregation_.aggregates_size() > 0;
+  }
+
+  const AggregationSpecPB& aggregation() const {
+    return aggregation_;
+  }
+
+  // Whether the scan selects the first rows in the order of some sort keys.
+  bool has_top_n() const {
+    return top_n_.order_by_size() > 0;
+  }
+
+  const TopNSpecPB& top_n() const {
+    return top_n_;
+  }
+
   Arena* arena() {
     return &arena_;
   }
@@ -237,6 +262,13 @@ class ScanConfiguration {
   std::deque<std::unique_ptr<KuduPredicate>> predicates_pool_;
 
   uint64_t row_format_flags_;
+
+  // The aggregation computed by the scan, if any.
+  AggregationSpecPB aggregation_;
+
+  // The sort keys of the rows selected by the scan, if any. The number of
+  // rows to select is the limit of the scan spec.
+  TopNSpecPB top_n_;
 };
 
 } // namespace client
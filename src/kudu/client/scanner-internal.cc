@@ -37,6 +37,9 @@
 #include "kudu/common/common.pb.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
@@ -91,7 +94,8 @@ KuduScanner::Data::Data(KuduTable* table)
     short_circuit_(false),
     table_(DCHECK_NOTNULL(table)->shared_from_this()),
     scan_attempts_(0),
-    num_rows_returned_(0) {
+    num_rows_returned_(0),
+    merged_results_returned_(false) {
 }
 
 KuduScanner::Data::~Data() {
@@ -425,6 +429,12 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
   if (configuration().row_format_flags() & KuduScanner::COLUMNAR_LAYOUT) {
     controller_.RequireServerFeature(TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE);
   }
+  if (merger_) {
+    controller_.RequireServerFeature(TabletServerFeatures::SCAN_AGGREGATION);
+  }
+  if (top_n_merger_) {
+    controller_.RequireServerFeature(TabletServerFeatures::SCAN_TOP_N);
+  }
 
   if (next_req_.has_new_scan_request()) {
     // Only new scan requests require authz tokens. Scan continuations rely on
@@ -502,7 +512,12 @@ Status KuduScanner::Data::OpenTablet(const PartitionKey& partition_key,
     scan->set_last_primary_key(last_primary_key_);
   }
 
-  if (configuration_.spec().has_limit()) {
+  if (configuration_.has_top_n()) {
+    // The limit is the number of rows to select from the tablet: no rows are
+    // returned before all the tablets are scanned.
+    *scan->mutable_top_n() = configuration_.top_n();
+    scan->mutable_top_n()->set_limit(configuration_.spec().limit());
+  } else if (configuration_.spec().has_limit()) {
     // Set the limit based on the number of rows we've already returned.
     int64_t new_limit = std::max(configuration_.spec().limit() - num_rows_returned_,
                                  static_cast<int64_t>(0));
@@ -512,6 +527,10 @@ Status KuduScanner::Data::OpenTablet(const PartitionKey& partition_key,
 
   scan->set_cache_blocks(configuration_.spec().cache_blocks());
 
+  if (configuration_.has_aggregation()) {
+    *scan->mutable_aggregation() = configuration_.aggregation();
+  }
+
   // For consistent operations, propagate the timestamp among all operations
   // performed the context of the same client. For READ_YOUR_WRITES scan, use
   // the propagation timestamp from the scan config.
@@ -696,6 +715,87 @@ bool KuduScanner::Data::MoreTablets() const {
   return partition_pruner_.HasMorePartitionKeyRanges();
 }
 
+bool KuduScanner::Data::MoreResponses() const {
+  return !short_circuit_ &&                  // The scan is not short circuited
+      (data_in_open_ ||                      // more data in hand
+       last_response_.has_more_results() ||  // more data in this tablet
+       MoreTablets());                       // more tablets to scan, possibly with more data
+}
+
+Status KuduScanner::Data::InitMerger() {
+  if (configuration_.spec().has_limit() ||
+      configuration_.row_format_flags() != KuduScanner::NO_FLAGS) {
+    return Status::InvalidArgument(
+        "aggregation can't be combined with a limit or row format flags");
+  }
+  // The tablet servers return the partial aggregates of an aggregator over
+  // the projection.
+  const AggregationSpecPB& spec = configuration_.aggregation();
+  unique_ptr<RowAggregator> aggregator;
+  RETURN_NOT_OK(RowAggregator::Create(spec, *configuration_.projection(), &aggregator));
+  RETURN_NOT_OK(RowAggregator::CreateMerger(spec, aggregator->result_schema(), &merger_));
+  client_result_schema_ = KuduSchema::FromSchema(merger_->result_schema());
+  return Status::OK();
+}
+
+Status KuduScanner::Data::InitTopNMerger() {
+  // A tablet server keeps the rows it selected until its tablet is fully
+  // scanned, so they would be lost if a fault-tolerant scan was resumed
+  // elsewhere.
+  if (!configuration_.spec().has_limit() ||
+      configuration_.has_aggregation() ||
+      configuration_.row_format_flags() != KuduScanner::NO_FLAGS ||
+      configuration_.is_fault_tolerant()) {
+    return Status::InvalidArgument(
+        "sort keys require a limit and can't be combined with an aggregation, "
+        "row format flags or a fault-tolerant scan");
+  }
+  TopNSpecPB spec = configuration_.top_n();
+  spec.set_limit(configuration_.spec().limit());
+  return TopNSelector::Create(spec, *configuration_.projection(), &top_n_merger_);
+}
+
+Status KuduScanner::Data::MergeBatch(const KuduScanBatch::Data& batch) {
+  const int num_rows = batch.num_rows();
+  if (num_rows == 0) {
+    return Status::OK();
+  }
+  const Schema* schema = batch.projection_;
+  RowBlockMemory mem;
+  RowBlock block(schema, num_rows, &mem);
+  block.selection_vector()->SetAllTrue();
+  for (int i = 0; i < num_rows; i++) {
+    const ConstContiguousRow src(schema, batch.direct_data_.data() + i * batch.projected_row_size_);
+    RowBlockRow dst = block.row(i);
+    RETURN_NOT_OK(CopyRow(src, &dst, block.arena()));
+  }
+  if (top_n_merger_) {
+    top_n_merger_->AddRows(block);
+    return Status::OK();
+  }
+  return merger_->AddRows(block);
+}
+
+Status KuduScanner::Data::NextMergedResults(KuduScanBatch::Data* batch) {
+  // Return the results in batches of about the size of a tablet server's.
+  static constexpr size_t kMergedBatchRows = 100;
+  RowBlockMemory mem;
+  if (top_n_merger_) {
+    RowBlock block(&top_n_merger_->schema(), kMergedBatchRows, &mem);
+    RETURN_NOT_OK(top_n_merger_->NextResults(&block));
+    if (block.nrows() < kMergedBatchRows) {
+      merged_results_returned_ = true;
+    }
+    return batch->Reset(block, configuration_.client_projection());
+  }
+  RowBlock block(&merger_->result_schema(), kMergedBatchRows, &mem);
+  RETURN_NOT_OK(merger_->NextResults(&block));
+  if (block.nrows() < kMergedBatchRows) {
+    merged_results_returned_ = true;
+  }
+  return batch->Reset(block, &client_result_schema_);
+}
+
 void KuduScanner::Data::PrepareRequest(RequestType state) {
   if (state == KuduScanner::Data::CLOSE) {
     next_req_.set_batch_size_bytes(0);
@@ -787,6 +887,25 @@ Status KuduScanBatch::Data::Reset(RpcController* controller,
                                  pad_unixtime_micros_to_16_bytes);
 }
 
+Status KuduScanBatch::Data::Reset(const RowBlock& block, const KuduSchema* client_projection) {
+  controller_.Reset();
+  projection_ = block.schema();
+  projected_row_size_ = CalculateProjectedRowSize(*projection_);
+  client_projection_ = client_projection;
+  row_format_flags_ = KuduScanner::NO_FLAGS;
+  resp_data_.Clear();
+  owned_direct_data_.clear();
+  owned_indirect_data_.clear();
+  if (block.nrows() == 0) {
+    return Status::OK();
+  }
+  resp_data_.set_num_rows(SerializeRowBlock(
+      block, nullptr, &owned_direct_data_, &owned_indirect_data_));
+  direct_data_ = Slice(owned_direct_data_);
+  indirect_data_ = Slice(owned_indirect_data_);
+  return RewriteRowBlockPointers(*projection_, resp_data_, indirect_data_, &direct_data_);
+}
+
 void KuduScanBatch::Data::ExtractRows(vector<KuduScanBatch::RowPtr>* rows) {
   DCHECK_EQ(row_format_flags_, KuduScanner::NO_FLAGS) << "Cannot extract rows. "
       << "Row format modifier flags were selected: " << row_format_flags_;
@@ -36,11 +36,14 @@
 #include "kudu/client/scan_configuration.h"
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
 #include "kudu/common/partition_pruner.h"
+#include "kudu/common/row_aggregator.h"
+#include "kudu/common/top_n_selector.h"
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/rpc_controller.h"
 #include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
@@ -48,6 +51,7 @@ namespace kudu {
 
 class MonoTime;
 class PartitionKey;
+class RowBlock;
 class Schema;
 
 namespace rpc {
@@ -191,6 +195,44 @@ class KuduScanner::Data {
   // but we won't know until we scan them.
   bool MoreTablets() const;
 
+  // Returns whether there may be more responses to receive from the tablet
+  // servers, i.e. whether there is data in hand, more data in the current
+  // tablet, or more tablets to scan.
+  bool MoreResponses() const;
+
+  // Initializes 'merger_' for a scan which computes an aggregation, checking
+  // the aggregation against the rest of the configuration.
+  Status InitMerger();
+
+  // Initializes 'top_n_merger_' for a scan which selects the first rows in
+  // the order of some sort keys, checking them against the rest of the
+  // configuration.
+  Status InitTopNMerger();
+
+  // Whether the responses of all the tablets must be merged before returning
+  // any results.
+  bool has_merger() const {
+    return merger_ || top_n_merger_;
+  }
+
+  // The schema of the rows returned by the tablet servers: the projection,
+  // or the schema of the partial aggregates if the scan computes an
+  // aggregation.
+  const Schema* response_projection() const {
+    return merger_ ? &merger_->result_schema() : configuration_.projection();
+  }
+  const KuduSchema* client_response_projection() const {
+    return merger_ ? &client_result_schema_ : configuration_.client_projection();
+  }
+
+  // Merges the rows of 'batch', a response of a tablet server, into 'merger_'
+  // or 'top_n_merger_'.
+  Status MergeBatch(const KuduScanBatch::Data& batch);
+
+  // Resets 'batch' to the next merged results, once all the responses have
+  // been merged.
+  Status NextMergedResults(KuduScanBatch::Data* batch);
+
   // Possible scan requests.
   enum RequestType {
     // A new scan of a particular tablet.
@@ -277,6 +319,20 @@ class KuduScanner::Data {
   // The scanner's cumulative resource metrics since the scan was started.
   ResourceMetrics resource_metrics_;
 
+  // For a scan which computes an aggregation, merges the partial aggregates
+  // returned for all the tablets. The tablet servers return rows of its
+  // result schema, which is also the schema of the merged results.
+  std::unique_ptr<RowAggregator> merger_;
+  KuduSchema client_result_schema_;
+
+  // For a scan which selects the first rows in the order of some sort keys,
+  // selects the first rows among those returned for all the tablets. Its
+  // schema is the projection.
+  std::unique_ptr<TopNSelector> top_n_merger_;
+
+  // Whether all the merged results have been returned.
+  bool merged_results_returned_;
+
   // Returns a text description of the scan suitable for debug printing.
   //
   // This method will not return sensitive predicate information, so it's
@@ -373,6 +429,10 @@ class KuduScanBatch::Data : public internal::ScanBatchDataInterface {
     return KuduRowResult(projection_, &direct_data_[offset]);
   }
 
+  // Resets the batch to the selected rows of 'block', which are copied into
+  // buffers owned by the batch. The schema of 'block' must outlive the batch.
+  Status Reset(const RowBlock& block, const KuduSchema* client_projection);
+
   void ExtractRows(std::vector<KuduScanBatch::RowPtr>* rows);
 
   void Clear() override;
@@ -388,6 +448,10 @@ class KuduScanBatch::Data : public internal::ScanBatchDataInterface {
   // The PB which contains the "direct data" slice.
   RowwiseRowBlockPB resp_data_;
 
+  // Holds the direct and indirect row data of a batch which was not
+  // returned by an RPC, but reset to the rows of a RowBlock.
+  faststring owned_direct_data_, owned_indirect_data_;
+
   // Slices into the direct and indirect row data, whose lifetime is ensured
   // by the members above.
   Slice direct_data_, indirect_data_;
@@ -83,6 +83,7 @@ class KuduColumnSpec::Data {
   std::optional<KuduColumnStorageAttributes::EncodingType> encoding;
   std::optional<KuduColumnStorageAttributes::CompressionType> compression;
   std::optional<int32_t> block_size;
+  std::optional<bool> bloom_filter;
   std::optional<bool> nullable;
   std::optional<bool> immutable;
   bool primary_key;
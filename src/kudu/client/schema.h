@@ -137,6 +137,7 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     RLE = 4,
     DICT_ENCODING = 5,
     BIT_SHUFFLE = 6,
+    FRAME_OF_REFERENCE = 7,
 
     /// @deprecated GROUP_VARINT is not supported for valid types, and
     /// will fall back to another encoding on the server side.
@@ -150,6 +151,7 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     SNAPPY = 2,
     LZ4 = 3,
     ZLIB = 4,
+    ZSTD = 5,
   };
 
 
@@ -490,6 +492,21 @@ class KUDU_EXPORT KuduColumnSpec {
   /// @return Pointer to the modified object.
   KuduColumnSpec* BlockSize(int32_t block_size);
 
+  /// Set whether to store a bloom filter of the column's values.
+  ///
+  /// Scans with equality or IN-list predicates on the column use the filter
+  /// to skip over the parts of the table's data which don't contain any of
+  /// the requested values. This is useful for point lookups on columns which
+  /// are not part of the primary key, at the cost of some additional space
+  /// and write amplification.
+  ///
+  /// @note The setting applies to data written after it has been changed.
+  ///
+  /// @param [in] enabled
+  ///   Whether to write the bloom filter.
+  /// @return Pointer to the modified object.
+  KuduColumnSpec* BloomFilter(bool enabled);
+
   /// @name Operations only relevant for decimal columns.
 
   ///@{
@@ -38,7 +38,8 @@ class ColumnMaterializationContext {
       pred_(pred),
       block_(block),
       sel_(sel),
-      decoder_eval_status_(kNotSet) {
+      decoder_eval_status_(kNotSet),
+      skip_deselected_rows_(false) {
     if (!pred_ || !sel || !block) {
       decoder_eval_status_ = kDecoderEvalNotSupported;
     }
@@ -110,6 +111,21 @@ class ColumnMaterializationContext {
     decoder_eval_status_ = kDecoderEvalNotSupported;
   }
 
+  // Checked by CFileIterator::Scan() to determine whether it may leave the
+  // cells of rows already cleared in the selection vector unmaterialized
+  // (on true).
+  bool SkipDeselectedRows() const {
+    return skip_deselected_rows_;
+  }
+
+  // Should be called by the owner of the selection vector if it has been
+  // initialized before materializing the column, and the cells of rows
+  // cleared in it will never be read.
+  void SetSkipDeselectedRows() {
+    DCHECK(sel_ != nullptr);
+    skip_deselected_rows_ = true;
+  }
+
  private:
   enum DecoderEvalStatus {
     // During scan, will try to evaluate with the decoder, after which the
@@ -139,6 +155,8 @@ class ColumnMaterializationContext {
   SelectionVector* const sel_;
 
   DecoderEvalStatus decoder_eval_status_;
+
+  bool skip_deselected_rows_;
 };
 
 } // namespace kudu
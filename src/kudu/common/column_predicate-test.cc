@@ -22,9 +22,11 @@
 #include <cstdlib>
 #include <functional>
 #include <initializer_list>
+#include <limits>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <gflags/gflags.h>
@@ -1498,6 +1500,95 @@ TEST_F(TestColumnPredicateDeathTest, TestMergeRequiresNameAndType) {
   }, "COMPARE_NAME_AND_TYPE");
 }
 
+// Test that evaluating predicates on a block of cells, which uses SIMD kernels
+// where the type allows, matches evaluating the predicates cell-by-cell.
+template<typename T>
+class ColumnPredicateEvaluationTest : public KuduTest {};
+
+using evaluation_test_types = ::testing::Types<
+  DataTypeTraits<INT8>,
+  DataTypeTraits<INT16>,
+  DataTypeTraits<INT32>,
+  DataTypeTraits<INT64>,
+  DataTypeTraits<UINT8>,
+  DataTypeTraits<UINT16>,
+  DataTypeTraits<UINT32>,
+  DataTypeTraits<UINT64>,
+  DataTypeTraits<FLOAT>,
+  DataTypeTraits<DOUBLE>>;
+
+TYPED_TEST_SUITE(ColumnPredicateEvaluationTest, evaluation_test_types);
+
+TYPED_TEST(ColumnPredicateEvaluationTest, TestMatchesEvaluateCell) {
+  using cpp_type = typename TypeParam::cpp_type;
+  constexpr auto kColType = TypeParam::physical_type;
+  // Not a multiple of 64 or 8, to exercise the tail handling.
+  constexpr int kNumRows = 1003;
+
+  // A pool of values including the extremes of the type, to exercise the
+  // handling of signedness.
+  vector<cpp_type> pool = {
+    std::numeric_limits<cpp_type>::lowest(),
+    static_cast<cpp_type>(0),
+    static_cast<cpp_type>(1),
+    static_cast<cpp_type>(3),
+    static_cast<cpp_type>(5),
+    static_cast<cpp_type>(7),
+    std::numeric_limits<cpp_type>::max(),
+  };
+  if constexpr (std::numeric_limits<cpp_type>::has_quiet_NaN) {
+    pool.push_back(std::numeric_limits<cpp_type>::quiet_NaN());
+  }
+
+  Random rng(SeedRandom());
+  ScopedColumnBlock<kColType> b(kNumRows);
+  for (int i = 0; i < kNumRows; i++) {
+    b[i] = pool[rng.Uniform(pool.size())];
+    b.SetCellIsNull(i, rng.OneIn(10));
+  }
+
+  ColumnSchema cs("c", kColType, ColumnSchema::NULLABLE);
+  vector<const void*> in_list = { &pool[0], &pool[3], &pool[6] };
+  vector<ColumnPredicate> preds = {
+    ColumnPredicate::Equality(cs, &pool[3]),
+    ColumnPredicate::Equality(cs, &pool[0]),
+    ColumnPredicate::Range(cs, &pool[2], &pool[5]),
+    ColumnPredicate::Range(cs, nullptr, &pool[4]),
+    ColumnPredicate::Range(cs, &pool[3], nullptr),
+    ColumnPredicate::Range(cs, &pool[0], &pool[6]),
+    ColumnPredicate::InList(cs, &in_list),
+    ColumnPredicate::IsNull(cs),
+    ColumnPredicate::IsNotNull(cs),
+  };
+  for (const auto& pred : preds) {
+    SCOPED_TRACE(pred.ToString());
+    if (pred.predicate_type() == PredicateType::None) {
+      continue;
+    }
+    // Deselect some rows up front: evaluation must never select them.
+    SelectionVector sel(kNumRows);
+    sel.SetAllTrue();
+    vector<bool> preselected(kNumRows);
+    for (int i = 0; i < kNumRows; i++) {
+      preselected[i] = !rng.OneIn(5);
+      if (!preselected[i]) {
+        sel.SetRowUnselected(i);
+      }
+    }
+    pred.Evaluate(b, &sel);
+
+    for (int i = 0; i < kNumRows; i++) {
+      bool expected = preselected[i];
+      if (pred.predicate_type() == PredicateType::IsNull) {
+        expected &= b.is_null(i);
+      } else {
+        expected &= !b.is_null(i) && pred.EvaluateCell<kColType>(&b[i]);
+      }
+      ASSERT_EQ(expected, sel.IsRowSelected(i)) << "at row " << i;
+    }
+  }
+}
+
 template<typename TypeParam>
 class ColumnPredicateBenchmark : public KuduTest {
   protected:
@@ -17,7 +17,12 @@
 
 #include "kudu/common/column_predicate.h"
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
 #include <type_traits>
@@ -27,6 +32,7 @@
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/gutil/cpu.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -626,16 +632,20 @@ namespace {
 // This technique can't safely be applied to cells like BINARY since these
 // consist of pointers, and following a junk pointer might crash the process.
 //
+// Evaluation starts at 'start_idx', which must be a multiple of 8.
+//
 // Returns the number of elements of 'cb' that were processed. This function
 // only processes multiples of 8, so if cb.nrows() is not a multiple of 8, the
 // last few elements may need to be processed by the caller.
 template <DataType PhysicalType, typename P>
 ATTRIBUTE_NOINLINE size_t ApplyPredicatePrimitive(
-    const ColumnBlock& block, uint8_t* __restrict__ sel_bitmap, P p) {
+    const ColumnBlock& block, size_t start_idx, uint8_t* __restrict__ sel_bitmap, P p) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  DCHECK_EQ(0, start_idx % 8);
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data()) + start_idx;
+  const size_t first_chunk = start_idx / 8;
   const size_t n_chunks = block.nrows() / 8;
-  for (size_t i = 0; i < n_chunks; ++i) {
+  for (size_t i = first_chunk; i < n_chunks; ++i) {
     uint8_t res_8 = 0;
     for (int j = 0; j < 8; j++) {
       res_8 |= p(data++) << j;
@@ -644,20 +654,288 @@ ATTRIBUTE_NOINLINE size_t ApplyPredicatePrimitive(
   }
   if (block.is_nullable()) {
     const uint8_t* const non_null_bitmap = block.non_null_bitmap();
-    for (size_t i = 0; i < n_chunks; ++i) {
+    for (size_t i = first_chunk; i < n_chunks; ++i) {
       sel_bitmap[i] &= non_null_bitmap[i];
     }
   }
   return n_chunks * 8;
 }
 
+// The types for which the predicates may be evaluated with SIMD kernels.
+template <typename T>
+constexpr bool SupportsSimdEvaluation() {
+  return (std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8) ||
+         std::is_same<T, float>::value || std::is_same<T, double>::value;
+}
+
+// The maximum number of values in an IN-list predicate for which the
+// predicate is evaluated with SIMD kernels. Each value costs a comparison per
+// cell, so for longer lists the binary search is cheaper.
+constexpr int kMaxSimdInListSize = 8;
+
+// The comparisons supported by the SIMD kernels.
+enum class SimdOp {
+  // cell < operands[0]
+  kLess,
+  // cell >= operands[0]
+  kGreaterOrEqual,
+  // operands[0] <= cell < operands[1]
+  kRange,
+  // cell == operands[0]
+  kEqual,
+  // cell == operands[i] for any i
+  kInList,
+};
+
+const bool kHasAvx2 = base::CPU().has_avx2();
+
+// AVX2 kernels. These are disabled on GCC4 because it doesn't support
+// per-function enabling of intrinsics.
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+
+#define KUDU_AVX2_INLINE inline ATTRIBUTE_ALWAYS_INLINE __attribute__((target("avx2")))
+
+// Vector operations on 256-bit registers of integers of type 'T'. The
+// comparisons return a vector with all bits of the lanes satisfying the
+// comparison set, and Mask() packs that into one bit per lane.
+//
+// AVX2 only has signed comparisons, so unsigned values are biased by
+// flipping their sign bit on load.
+template <typename T>
+struct Avx2Ops {
+  using Vec = __m256i;
+  static constexpr int kLanes = sizeof(Vec) / sizeof(T);
+
+  static KUDU_AVX2_INLINE Vec Set1(T v) {
+    if constexpr (sizeof(T) == 1) {
+      return _mm256_set1_epi8(static_cast<char>(v));
+    } else if constexpr (sizeof(T) == 2) {
+      return _mm256_set1_epi16(static_cast<int16_t>(v));
+    } else if constexpr (sizeof(T) == 4) {
+      return _mm256_set1_epi32(static_cast<int32_t>(v));
+    } else {
+      return _mm256_set1_epi64x(static_cast<int64_t>(v));
+    }
+  }
+  static KUDU_AVX2_INLINE Vec Bias(Vec v) {
+    if constexpr (std::is_signed<T>::value) {
+      return v;
+    } else {
+      return _mm256_xor_si256(v, Set1(static_cast<T>(T(1) << (sizeof(T) * 8 - 1))));
+    }
+  }
+  static KUDU_AVX2_INLINE Vec Broadcast(T v) {
+    return Bias(Set1(v));
+  }
+  static KUDU_AVX2_INLINE Vec Load(const T* p) {
+    return Bias(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  }
+  static KUDU_AVX2_INLINE Vec Greater(Vec a, Vec b) {
+    if constexpr (sizeof(T) == 1) {
+      return _mm256_cmpgt_epi8(a, b);
+    } else if constexpr (sizeof(T) == 2) {
+      return _mm256_cmpgt_epi16(a, b);
+    } else if constexpr (sizeof(T) == 4) {
+      return _mm256_cmpgt_epi32(a, b);
+    } else {
+      return _mm256_cmpgt_epi64(a, b);
+    }
+  }
+  static KUDU_AVX2_INLINE Vec Less(Vec a, Vec b) {
+    return Greater(b, a);
+  }
+  static KUDU_AVX2_INLINE Vec GreaterOrEqual(Vec a, Vec b) {
+    return _mm256_xor_si256(Greater(b, a), _mm256_set1_epi32(-1));
+  }
+  static KUDU_AVX2_INLINE Vec Equal(Vec a, Vec b) {
+    if constexpr (sizeof(T) == 1) {
+      return _mm256_cmpeq_epi8(a, b);
+    } else if constexpr (sizeof(T) == 2) {
+      return _mm256_cmpeq_epi16(a, b);
+    } else if constexpr (sizeof(T) == 4) {
+      return _mm256_cmpeq_epi32(a, b);
+    } else {
+      return _mm256_cmpeq_epi64(a, b);
+    }
+  }
+  static KUDU_AVX2_INLINE Vec And(Vec a, Vec b) {
+    return _mm256_and_si256(a, b);
+  }
+  static KUDU_AVX2_INLINE Vec Or(Vec a, Vec b) {
+    return _mm256_or_si256(a, b);
+  }
+  static KUDU_AVX2_INLINE uint32_t Mask(Vec m) {
+    if constexpr (sizeof(T) == 1) {
+      return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    } else if constexpr (sizeof(T) == 2) {
+      // Narrow the 16-bit lanes to bytes. The pack works within each 128-bit
+      // half, so the results are then gathered into the low 128 bits.
+      __m256i packed = _mm256_packs_epi16(m, _mm256_setzero_si256());
+      packed = _mm256_permute4x64_epi64(packed, 0xD8);
+      return static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xFFFF;
+    } else if constexpr (sizeof(T) == 4) {
+      return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+    } else {
+      return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+  }
+};
+
+// Floating point comparisons must match those of DataTypeTraits::Compare():
+// a NaN compares neither less nor greater than any value, hence it's "equal"
+// to all values, and "greater or equal" than all values.
+template <>
+struct Avx2Ops<float> {
+  using Vec = __m256;
+  static constexpr int kLanes = sizeof(Vec) / sizeof(float);
+
+  static KUDU_AVX2_INLINE Vec Broadcast(float v) { return _mm256_set1_ps(v); }
+  static KUDU_AVX2_INLINE Vec Load(const float* p) { return _mm256_loadu_ps(p); }
+  static KUDU_AVX2_INLINE Vec Less(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static KUDU_AVX2_INLINE Vec GreaterOrEqual(Vec a, Vec b) {
+    return _mm256_cmp_ps(a, b, _CMP_NLT_UQ);
+  }
+  static KUDU_AVX2_INLINE Vec Equal(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_UQ); }
+  static KUDU_AVX2_INLINE Vec And(Vec a, Vec b) { return _mm256_and_ps(a, b); }
+  static KUDU_AVX2_INLINE Vec Or(Vec a, Vec b) { return _mm256_or_ps(a, b); }
+  static KUDU_AVX2_INLINE uint32_t Mask(Vec m) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(m));
+  }
+};
+
+template <>
+struct Avx2Ops<double> {
+  using Vec = __m256d;
+  static constexpr int kLanes = sizeof(Vec) / sizeof(double);
+
+  static KUDU_AVX2_INLINE Vec Broadcast(double v) { return _mm256_set1_pd(v); }
+  static KUDU_AVX2_INLINE Vec Load(const double* p) { return _mm256_loadu_pd(p); }
+  static KUDU_AVX2_INLINE Vec Less(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static KUDU_AVX2_INLINE Vec GreaterOrEqual(Vec a, Vec b) {
+    return _mm256_cmp_pd(a, b, _CMP_NLT_UQ);
+  }
+  static KUDU_AVX2_INLINE Vec Equal(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_EQ_UQ); }
+  static KUDU_AVX2_INLINE Vec And(Vec a, Vec b) { return _mm256_and_pd(a, b); }
+  static KUDU_AVX2_INLINE Vec Or(Vec a, Vec b) { return _mm256_or_pd(a, b); }
+  static KUDU_AVX2_INLINE uint32_t Mask(Vec m) {
+    return static_cast<uint32_t>(_mm256_movemask_pd(m));
+  }
+};
+
+#undef KUDU_AVX2_INLINE
+
+// Evaluate the comparison 'OP' against 'operands' for the cells of 'data',
+// 64 cells at a time, so that the selection vector is updated a word at a
+// time. As with ApplyPredicatePrimitive(), junk in null cells is evaluated
+// too, and the result is masked with the non-null bitmap.
+//
+// Returns the number of cells processed, which is a multiple of 64.
+template <typename T, SimdOp OP>
+__attribute__((target("avx2")))
+size_t ApplyPredicateAvx2(const T* __restrict__ data,
+                          size_t nrows,
+                          const T* operands,
+                          int n_operands,
+                          const uint8_t* __restrict__ non_null_bitmap,
+                          uint8_t* __restrict__ sel_bitmap) {
+  using Ops = Avx2Ops<T>;
+  using Vec = typename Ops::Vec;
+  static_assert(64 % Ops::kLanes == 0, "lanes must evenly divide a 64-bit word");
+  DCHECK_GT(n_operands, 0);
+  DCHECK_LE(n_operands, kMaxSimdInListSize);
+
+  Vec ops[kMaxSimdInListSize];
+  for (int i = 0; i < n_operands; i++) {
+    ops[i] = Ops::Broadcast(operands[i]);
+  }
+
+  const size_t n_words = nrows / 64;
+  for (size_t w = 0; w < n_words; w++) {
+    uint64_t res = 0;
+    for (int k = 0; k < 64; k += Ops::kLanes, data += Ops::kLanes) {
+      const Vec v = Ops::Load(data);
+      Vec m;
+      if constexpr (OP == SimdOp::kLess) {
+        m = Ops::Less(v, ops[0]);
+      } else if constexpr (OP == SimdOp::kGreaterOrEqual) {
+        m = Ops::GreaterOrEqual(v, ops[0]);
+      } else if constexpr (OP == SimdOp::kRange) {
+        m = Ops::And(Ops::GreaterOrEqual(v, ops[0]), Ops::Less(v, ops[1]));
+      } else if constexpr (OP == SimdOp::kEqual) {
+        m = Ops::Equal(v, ops[0]);
+      } else {
+        m = Ops::Equal(v, ops[0]);
+        for (int i = 1; i < n_operands; i++) {
+          m = Ops::Or(m, Ops::Equal(v, ops[i]));
+        }
+      }
+      res |= static_cast<uint64_t>(Ops::Mask(m)) << k;
+    }
+    uint8_t* sel_word = sel_bitmap + w * sizeof(uint64_t);
+    uint64_t sel = UnalignedLoad<uint64_t>(sel_word) & res;
+    if (non_null_bitmap) {
+      sel &= UnalignedLoad<uint64_t>(non_null_bitmap + w * sizeof(uint64_t));
+    }
+    UnalignedStore<uint64_t>(sel_word, sel);
+  }
+  return n_words * 64;
+}
+
+#endif
 
+// Evaluate the comparison 'op' against 'operands' using SIMD kernels, if
+// supported by the CPU and the type.
+//
+// Returns the number of leading cells of 'block' that were processed; the
+// remaining ones must be processed by the caller.
+template <DataType PhysicalType>
+size_t ApplyPredicateSimd(const ColumnBlock& block,
+                          SelectionVector* sel,
+                          SimdOp op,
+                          const typename DataTypeTraits<PhysicalType>::cpp_type* operands,
+                          int n_operands) {
+  using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+  if constexpr (SupportsSimdEvaluation<cpp_type>()) {
+    if (kHasAvx2) {
+      const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+      const uint8_t* non_null_bitmap = block.is_nullable() ? block.non_null_bitmap() : nullptr;
+      uint8_t* sel_bitmap = sel->mutable_bitmap();
+      switch (op) {
+        case SimdOp::kLess:
+          return ApplyPredicateAvx2<cpp_type, SimdOp::kLess>(
+              data, block.nrows(), operands, n_operands, non_null_bitmap, sel_bitmap);
+        case SimdOp::kGreaterOrEqual:
+          return ApplyPredicateAvx2<cpp_type, SimdOp::kGreaterOrEqual>(
+              data, block.nrows(), operands, n_operands, non_null_bitmap, sel_bitmap);
+        case SimdOp::kRange:
+          return ApplyPredicateAvx2<cpp_type, SimdOp::kRange>(
+              data, block.nrows(), operands, n_operands, non_null_bitmap, sel_bitmap);
+        case SimdOp::kEqual:
+          return ApplyPredicateAvx2<cpp_type, SimdOp::kEqual>(
+              data, block.nrows(), operands, n_operands, non_null_bitmap, sel_bitmap);
+        case SimdOp::kInList:
+          return ApplyPredicateAvx2<cpp_type, SimdOp::kInList>(
+              data, block.nrows(), operands, n_operands, non_null_bitmap, sel_bitmap);
+      }
+    }
+  }
+#endif
+  return 0;
+}
+
+// Apply the predicate 'p' to the cells of 'block' starting at 'start_idx',
+// which must be a multiple of 8. The cells before 'start_idx' are expected to
+// have been evaluated already, e.g. by ApplyPredicateSimd().
 template <DataType PhysicalType, typename P>
-void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
+void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p, size_t start_idx = 0) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  size_t start_idx = 0;
+  if (start_idx == block.nrows()) {
+    return;
+  }
   if constexpr (std::is_fundamental<cpp_type>::value) {
-    start_idx = ApplyPredicatePrimitive<PhysicalType>(block, sel->mutable_bitmap(), p);
+    start_idx = ApplyPredicatePrimitive<PhysicalType>(
+        block, start_idx, sel->mutable_bitmap(), p);
     if (PREDICT_TRUE(start_idx == block.nrows())) {
       return;
     }
@@ -693,7 +971,19 @@ template<bool IS_NOT_NULL>
 void ApplyNullPredicate(const ColumnBlock& block, uint8_t* __restrict__ sel_vec) {
   const size_t n_bytes = KUDU_ALIGN_UP(block.nrows(), 8) / 8;
   const uint8_t* const non_null_bitmap = block.non_null_bitmap();
-  for (size_t i = 0; i < n_bytes; ++i) {
+  // Process a word at a time, then the remaining bytes.
+  const size_t n_words = n_bytes / sizeof(uint64_t);
+  for (size_t i = 0; i < n_words; ++i) {
+    const size_t off = i * sizeof(uint64_t);
+    const uint64_t non_null = UnalignedLoad<uint64_t>(non_null_bitmap + off);
+    const uint64_t sel = UnalignedLoad<uint64_t>(sel_vec + off);
+    if constexpr (IS_NOT_NULL) {
+      UnalignedStore<uint64_t>(sel_vec + off, sel & non_null);
+    } else {
+      UnalignedStore<uint64_t>(sel_vec + off, sel & ~non_null);
+    }
+  }
+  for (size_t i = n_words * sizeof(uint64_t); i < n_bytes; ++i) {
     if constexpr (IS_NOT_NULL) {
       sel_vec[i] &= non_null_bitmap[i];
     } else {
@@ -715,26 +1005,35 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       cpp_type local_upper = upper_ ? *static_cast<const cpp_type*>(upper_) : cpp_type();
 
       if (lower_ == nullptr) {
+        size_t start_idx = ApplyPredicateSimd<PhysicalType>(
+            block, sel, SimdOp::kLess, &local_upper, 1);
         ApplyPredicate<PhysicalType>(block, sel, [local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0;
-        });
+        }, start_idx);
       } else if (upper_ == nullptr) {
+        size_t start_idx = ApplyPredicateSimd<PhysicalType>(
+            block, sel, SimdOp::kGreaterOrEqual, &local_lower, 1);
         ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       } else {
+        const cpp_type bounds[] = { local_lower, local_upper };
+        size_t start_idx = ApplyPredicateSimd<PhysicalType>(
+            block, sel, SimdOp::kRange, bounds, 2);
         ApplyPredicate<PhysicalType>(block, sel, [local_lower, local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0 &&
                    traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       }
       return;
     }
     case PredicateType::Equality: {
       cpp_type local_lower = lower_ ? *static_cast<const cpp_type*>(lower_) : cpp_type();
+      size_t start_idx = ApplyPredicateSimd<PhysicalType>(
+          block, sel, SimdOp::kEqual, &local_lower, 1);
       ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) == 0;
-      });
+      }, start_idx);
       return;
     }
     case PredicateType::IsNotNull: {
@@ -753,12 +1052,23 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       return;
     }
     case PredicateType::InList: {
+      size_t start_idx = 0;
+      if constexpr (SupportsSimdEvaluation<cpp_type>()) {
+        if (!values_.empty() && values_.size() <= static_cast<size_t>(kMaxSimdInListSize)) {
+          cpp_type local_values[kMaxSimdInListSize];
+          for (size_t i = 0; i < values_.size(); i++) {
+            local_values[i] = *static_cast<const cpp_type*>(values_[i]);
+          }
+          start_idx = ApplyPredicateSimd<PhysicalType>(
+              block, sel, SimdOp::kInList, local_values, values_.size());
+        }
+      }
       ApplyPredicate<PhysicalType>(block, sel, [this] (const void* cell) {
         return std::binary_search(values_.begin(), values_.end(), cell,
                                   [] (const void* lhs, const void* rhs) {
                                     return traits::Compare(lhs, rhs) < 0;
                                   });
-      });
+      }, start_idx);
       return;
     }
     case PredicateType::InBloomFilter: {
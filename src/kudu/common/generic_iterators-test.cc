@@ -62,6 +62,7 @@
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/threadpool.h"
 
 DEFINE_int32(num_lists, 3, "Number of lists to merge");
 DEFINE_int32(num_rows, 1000, "Number of entries per list");
@@ -512,6 +513,80 @@ TEST(TestMergeIterator, TestDeDupGhostRows) {
                       /*include_deleted_rows=*/true));
 }
 
+// Test that a ParallelUnionIterator returns all the rows of its sub-iterators,
+// including empty ones, whatever the sizes of the blocks read ahead and of
+// the blocks the rows are returned in.
+TEST(TestParallelUnionIterator, TestReturnsAllRows) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("scan").set_max_threads(4).Build(&pool));
+
+  constexpr int kNumIters = 10;
+  constexpr int kRowsPerIter = 1000;
+  for (int parallelism : { 1, 3, 8 }) {
+    SCOPED_TRACE(parallelism);
+    vector<IterWithBounds> input;
+    vector<int64_t> expected;
+    for (int i = 0; i < kNumIters; i++) {
+      vector<int64_t> ints;
+      // Leave one of the sub-iterators empty.
+      if (i != 3) {
+        for (int j = 0; j < kRowsPerIter; j++) {
+          ints.push_back(i * kRowsPerIter + j);
+        }
+      }
+      expected.insert(expected.end(), ints.begin(), ints.end());
+      unique_ptr<VectorIterator> vec(new VectorIterator(ints));
+      vec->set_block_size(37);
+      IterWithBounds iwb;
+      iwb.iter = NewMaterializingIterator(std::move(vec));
+      input.emplace_back(std::move(iwb));
+    }
+    ParallelUnionIteratorOptions opts(pool.get(), parallelism);
+    opts.block_rows = 50;
+    unique_ptr<RowwiseIterator> iter(NewParallelUnionIterator(opts, std::move(input)));
+    ASSERT_OK(iter->Init(nullptr));
+
+    vector<int64_t> results;
+    RowBlockMemory mem;
+    RowBlock dst(&kIntSchema, 16, &mem);
+    while (iter->HasNext()) {
+      ASSERT_OK(iter->NextBlock(&dst));
+      for (size_t i = 0; i < dst.nrows(); i++) {
+        if (dst.selection_vector()->IsRowSelected(i)) {
+          results.push_back(*reinterpret_cast<const int64_t*>(dst.row(i).cell_ptr(kValColIdx)));
+        }
+      }
+    }
+    std::sort(results.begin(), results.end());
+    ASSERT_EQ(expected, results);
+  }
+}
+
+// Test that a ParallelUnionIterator which isn't fully consumed stops scanning
+// its sub-iterators when destroyed.
+TEST(TestParallelUnionIterator, TestNotConsumedCleanup) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("scan").set_max_threads(4).Build(&pool));
+  vector<IterWithBounds> input;
+  for (int i = 0; i < 5; i++) {
+    unique_ptr<VectorIterator> vec(new VectorIterator(vector<int64_t>(10000, i)));
+    vec->set_block_size(10);
+    IterWithBounds iwb;
+    iwb.iter = NewMaterializingIterator(std::move(vec));
+    input.emplace_back(std::move(iwb));
+  }
+  unique_ptr<RowwiseIterator> iter(NewParallelUnionIterator(
+      ParallelUnionIteratorOptions(pool.get(), 4), std::move(input)));
+  ASSERT_OK(iter->Init(nullptr));
+  ASSERT_TRUE(iter->HasNext());
+  RowBlockMemory mem;
+  RowBlock dst(&kIntSchema, 100, &mem);
+  ASSERT_OK(iter->NextBlock(&dst));
+  ASSERT_GT(dst.nrows(), 0);
+  iter.reset();
+  pool->Wait();
+}
+
 // Test that the MaterializingIterator properly evaluates predicates when they apply
 // to single columns.
 TEST(TestMaterializingIterator, TestMaterializingPredicatePushdown) {
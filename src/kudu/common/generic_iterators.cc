@@ -61,10 +61,13 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/condition_variable.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/memory/arena.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/object_pool.h"
+#include "kudu/util/threadpool.h"
 
 namespace boost {
 namespace heap {
@@ -1108,6 +1111,325 @@ unique_ptr<RowwiseIterator> NewUnionIterator(vector<IterWithBounds> iters) {
   return unique_ptr<RowwiseIterator>(new UnionIterator(std::move(iters)));
 }
 
+////////////////////////////////////////////////////////////
+// ParallelUnionIterator
+////////////////////////////////////////////////////////////
+
+// An iterator which, like UnionIterator, returns the rows of its sub-iterators
+// one after the other, but scans the sub-iterators on a thread pool.
+//
+// Up to 'max_parallelism' tasks on the pool take sub-iterators which have more
+// rows and read blocks from them into a fixed set of buffers, which are then
+// handed out to NextBlock() in the order they were filled. A task stops once
+// all the buffers are full, and tasks are started again as NextBlock() frees
+// buffers, so a scan whose client stops asking for rows doesn't hold on to
+// any thread of the pool.
+//
+// The rows of a sub-iterator are returned in order, but the rows of different
+// sub-iterators are interleaved.
+class ParallelUnionIterator : public RowwiseIterator {
+ public:
+  ParallelUnionIterator(ParallelUnionIteratorOptions opts, vector<IterWithBounds> iters);
+
+  ~ParallelUnionIterator() override;
+
+  Status Init(ScanSpec *spec) override;
+
+  bool HasNext() const override;
+
+  string ToString() const override;
+
+  const Schema &schema() const override {
+    CHECK(initted_);
+    return *schema_;
+  }
+
+  void GetIteratorStats(vector<IteratorStats>* stats) const override;
+
+  Status NextBlock(RowBlock* dst) override;
+
+ private:
+  // A block read from a sub-iterator, with the memory for its indirect data.
+  struct Buffer {
+    Buffer(const Schema* schema, size_t nrows)
+        : block(schema, nrows, &mem) {
+    }
+    RowBlockMemory mem;
+    RowBlock block;
+  };
+
+  // Read blocks from sub-iterators until there are no free buffers or no
+  // sub-iterators with more rows left.
+  void RunWorker();
+
+  // Take the next sub-iterator to scan and a buffer to read a block into,
+  // returning false if there are none.
+  bool TakeWorkUnlocked(size_t* iter_idx, Buffer** buf);
+
+  // Start tasks on the pool if there are buffers and sub-iterators for them.
+  void MaybeStartWorkersUnlocked();
+
+  // Wait until there's a block to return or all the sub-iterators have been
+  // scanned, or an error occurred.
+  void WaitForBlockUnlocked() const;
+
+  const ParallelUnionIteratorOptions opts_;
+
+  unique_ptr<Schema> schema_;
+  bool initted_;
+
+  // The sub-iterators. Each of them is only accessed by one task at a time.
+  vector<IterWithBounds> iters_;
+
+  // Copies of the scan spec for the sub-iterators. See UnionIterator.
+  ObjectPool<ScanSpec> scan_spec_copies_;
+
+  // The token on which the tasks are run.
+  unique_ptr<ThreadPoolToken> token_;
+
+  vector<unique_ptr<Buffer>> buffers_;
+
+  // The buffer whose block is being returned by NextBlock(), if any, and the
+  // index of its next row to return. Only accessed by the caller's thread.
+  Buffer* current_;
+  size_t current_offset_;
+
+  // Protects all the members below.
+  mutable Mutex lock_;
+  ConditionVariable cond_;
+
+  // Buffers which aren't in use, and buffers holding blocks to return.
+  vector<Buffer*> free_;
+  deque<Buffer*> ready_;
+
+  // The indexes of the sub-iterators which may have more rows but aren't
+  // being scanned.
+  deque<size_t> pending_;
+
+  // The number of running or queued tasks.
+  int num_workers_;
+
+  // Set when the iterator is destroyed, to stop the tasks.
+  bool cancelled_;
+
+  // The first error returned by a sub-iterator.
+  Status status_;
+
+  // Statistics (keyed by projection column index) accumulated so far by any
+  // fully-consumed sub-iterators. The statistics of the sub-iterators being
+  // scanned aren't accessed, since they're concurrently modified.
+  vector<IteratorStats> finished_iter_stats_by_col_;
+};
+
+ParallelUnionIterator::ParallelUnionIterator(ParallelUnionIteratorOptions opts,
+                                             vector<IterWithBounds> iters)
+    : opts_(opts),
+      initted_(false),
+      iters_(std::move(iters)),
+      current_(nullptr),
+      current_offset_(0),
+      cond_(&lock_),
+      num_workers_(0),
+      cancelled_(false) {
+  CHECK_GT(iters_.size(), 0);
+  CHECK_GT(opts_.max_parallelism, 0);
+}
+
+ParallelUnionIterator::~ParallelUnionIterator() {
+  {
+    MutexLock l(lock_);
+    cancelled_ = true;
+  }
+  if (token_) {
+    token_->Shutdown();
+  }
+}
+
+Status ParallelUnionIterator::Init(ScanSpec *spec) {
+  CHECK(!initted_);
+
+  // Initialize the sub-iterators on the caller's thread, as UnionIterator does.
+  for (auto& i : iters_) {
+    ScanSpec *spec_copy = spec != nullptr ? scan_spec_copies_.Construct(*spec) : nullptr;
+    RETURN_NOT_OK(InitAndMaybeWrap(&i.iter, spec_copy));
+    i.encoded_bounds.reset();
+  }
+  if (spec != nullptr) {
+    spec->RemovePredicates();
+  }
+
+  schema_.reset(new Schema(iters_.front().iter->schema()));
+  finished_iter_stats_by_col_.resize(schema_->num_columns());
+#ifndef NDEBUG
+  for (const auto& i : iters_) {
+    if (i.iter->schema() != *schema_) {
+      return Status::InvalidArgument(
+          Substitute("Schemas do not match: $0 vs. $1",
+                     schema_->ToString(), i.iter->schema().ToString()));
+    }
+  }
+#endif
+
+  const size_t num_buffers = std::max(opts_.max_parallelism * opts_.blocks_per_thread, 2);
+  for (size_t i = 0; i < num_buffers; i++) {
+    buffers_.emplace_back(new Buffer(schema_.get(), opts_.block_rows));
+  }
+  token_ = opts_.pool->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+  initted_ = true;
+
+  MutexLock l(lock_);
+  for (auto& b : buffers_) {
+    free_.push_back(b.get());
+  }
+  for (size_t i = 0; i < iters_.size(); i++) {
+    pending_.push_back(i);
+  }
+  MaybeStartWorkersUnlocked();
+  return status_;
+}
+
+void ParallelUnionIterator::MaybeStartWorkersUnlocked() {
+  lock_.AssertAcquired();
+  while (num_workers_ < opts_.max_parallelism &&
+         !pending_.empty() && !free_.empty() &&
+         !cancelled_ && status_.ok()) {
+    Status s = token_->Submit([this]() { this->RunWorker(); });
+    if (PREDICT_FALSE(!s.ok())) {
+      status_ = s.CloneAndPrepend("unable to start scanning sub-iterator");
+      cond_.Broadcast();
+      return;
+    }
+    num_workers_++;
+  }
+}
+
+bool ParallelUnionIterator::TakeWorkUnlocked(size_t* iter_idx, Buffer** buf) {
+  lock_.AssertAcquired();
+  if (cancelled_ || !status_.ok() || pending_.empty() || free_.empty()) {
+    return false;
+  }
+  *iter_idx = pending_.front();
+  pending_.pop_front();
+  *buf = free_.back();
+  free_.pop_back();
+  return true;
+}
+
+void ParallelUnionIterator::RunWorker() {
+  size_t iter_idx;
+  Buffer* buf;
+  {
+    MutexLock l(lock_);
+    if (!TakeWorkUnlocked(&iter_idx, &buf)) {
+      num_workers_--;
+      cond_.Broadcast();
+      return;
+    }
+  }
+  while (true) {
+    RowwiseIterator* iter = iters_[iter_idx].iter.get();
+    Status s;
+    bool has_next = iter->HasNext();
+    bool read_block = false;
+    if (has_next) {
+      buf->mem.Reset();
+      s = iter->NextBlock(&buf->block);
+      read_block = s.ok() && buf->block.nrows() > 0;
+      has_next = s.ok() && iter->HasNext();
+    }
+
+    MutexLock l(lock_);
+    if (read_block) {
+      ready_.push_back(buf);
+    } else {
+      free_.push_back(buf);
+    }
+    if (PREDICT_FALSE(!s.ok())) {
+      if (status_.ok()) {
+        status_ = s;
+      }
+    } else if (has_next) {
+      // Put the sub-iterator first in line, so that this task keeps scanning
+      // it if there's a free buffer.
+      pending_.push_front(iter_idx);
+    } else {
+      AddIterStats(*iter, &finished_iter_stats_by_col_);
+    }
+    cond_.Broadcast();
+    if (!TakeWorkUnlocked(&iter_idx, &buf)) {
+      num_workers_--;
+      cond_.Broadcast();
+      return;
+    }
+  }
+}
+
+void ParallelUnionIterator::WaitForBlockUnlocked() const {
+  lock_.AssertAcquired();
+  // While the caller holds no buffer, tasks are running whenever there are
+  // sub-iterators left, since they only stop for lack of free buffers.
+  while (ready_.empty() && status_.ok() && num_workers_ > 0) {
+    cond_.Wait();
+  }
+}
+
+bool ParallelUnionIterator::HasNext() const {
+  CHECK(initted_);
+  if (current_) {
+    return true;
+  }
+  MutexLock l(lock_);
+  WaitForBlockUnlocked();
+  // On error, report that there's more so that NextBlock() returns it.
+  return !ready_.empty() || !status_.ok();
+}
+
+Status ParallelUnionIterator::NextBlock(RowBlock* dst) {
+  CHECK(initted_);
+  if (!current_) {
+    MutexLock l(lock_);
+    WaitForBlockUnlocked();
+    RETURN_NOT_OK(status_);
+    if (ready_.empty()) {
+      dst->Resize(0);
+      return Status::OK();
+    }
+    current_ = ready_.front();
+    ready_.pop_front();
+    current_offset_ = 0;
+  }
+
+  const RowBlock& src = current_->block;
+  const size_t nrows = std::min(dst->row_capacity(), src.nrows() - current_offset_);
+  dst->Resize(nrows);
+  RETURN_NOT_OK(src.CopyTo(dst, current_offset_, 0, nrows));
+  current_offset_ += nrows;
+  if (current_offset_ == src.nrows()) {
+    MutexLock l(lock_);
+    free_.push_back(current_);
+    current_ = nullptr;
+    MaybeStartWorkersUnlocked();
+  }
+  return Status::OK();
+}
+
+string ParallelUnionIterator::ToString() const {
+  return Substitute("ParallelUnion($0)", JoinMapped(iters_, [](const IterWithBounds& i) {
+      return i.iter->ToString();
+    }, ","));
+}
+
+void ParallelUnionIterator::GetIteratorStats(vector<IteratorStats>* stats) const {
+  CHECK(initted_);
+  MutexLock l(lock_);
+  *stats = finished_iter_stats_by_col_;
+}
+
+unique_ptr<RowwiseIterator> NewParallelUnionIterator(ParallelUnionIteratorOptions opts,
+                                                     vector<IterWithBounds> iters) {
+  return unique_ptr<RowwiseIterator>(new ParallelUnionIterator(opts, std::move(iters)));
+}
+
 ////////////////////////////////////////////////////////////
 // MaterializingIterator
 ////////////////////////////////////////////////////////////
@@ -1304,6 +1626,7 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
       // evaluation.
       ctx.SetDecoderEvalNotSupported();
     }
+    ctx.SetSkipDeselectedRows();
 
     // Determine the number of rows filtered out by this predicate, if disableable.
     //
@@ -1343,6 +1666,7 @@ Status MaterializingIterator::MaterializeBlock(RowBlock *dst) {
                                      nullptr,
                                      &dst_col,
                                      dst->selection_vector());
+    ctx.SetSkipDeselectedRows();
     RETURN_NOT_OK(iter_->MaterializeColumn(&ctx));
   }
 
@@ -16,6 +16,7 @@
 // under the License.
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,7 @@ namespace kudu {
 
 class ColumnPredicate;
 class ScanSpec;
+class ThreadPool;
 
 // Encapsulates a rowwise-iterator along with the (encoded) lower and upper
 // bounds for the rowset that the iterator belongs to.
@@ -62,6 +64,38 @@ std::unique_ptr<RowwiseIterator> NewMergeIterator(
 // The iterators must have matching schemas and should not yet be initialized.
 std::unique_ptr<RowwiseIterator> NewUnionIterator(std::vector<IterWithBounds> iters);
 
+// Options struct for the ParallelUnionIterator.
+struct ParallelUnionIteratorOptions {
+  ParallelUnionIteratorOptions(ThreadPool* pool, int max_parallelism)
+      : pool(pool),
+        max_parallelism(max_parallelism) {}
+
+  // The pool on which the sub-iterators are scanned. Must outlive the
+  // iterator.
+  ThreadPool* const pool;
+
+  // The maximum number of sub-iterators scanned concurrently.
+  const int max_parallelism;
+
+  // The maximum number of rows in each block read ahead from a sub-iterator.
+  size_t block_rows = 128;
+
+  // The number of blocks which may be read ahead per unit of parallelism.
+  // Scanning stops once all of them are waiting to be returned.
+  int blocks_per_thread = 2;
+};
+
+// Constructs a ParallelUnionIterator of the given iterators: like a
+// UnionIterator, but the sub-iterators are scanned on a thread pool, reading
+// blocks of rows ahead of the calls to NextBlock().
+//
+// The iterators must have matching schemas and should not yet be initialized.
+// They must be safe to scan concurrently with one another, and from threads
+// other than the one which created them.
+std::unique_ptr<RowwiseIterator> NewParallelUnionIterator(
+    ParallelUnionIteratorOptions opts,
+    std::vector<IterWithBounds> iters);
+
 // Constructs a MaterializingIterator of the given ColumnwiseIterator.
 std::unique_ptr<RowwiseIterator> NewMaterializingIterator(
     std::unique_ptr<ColumnwiseIterator> iter);
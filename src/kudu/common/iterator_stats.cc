@@ -30,18 +30,21 @@ IteratorStats::IteratorStats()
     : cells_read(0),
       bytes_read(0),
       blocks_read(0),
+      cells_skipped(0),
       predicates_disabled(0) {
 }
 
 string IteratorStats::ToString() const {
-  return Substitute("cells_read=$0 bytes_read=$1 blocks_read=$2 predicates_disabled=$3",
-                    cells_read, bytes_read, blocks_read, predicates_disabled);
+  return Substitute("cells_read=$0 bytes_read=$1 blocks_read=$2 cells_skipped=$3 "
+                    "predicates_disabled=$4",
+                    cells_read, bytes_read, blocks_read, cells_skipped, predicates_disabled);
 }
 
 IteratorStats& IteratorStats::operator+=(const IteratorStats& other) {
   cells_read += other.cells_read;
   bytes_read += other.bytes_read;
   blocks_read += other.blocks_read;
+  cells_skipped += other.cells_skipped;
   predicates_disabled += other.predicates_disabled;
   DCheckNonNegative();
   return *this;
@@ -51,6 +54,7 @@ IteratorStats& IteratorStats::operator-=(const IteratorStats& other) {
   cells_read -= other.cells_read;
   bytes_read -= other.bytes_read;
   blocks_read -= other.blocks_read;
+  cells_skipped -= other.cells_skipped;
   predicates_disabled -= other.predicates_disabled;
   DCheckNonNegative();
   return *this;
@@ -72,6 +76,7 @@ void IteratorStats::DCheckNonNegative() const {
   DCHECK_GE(cells_read, 0);
   DCHECK_GE(bytes_read, 0);
   DCHECK_GE(blocks_read, 0);
+  DCHECK_GE(cells_skipped, 0);
   DCHECK_GE(predicates_disabled, 0);
 }
 } // namespace kudu
@@ -37,6 +37,10 @@ struct IteratorStats {
   // The number of CFile data blocks read from disk (or cache) by the iterator.
   int64_t blocks_read;
 
+  // The number of cells which were read from disk but were left undecoded
+  // because their rows had already been filtered out of the scan results.
+  int64_t cells_skipped;
+
   // The number of column predicates disabled because they were determined to be
   // ineffective.
   // There is only one predicate per column (if any) so for a per column stat this would be 0 or 1.
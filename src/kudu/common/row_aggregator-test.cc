@@ -0,0 +1,281 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/row_aggregator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::optional;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+
+typedef AggregationSpecPB::AggregatePB AggregatePB;
+
+class RowAggregatorTest : public KuduTest {
+ public:
+  RowAggregatorTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchemaBuilder().name("g").type(STRING).nullable(true),
+                  ColumnSchemaBuilder().name("v").type(INT32).nullable(true) },
+                1) {
+  }
+
+ protected:
+  struct TestRow {
+    int32_t key;
+    optional<string> g;
+    optional<int32_t> v;
+  };
+
+  static AggregationSpecPB GroupedSpec() {
+    AggregationSpecPB spec;
+    spec.add_group_by_columns("g");
+    AddAggregate(AggregatePB::COUNT, nullptr, &spec);
+    AddAggregate(AggregatePB::COUNT, "v", &spec);
+    AddAggregate(AggregatePB::SUM, "v", &spec);
+    AddAggregate(AggregatePB::MIN, "v", &spec);
+    AddAggregate(AggregatePB::MAX, "v", &spec);
+    return spec;
+  }
+
+  static void AddAggregate(AggregatePB::Function function, const char* column,
+                           AggregationSpecPB* spec) {
+    AggregatePB* agg = spec->add_aggregates();
+    agg->set_function(function);
+    if (column) {
+      agg->set_column(column);
+    }
+  }
+
+  // Fill 'block' with 'rows', selecting all but those with a negative key.
+  void FillBlock(const vector<TestRow>& rows, RowBlock* block) {
+    block->Resize(rows.size());
+    block->selection_vector()->SetAllTrue();
+    ColumnBlock keys = block->column_block(0);
+    ColumnBlock groups = block->column_block(1);
+    ColumnBlock values = block->column_block(2);
+    for (size_t i = 0; i < rows.size(); i++) {
+      const TestRow& row = rows[i];
+      keys.SetCellValue(i, &row.key);
+      if (row.key < 0) {
+        block->selection_vector()->SetRowUnselected(i);
+      }
+      groups.SetCellIsNull(i, !row.g);
+      if (row.g) {
+        Slice s(*row.g);
+        groups.SetCellValue(i, &s);
+      }
+      values.SetCellIsNull(i, !row.v);
+      if (row.v) {
+        values.SetCellValue(i, &*row.v);
+      }
+    }
+  }
+
+  // Return the stringified results of 'aggregator', in sorted order.
+  static vector<string> Results(RowAggregator* aggregator) {
+    const Schema& schema = aggregator->result_schema();
+    RowBlockMemory mem;
+    // Use a small block to return the results in several batches.
+    RowBlock block(&schema, 2, &mem);
+    vector<string> results;
+    while (true) {
+      CHECK_OK(aggregator->NextResults(&block));
+      if (block.nrows() == 0) {
+        break;
+      }
+      for (size_t i = 0; i < block.nrows(); i++) {
+        results.emplace_back(schema.DebugRow(block.row(i)));
+      }
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+  }
+
+  const Schema schema_;
+};
+
+TEST_F(RowAggregatorTest, TestGroupedAggregates) {
+  const vector<TestRow> rows = {
+    { 1, string("a"), 5 },
+    { 2, string("b"), 1 },
+    { 3, string("a"), std::nullopt },
+    { 4, std::nullopt, 7 },
+    { 5, string("a"), -3 },
+    { -6, string("b"), 100 },  // Not selected.
+    { 7, string("c"), std::nullopt },
+  };
+  RowBlockMemory mem;
+  RowBlock block(&schema_, rows.size(), &mem);
+  FillBlock(rows, &block);
+
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(GroupedSpec(), schema_, &aggregator));
+  ASSERT_EQ("(\n"
+            "    g STRING NULLABLE,\n"
+            "    count(*) INT64 NOT NULL,\n"
+            "    count(v) INT64 NOT NULL,\n"
+            "    sum(v) INT64 NULLABLE,\n"
+            "    min(v) INT32 NULLABLE,\n"
+            "    max(v) INT32 NULLABLE,\n"
+            "    PRIMARY KEY ()\n"
+            ")",
+            aggregator->result_schema().ToString(Schema::BASE_INFO));
+  ASSERT_OK(aggregator->AddRows(block));
+  ASSERT_EQ(4, aggregator->num_result_rows());
+
+  const vector<string> expected = {
+    R"((string g="a", int64 count(*)=3, int64 count(v)=2, int64 sum(v)=2, )"
+    R"(int32 min(v)=-3, int32 max(v)=5))",
+    R"((string g="b", int64 count(*)=1, int64 count(v)=1, int64 sum(v)=1, )"
+    R"(int32 min(v)=1, int32 max(v)=1))",
+    R"((string g="c", int64 count(*)=1, int64 count(v)=0, int64 sum(v)=NULL, )"
+    R"(int32 min(v)=NULL, int32 max(v)=NULL))",
+    R"((string g=NULL, int64 count(*)=1, int64 count(v)=1, int64 sum(v)=7, )"
+    R"(int32 min(v)=7, int32 max(v)=7))",
+  };
+  ASSERT_EQ(expected, Results(aggregator.get()));
+
+  // Returning the results resets the aggregator.
+  ASSERT_EQ(0, aggregator->num_result_rows());
+  ASSERT_OK(aggregator->AddRows(block));
+  ASSERT_EQ(expected, Results(aggregator.get()));
+
+  // Aggregating parts of the rows separately and merging the partial results
+  // gives the same results.
+  unique_ptr<RowAggregator> merger;
+  ASSERT_OK(RowAggregator::CreateMerger(GroupedSpec(), aggregator->result_schema(), &merger));
+  for (size_t i = 0; i < rows.size(); i++) {
+    RowBlock part(&schema_, 1, &mem);
+    FillBlock({ rows[i] }, &part);
+    ASSERT_OK(aggregator->AddRows(part));
+
+    const Schema& partial_schema = aggregator->result_schema();
+    RowBlock partial(&partial_schema, 10, &mem);
+    ASSERT_OK(aggregator->NextResults(&partial));
+    ASSERT_OK(merger->AddRows(partial));
+    ASSERT_OK(aggregator->NextResults(&partial));
+    ASSERT_EQ(0, partial.nrows());
+  }
+  ASSERT_EQ(expected, Results(merger.get()));
+}
+
+TEST_F(RowAggregatorTest, TestGlobalAggregates) {
+  AggregationSpecPB spec;
+  AddAggregate(AggregatePB::COUNT, nullptr, &spec);
+  AddAggregate(AggregatePB::SUM, "v", &spec);
+
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(spec, schema_, &aggregator));
+  unique_ptr<RowAggregator> merger;
+  ASSERT_OK(RowAggregator::CreateMerger(spec, aggregator->result_schema(), &merger));
+
+  // Without any rows, there are no partial results, but merging them still
+  // gives a result.
+  ASSERT_TRUE(Results(aggregator.get()).empty());
+  ASSERT_EQ(vector<string>{ "(int64 count(*)=0, int64 sum(v)=NULL)" }, Results(merger.get()));
+
+  RowBlockMemory mem;
+  RowBlock block(&schema_, 3, &mem);
+  FillBlock({ { 1, std::nullopt, 2 }, { 2, std::nullopt, 3 }, { 3, std::nullopt, 4 } }, &block);
+  ASSERT_OK(aggregator->AddRows(block));
+  ASSERT_EQ(vector<string>{ "(int64 count(*)=3, int64 sum(v)=9)" }, Results(aggregator.get()));
+}
+
+TEST_F(RowAggregatorTest, TestSumOverflow) {
+  AggregationSpecPB spec;
+  AddAggregate(AggregatePB::SUM, "v", &spec);
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(spec, schema_, &aggregator));
+  unique_ptr<RowAggregator> merger;
+  ASSERT_OK(RowAggregator::CreateMerger(spec, aggregator->result_schema(), &merger));
+
+  // Merging two partial sums close to the maximum overflows INT64.
+  const Schema& partial_schema = aggregator->result_schema();
+  RowBlockMemory mem;
+  RowBlock partial(&partial_schema, 2, &mem);
+  partial.selection_vector()->SetAllTrue();
+  ColumnBlock sums = partial.column_block(0);
+  const int64_t sum = std::numeric_limits<int64_t>::max() - 1;
+  for (size_t i = 0; i < partial.nrows(); i++) {
+    sums.SetCellIsNull(i, false);
+    sums.SetCellValue(i, &sum);
+  }
+  Status s = merger->AddRows(partial);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "sum(v) overflows");
+}
+
+TEST_F(RowAggregatorTest, TestInvalidSpecs) {
+  unique_ptr<RowAggregator> aggregator;
+  {
+    AggregationSpecPB spec;
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(AggregatePB::SUM, nullptr, &spec);
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "sum(*) requires a column");
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(AggregatePB::SUM, "g", &spec);
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "sum(g) is not supported for type string");
+  }
+  {
+    AggregationSpecPB spec;
+    spec.add_group_by_columns("missing");
+    AddAggregate(AggregatePB::COUNT, nullptr, &spec);
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  }
+  {
+    AggregationSpecPB spec;
+    AddAggregate(AggregatePB::MAX, "v", &spec);
+    AddAggregate(AggregatePB::MAX, "v", &spec);
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+}
+
+} // namespace kudu
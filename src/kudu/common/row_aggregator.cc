@@ -0,0 +1,394 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/row_aggregator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/ascii_ctype.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/safe_math.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+
+typedef AggregationSpecPB::AggregatePB AggregatePB;
+
+namespace {
+
+// Returns the cell at 'row_idx' of 'col', or nullptr if it is null.
+const uint8_t* GetCell(const ColumnBlock& col, size_t row_idx) {
+  return col.is_nullable() ? col.nullable_cell_ptr(row_idx) : col.cell_ptr(row_idx);
+}
+
+// Returns whether values of 'type' can be summed, and if so, sets
+// '*sum_type' to the type of their sum.
+bool GetSumType(DataType type, DataType* sum_type) {
+  switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64:
+      *sum_type = INT64;
+      return true;
+    case FLOAT:
+    case DOUBLE:
+      *sum_type = DOUBLE;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Adds the value of type 'type' at 'cell' to the sum at 'sum'. Returns
+// false if an integer sum overflows, in which case the sum isn't updated.
+bool AddToSum(DataType type, const uint8_t* cell, uint8_t* sum) {
+  int64_t i;
+  switch (type) {
+    case INT8: i = UnalignedLoad<int8_t>(cell); break;
+    case INT16: i = UnalignedLoad<int16_t>(cell); break;
+    case INT32: i = UnalignedLoad<int32_t>(cell); break;
+    case INT64: i = UnalignedLoad<int64_t>(cell); break;
+    case FLOAT:
+      UnalignedStore<double>(sum, UnalignedLoad<double>(sum) + UnalignedLoad<float>(cell));
+      return true;
+    case DOUBLE:
+      UnalignedStore<double>(sum, UnalignedLoad<double>(sum) + UnalignedLoad<double>(cell));
+      return true;
+    default:
+      LOG(FATAL) << "unsupported type for SUM: " << DataType_Name(type);
+  }
+  bool overflowed;
+  const int64_t result = AddWithOverflowCheck(UnalignedLoad<int64_t>(sum), i, &overflowed);
+  if (PREDICT_FALSE(overflowed)) {
+    return false;
+  }
+  UnalignedStore<int64_t>(sum, result);
+  return true;
+}
+
+string FunctionName(AggregatePB::Function function) {
+  string name = AggregatePB::Function_Name(function);
+  for (auto& c : name) {
+    c = ascii_tolower(c);
+  }
+  return name;
+}
+
+} // anonymous namespace
+
+RowAggregator::RowAggregator(bool merge,
+                             Schema result_schema,
+                             vector<int> group_by_idxs,
+                             vector<Aggregate> aggregates)
+    : merge_(merge),
+      result_schema_(std::move(result_schema)),
+      row_size_(ContiguousRowHelper::row_size(result_schema_)),
+      group_by_idxs_(std::move(group_by_idxs)),
+      aggregates_(std::move(aggregates)),
+      arena_(1024),
+      next_result_(0),
+      returning_results_(false) {
+}
+
+RowAggregator::~RowAggregator() = default;
+
+Status RowAggregator::Create(const AggregationSpecPB& spec,
+                             const Schema& input_schema,
+                             unique_ptr<RowAggregator>* aggregator) {
+  return Init(spec, input_schema, /*merge=*/false, aggregator);
+}
+
+Status RowAggregator::CreateMerger(const AggregationSpecPB& spec,
+                                   const Schema& partial_schema,
+                                   unique_ptr<RowAggregator>* aggregator) {
+  return Init(spec, partial_schema, /*merge=*/true, aggregator);
+}
+
+Status RowAggregator::Init(const AggregationSpecPB& spec,
+                           const Schema& input_schema,
+                           bool merge,
+                           unique_ptr<RowAggregator>* aggregator) {
+  if (spec.aggregates_size() == 0) {
+    return Status::InvalidArgument("aggregation must compute at least one aggregate");
+  }
+
+  vector<ColumnSchema> result_cols;
+  vector<int> group_by_idxs;
+  for (const auto& col_name : spec.group_by_columns()) {
+    int idx;
+    RETURN_NOT_OK_PREPEND(input_schema.FindColumn(col_name, &idx),
+                          "invalid grouping column");
+    const ColumnSchema& col = input_schema.column(idx);
+    if (col.type_info()->is_array()) {
+      return Status::InvalidArgument(Substitute(
+          "may not group by array column '$0'", col_name));
+    }
+    group_by_idxs.push_back(idx);
+    result_cols.push_back(col);
+  }
+
+  vector<Aggregate> aggregates;
+  for (const auto& agg_pb : spec.aggregates()) {
+    Aggregate agg;
+    agg.function = agg_pb.function();
+    agg.result_idx = result_cols.size();
+    const string name = Substitute("$0($1)", FunctionName(agg.function),
+                                   agg_pb.has_column() ? agg_pb.column() : "*");
+    if (agg.function != AggregatePB::COUNT && !agg_pb.has_column()) {
+      return Status::InvalidArgument(Substitute("$0 requires a column", name));
+    }
+    // When merging, the aggregates are computed over the partial values.
+    int input_idx = -1;
+    if (merge) {
+      RETURN_NOT_OK_PREPEND(input_schema.FindColumn(name, &input_idx),
+                            "invalid partial aggregate column");
+    } else if (agg_pb.has_column()) {
+      RETURN_NOT_OK_PREPEND(input_schema.FindColumn(agg_pb.column(), &input_idx),
+                            "invalid aggregated column");
+    }
+    agg.input_idx = input_idx;
+
+    ColumnSchemaBuilder result_col;
+    result_col.name(name).nullable(true);
+    const ColumnSchema* input_col = input_idx >= 0 ? &input_schema.column(input_idx) : nullptr;
+    if (input_col && input_col->type_info()->is_array() && agg.function != AggregatePB::COUNT) {
+      return Status::InvalidArgument(Substitute("$0 is not supported for arrays", name));
+    }
+    switch (agg.function) {
+      case AggregatePB::COUNT:
+        result_col.type(INT64).nullable(false);
+        break;
+      case AggregatePB::SUM: {
+        DataType sum_type;
+        if (!GetSumType(input_col->type_info()->type(), &sum_type)) {
+          return Status::InvalidArgument(Substitute(
+              "$0 is not supported for type $1", name, input_col->type_info()->name()));
+        }
+        result_col.type(sum_type);
+        break;
+      }
+      case AggregatePB::MIN:
+      case AggregatePB::MAX:
+        result_col.type(input_col->type_info()->type())
+                  .type_attributes(input_col->type_attributes());
+        break;
+      default:
+        return Status::InvalidArgument(Substitute(
+            "unknown aggregate function: $0", agg_pb.function()));
+    }
+    result_cols.emplace_back(result_col.Build());
+    aggregates.emplace_back(agg);
+  }
+
+  Schema result_schema;
+  RETURN_NOT_OK_PREPEND(result_schema.Reset(std::move(result_cols), 0),
+                        "invalid aggregation");
+  aggregator->reset(new RowAggregator(merge, std::move(result_schema),
+                                      std::move(group_by_idxs), std::move(aggregates)));
+  return Status::OK();
+}
+
+Status RowAggregator::AddRows(const RowBlock& block) {
+  DCHECK(!returning_results_);
+  const SelectionVector* sel = block.selection_vector();
+  for (size_t i = 0; i < block.nrows(); i++) {
+    if (!sel->IsRowSelected(i)) {
+      continue;
+    }
+    RETURN_NOT_OK(UpdateGroup(block, i, FindOrCreateGroup(block, i)));
+  }
+  return Status::OK();
+}
+
+uint8_t* RowAggregator::FindOrCreateGroup(const RowBlock& block, size_t row_idx) {
+  // Encode the grouping values as a null marker followed by the value, with
+  // variable-length values prefixed by their length.
+  key_buf_.clear();
+  for (int idx : group_by_idxs_) {
+    const ColumnBlock col = block.column_block(idx);
+    const uint8_t* cell = GetCell(col, row_idx);
+    key_buf_.push_back(cell == nullptr ? 0 : 1);
+    if (cell == nullptr) {
+      continue;
+    }
+    if (col.type_info()->physical_type() == BINARY) {
+      const Slice* s = reinterpret_cast<const Slice*>(cell);
+      PutVarint32(&key_buf_, s->size());
+      key_buf_.append(s->data(), s->size());
+    } else {
+      key_buf_.append(cell, col.type_info()->size());
+    }
+  }
+
+  auto it = groups_.find(Slice(key_buf_));
+  if (PREDICT_TRUE(it != groups_.end())) {
+    return it->second;
+  }
+
+  // Copy the grouping values into a new group.
+  uint8_t* group = NewGroup();
+  ContiguousRow row(&result_schema_, group);
+  for (size_t i = 0; i < group_by_idxs_.size(); i++) {
+    const ColumnBlock col = block.column_block(group_by_idxs_[i]);
+    const uint8_t* cell = GetCell(col, row_idx);
+    if (cell == nullptr) {
+      row.set_null(i, true);
+      continue;
+    }
+    if (col.type_info()->physical_type() == BINARY) {
+      Slice* dst = reinterpret_cast<Slice*>(row.mutable_cell_ptr(i));
+      CHECK(arena_.RelocateSlice(*reinterpret_cast<const Slice*>(cell), dst));
+    } else {
+      memcpy(row.mutable_cell_ptr(i), cell, col.type_info()->size());
+    }
+  }
+  Slice key;
+  CHECK(arena_.RelocateSlice(Slice(key_buf_), &key));
+  groups_.emplace(key, group);
+  return group;
+}
+
+uint8_t* RowAggregator::NewGroup() {
+  uint8_t* group = static_cast<uint8_t*>(arena_.AllocateBytesAligned(row_size_, 8));
+  CHECK(group);
+  memset(group, 0, row_size_);
+  ContiguousRow row(&result_schema_, group);
+  for (const auto& agg : aggregates_) {
+    if (agg.function != AggregatePB::COUNT) {
+      row.set_null(agg.result_idx, true);
+    }
+  }
+  return group;
+}
+
+Status RowAggregator::UpdateGroup(const RowBlock& block, size_t row_idx, uint8_t* group) {
+  ContiguousRow row(&result_schema_, group);
+  for (const auto& agg : aggregates_) {
+    uint8_t* dst = row.mutable_cell_ptr(agg.result_idx);
+    if (agg.input_idx < 0) {
+      // COUNT(*).
+      UnalignedStore<int64_t>(dst, UnalignedLoad<int64_t>(dst) + 1);
+      continue;
+    }
+    const ColumnBlock col = block.column_block(agg.input_idx);
+    const uint8_t* cell = GetCell(col, row_idx);
+    if (cell == nullptr) {
+      continue;
+    }
+    switch (agg.function) {
+      case AggregatePB::COUNT:
+        UnalignedStore<int64_t>(dst, UnalignedLoad<int64_t>(dst) +
+                                     (merge_ ? UnalignedLoad<int64_t>(cell) : 1));
+        break;
+      case AggregatePB::SUM:
+        if (PREDICT_FALSE(!AddToSum(col.type_info()->type(), cell, dst))) {
+          return Status::InvalidArgument(Substitute(
+              "$0 overflows the range of its type",
+              result_schema_.column(agg.result_idx).name()));
+        }
+        row.set_null(agg.result_idx, false);
+        break;
+      case AggregatePB::MIN:
+      case AggregatePB::MAX: {
+        if (!row.is_null(agg.result_idx)) {
+          const int cmp = col.type_info()->Compare(cell, dst);
+          if (agg.function == AggregatePB::MIN ? cmp >= 0 : cmp <= 0) {
+            break;
+          }
+        }
+        row.set_null(agg.result_idx, false);
+        if (col.type_info()->physical_type() == BINARY) {
+          CHECK(arena_.RelocateSlice(*reinterpret_cast<const Slice*>(cell),
+                                     reinterpret_cast<Slice*>(dst)));
+        } else {
+          memcpy(dst, cell, col.type_info()->size());
+        }
+        break;
+      }
+      default:
+        LOG(FATAL) << "unknown aggregate function";
+    }
+  }
+  return Status::OK();
+}
+
+size_t RowAggregator::num_result_rows() const {
+  if (merge_ && group_by_idxs_.empty() && groups_.empty()) {
+    return 1;
+  }
+  return groups_.size();
+}
+
+size_t RowAggregator::memory_footprint() const {
+  return arena_.memory_footprint() +
+      groups_.size() * (sizeof(Slice) + sizeof(uint8_t*) + sizeof(void*));
+}
+
+Status RowAggregator::NextResults(RowBlock* block) {
+  DCHECK(*block->schema() == result_schema_);
+  if (!returning_results_) {
+    returning_results_ = true;
+    results_.reserve(num_result_rows());
+    for (const auto& [key, group] : groups_) {
+      results_.push_back(group);
+    }
+    if (results_.size() < num_result_rows()) {
+      results_.push_back(NewGroup());
+    }
+  }
+
+  const size_t nrows = std::min(block->row_capacity(), results_.size() - next_result_);
+  block->Resize(nrows);
+  if (nrows == 0) {
+    Reset();
+    return Status::OK();
+  }
+  block->selection_vector()->SetAllTrue();
+  for (size_t i = 0; i < nrows; i++) {
+    const ConstContiguousRow src(&result_schema_, results_[next_result_++]);
+    RowBlockRow dst = block->row(i);
+    RETURN_NOT_OK(CopyRow(src, &dst, block->arena()));
+  }
+  return Status::OK();
+}
+
+void RowAggregator::Reset() {
+  groups_.clear();
+  results_.clear();
+  next_result_ = 0;
+  returning_results_ = false;
+  arena_.Reset();
+}
+
+} // namespace kudu
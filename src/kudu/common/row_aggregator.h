@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/hash/string_hash.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class RowBlock;
+
+// Computes the aggregates described by an AggregationSpecPB over blocks of
+// rows, grouping the rows by the values of the spec's grouping columns.
+//
+// Each group is kept as a row of the result schema allocated from an arena:
+// the values of the grouping columns, followed by the running value of each
+// aggregate. Groups are looked up by hashing their grouping values.
+//
+// The aggregates are decomposable, so rows can be aggregated in several
+// places and the partial results merged: an aggregator created with
+// CreateMerger() takes rows of the result schema of one created with Create()
+// for the same spec. For example, each tablet server aggregates the rows it
+// scans, and the client merges the per-tablet results.
+//
+// This class is not thread-safe.
+class RowAggregator {
+ public:
+  // Create an aggregator for 'spec' over rows of 'input_schema'.
+  //
+  // Returns InvalidArgument if the spec refers to columns not in
+  // 'input_schema', applies a function to a column of a type it doesn't
+  // support, or computes the same aggregate more than once.
+  static Status Create(const AggregationSpecPB& spec,
+                       const Schema& input_schema,
+                       std::unique_ptr<RowAggregator>* aggregator);
+
+  // Create an aggregator merging partial results, i.e. rows of the result
+  // schema of an aggregator created by Create() for the same spec and input.
+  static Status CreateMerger(const AggregationSpecPB& spec,
+                             const Schema& partial_schema,
+                             std::unique_ptr<RowAggregator>* aggregator);
+
+  ~RowAggregator();
+
+  // The schema of the result rows: the grouping columns, followed by one
+  // column per aggregate, in the order of the spec.
+  const Schema& result_schema() const { return result_schema_; }
+
+  // Add the selected rows of 'block', whose schema must be the input schema
+  // of the aggregator, to the groups.
+  //
+  // Returns InvalidArgument if an integer sum overflows INT64, after which
+  // the aggregator must not be used any more.
+  Status AddRows(const RowBlock& block);
+
+  // The number of result rows for the rows added so far.
+  //
+  // When merging the results of an aggregation without grouping columns,
+  // there is always a result row, even if no rows were added.
+  size_t num_result_rows() const;
+
+  // The approximate amount of memory used by the groups.
+  size_t memory_footprint() const;
+
+  // Copy the next result rows into 'block', which must use the result
+  // schema, up to the block's capacity. Successive calls return all the
+  // result rows, followed by an empty block, at which point the aggregator
+  // is reset and can be reused for more rows. No rows may be added while
+  // the results are being returned.
+  //
+  // Variable-length data is copied into the block's arena.
+  Status NextResults(RowBlock* block);
+
+ private:
+  struct Aggregate {
+    AggregationSpecPB::AggregatePB::Function function;
+    // The index of the aggregated column in the input schema, or -1 to count
+    // the rows themselves.
+    int input_idx;
+    // The index of the aggregate in the result schema.
+    int result_idx;
+  };
+
+  struct SliceHash {
+    size_t operator()(const Slice& s) const {
+      return HashStringThoroughly(reinterpret_cast<const char*>(s.data()), s.size());
+    }
+  };
+
+  RowAggregator(bool merge, Schema result_schema,
+                std::vector<int> group_by_idxs, std::vector<Aggregate> aggregates);
+
+  static Status Init(const AggregationSpecPB& spec,
+                     const Schema& input_schema,
+                     bool merge,
+                     std::unique_ptr<RowAggregator>* aggregator);
+
+  // Return the state of the group of row 'row_idx' of 'block', creating it
+  // if needed.
+  uint8_t* FindOrCreateGroup(const RowBlock& block, size_t row_idx);
+
+  // Return a newly allocated group with null aggregates and zero counts.
+  uint8_t* NewGroup();
+
+  // Update the aggregates of 'group' with row 'row_idx' of 'block'.
+  Status UpdateGroup(const RowBlock& block, size_t row_idx, uint8_t* group);
+
+  // Discard all the groups.
+  void Reset();
+
+  // Whether the input rows are partial results to merge.
+  const bool merge_;
+  const Schema result_schema_;
+  const size_t row_size_;
+
+  // The indexes of the grouping columns in the input schema.
+  const std::vector<int> group_by_idxs_;
+  const std::vector<Aggregate> aggregates_;
+
+  // Maps the encoded grouping values of each group to its state. The keys
+  // and the states are allocated from 'arena_'.
+  std::unordered_map<Slice, uint8_t*, SliceHash> groups_;
+  Arena arena_;
+
+  // A buffer for encoding the grouping values of a row.
+  faststring key_buf_;
+
+  // The groups to return from NextResults(), once it's been called, and the
+  // index of the next one to return.
+  std::vector<const uint8_t*> results_;
+  size_t next_result_;
+  bool returning_results_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowAggregator);
+};
+
+} // namespace kudu
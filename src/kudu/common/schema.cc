@@ -110,10 +110,11 @@ string ColumnTypeAttributes::ToStringForType(DataType type) const {
 string ColumnStorageAttributes::ToString() const {
   const string cfile_block_size_str =
       cfile_block_size == 0 ? "" : Substitute(" $0", cfile_block_size);
-  return Substitute("$0 $1$2",
+  return Substitute("$0 $1$2$3",
                     EncodingType_Name(encoding),
                     CompressionType_Name(compression),
-                    cfile_block_size_str);
+                    cfile_block_size_str,
+                    bloom_filter ? " BLOOM_FILTER" : "");
 }
 
 Status ColumnSchema::ApplyDelta(const ColumnSchemaDelta& col_delta) {
@@ -150,6 +151,9 @@ Status ColumnSchema::ApplyDelta(const ColumnSchemaDelta& col_delta) {
   if (col_delta.cfile_block_size) {
     storage_attributes_.cfile_block_size = *col_delta.cfile_block_size;
   }
+  if (col_delta.bloom_filter) {
+    storage_attributes_.bloom_filter = *col_delta.bloom_filter;
+  }
   if (col_delta.new_comment) {
     comment_ = col_delta.new_comment.value();
   }
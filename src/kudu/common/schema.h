@@ -145,7 +145,8 @@ struct ColumnStorageAttributes {
   ColumnStorageAttributes()
       : encoding(AUTO_ENCODING),
         compression(DEFAULT_COMPRESSION),
-        cfile_block_size(0) {
+        cfile_block_size(0),
+        bloom_filter(false) {
   }
 
   ColumnStorageAttributes(EncodingType enc,
@@ -153,7 +154,8 @@ struct ColumnStorageAttributes {
                           int32_t block_size = 0)
       : encoding(enc),
         compression(cmp),
-        cfile_block_size(block_size) {
+        cfile_block_size(block_size),
+        bloom_filter(false) {
   }
 
   std::string ToString() const;
@@ -164,6 +166,11 @@ struct ColumnStorageAttributes {
   // The preferred block size for cfile blocks. If 0, uses the
   // server-wide default.
   int32_t cfile_block_size;
+
+  // Whether to write a bloom filter of the column's values, allowing scans
+  // with equality or IN-list predicates on the column to skip rowsets which
+  // don't contain any of the values.
+  bool bloom_filter;
 };
 
 // A struct representing changes to a ColumnSchema.
@@ -194,6 +201,7 @@ struct ColumnSchemaDelta {
   std::optional<EncodingType> encoding;
   std::optional<CompressionType> compression;
   std::optional<int32_t> cfile_block_size;
+  std::optional<bool> bloom_filter;
 
   std::optional<std::string> new_comment;
 
@@ -0,0 +1,247 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/top_n_selector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/random.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::optional;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+
+class TopNSelectorTest : public KuduTest {
+ public:
+  TopNSelectorTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchemaBuilder().name("v").type(INT32).nullable(true),
+                  ColumnSchema("s", STRING) },
+                1) {
+  }
+
+ protected:
+  struct TestRow {
+    int32_t key;
+    optional<int32_t> v;
+    string s;
+
+    string ToString() const {
+      return Substitute(R"((int32 key=$0, int32 v=$1, string s="$2"))",
+                        key, v ? std::to_string(*v) : "NULL", s);
+    }
+  };
+
+  static void AddSortKey(const char* column, bool descending, bool nulls_first,
+                         TopNSpecPB* spec) {
+    TopNSpecPB::SortKeyPB* key = spec->add_order_by();
+    key->set_column(column);
+    key->set_descending(descending);
+    key->set_nulls_first(nulls_first);
+  }
+
+  // Add 'rows' to 'selector' in blocks of up to 100 rows, selecting all
+  // but those with a negative key.
+  void AddRows(const vector<TestRow>& rows, TopNSelector* selector) {
+    RowBlockMemory mem;
+    RowBlock block(&schema_, 100, &mem);
+    for (size_t start = 0; start < rows.size(); start += block.row_capacity()) {
+      const size_t nrows = std::min(block.row_capacity(), rows.size() - start);
+      block.Resize(nrows);
+      block.selection_vector()->SetAllTrue();
+      ColumnBlock keys = block.column_block(0);
+      ColumnBlock values = block.column_block(1);
+      ColumnBlock strings = block.column_block(2);
+      for (size_t i = 0; i < nrows; i++) {
+        const TestRow& row = rows[start + i];
+        keys.SetCellValue(i, &row.key);
+        if (row.key < 0) {
+          block.selection_vector()->SetRowUnselected(i);
+        }
+        values.SetCellIsNull(i, !row.v);
+        if (row.v) {
+          values.SetCellValue(i, &*row.v);
+        }
+        Slice s(row.s);
+        strings.SetCellValue(i, &s);
+      }
+      selector->AddRows(block);
+      mem.Reset();
+    }
+  }
+
+  // Return the stringified results of 'selector', in order.
+  static vector<string> Results(TopNSelector* selector) {
+    const Schema& schema = selector->schema();
+    RowBlockMemory mem;
+    // Use a small block to return the results in several batches.
+    RowBlock block(&schema, 3, &mem);
+    vector<string> results;
+    while (true) {
+      CHECK_OK(selector->NextResults(&block));
+      if (block.nrows() == 0) {
+        break;
+      }
+      for (size_t i = 0; i < block.nrows(); i++) {
+        results.emplace_back(schema.DebugRow(block.row(i)));
+      }
+    }
+    return results;
+  }
+
+  const Schema schema_;
+};
+
+// Select the rows with the largest values, with null values last, against
+// sorting all the rows.
+TEST_F(TopNSelectorTest, TestSelectFirstRows) {
+  constexpr int kNumRows = 5000;
+  constexpr int kLimit = 20;
+  Random rng(SeedRandom());
+  vector<TestRow> rows;
+  for (int i = 0; i < kNumRows; i++) {
+    optional<int32_t> v;
+    if (!rng.OneIn(10)) {
+      v = rng.Uniform(1000);
+    }
+    rows.push_back({ rng.OneIn(20) ? -i : i, v, Substitute("row $0", i) });
+  }
+
+  TopNSpecPB spec;
+  AddSortKey("v", /*descending=*/true, /*nulls_first=*/false, &spec);
+  AddSortKey("key", /*descending=*/false, /*nulls_first=*/false, &spec);
+  spec.set_limit(kLimit);
+  unique_ptr<TopNSelector> selector;
+  ASSERT_OK(TopNSelector::Create(spec, schema_, &selector));
+  AddRows(rows, selector.get());
+  ASSERT_EQ(kLimit, selector->num_rows());
+
+  vector<TestRow> sorted;
+  std::copy_if(rows.begin(), rows.end(), std::back_inserter(sorted),
+               [](const TestRow& r) { return r.key >= 0; });
+  std::sort(sorted.begin(), sorted.end(), [](const TestRow& a, const TestRow& b) {
+    // Non-null values first, then larger values first, then smaller keys.
+    return std::make_tuple(!a.v, -a.v.value_or(0), a.key) <
+           std::make_tuple(!b.v, -b.v.value_or(0), b.key);
+  });
+  vector<string> expected;
+  for (int i = 0; i < kLimit; i++) {
+    expected.emplace_back(sorted[i].ToString());
+  }
+  ASSERT_EQ(expected, Results(selector.get()));
+
+  // Returning the results resets the selector.
+  ASSERT_EQ(0, selector->num_rows());
+
+  // Selecting the first rows of parts of the rows and then the first rows of
+  // the partial results gives the same results.
+  unique_ptr<TopNSelector> merger;
+  ASSERT_OK(TopNSelector::Create(spec, schema_, &merger));
+  RowBlockMemory mem;
+  RowBlock partial(&schema_, kLimit, &mem);
+  for (int start = 0; start < kNumRows; start += 1000) {
+    AddRows(vector<TestRow>(rows.begin() + start, rows.begin() + start + 1000), selector.get());
+    ASSERT_OK(selector->NextResults(&partial));
+    merger->AddRows(partial);
+    ASSERT_OK(selector->NextResults(&partial));
+    ASSERT_EQ(0, partial.nrows());
+  }
+  ASSERT_EQ(expected, Results(merger.get()));
+}
+
+// Adding the rows in reverse order evicts a row from the heap for every
+// added row, compacting the selected rows many times.
+TEST_F(TopNSelectorTest, TestEvictions) {
+  TopNSpecPB spec;
+  AddSortKey("s", /*descending=*/false, /*nulls_first=*/false, &spec);
+  spec.set_limit(3);
+  unique_ptr<TopNSelector> selector;
+  ASSERT_OK(TopNSelector::Create(spec, schema_, &selector));
+
+  vector<TestRow> rows;
+  for (int i = 10000; i >= 0; i--) {
+    rows.push_back({ i, std::nullopt, Substitute("row $0", i) });
+  }
+  AddRows(rows, selector.get());
+  ASSERT_EQ(vector<string>({ R"((int32 key=0, int32 v=NULL, string s="row 0"))",
+                             R"((int32 key=1, int32 v=NULL, string s="row 1"))",
+                             R"((int32 key=10, int32 v=NULL, string s="row 10"))" }),
+            Results(selector.get()));
+}
+
+TEST_F(TopNSelectorTest, TestNullsFirst) {
+  TopNSpecPB spec;
+  AddSortKey("v", /*descending=*/false, /*nulls_first=*/true, &spec);
+  spec.set_limit(2);
+  unique_ptr<TopNSelector> selector;
+  ASSERT_OK(TopNSelector::Create(spec, schema_, &selector));
+  AddRows({ { 1, 5, "a" }, { 2, std::nullopt, "b" }, { 3, 2, "c" }, { 4, 7, "d" } },
+          selector.get());
+  ASSERT_EQ(vector<string>({ R"((int32 key=2, int32 v=NULL, string s="b"))",
+                             R"((int32 key=3, int32 v=2, string s="c"))" }),
+            Results(selector.get()));
+}
+
+TEST_F(TopNSelectorTest, TestInvalidSpecs) {
+  unique_ptr<TopNSelector> selector;
+  {
+    TopNSpecPB spec;
+    spec.set_limit(10);
+    Status s = TopNSelector::Create(spec, schema_, &selector);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "requires at least one sort key");
+  }
+  {
+    TopNSpecPB spec;
+    AddSortKey("v", /*descending=*/false, /*nulls_first=*/false, &spec);
+    Status s = TopNSelector::Create(spec, schema_, &selector);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "requires a limit");
+  }
+  {
+    TopNSpecPB spec;
+    AddSortKey("missing", /*descending=*/false, /*nulls_first=*/false, &spec);
+    spec.set_limit(10);
+    Status s = TopNSelector::Create(spec, schema_, &selector);
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  }
+}
+
+} // namespace kudu
@@ -0,0 +1,203 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/top_n_selector.h"
+
+#include <algorithm>
+#include <ostream>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/row.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+
+namespace {
+
+// The initial size of the arena holding the selected rows.
+constexpr size_t kInitialArenaSize = 1024;
+
+// The minimum number of rows evicted from the heap before the arena is
+// compacted. The arena is also only compacted once the evicted rows
+// outnumber the selected ones, so compaction takes amortized constant time
+// per evicted row, and the arena holds at most about twice as many rows as
+// needed.
+constexpr size_t kMinEvictionsBeforeCompaction = 1024;
+
+} // anonymous namespace
+
+TopNSelector::TopNSelector(Schema schema, vector<SortKey> sort_keys, uint64_t limit)
+    : schema_(std::move(schema)),
+      sort_keys_(std::move(sort_keys)),
+      limit_(limit),
+      arena_(new Arena(kInitialArenaSize)),
+      num_evicted_(0),
+      next_result_(0),
+      returning_results_(false) {
+}
+
+TopNSelector::~TopNSelector() = default;
+
+Status TopNSelector::Create(const TopNSpecPB& spec,
+                            const Schema& schema,
+                            unique_ptr<TopNSelector>* selector) {
+  if (spec.order_by_size() == 0) {
+    return Status::InvalidArgument("top-N selection requires at least one sort key");
+  }
+  if (!spec.has_limit()) {
+    return Status::InvalidArgument("top-N selection requires a limit");
+  }
+  vector<SortKey> sort_keys;
+  for (const auto& key_pb : spec.order_by()) {
+    int idx;
+    RETURN_NOT_OK_PREPEND(schema.FindColumn(key_pb.column(), &idx), "invalid sort key");
+    const ColumnSchema& col = schema.column(idx);
+    if (col.type_info()->is_array()) {
+      return Status::InvalidArgument(Substitute(
+          "may not sort by array column '$0'", key_pb.column()));
+    }
+    sort_keys.push_back({ idx, col.type_info(), col.is_nullable(),
+                          key_pb.descending(), key_pb.nulls_first() });
+  }
+  selector->reset(new TopNSelector(schema, std::move(sort_keys), spec.limit()));
+  return Status::OK();
+}
+
+template<class RowType1, class RowType2>
+int TopNSelector::Compare(const RowType1& a, const RowType2& b) const {
+  for (const auto& key : sort_keys_) {
+    if (key.nullable) {
+      const bool a_null = a.is_null(key.col_idx);
+      const bool b_null = b.is_null(key.col_idx);
+      if (a_null && b_null) {
+        continue;
+      }
+      // Nulls go first or last regardless of the direction of the sort.
+      if (a_null || b_null) {
+        return a_null == key.nulls_first ? -1 : 1;
+      }
+    }
+    const int cmp = key.type_info->Compare(a.cell_ptr(key.col_idx), b.cell_ptr(key.col_idx));
+    if (cmp != 0) {
+      return key.descending ? -cmp : cmp;
+    }
+  }
+  return 0;
+}
+
+void TopNSelector::AddRows(const RowBlock& block) {
+  DCHECK(!returning_results_);
+  DCHECK(*block.schema() == schema_);
+  if (PREDICT_FALSE(limit_ == 0)) {
+    return;
+  }
+  const auto precedes = [this](const uint8_t* a, const uint8_t* b) {
+    return Compare(ConstContiguousRow(&schema_, a), ConstContiguousRow(&schema_, b)) < 0;
+  };
+  const SelectionVector* sel = block.selection_vector();
+  for (size_t i = 0; i < block.nrows(); i++) {
+    if (!sel->IsRowSelected(i)) {
+      continue;
+    }
+    if (heap_.size() < limit_) {
+      heap_.push_back(CopyToArena(block, i));
+      std::push_heap(heap_.begin(), heap_.end(), precedes);
+      continue;
+    }
+    // Once the heap is full, rows which don't precede the last selected row
+    // are dropped without being copied.
+    if (Compare(block.row(i), ConstContiguousRow(&schema_, heap_.front())) >= 0) {
+      continue;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), precedes);
+    heap_.back() = CopyToArena(block, i);
+    std::push_heap(heap_.begin(), heap_.end(), precedes);
+    if (++num_evicted_ >= std::max(heap_.size(), kMinEvictionsBeforeCompaction)) {
+      Compact();
+    }
+  }
+}
+
+uint8_t* TopNSelector::CopyToArena(const RowBlock& block, size_t row_idx) {
+  uint8_t* data = static_cast<uint8_t*>(
+      arena_->AllocateBytesAligned(ContiguousRowHelper::row_size(schema_), 8));
+  CHECK(data);
+  ContiguousRow dst(&schema_, data);
+  CHECK_OK(CopyRow(block.row(row_idx), &dst, arena_.get()));
+  return data;
+}
+
+void TopNSelector::Compact() {
+  unique_ptr<Arena> old_arena(std::move(arena_));
+  arena_.reset(new Arena(kInitialArenaSize));
+  const size_t row_size = ContiguousRowHelper::row_size(schema_);
+  for (auto& row : heap_) {
+    uint8_t* data = static_cast<uint8_t*>(arena_->AllocateBytesAligned(row_size, 8));
+    CHECK(data);
+    ContiguousRow dst(&schema_, data);
+    CHECK_OK(CopyRow(ConstContiguousRow(&schema_, row), &dst, arena_.get()));
+    row = data;
+  }
+  num_evicted_ = 0;
+}
+
+size_t TopNSelector::memory_footprint() const {
+  return arena_->memory_footprint() + heap_.capacity() * sizeof(const uint8_t*);
+}
+
+Status TopNSelector::NextResults(RowBlock* block) {
+  DCHECK(*block->schema() == schema_);
+  if (!returning_results_) {
+    returning_results_ = true;
+    std::sort_heap(heap_.begin(), heap_.end(), [this](const uint8_t* a, const uint8_t* b) {
+      return Compare(ConstContiguousRow(&schema_, a), ConstContiguousRow(&schema_, b)) < 0;
+    });
+  }
+
+  const size_t nrows = std::min(block->row_capacity(), heap_.size() - next_result_);
+  block->Resize(nrows);
+  if (nrows == 0) {
+    Reset();
+    return Status::OK();
+  }
+  block->selection_vector()->SetAllTrue();
+  for (size_t i = 0; i < nrows; i++) {
+    const ConstContiguousRow src(&schema_, heap_[next_result_++]);
+    RowBlockRow dst = block->row(i);
+    RETURN_NOT_OK(CopyRow(src, &dst, block->arena()));
+  }
+  return Status::OK();
+}
+
+void TopNSelector::Reset() {
+  heap_.clear();
+  arena_->Reset();
+  num_evicted_ = 0;
+  next_result_ = 0;
+  returning_results_ = false;
+}
+
+} // namespace kudu
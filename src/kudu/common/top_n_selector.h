@@ -0,0 +1,128 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/common/schema.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class RowBlock;
+class TypeInfo;
+
+// Selects the first rows of a stream of row blocks in the order described
+// by a TopNSpecPB, i.e. the rows of "ORDER BY ... LIMIT n".
+//
+// The selected rows are copied into an arena and kept in a bounded heap
+// whose top is the last of them in the sort order, so each incoming row is
+// usually compared against that row only, and copied only if it precedes it.
+//
+// Selecting the first rows of several streams and then the first rows of
+// their union gives the first rows of all the streams: each tablet server
+// selects the first rows of the rows it scans, and the client selects the
+// first rows of the per-tablet results with another selector for the same
+// spec and schema.
+//
+// This class is not thread-safe.
+class TopNSelector {
+ public:
+  // Create a selector for 'spec' over rows of 'schema'.
+  //
+  // Returns InvalidArgument if the spec has no sort keys or limit, or sorts
+  // by an array column, and NotFound if it sorts by a column not in 'schema'.
+  static Status Create(const TopNSpecPB& spec,
+                       const Schema& schema,
+                       std::unique_ptr<TopNSelector>* selector);
+
+  ~TopNSelector();
+
+  // The schema of the rows.
+  const Schema& schema() const { return schema_; }
+
+  // Add the selected rows of 'block', whose schema must be the selector's.
+  void AddRows(const RowBlock& block);
+
+  // The number of rows selected so far.
+  size_t num_rows() const { return heap_.size(); }
+
+  // The approximate amount of memory used by the selected rows.
+  size_t memory_footprint() const;
+
+  // Copy the next selected rows, in order, into 'block', which must use the
+  // selector's schema, up to the block's capacity. Successive calls return
+  // all the selected rows, followed by an empty block, at which point the
+  // selector is reset and can be reused for more rows. No rows may be added
+  // while the results are being returned.
+  //
+  // Variable-length data is copied into the block's arena.
+  Status NextResults(RowBlock* block);
+
+ private:
+  struct SortKey {
+    int col_idx;
+    const TypeInfo* type_info;
+    bool nullable;
+    bool descending;
+    bool nulls_first;
+  };
+
+  TopNSelector(Schema schema, std::vector<SortKey> sort_keys, uint64_t limit);
+
+  // Returns a negative value if 'a' comes before 'b' in the sort order, a
+  // positive one if it comes after, and 0 if they're equal on all the keys.
+  template<class RowType1, class RowType2>
+  int Compare(const RowType1& a, const RowType2& b) const;
+
+  // Copy row 'row_idx' of 'block' into the arena.
+  uint8_t* CopyToArena(const RowBlock& block, size_t row_idx);
+
+  // Copy the selected rows into a fresh arena, dropping the evicted ones.
+  void Compact();
+
+  // Discard all the rows.
+  void Reset();
+
+  const Schema schema_;
+  const std::vector<SortKey> sort_keys_;
+  const uint64_t limit_;
+
+  // The selected rows, as a heap whose top is the last of them in the sort
+  // order. Once the results are being returned, they're sorted instead.
+  std::vector<const uint8_t*> heap_;
+
+  // Holds the selected rows, and those which were evicted from the heap
+  // since the last compaction.
+  std::unique_ptr<Arena> arena_;
+  size_t num_evicted_;
+
+  // The index in 'heap_' of the next row to return from NextResults(), once
+  // it's been called.
+  size_t next_result_;
+  bool returning_results_;
+
+  DISALLOW_COPY_AND_ASSIGN(TopNSelector);
+};
+
+} // namespace kudu
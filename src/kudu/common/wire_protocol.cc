@@ -259,6 +259,9 @@ void ColumnSchemaToPB(const ColumnSchema& col_schema, ColumnSchemaPB *pb, int fl
     pb->set_encoding(col_schema.attributes().encoding);
     pb->set_compression(col_schema.attributes().compression);
     pb->set_cfile_block_size(col_schema.attributes().cfile_block_size);
+    if (col_schema.attributes().bloom_filter) {
+      pb->set_bloom_filter(true);
+    }
   }
   if (col_schema.has_read_default()) {
     if (type_info->physical_type() == BINARY) {
@@ -387,6 +390,9 @@ Status ColumnSchemaBuilderFromPB(const ColumnSchemaPB& pb,
   if (pb.has_cfile_block_size()) {
     attributes.cfile_block_size = pb.cfile_block_size();
   }
+  if (pb.has_bloom_filter()) {
+    attributes.bloom_filter = pb.bloom_filter();
+  }
   builder.storage_attributes(attributes);
 
   builder.immutable(pb.has_immutable() ? pb.immutable() : false);
@@ -421,6 +427,9 @@ void ColumnSchemaDeltaToPB(const ColumnSchemaDelta& col_delta, ColumnSchemaDelta
   if (col_delta.cfile_block_size) {
     pb->set_block_size(*col_delta.cfile_block_size);
   }
+  if (col_delta.bloom_filter) {
+    pb->set_bloom_filter(*col_delta.bloom_filter);
+  }
   if (col_delta.new_comment) {
     pb->set_new_comment(*col_delta.new_comment);
   }
@@ -449,6 +458,9 @@ ColumnSchemaDelta ColumnSchemaDeltaFromPB(const ColumnSchemaDeltaPB& pb) {
   if (pb.has_block_size()) {
     col_delta.cfile_block_size = pb.block_size();
   }
+  if (pb.has_bloom_filter()) {
+    col_delta.bloom_filter = pb.bloom_filter();
+  }
   if (pb.has_new_comment()) {
     col_delta.new_comment = pb.new_comment();
   }
@@ -178,7 +178,7 @@ class LogTestOptionalCompression : public LogTest,
   }
 };
 INSTANTIATE_TEST_SUITE_P(Codecs, LogTestOptionalCompression,
-                         ::testing::Values(NO_COMPRESSION, LZ4));
+                         ::testing::Values(NO_COMPRESSION, LZ4, ZSTD));
 
 // If we write more than one entry in a batch, we should be able to
 // read all of those entries back.
@@ -46,6 +46,17 @@ DEFINE_string(block_manager_preflush_control, "finalize",
               "never be pre-flushed but still be flushed when closed.");
 TAG_FLAG(block_manager_preflush_control, experimental);
 
+DEFINE_bool(block_manager_direct_reads, false,
+            "Whether to read data blocks with direct I/O, bypassing the page "
+            "cache. Data blocks read through the page cache are cached both "
+            "there and in the block cache; with direct reads, the block cache "
+            "is the only cache of data blocks, so --block_cache_capacity_mb "
+            "should be raised to take over the memory the page cache used for "
+            "them. Metadata and WAL files are still read through the page "
+            "cache. Only applies to data files opened after it's set.");
+TAG_FLAG(block_manager_direct_reads, advanced);
+TAG_FLAG(block_manager_direct_reads, experimental);
+
 namespace kudu {
 namespace fs {
 
@@ -67,6 +67,7 @@ using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
+DECLARE_bool(block_manager_direct_reads);
 DECLARE_bool(enable_data_block_fsync);
 DECLARE_string(block_manager_preflush_control);
 
@@ -857,11 +858,12 @@ Status FileBlockManager::OpenBlock(const BlockId& block_id,
   shared_ptr<RandomAccessFile> reader;
   if (PREDICT_TRUE(file_cache_)) {
     RETURN_NOT_OK_FBM_DISK_FAILURE(file_cache_->OpenFile<Env::MUST_EXIST>(
-        path, &reader));
+        path, &reader, FLAGS_block_manager_direct_reads));
   } else {
     unique_ptr<RandomAccessFile> r;
     RandomAccessFileOptions opts;
     opts.is_sensitive = true;
+    opts.direct_reads = FLAGS_block_manager_direct_reads;
     RETURN_NOT_OK_FBM_DISK_FAILURE(env_->NewRandomAccessFile(opts, path, &r));
     reader.reset(r.release());
   }
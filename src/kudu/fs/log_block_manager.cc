@@ -93,6 +93,7 @@
 #include "kudu/util/threadpool.h"
 #include "kudu/util/trace.h"
 
+DECLARE_bool(block_manager_direct_reads);
 DECLARE_bool(enable_data_block_fsync);
 DECLARE_string(block_manager_preflush_control);
 
@@ -1229,7 +1230,7 @@ Status LogBlockContainerNativeMeta::Create(LogBlockManager* block_manager,
       metadata_status = block_manager->file_cache_->OpenFile<Env::MUST_CREATE>(
           metadata_path, &metadata_writer);
       data_status = block_manager->file_cache_->OpenFile<Env::MUST_CREATE>(
-          data_path, &data_file);
+          data_path, &data_file, FLAGS_block_manager_direct_reads);
     } else {
       if (metadata_writer) {
         WARN_NOT_OK(block_manager->env()->DeleteFile(metadata_path),
@@ -1247,6 +1248,7 @@ Status LogBlockContainerNativeMeta::Create(LogBlockManager* block_manager,
       metadata_status = block_manager->env()->NewRWFile(
           rw_opts, metadata_path, &rwf);
       metadata_writer.reset(rwf.release());
+      rw_opts.direct_reads = FLAGS_block_manager_direct_reads;
       data_status = block_manager->env()->NewRWFile(
           rw_opts, data_path, &rwf);
       data_file.reset(rwf.release());
@@ -1295,7 +1297,8 @@ Status LogBlockContainerNativeMeta::Open(LogBlockManager* block_manager,
     RETURN_NOT_OK_CONTAINER_DISK_FAILURE(
         block_manager->file_cache_->OpenFile<Env::MUST_EXIST>(metadata_path, &metadata_file));
     RETURN_NOT_OK_CONTAINER_DISK_FAILURE(
-        block_manager->file_cache_->OpenFile<Env::MUST_EXIST>(data_path, &data_file));
+        block_manager->file_cache_->OpenFile<Env::MUST_EXIST>(
+            data_path, &data_file, FLAGS_block_manager_direct_reads));
   } else {
     RWFileOptions opts;
     opts.mode = Env::MUST_EXIST;
@@ -1304,6 +1307,7 @@ Status LogBlockContainerNativeMeta::Open(LogBlockManager* block_manager,
     RETURN_NOT_OK_CONTAINER_DISK_FAILURE(block_manager->env()->NewRWFile(
         opts, metadata_path, &rwf));
     metadata_file.reset(rwf.release());
+    opts.direct_reads = FLAGS_block_manager_direct_reads;
     RETURN_NOT_OK_CONTAINER_DISK_FAILURE(block_manager->env()->NewRWFile(
         opts, data_path, &rwf));
     data_file.reset(rwf.release());
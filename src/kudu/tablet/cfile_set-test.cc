@@ -21,6 +21,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -63,11 +64,15 @@
 #include "kudu/util/test_util.h"
 
 DECLARE_int32(cfile_default_block_size);
+DECLARE_int32(cfile_lazy_materialization_min_skip_rows);
+DECLARE_bool(consult_column_bloom_filters);
+DECLARE_bool(consult_zone_maps);
 
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
+using strings::Substitute;
 
 namespace kudu {
 namespace tablet {
@@ -529,6 +534,119 @@ TEST_F(TestCFileSet, TestRangeScan) {
   EXPECT_EQ(1, stats[2].blocks_read);
 }
 
+// Add a range predicate on a non-key column and ensure that the other columns
+// are only decoded for the rows which pass it.
+TEST_F(TestCFileSet, TestLateMaterialization) {
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  for (int min_skip_rows : { 0, 1, 16 }) {
+    SCOPED_TRACE(min_skip_rows);
+    FLAGS_cfile_lazy_materialization_min_skip_rows = min_skip_rows;
+
+    unique_ptr<CFileSet::Iterator> cfile_iter(fileset->NewIterator(&schema_, nullptr));
+    unique_ptr<RowwiseIterator> iter(NewMaterializingIterator(std::move(cfile_iter)));
+    Arena arena(1024);
+
+    // Select rows 1050 through 1059 by their values in column 1.
+    ScanSpec spec;
+    int32_t lower = 10500;
+    int32_t upper = 10600;
+    auto pred = ColumnPredicate::Range(schema_.column(1), &lower, &upper);
+    spec.AddPredicate(pred);
+    spec.OptimizeScan(schema_, &arena, true);
+    ASSERT_OK(iter->Init(&spec));
+
+    vector<string> results;
+    ASSERT_OK(IterateToStringList(iter.get(), &results));
+    ASSERT_EQ(10, results.size());
+    for (int i = 0; i < results.size(); i++) {
+      int row = 1050 + i;
+      EXPECT_EQ(StringPrintf("(int32 c0=%d, int32 c1=%d, int32 c2=%d)",
+                             row * 2, row * 10, row * 100),
+                results[i]);
+    }
+
+    vector<IteratorStats> stats;
+    iter->GetIteratorStats(&stats);
+    ASSERT_EQ(3, stats.size());
+    for (int i = 0; i < 3; i++) {
+      LOG(INFO) << "Col " << i << " stats: " << stats[i].ToString();
+    }
+
+    // The predicate column is evaluated in its entirety.
+    EXPECT_EQ(0, stats[1].cells_skipped);
+    if (min_skip_rows == 0) {
+      EXPECT_EQ(0, stats[0].cells_skipped);
+      EXPECT_EQ(0, stats[2].cells_skipped);
+    } else {
+      // The rows around the selected ones were read, but not decoded.
+      EXPECT_GT(stats[0].cells_skipped, 0);
+      EXPECT_GT(stats[2].cells_skipped, 0);
+      EXPECT_LE(stats[0].cells_skipped, stats[0].cells_read - 10);
+      EXPECT_LE(stats[2].cells_skipped, stats[2].cells_read - 10);
+    }
+  }
+}
+
+// Test that the zone maps of the base data rule out the rows of the blocks
+// which can't satisfy a predicate on a non-key column.
+TEST_F(TestCFileSet, TestPruneWithZoneMaps) {
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  for (bool consult_zone_maps : { false, true }) {
+    SCOPED_TRACE(consult_zone_maps);
+    FLAGS_consult_zone_maps = consult_zone_maps;
+
+    unique_ptr<CFileSet::Iterator> iter(fileset->NewIterator(&schema_, nullptr));
+    Arena arena(1024);
+
+    // Select rows 5000 through 5099 by their values in column 1.
+    ScanSpec spec;
+    int32_t lower = 50000;
+    int32_t upper = 51000;
+    auto pred = ColumnPredicate::Range(schema_.column(1), &lower, &upper);
+    spec.AddPredicate(pred);
+    spec.OptimizeScan(schema_, &arena, true);
+    ASSERT_OK(iter->Init(&spec));
+
+    RowBlockMemory mem;
+    RowBlock block(&schema_, 100, &mem);
+    size_t row_idx = 0;
+    size_t num_selected = 0;
+    while (iter->HasNext()) {
+      size_t n = block.nrows();
+      ASSERT_OK(iter->PrepareBatch(&n));
+      block.Resize(n);
+      ASSERT_OK(iter->InitializeSelectionVector(block.selection_vector()));
+      ASSERT_OK(iter->PruneSelectionVector(block.selection_vector()));
+      for (size_t i = 0; i < n; i++) {
+        if (row_idx + i >= 5000 && row_idx + i < 5100) {
+          ASSERT_TRUE(block.selection_vector()->IsRowSelected(i)) << "row " << row_idx + i;
+        }
+      }
+      num_selected += block.selection_vector()->CountSelected();
+      row_idx += n;
+      ASSERT_OK(iter->FinishBatch());
+    }
+    ASSERT_EQ(kNumRows, row_idx);
+    if (consult_zone_maps) {
+      EXPECT_LT(num_selected, kNumRows / 10);
+    } else {
+      EXPECT_EQ(kNumRows, num_selected);
+    }
+  }
+}
+
 // Several other black-box tests for range scans. These are similar to
 // TestRangeScan above, except don't inspect internal state.
 TEST_F(TestCFileSet, TestRangePredicates2) {
@@ -685,6 +803,143 @@ TEST_F(TestCFileSet, TestKUDU3384) {
   DoTestRangeScan(fileset, INT32_MAX - kNumRows, INT32_MAX);
 }
 
+class TestCFileSetBloomFilter : public KuduRowSetTest {
+ public:
+  explicit TestCFileSetBloomFilter(DataType value_type = STRING)
+      : KuduRowSetTest(Schema({ ColumnSchema("c0", INT32),
+                                ColumnSchemaBuilder()
+                                    .name("c1")
+                                    .type(value_type)
+                                    .storage_attributes(GetBloomFilterStorage()) },
+                              1)) {
+  }
+
+  static ColumnStorageAttributes GetBloomFilterStorage() {
+    ColumnStorageAttributes attr;
+    attr.bloom_filter = true;
+    return attr;
+  }
+
+  // Write out a test rowset whose second column contains "user_<2 * index>".
+  void WriteTestRowSet(int nrows) {
+    DiskRowSetWriter rsw(rowset_meta_.get(), &schema_,
+                         BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01f));
+    ASSERT_OK(rsw.Open());
+
+    RowBuilder rb(&schema_);
+    for (int i = 0; i < nrows; i++) {
+      rb.Reset();
+      rb.AddInt32(i);
+      rb.AddString(Substitute("user_$0", i * 2));
+      ASSERT_OK_FAST(WriteRow(rb.data(), &rsw));
+    }
+    ASSERT_OK(rsw.Finish());
+  }
+
+  // Return whether any row of the first batch of a scan of 'fileset' with
+  // 'pred' remains selected after pruning.
+  bool BaseDataMayMatch(const shared_ptr<CFileSet>& fileset, const ColumnPredicate& pred) {
+    unique_ptr<CFileSet::Iterator> iter(fileset->NewIterator(&schema_, nullptr));
+    ScanSpec spec;
+    spec.AddPredicate(pred);
+    CHECK_OK(iter->Init(&spec));
+
+    RowBlockMemory mem;
+    RowBlock block(&schema_, 100, &mem);
+    size_t n = block.nrows();
+    CHECK_OK(iter->PrepareBatch(&n));
+    block.Resize(n);
+    CHECK_OK(iter->InitializeSelectionVector(block.selection_vector()));
+    CHECK_OK(iter->PruneSelectionVector(block.selection_vector()));
+    return block.selection_vector()->AnySelected();
+  }
+};
+
+TEST_F(TestCFileSetBloomFilter, TestPruneWithBloomFilter) {
+  const int kNumRows = 1000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  // Values present in the rowset are never ruled out.
+  for (int i = 0; i < kNumRows; i += 97) {
+    string value = Substitute("user_$0", i * 2);
+    Slice value_slice(value);
+    ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::Equality(schema_.column(1),
+                                                                    &value_slice)));
+  }
+
+  // Nearly all of the absent values are ruled out, up to the filter's false
+  // positive rate.
+  int num_excluded = 0;
+  for (int i = 0; i < 100; i++) {
+    string value = Substitute("user_$0", i * 2 + 1);
+    Slice value_slice(value);
+    if (!BaseDataMayMatch(fileset, ColumnPredicate::Equality(schema_.column(1), &value_slice))) {
+      num_excluded++;
+    }
+  }
+  ASSERT_GE(num_excluded, 90);
+
+  // An IN-list predicate may match as long as any of its values may.
+  string present = "user_10";
+  string absent = "user_11";
+  Slice present_slice(present);
+  Slice absent_slice(absent);
+  vector<const void*> values = { &absent_slice, &present_slice };
+  ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::InList(schema_.column(1), &values)));
+
+  // Bloom filters aren't consulted when disabled.
+  FLAGS_consult_column_bloom_filters = false;
+  ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::Equality(schema_.column(1),
+                                                                  &absent_slice)));
+}
+
+class TestCFileSetDoubleBloomFilter : public TestCFileSetBloomFilter {
+ public:
+  TestCFileSetDoubleBloomFilter()
+      : TestCFileSetBloomFilter(DOUBLE) {
+  }
+
+  // Write out a test rowset whose second column contains the given values.
+  void WriteTestRowSet(const vector<double>& values) {
+    DiskRowSetWriter rsw(rowset_meta_.get(), &schema_,
+                         BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01f));
+    ASSERT_OK(rsw.Open());
+
+    RowBuilder rb(&schema_);
+    for (int i = 0; i < values.size(); i++) {
+      rb.Reset();
+      rb.AddInt32(i);
+      rb.AddDouble(values[i]);
+      ASSERT_OK_FAST(WriteRow(rb.data(), &rsw));
+    }
+    ASSERT_OK(rsw.Finish());
+  }
+};
+
+// Test that floating point values which compare equal but differ in their
+// bits aren't ruled out by the bloom filter.
+TEST_F(TestCFileSetDoubleBloomFilter, TestNegativeZeroAndNaN) {
+  WriteTestRowSet({ -0.0, -std::numeric_limits<double>::quiet_NaN(), 1.5 });
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  const double kPositiveZero = 0.0;
+  ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::Equality(schema_.column(1),
+                                                                  &kPositiveZero)));
+  const double kNegativeZero = -0.0;
+  ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::Equality(schema_.column(1),
+                                                                  &kNegativeZero)));
+  const double kNaN = std::numeric_limits<double>::quiet_NaN();
+  vector<const void*> values = { &kNaN };
+  ASSERT_TRUE(BaseDataMayMatch(fileset, ColumnPredicate::InList(schema_.column(1), &values)));
+}
+
 class InListPredicateBenchmark : public KuduRowSetTest {
  public:
   InListPredicateBenchmark()
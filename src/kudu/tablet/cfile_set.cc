@@ -17,6 +17,7 @@
 #include "kudu/tablet/cfile_set.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -32,6 +33,7 @@
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/iterator_stats.h"
@@ -42,6 +44,7 @@
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/casts.h"
 #include "kudu/gutil/dynamic_annotations.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/map-util.h"
@@ -59,6 +62,19 @@
 DEFINE_bool(consult_bloom_filters, true, "Whether to consult bloom filters on row presence checks");
 TAG_FLAG(consult_bloom_filters, hidden);
 
+DEFINE_bool(consult_zone_maps, true,
+            "Whether scans consult the zone maps of the base data to skip over "
+            "rows in data blocks which can't satisfy the scan predicates");
+TAG_FLAG(consult_zone_maps, advanced);
+TAG_FLAG(consult_zone_maps, runtime);
+
+DEFINE_bool(consult_column_bloom_filters, true,
+            "Whether scans with equality or IN-list predicates on columns with "
+            "bloom filters consult the filters to skip over the base data of "
+            "rowsets which don't contain any of the values");
+TAG_FLAG(consult_column_bloom_filters, advanced);
+TAG_FLAG(consult_column_bloom_filters, runtime);
+
 DECLARE_bool(rowset_metadata_store_keys);
 
 using kudu::cfile::BloomFileReader;
@@ -232,16 +248,18 @@ CFileReader* CFileSet::key_index_reader() const {
 Status CFileSet::NewColumnIterator(ColumnId col_id,
                                    CFileReader::CacheControl cache_blocks,
                                    const fs::IOContext* io_context,
+                                   ThreadPool* readahead_pool,
                                    unique_ptr<CFileIterator>* iter) const {
   return FindOrDie(readers_by_col_id_, col_id)->NewIterator(iter, cache_blocks,
-                                                            io_context);
+                                                            io_context, readahead_pool);
 }
 
 unique_ptr<CFileSet::Iterator> CFileSet::NewIterator(
     const Schema* projection,
-    const IOContext* io_context) const {
+    const IOContext* io_context,
+    ThreadPool* readahead_pool) const {
   return unique_ptr<CFileSet::Iterator>(
-      new CFileSet::Iterator(shared_from_this(), projection, io_context));
+      new CFileSet::Iterator(shared_from_this(), projection, io_context, readahead_pool));
 }
 
 Status CFileSet::CountRows(const IOContext* io_context, rowid_t *count) const {
@@ -290,29 +308,44 @@ Status CFileSet::FindRow(const RowSetKeyProbe &probe,
     // If it's already initialized, this is a no-op.
     RETURN_NOT_OK(bloom_reader_->Init(io_context));
 
-    stats->blooms_consulted++;
-    bool present;
-    Status s = bloom_reader_->CheckKeyPresent(probe.bloom_probe(), io_context, &present);
-    if (s.ok() && !present) {
+    bool maybe_present;
+    RETURN_NOT_OK(CheckBloomFilter(probe, io_context, &maybe_present, stats));
+    if (!maybe_present) {
       idx->reset();
       return Status::OK();
     }
-    if (!s.ok()) {
-      KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
-          rowset_metadata_->bloom_block().ToString(), s.ToString());
-      if (PREDICT_FALSE(s.IsDiskFailure())) {
-        // If the bloom lookup failed because of a disk failure, return early
-        // since I/O to the tablet should be stopped.
-        return s;
-      }
-      // Continue with the slow path
-    }
   }
 
-  stats->keys_consulted++;
   unique_ptr<CFileIterator> key_iter;
   RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+  return SeekToKey(probe, key_iter.get(), idx, stats);
+}
+
+Status CFileSet::CheckBloomFilter(const RowSetKeyProbe& probe,
+                                  const IOContext* io_context,
+                                  bool* maybe_present,
+                                  ProbeStats* stats) const {
+  stats->blooms_consulted++;
+  Status s = bloom_reader_->CheckKeyPresent(probe.bloom_probe(), io_context, maybe_present);
+  if (!s.ok()) {
+    KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
+        rowset_metadata_->bloom_block().ToString(), s.ToString());
+    if (PREDICT_FALSE(s.IsDiskFailure())) {
+      // If the bloom lookup failed because of a disk failure, return early
+      // since I/O to the tablet should be stopped.
+      return s;
+    }
+    // Continue with the slow path
+    *maybe_present = true;
+  }
+  return Status::OK();
+}
 
+Status CFileSet::SeekToKey(const RowSetKeyProbe& probe,
+                           CFileIterator* key_iter,
+                           optional<rowid_t>* idx,
+                           ProbeStats* stats) {
+  stats->keys_consulted++;
   bool exact;
   Status s = key_iter->SeekAtOrAfter(probe.encoded_key(), &exact);
   if (s.IsNotFound() || (s.ok() && !exact)) {
@@ -340,6 +373,52 @@ Status CFileSet::CheckRowPresent(const RowSetKeyProbe& probe, const IOContext* i
   return Status::OK();
 }
 
+Status CFileSet::CheckRowsPresent(const vector<const RowSetKeyProbe*>& probes,
+                                  const vector<ProbeStats*>& stats,
+                                  const IOContext* io_context,
+                                  vector<bool>* present,
+                                  vector<rowid_t>* rowids) const {
+  DCHECK_EQ(probes.size(), stats.size());
+  const size_t num_probes = probes.size();
+  present->assign(num_probes, true);
+  rowids->resize(num_probes);
+
+  // Rule out what we can with the bloom filter first. The keys are sorted,
+  // so consecutive keys mostly fall into the same bloom block, which the
+  // reader keeps around between lookups.
+  if (FLAGS_consult_bloom_filters) {
+    RETURN_NOT_OK(bloom_reader_->Init(io_context));
+    for (size_t i = 0; i < num_probes; i++) {
+      bool maybe_present;
+      RETURN_NOT_OK(CheckBloomFilter(*probes[i], io_context, &maybe_present, stats[i]));
+      (*present)[i] = maybe_present;
+    }
+  }
+
+  // Look the remaining keys up in the key index, sharing one iterator which
+  // seeks forward through the index in key order.
+  unique_ptr<CFileIterator> key_iter;
+  for (size_t i = 0; i < num_probes; i++) {
+    if (!(*present)[i]) {
+      continue;
+    }
+    if (!key_iter) {
+      RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+    }
+    optional<rowid_t> idx;
+    RETURN_NOT_OK(SeekToKey(*probes[i], key_iter.get(), &idx, stats[i]));
+    (*present)[i] = idx.has_value();
+    if (idx) {
+  // Suppress false positive about 'idx' used when uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+      (*rowids)[i] = *idx;
+#pragma GCC diagnostic pop
+    }
+  }
+  return Status::OK();
+}
+
 Status CFileSet::NewKeyIterator(const IOContext* io_context,
                                 unique_ptr<CFileIterator>* key_iter) const {
   CFileReader* key_reader = key_index_reader();
@@ -382,7 +461,8 @@ Status CFileSet::Iterator::CreateColumnIterators(const ScanSpec* spec) {
       continue;
     }
     unique_ptr<CFileIterator> iter;
-    RETURN_NOT_OK_PREPEND(base_data_->NewColumnIterator(col_id, cache_blocks, io_context_, &iter),
+    RETURN_NOT_OK_PREPEND(base_data_->NewColumnIterator(col_id, cache_blocks, io_context_,
+                                                        readahead_pool_, &iter),
                           Substitute("could not create iterator for column $0",
                                      projection_->column(proj_col_idx).ToString()));
     ret_iters.emplace_back(std::move(iter));
@@ -415,6 +495,35 @@ Status CFileSet::Iterator::Init(ScanSpec *spec) {
     // If there is a range predicate on the key column, push that down into an
     // ordinal range.
     RETURN_NOT_OK(PushdownRangeScanPredicate(spec));
+
+    // Keep track of the remaining predicates on columns with data in this
+    // rowset, to consult their zone maps and bloom filters.
+    if (spec != nullptr) {
+      for (const auto& [col_name, pred] : spec->predicates()) {
+        int col_idx = projection_->find_column(col_name);
+        if (col_idx == Schema::kColumnNotFound ||
+            !base_data_->has_data_for_column_id(projection_->column_id(col_idx))) {
+          continue;
+        }
+        zone_map_predicates_.emplace_back(col_idx, pred);
+
+        if (FLAGS_consult_column_bloom_filters && !excluded_by_bloom_filter_) {
+          auto* col_iter = down_cast<CFileIterator*>(col_iters_[col_idx].get());
+          bool may_match;
+          RETURN_NOT_OK(col_iter->CheckBloomFilter(pred, &may_match));
+          excluded_by_bloom_filter_ = !may_match;
+        }
+      }
+    }
+  }
+
+  // The blocks past the upper bound are never read, so they aren't read ahead
+  // either.
+  for (int col_idx = 0; col_idx < projection_->num_columns(); col_idx++) {
+    if (base_data_->has_data_for_column_id(projection_->column_id(col_idx))) {
+      auto* col_iter = down_cast<CFileIterator*>(col_iters_[col_idx].get());
+      col_iter->SetReadaheadUpperBound(upper_bound_idx_);
+    }
   }
 
   initted_ = true;
@@ -586,6 +695,25 @@ Status CFileSet::Iterator::InitializeSelectionVector(SelectionVector *sel_vec) {
   return Status::OK();
 }
 
+Status CFileSet::Iterator::PruneSelectionVector(SelectionVector* sel_vec) {
+  DCHECK_EQ(prepared_count_, sel_vec->nrows());
+  if (excluded_by_bloom_filter_) {
+    sel_vec->SetAllFalse();
+    return Status::OK();
+  }
+  if (!FLAGS_consult_zone_maps) {
+    return Status::OK();
+  }
+  for (const auto& [col_idx, pred] : zone_map_predicates_) {
+    auto* col_iter = down_cast<CFileIterator*>(col_iters_[col_idx].get());
+    RETURN_NOT_OK(col_iter->PruneWithZoneMap(pred, cur_idx_, sel_vec));
+    if (!sel_vec->AnySelected()) {
+      break;
+    }
+  }
+  return Status::OK();
+}
+
 Status CFileSet::Iterator::MaterializeColumn(ColumnMaterializationContext *ctx) {
   CHECK_EQ(prepared_count_, ctx->block()->nrows());
   DCHECK_LT(ctx->col_idx(), col_iters_.size());
@@ -31,6 +31,7 @@
 #include <gtest/gtest_prod.h>
 
 #include "kudu/cfile/cfile_reader.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/schema.h"
@@ -47,6 +48,7 @@ class ColumnMaterializationContext;
 class MemTracker;
 class ScanSpec;
 class SelectionVector;
+class ThreadPool;
 struct IteratorStats;
 
 namespace cfile {
@@ -83,9 +85,11 @@ class CFileSet :
                      std::shared_ptr<CFileSet>* cfile_set);
 
   // Create an iterator with the given projection. 'projection' must remain valid
-  // for the lifetime of the returned iterator.
+  // for the lifetime of the returned iterator. If 'readahead_pool' is set, the
+  // columns' data blocks are read ahead of the scan on it.
   std::unique_ptr<Iterator> NewIterator(const Schema* projection,
-                                        const fs::IOContext* io_context) const;
+                                        const fs::IOContext* io_context,
+                                        ThreadPool* readahead_pool = nullptr) const;
 
   Status CountRows(const fs::IOContext* io_context, rowid_t *count) const;
 
@@ -124,6 +128,16 @@ class CFileSet :
   Status CheckRowPresent(const RowSetKeyProbe& probe, const fs::IOContext* io_context,
                          bool* present, rowid_t* rowid, ProbeStats* stats) const;
 
+  // Check if each of the given rows is present, like CheckRowPresent(). The
+  // probes must be sorted by their encoded keys. All the keys are checked
+  // against the bloom filter first, and then the remaining ones are looked up
+  // in the key index with a single iterator.
+  Status CheckRowsPresent(const std::vector<const RowSetKeyProbe*>& probes,
+                          const std::vector<ProbeStats*>& stats,
+                          const fs::IOContext* io_context,
+                          std::vector<bool>* present,
+                          std::vector<rowid_t>* rowids) const;
+
   // Return true if there exists a CFile for the given column ID.
   bool has_data_for_column_id(ColumnId col_id) const {
     return ContainsKey(readers_by_col_id_, col_id);
@@ -149,10 +163,26 @@ class CFileSet :
   Status NewColumnIterator(ColumnId col_id,
                            cfile::CFileReader::CacheControl cache_blocks,
                            const fs::IOContext* io_context,
+                           ThreadPool* readahead_pool,
                            std::unique_ptr<cfile::CFileIterator>* iter) const;
   Status NewKeyIterator(const fs::IOContext* io_context,
                         std::unique_ptr<cfile::CFileIterator>* key_iter) const;
 
+  // Check the given key against the bloom filter, which must be initialized.
+  // Sets 'maybe_present' to true if the bloom filter can't rule the key out,
+  // or if it can't be read because of an error other than a disk failure.
+  Status CheckBloomFilter(const RowSetKeyProbe& probe,
+                          const fs::IOContext* io_context,
+                          bool* maybe_present,
+                          ProbeStats* stats) const;
+
+  // Seek 'key_iter' to the given key, setting 'idx' to the index of its row
+  // if it's present, or to std::nullopt otherwise.
+  static Status SeekToKey(const RowSetKeyProbe& probe,
+                          cfile::CFileIterator* key_iter,
+                          std::optional<rowid_t>* idx,
+                          ProbeStats* stats);
+
   // Return the CFileReader responsible for reading the key index.
   // (the ad-hoc reader for composite keys, otherwise the key column reader)
   cfile::CFileReader* key_index_reader() const;
@@ -196,6 +226,15 @@ class CFileSet::Iterator : public ColumnwiseIterator {
 
   Status InitializeSelectionVector(SelectionVector *sel_vec) override;
 
+  // Deselect the rows of the prepared batch in 'sel_vec' which can't satisfy
+  // the scan's predicates: all of them if the bloom filter of a column rules
+  // out the values of an equality or IN-list predicate, or those belonging
+  // to data blocks ruled out by their zone maps.
+  //
+  // The zone maps and bloom filters only describe the base data, so this
+  // must not be used if any rows of the batch may have been updated.
+  Status PruneSelectionVector(SelectionVector* sel_vec);
+
   Status MaterializeColumn(ColumnMaterializationContext *ctx) override;
 
   Status FinishBatch() override;
@@ -230,13 +269,16 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // 'projection' must remain valid for the lifetime of this object.
   Iterator(std::shared_ptr<CFileSet const> base_data,
            const Schema* projection,
-           const fs::IOContext* io_context)
+           const fs::IOContext* io_context,
+           ThreadPool* readahead_pool)
       : base_data_(std::move(base_data)),
         projection_(projection),
         initted_(false),
         cur_idx_(0),
         prepared_count_(0),
         io_context_(io_context),
+        readahead_pool_(readahead_pool),
+        excluded_by_bloom_filter_(false),
         arena_(256) {}
 
   // Fill in col_iters_ for each of the requested columns.
@@ -277,6 +319,7 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   rowid_t upper_bound_idx_;
 
   const fs::IOContext* io_context_;
+  ThreadPool* const readahead_pool_;
 
   // The underlying columns are prepared lazily, so that if a column is never
   // materialized, it doesn't need to be read off disk.
@@ -286,6 +329,14 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // stored in 'col_iters_'.
   std::vector<cfile::ColumnIterator*> prepared_iters_;
 
+  // The scan predicates on columns with data in this rowset, along with the
+  // indexes of those columns in the projection.
+  std::vector<std::pair<size_t, ColumnPredicate>> zone_map_predicates_;
+
+  // Whether the bloom filter of a column rules out every value of one of
+  // the predicates, in which case none of the base data rows match.
+  bool excluded_by_bloom_filter_;
+
   Arena arena_;
 };
 
@@ -56,6 +56,7 @@
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/local_tablet_writer.h"
@@ -93,6 +94,7 @@ DEFINE_uint32(merge_benchmark_num_rows_per_rowset, 500000,
               "Number of rowsets as input to the merge");
 
 DECLARE_bool(rowset_compaction_rows_per_block_enable_validation);
+DECLARE_int32(memrowset_num_shards);
 DECLARE_uint32(rowset_compaction_rows_per_block);
 DECLARE_string(block_manager);
 
@@ -592,6 +594,28 @@ TEST_F(TestCompaction, TestMemRowSetInput) {
             out[9]);
 }
 
+// Test that flushing a MemRowSet whose rows are spread across several shards
+// writes them out in key order.
+TEST_F(TestCompaction, TestFlushShardedMemRowSet) {
+  FLAGS_memrowset_num_shards = 4;
+  constexpr int kNumRows = 1000;
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              mem_trackers_.tablet_tracker, &mrs));
+  InsertRows(mrs.get(), kNumRows, 0);
+  UpdateRows(mrs.get(), kNumRows, 0, 1);
+
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(FlushMRSAndReopenNoRoll(*mrs, schema_, &rs));
+  vector<string> rows;
+  ASSERT_OK(rs->DebugDump(&rows));
+  ASSERT_EQ(kNumRows, rows.size());
+  for (int i = 0; i < kNumRows; i++) {
+    const string key = StringPrintf(kRowKeyFormat, static_cast<int64_t>(i) * 10);
+    ASSERT_STR_CONTAINS(rows[i], Substitute("key=\"$0\"", key));
+  }
+}
+
 TEST_F(TestCompaction, TestFlushMRSWithRolling) {
   // Create a memrowset with enough rows so that, when we flush with a small
   // roll threshold, we'll end up creating multiple DiskRowSets.
@@ -126,6 +126,10 @@ namespace {
 // compaction.
 const int kCompactionOutputBlockNumRows = 100;
 
+// The maximum number of rows we will read at a time from a MemRowSet
+// during a flush.
+const int kMemRowSetInputBlockNumRows = 100;
+
 // Advances to the last mutation in a mutation list.
 void AdvanceToLastInList(Mutation** m) {
   if (*m == nullptr) return;
@@ -167,19 +171,15 @@ class MemRowSetCompactionInput : public CompactionOrFlushInput {
   }
 
   Status PrepareBlock(vector<CompactionInputRow>* block) override {
-    const auto num_in_block = iter_->remaining_in_leaf();
-    block->resize(num_in_block);
-
-    // Realloc the internal block storage if we don't have enough space to
-    // copy the whole leaf node's worth of data into it.
-    if (PREDICT_FALSE(!row_block_ || num_in_block > row_block_->nrows())) {
-      row_block_.reset(new RowBlock(&iter_->schema(), num_in_block, &mem_));
+    block->resize(kMemRowSetInputBlockNumRows);
+    if (PREDICT_FALSE(!row_block_)) {
+      row_block_.reset(new RowBlock(&iter_->schema(), kMemRowSetInputBlockNumRows, &mem_));
     }
 
     mem_.arena.Reset();
     RowChangeListEncoder undo_encoder(&buffer_);
     int next_row_index = 0;
-    for (int i = 0; i < num_in_block; ++i) {
+    while (next_row_index < kMemRowSetInputBlockNumRows && iter_->HasNext()) {
       // TODO(todd): A copy is performed to make all CompactionInputRow have the same schema
       CompactionInputRow& input_row = block->at(next_row_index);
       input_row.row.Reset(row_block_.get(), next_row_index);
@@ -217,7 +217,7 @@ class MemRowSetCompactionInput : public CompactionOrFlushInput {
       iter_->Next();
     }
 
-    if (PREDICT_FALSE(next_row_index < num_in_block)) {
+    if (next_row_index < kMemRowSetInputBlockNumRows) {
       block->resize(next_row_index);
     }
 
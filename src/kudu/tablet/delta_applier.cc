@@ -121,6 +121,11 @@ Status DeltaApplier::InitializeSelectionVector(SelectionVector* sel_vec) {
     deltas.ToSelectionVector(sel_vec);
   } else {
     RETURN_NOT_OK(base_iter_->InitializeSelectionVector(sel_vec));
+    // Unless updates in this batch may have changed the base data, rows can
+    // be ruled out based on the zone maps and bloom filters of the base data.
+    if (!delta_iter_->MayHaveDeltas()) {
+      RETURN_NOT_OK(base_iter_->PruneSelectionVector(sel_vec));
+    }
   }
   if (!opts_.include_deleted_rows) {
     RETURN_NOT_OK(delta_iter_->ApplyDeletes(sel_vec));
@@ -86,7 +86,8 @@ MajorDeltaCompaction::MajorDeltaCompaction(
     vector<shared_ptr<DeltaStore> > included_stores,
     vector<ColumnId> col_ids,
     HistoryGcOpts history_gc_opts,
-    string tablet_id)
+    string tablet_id,
+    ThreadPool* column_writer_pool)
     : fs_manager_(fs_manager),
       base_schema_(base_schema),
       column_ids_(std::move(col_ids)),
@@ -95,6 +96,7 @@ MajorDeltaCompaction::MajorDeltaCompaction(
       included_stores_(std::move(included_stores)),
       delta_iter_(std::move(delta_iter)),
       tablet_id_(std::move(tablet_id)),
+      column_writer_pool_(column_writer_pool),
       redo_delta_mutations_written_(0),
       undo_delta_mutations_written_(0),
       state_(kInitialized) {
@@ -319,7 +321,8 @@ Status MajorDeltaCompaction::OpenBaseDataWriter() {
 
   unique_ptr<MultiColumnWriter> w(new MultiColumnWriter(fs_manager_,
                                                         &partial_schema_,
-                                                        tablet_id_));
+                                                        tablet_id_,
+                                                        column_writer_pool_));
   RETURN_NOT_OK(w->Open());
   base_data_writer_ = std::move(w);
   return Status::OK();
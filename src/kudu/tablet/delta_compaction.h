@@ -32,6 +32,7 @@ namespace kudu {
 
 class FsManager;
 class MemTracker;
+class ThreadPool;
 
 namespace fs {
 struct IOContext;
@@ -64,7 +65,8 @@ class MajorDeltaCompaction {
       std::vector<std::shared_ptr<DeltaStore> > included_stores,
       std::vector<ColumnId> col_ids,
       HistoryGcOpts history_gc_opts,
-      std::string tablet_id);
+      std::string tablet_id,
+      ThreadPool* column_writer_pool = nullptr);
   ~MajorDeltaCompaction();
 
   // Executes the compaction.
@@ -135,6 +137,9 @@ class MajorDeltaCompaction {
   // The ID of the tablet being compacted.
   const std::string tablet_id_;
 
+  // The pool to write the compacted columns on in parallel, or null.
+  ThreadPool* const column_writer_pool_;
+
   // Outputs:
   std::unique_ptr<MultiColumnWriter> base_data_writer_;
   // The following two may not be initialized if we don't need to write a delta file.
@@ -66,11 +66,13 @@
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/random.h"
+#include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 #include "kudu/util/stopwatch.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
+#include "kudu/util/threadpool.h"
 
 namespace kudu {
 namespace tablet {
@@ -85,6 +87,8 @@ DECLARE_int32(cfile_default_block_size);
 DECLARE_double(env_inject_eio);
 DECLARE_int32(tablet_history_max_age_sec);
 DECLARE_bool(rowset_metadata_store_keys);
+DECLARE_int32(rowset_column_writer_inject_finish_failure_col_idx);
+DECLARE_bool(rowset_use_block_bloom_filter);
 DECLARE_double(tablet_delta_store_major_compact_min_ratio);
 DECLARE_int32(tablet_delta_store_minor_compact_max);
 DECLARE_uint64(all_delete_op_delta_file_cnt_for_compaction);
@@ -187,6 +191,180 @@ TEST_F(TestRowSet, TestRowSetRoundTrip) {
   }
 }
 
+// Test that checking the presence of a sorted batch of keys gives the same
+// results as checking them one at a time.
+TEST_F(TestRowSet, TestCheckRowsPresent) {
+  WriteTestRowSet(100);
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  OperationResultPB result;
+  ASSERT_OK(DeleteRow(rs.get(), 10, &result));
+
+  // Keys before, between and after the keys of the rowset, including a
+  // deleted one.
+  vector<string> keys = { "a" };
+  for (int i : { 0, 10, 20, 49, 99 }) {
+    char buf[256];
+    FormatKey(i, buf, sizeof(buf));
+    keys.emplace_back(buf);
+    if (i == 49) {
+      keys.emplace_back(string(buf) + "x");
+    }
+  }
+  keys.emplace_back("z");
+  const vector<bool> expected = { false, true, false, true, true, false, true, false };
+  ASSERT_EQ(expected.size(), keys.size());
+
+  const Schema pk = schema_.CreateKeyProjection();
+  Arena arena(1024);
+  vector<unique_ptr<RowBuilder>> builders;
+  vector<unique_ptr<RowSetKeyProbe>> probes;
+  vector<ProbeStats> stats(keys.size());
+  vector<const RowSetKeyProbe*> probe_ptrs;
+  vector<ProbeStats*> stats_ptrs;
+  for (int i = 0; i < keys.size(); i++) {
+    builders.emplace_back(new RowBuilder(&pk));
+    builders.back()->AddString(Slice(keys[i]));
+    probes.emplace_back(new RowSetKeyProbe(builders.back()->row(), &arena));
+    probe_ptrs.push_back(probes.back().get());
+    stats_ptrs.push_back(&stats[i]);
+  }
+
+  vector<bool> present;
+  ASSERT_OK(rs->CheckRowsPresent(probe_ptrs, stats_ptrs, nullptr, &present));
+  ASSERT_EQ(expected, present);
+  for (int i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(1, stats[i].blooms_consulted);
+    bool row_present;
+    ProbeStats row_stats;
+    ASSERT_OK(rs->CheckRowPresent(*probes[i], nullptr, &row_present, &row_stats));
+    ASSERT_EQ(expected[i], row_present) << keys[i];
+  }
+}
+
+// Test writing a rowset whose columns are written in parallel, and reading
+// it back.
+TEST_F(TestRowSet, TestRowSetRoundTripWithParallelColumnWriters) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("col-writer").set_max_threads(4).Build(&pool));
+  // Write enough rows for the writer to append several batches of buffered
+  // rows to the columns.
+  constexpr int kNumRows = 40000;
+  DiskRowSetWriter drsw(rowset_meta_.get(), &schema_,
+                        BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01F), pool.get());
+  DoWriteTestRowSet(kNumRows, &drsw);
+
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  IterateProjection(*rs, schema_, kNumRows);
+  for (int i : { 0, 16383, 16384, 30000, kNumRows - 1 }) {
+    char buf[256];
+    FormatKey(i, buf, sizeof(buf));
+    NO_FATALS(VerifyRandomRead(*rs, buf,
+                               Substitute(R"((string key="$0", uint32 val=$1))", buf, i)));
+  }
+}
+
+// Test that the rows buffered to be written to the columns in parallel count
+// towards the written size, which rowsets are rolled by.
+TEST_F(TestRowSet, TestWrittenSizeWithParallelColumnWriters) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("col-writer").set_max_threads(4).Build(&pool));
+  DiskRowSetWriter drsw(rowset_meta_.get(), &schema_,
+                        BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01F), pool.get());
+  ASSERT_OK(drsw.Open());
+  const size_t initial_size = drsw.written_size();
+
+  // Fewer rows than the writer buffers, so none of them is written to the
+  // columns before they're finished.
+  constexpr int kNumRows = 1000;
+  char buf[256];
+  RowBuilder rb(&schema_);
+  for (int i = 0; i < kNumRows; i++) {
+    rb.Reset();
+    FormatKey(i, buf, sizeof(buf));
+    rb.AddString(Slice(buf));
+    rb.AddUint32(i);
+    ASSERT_OK(WriteRow(rb.data(), &drsw));
+  }
+  ASSERT_GE(drsw.written_size(), initial_size + kNumRows * (sizeof(Slice) + sizeof(uint32_t)));
+  ASSERT_OK(drsw.Finish());
+}
+
+// Test finishing the columns of a rowset in parallel, both when all of them
+// are finished successfully and when finishing one of them fails.
+TEST_F(TestRowSet, TestFinishWithParallelColumnWriters) {
+  unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("col-writer").set_max_threads(4).Build(&pool));
+  constexpr int kNumRows = 1000;
+  const auto write_rows = [&](DiskRowSetWriter* drsw) {
+    char buf[256];
+    RowBuilder rb(&schema_);
+    for (int i = 0; i < kNumRows; i++) {
+      rb.Reset();
+      FormatKey(i, buf, sizeof(buf));
+      rb.AddString(Slice(buf));
+      rb.AddUint32(i);
+      ASSERT_OK(WriteRow(rb.data(), drsw));
+    }
+  };
+
+  // An error finishing the writer of one column fails the whole rowset, even
+  // though the other columns are finished successfully.
+  {
+    FLAGS_rowset_column_writer_inject_finish_failure_col_idx = 1;
+    SCOPED_CLEANUP({
+      FLAGS_rowset_column_writer_inject_finish_failure_col_idx = -1;
+    });
+    DiskRowSetWriter drsw(rowset_meta_.get(), &schema_,
+                          BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01F), pool.get());
+    ASSERT_OK(drsw.Open());
+    NO_FATALS(write_rows(&drsw));
+    Status s = drsw.Finish();
+    ASSERT_TRUE(s.IsIOError()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "injected column writer finish failure");
+  }
+
+  // Without the error, all the columns are finished and the rowset can be
+  // read back.
+  {
+    DiskRowSetWriter drsw(rowset_meta_.get(), &schema_,
+                          BloomFilterSizing::BySizeAndFPRate(32*1024, 0.01F), pool.get());
+    ASSERT_OK(drsw.Open());
+    NO_FATALS(write_rows(&drsw));
+    ASSERT_OK(drsw.Finish());
+  }
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+  IterateProjection(*rs, schema_, kNumRows);
+}
+
+// Test writing a rowset whose key bloom filters are block bloom filters, and
+// checking the presence of keys in it.
+TEST_F(TestRowSet, TestCheckRowPresentWithBlockBloomFilter) {
+  FLAGS_rowset_use_block_bloom_filter = true;
+  constexpr int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+  shared_ptr<DiskRowSet> rs;
+  ASSERT_OK(OpenTestRowSet(&rs));
+
+  const Schema pk = schema_.CreateKeyProjection();
+  Arena arena(1024);
+  for (int i = 0; i < kNumRows; i += 97) {
+    char buf[256];
+    FormatKey(i, buf, sizeof(buf));
+    for (const auto& key : { string(buf), string(buf) + "x" }) {
+      RowBuilder rb(&pk);
+      rb.AddString(Slice(key));
+      RowSetKeyProbe probe(rb.row(), &arena);
+      bool present;
+      ProbeStats stats;
+      ASSERT_OK(rs->CheckRowPresent(probe, nullptr, &present, &stats));
+      ASSERT_EQ(key == buf, present) << key;
+    }
+  }
+}
+
 // Test writing a rowset, and then updating some rows in it.
 TEST_F(TestRowSet, TestRowSetUpdate) {
   Arena arena(64);
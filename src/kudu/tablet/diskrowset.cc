@@ -89,6 +89,14 @@ DEFINE_bool(rowset_deltas_size_include_undo, true,
             "computation of upper and lower bounds for a set of rowsets");
 TAG_FLAG(rowset_deltas_size_include_undo, advanced);
 
+DEFINE_bool(rowset_use_block_bloom_filter, false,
+            "Whether to write the primary key bloom filters of new rowsets as "
+            "block bloom filters, whose lookups touch a single cache line, "
+            "rather than classic bloom filters. Rowsets written with this "
+            "enabled can't be read by versions which predate the format.");
+TAG_FLAG(rowset_use_block_bloom_filter, advanced);
+TAG_FLAG(rowset_use_block_bloom_filter, experimental);
+
 using kudu::cfile::BloomFileWriter;
 using kudu::fs::BlockCreationTransaction;
 using kudu::fs::CreateBlockOptions;
@@ -112,10 +120,12 @@ namespace tablet {
 
 DiskRowSetWriter::DiskRowSetWriter(RowSetMetadata* rowset_metadata,
                                    const Schema* schema,
-                                   BloomFilterSizing bloom_sizing)
+                                   BloomFilterSizing bloom_sizing,
+                                   ThreadPool* column_writer_pool)
     : rowset_metadata_(rowset_metadata),
       schema_(schema),
       bloom_sizing_(bloom_sizing),
+      column_writer_pool_(column_writer_pool),
       finished_(false),
       written_count_(0) {
   CHECK(schema->has_column_ids());
@@ -126,7 +136,7 @@ Status DiskRowSetWriter::Open() {
 
   FsManager* fs = rowset_metadata_->fs_manager();
   const string& tablet_id = rowset_metadata_->tablet_metadata()->tablet_id();
-  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id));
+  col_writer_.reset(new MultiColumnWriter(fs, schema_, tablet_id, column_writer_pool_));
   RETURN_NOT_OK(col_writer_->Open());
 
   // Open bloom filter.
@@ -150,7 +160,8 @@ Status DiskRowSetWriter::InitBloomFileWriter() {
                         "Couldn't allocate a block for bloom filter");
   rowset_metadata_->set_bloom_block(block->id());
 
-  bloom_writer_.reset(new cfile::BloomFileWriter(std::move(block), bloom_sizing_));
+  bloom_writer_.reset(new cfile::BloomFileWriter(std::move(block), bloom_sizing_,
+                                                 FLAGS_rowset_use_block_bloom_filter));
   RETURN_NOT_OK(bloom_writer_->Start());
   return Status::OK();
 }
@@ -329,12 +340,14 @@ DiskRowSetWriter::~DiskRowSetWriter() {
 
 RollingDiskRowSetWriter::RollingDiskRowSetWriter(
     TabletMetadata* tablet_metadata, const Schema& schema,
-    BloomFilterSizing bloom_sizing, size_t target_rowset_size)
+    BloomFilterSizing bloom_sizing, size_t target_rowset_size,
+    ThreadPool* column_writer_pool)
     : state_(kInitialized),
       tablet_metadata_(DCHECK_NOTNULL(tablet_metadata)),
       schema_(schema),
       bloom_sizing_(bloom_sizing),
       target_rowset_size_(target_rowset_size),
+      column_writer_pool_(column_writer_pool),
       row_idx_in_cur_drs_(0),
       can_roll_(false),
       written_count_(0),
@@ -363,7 +376,8 @@ Status RollingDiskRowSetWriter::RollWriter() {
 
   RETURN_NOT_OK(tablet_metadata_->CreateRowSet(&cur_drs_metadata_));
 
-  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_));
+  cur_writer_.reset(new DiskRowSetWriter(cur_drs_metadata_.get(), &schema_, bloom_sizing_,
+                                         column_writer_pool_));
   RETURN_NOT_OK(cur_writer_->Open());
 
   FsManager* fs = tablet_metadata_->fs_manager();
@@ -560,7 +574,8 @@ Status DiskRowSet::MinorCompactDeltaStores(const IOContext* io_context) {
 }
 
 Status DiskRowSet::MajorCompactDeltaStores(const IOContext* io_context,
-                                           HistoryGcOpts history_gc_opts) {
+                                           HistoryGcOpts history_gc_opts,
+                                           ThreadPool* column_writer_pool) {
   vector<ColumnId> col_ids;
   delta_tracker_->GetColumnIdsToCompact(&col_ids);
 
@@ -569,12 +584,14 @@ Status DiskRowSet::MajorCompactDeltaStores(const IOContext* io_context,
     return Status::OK();
   }
 
-  return MajorCompactDeltaStoresWithColumnIds(col_ids, io_context, std::move(history_gc_opts));
+  return MajorCompactDeltaStoresWithColumnIds(col_ids, io_context, std::move(history_gc_opts),
+                                              column_writer_pool);
 }
 
 Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>& col_ids,
                                                         const IOContext* io_context,
-                                                        HistoryGcOpts history_gc_opts) {
+                                                        HistoryGcOpts history_gc_opts,
+                                                        ThreadPool* column_writer_pool) {
   VLOG_WITH_PREFIX(1) << "Major compacting REDO delta stores (cols: " << col_ids << ")";
   TRACE_EVENT0("tablet", "DiskRowSet::MajorCompactDeltaStoresWithColumnIds");
   std::lock_guard l(*mutable_delta_tracker()->compact_flush_lock());
@@ -592,7 +609,7 @@ Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>&
   opts.io_context = io_context;
   unique_ptr<MajorDeltaCompaction> compaction;
   RETURN_NOT_OK(NewMajorDeltaCompaction(
-      col_ids, opts, std::move(history_gc_opts), &compaction));
+      col_ids, opts, std::move(history_gc_opts), column_writer_pool, &compaction));
 
   RETURN_NOT_OK(compaction->Compact(io_context));
 
@@ -640,6 +657,7 @@ Status DiskRowSet::MajorCompactDeltaStoresWithColumnIds(const vector<ColumnId>&
 Status DiskRowSet::NewMajorDeltaCompaction(const vector<ColumnId>& col_ids,
                                            const RowIteratorOptions& opts,
                                            HistoryGcOpts history_gc_opts,
+                                           ThreadPool* column_writer_pool,
                                            unique_ptr<MajorDeltaCompaction>* out) const {
   DCHECK(open_);
   shared_lock l(component_lock_);
@@ -656,7 +674,8 @@ Status DiskRowSet::NewMajorDeltaCompaction(const vector<ColumnId>& col_ids,
                                       std::move(included_stores),
                                       col_ids,
                                       std::move(history_gc_opts),
-                                      rowset_metadata_->tablet_metadata()->tablet_id()));
+                                      rowset_metadata_->tablet_metadata()->tablet_id(),
+                                      column_writer_pool));
   return Status::OK();
 }
 
@@ -666,7 +685,8 @@ Status DiskRowSet::NewRowIterator(const RowIteratorOptions& opts,
   shared_lock l(component_lock_);
 
   shared_ptr<CFileSet::Iterator> base_iter(base_data_->NewIterator(opts.projection,
-                                                                   opts.io_context));
+                                                                   opts.io_context,
+                                                                   opts.readahead_pool));
   unique_ptr<ColumnwiseIterator> col_iter;
   RETURN_NOT_OK(delta_tracker_->WrapIterator(base_iter, opts, &col_iter));
 
@@ -751,6 +771,28 @@ Status DiskRowSet::CheckRowPresent(const RowSetKeyProbe& probe,
   return Status::OK();
 }
 
+Status DiskRowSet::CheckRowsPresent(const vector<const RowSetKeyProbe*>& probes,
+                                    const vector<ProbeStats*>& stats,
+                                    const IOContext* io_context,
+                                    vector<bool>* present) const {
+  DCHECK(open_);
+  shared_lock l(component_lock_);
+
+  vector<rowid_t> row_idxs;
+  RETURN_NOT_OK(base_data_->CheckRowsPresent(probes, stats, io_context, present, &row_idxs));
+  for (size_t i = 0; i < probes.size(); i++) {
+    if (!(*present)[i]) {
+      // If it wasn't in the base data, then it's definitely not in the rowset.
+      continue;
+    }
+    // Otherwise it might be in the base data but deleted.
+    bool deleted = false;
+    RETURN_NOT_OK(delta_tracker_->CheckRowDeleted(row_idxs[i], io_context, &deleted, stats[i]));
+    (*present)[i] = !deleted;
+  }
+  return Status::OK();
+}
+
 Status DiskRowSet::CountRows(const IOContext* io_context, rowid_t* count) const {
   DCHECK(open_);
   rowid_t num_rows = num_rows_.load();
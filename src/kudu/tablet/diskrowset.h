@@ -56,6 +56,7 @@ class MonoTime;
 class RowBlock;
 class RowChangeList;
 class RowwiseIterator;
+class ThreadPool;
 class Timestamp;
 
 namespace tablet {
@@ -106,8 +107,12 @@ class OperationResultPB;
 class DiskRowSetWriter final {
  public:
   // TODO(todd): document ownership of rowset_metadata
+  //
+  // If 'column_writer_pool' is set, the columns are written in parallel on it.
+  // See MultiColumnWriter.
   DiskRowSetWriter(RowSetMetadata* rowset_metadata, const Schema* schema,
-                   BloomFilterSizing bloom_sizing);
+                   BloomFilterSizing bloom_sizing,
+                   ThreadPool* column_writer_pool = nullptr);
 
   ~DiskRowSetWriter();
 
@@ -160,6 +165,7 @@ class DiskRowSetWriter final {
   const Schema* const schema_;
 
   BloomFilterSizing bloom_sizing_;
+  ThreadPool* const column_writer_pool_;
 
   bool finished_;
   rowid_t written_count_;
@@ -181,11 +187,13 @@ class RollingDiskRowSetWriter final {
  public:
   // Create a new rolling writer. The given 'tablet_metadata' must stay valid
   // for the lifetime of this writer, and is used to construct the new rowsets
-  // that this RollingDiskRowSetWriter creates.
+  // that this RollingDiskRowSetWriter creates. If 'column_writer_pool' is set,
+  // the columns of the rowsets are written in parallel on it.
   RollingDiskRowSetWriter(TabletMetadata* tablet_metadata,
                           const Schema& schema,
                           BloomFilterSizing bloom_sizing,
-                          size_t target_rowset_size);
+                          size_t target_rowset_size,
+                          ThreadPool* column_writer_pool = nullptr);
   ~RollingDiskRowSetWriter();
 
   Status Open();
@@ -265,6 +273,7 @@ class RollingDiskRowSetWriter final {
   std::shared_ptr<RowSetMetadata> cur_drs_metadata_;
   const BloomFilterSizing bloom_sizing_;
   const size_t target_rowset_size_;
+  ThreadPool* const column_writer_pool_;
 
   std::unique_ptr<DiskRowSetWriter> cur_writer_;
 
@@ -375,6 +384,11 @@ class DiskRowSet :
                          const fs::IOContext* io_context,
                          bool* present, ProbeStats* stats) const override;
 
+  Status CheckRowsPresent(const std::vector<const RowSetKeyProbe*>& probes,
+                          const std::vector<ProbeStats*>& stats,
+                          const fs::IOContext* io_context,
+                          std::vector<bool>* present) const override;
+
   ////////////////////
   // Read functions.
   ////////////////////
@@ -442,8 +456,11 @@ class DiskRowSet :
   Status DeleteAncientUndoDeltas(Timestamp ancient_history_mark, const fs::IOContext* io_context,
                                  int64_t* blocks_deleted, int64_t* bytes_deleted) override;
 
-  // Major compacts all the delta files for all the columns.
-  Status MajorCompactDeltaStores(const fs::IOContext* io_context, HistoryGcOpts history_gc_opts);
+  // Major compacts all the delta files for all the columns. If
+  // 'column_writer_pool' is set, the compacted columns are written in
+  // parallel on it.
+  Status MajorCompactDeltaStores(const fs::IOContext* io_context, HistoryGcOpts history_gc_opts,
+                                 ThreadPool* column_writer_pool = nullptr);
 
   std::mutex* compact_flush_lock() override {
     return &compact_flush_lock_;
@@ -509,12 +526,14 @@ class DiskRowSet :
   Status NewMajorDeltaCompaction(const std::vector<ColumnId>& col_ids,
                                  const RowIteratorOptions& opts,
                                  HistoryGcOpts history_gc_opts,
+                                 ThreadPool* column_writer_pool,
                                  std::unique_ptr<MajorDeltaCompaction>* out) const;
 
   // Major compacts all the delta files for the specified columns.
   Status MajorCompactDeltaStoresWithColumnIds(const std::vector<ColumnId>& col_ids,
                                               const fs::IOContext* io_context,
-                                              HistoryGcOpts history_gc_opts);
+                                              HistoryGcOpts history_gc_opts,
+                                              ThreadPool* column_writer_pool = nullptr);
 
   Status DebugDumpImpl(int64_t* rows_left, std::vector<std::string>* lines) override;
 
@@ -72,6 +72,8 @@ DEFINE_double(update_ratio, 0.2,
 DEFINE_int32(times_to_update, 5000,
              "Number of updates for each row for the update performance test");
 
+DECLARE_int32(memrowset_num_shards);
+
 using kudu::consensus::OpId;
 using kudu::log::LogAnchorRegistry;
 using std::nullopt;
@@ -463,6 +465,46 @@ TEST_F(TestMemRowSet, TestInsertAndIterateCompoundKey) {
   ASSERT_FALSE(iter->HasNext());
 }
 
+// Test that the rows of a MemRowSet which is split into several shards are
+// found by their keys, and iterated through in key order.
+TEST_F(TestMemRowSet, TestShardedMemRowSet) {
+  FLAGS_memrowset_num_shards = 4;
+  constexpr int kNumRows = 100;
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              MemTracker::GetRootTracker(), &mrs));
+
+  // Insert the rows in reverse key order.
+  for (int i = kNumRows - 1; i >= 0; i--) {
+    ASSERT_OK(InsertRow(mrs.get(), StringPrintf("row %03d", i), i));
+  }
+  ASSERT_EQ(kNumRows, mrs->entry_count());
+  ASSERT_TRUE(InsertRow(mrs.get(), "row 050", 0).IsAlreadyPresent());
+
+  OperationResultPB result;
+  ASSERT_OK(UpdateRow(mrs.get(), "row 010", 1000, &result));
+  ASSERT_OK(DeleteRow(mrs.get(), "row 020", &result));
+  bool present;
+  ASSERT_OK(CheckRowPresent(*mrs, "row 010", &present));
+  ASSERT_TRUE(present);
+  ASSERT_OK(CheckRowPresent(*mrs, "row 020", &present));
+  ASSERT_FALSE(present);
+  NO_FATALS(CheckValue(mrs, "row 010", R"((string key="row 010", uint32 val=1000))"));
+  NO_FATALS(CheckValue(mrs, "row 090", R"((string key="row 090", uint32 val=90))"));
+
+  unique_ptr<MemRowSet::Iterator> iter(mrs->NewIterator());
+  ASSERT_OK(iter->Init(nullptr));
+  for (int i = 0; i < kNumRows; i++) {
+    ASSERT_TRUE(iter->HasNext());
+    MRSRow row = iter->GetCurrentRow();
+    EXPECT_EQ(StringPrintf(R"((string key="row %03d", uint32 val=%d))", i, i),
+              schema_.DebugRow(row));
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->HasNext());
+  ASSERT_TRUE(CheckRowsAtSnapshot(mrs.get(), MvccSnapshot(mvcc_), kNumRows - 1));
+}
+
 // Test that inserting duplicate key data fails with Status::AlreadyPresent
 TEST_F(TestMemRowSet, TestInsertDuplicate) {
   shared_ptr<MemRowSet> mrs;
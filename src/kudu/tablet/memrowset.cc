@@ -46,6 +46,7 @@
 #include "kudu/tablet/tablet.pb.h"
 #include "kudu/tablet/txn_metadata.h"
 #include "kudu/util/flag_tags.h"
+#include "kudu/util/hash_util.h"
 #include "kudu/util/mem_tracker.h"
 #include "kudu/util/memory/memory.h"
 
@@ -53,6 +54,24 @@ DEFINE_bool(mrs_use_codegen, true, "whether the memrowset should use code "
             "generation for iteration");
 TAG_FLAG(mrs_use_codegen, hidden);
 
+DEFINE_int32(memrowset_num_shards, 1,
+             "The number of shards which the rows of a MemRowSet are spread across "
+             "by the hash of their keys. Each shard has its own tree and arena, so "
+             "more shards reduce the contention between concurrent writers to a "
+             "tablet, at the expense of merging the shards when scanning and "
+             "flushing the MemRowSet.");
+TAG_FLAG(memrowset_num_shards, advanced);
+TAG_FLAG(memrowset_num_shards, experimental);
+
+static bool ValidateMemRowSetNumShards(const char* flagname, int32_t value) {
+  if (value < 1) {
+    LOG(ERROR) << flagname << " must be at least 1. Received: " << value;
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(memrowset_num_shards, &ValidateMemRowSetNumShards);
+
 using kudu::consensus::OpId;
 using kudu::fs::IOContext;
 using kudu::log::LogAnchorRegistry;
@@ -132,8 +151,6 @@ MemRowSet::MemRowSet(int64_t id,
     allocator_(new MemoryTrackingBufferAllocator(
         HeapBufferAllocator::Get(),
         CreateMemTrackerForMemRowSet(id, std::move(parent_tracker)))),
-    arena_(new ThreadSafeMemoryTrackingArena(kInitialArenaSize, allocator_)),
-    tree_(arena_),
     debug_insert_count_(0),
     debug_update_count_(0),
     anchorer_(log_anchor_registry, Substitute("MemRowSet-$0$1", id_, txn_id_ ?
@@ -141,6 +158,12 @@ MemRowSet::MemRowSet(int64_t id,
     has_been_compacted_(false),
     live_row_count_(0) {
   CHECK(schema.has_column_ids());
+  const int num_shards = FLAGS_memrowset_num_shards;
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; i++) {
+    shards_.emplace_back(new Shard(std::make_shared<ThreadSafeMemoryTrackingArena>(
+        kInitialArenaSize, allocator_)));
+  }
   ANNOTATE_BENIGN_RACE(&debug_insert_count_, "insert count isnt accurate");
   ANNOTATE_BENIGN_RACE(&debug_update_count_, "update count isnt accurate");
 }
@@ -148,6 +171,14 @@ MemRowSet::MemRowSet(int64_t id,
 MemRowSet::~MemRowSet() {
 }
 
+MemRowSet::Shard* MemRowSet::ShardForKey(const Slice& encoded_key) const {
+  if (PREDICT_TRUE(shards_.size() == 1)) {
+    return shards_[0].get();
+  }
+  uint64_t hash = HashUtil::FastHash64(encoded_key.data(), encoded_key.size(), 0);
+  return shards_[hash % shards_.size()].get();
+}
+
 Status MemRowSet::DebugDumpImpl(int64_t* rows_left, vector<string>* lines) {
   unique_ptr<Iterator> iter(NewIterator());
   RETURN_NOT_OK(iter->Init(nullptr));
@@ -194,9 +225,10 @@ Status MemRowSet::Insert(Timestamp timestamp,
     faststring enc_key_buf;
     schema_.EncodeComparableKey(row, &enc_key_buf);
     Slice enc_key(enc_key_buf);
+    Shard* shard = ShardForKey(enc_key);
 
     btree::PreparedMutation<MSBTreeTraits> mutation(enc_key);
-    mutation.Prepare(&tree_);
+    mutation.Prepare(&shard->tree);
 
     // TODO: for now, the key ends up stored doubly --
     // once encoded in the btree key, and again in the value
@@ -212,7 +244,7 @@ Status MemRowSet::Insert(Timestamp timestamp,
       }
 
       // Insert a "reinsert" mutation.
-      return Reinsert(timestamp, row, &ms_row);
+      return Reinsert(timestamp, row, shard, &ms_row);
     }
 
     // Copy the non-encoded key onto the stack since we need
@@ -221,7 +253,7 @@ Status MemRowSet::Insert(Timestamp timestamp,
     mrsrow.header_->insertion_timestamp = timestamp;
     mrsrow.header_->redo_head = nullptr;
     mrsrow.header_->redo_tail = nullptr;
-    RETURN_NOT_OK(mrsrow.CopyRow(row, arena_.get()));
+    RETURN_NOT_OK(mrsrow.CopyRow(row, shard->arena.get()));
 
     CHECK(mutation.Insert(mrsrow_slice))
         << "Expected to be able to insert, since the prepared mutation "
@@ -235,7 +267,8 @@ Status MemRowSet::Insert(Timestamp timestamp,
   return Status::OK();
 }
 
-Status MemRowSet::Reinsert(Timestamp timestamp, const ConstContiguousRow& row, MRSRow *ms_row) {
+Status MemRowSet::Reinsert(Timestamp timestamp, const ConstContiguousRow& row,
+                           Shard* shard, MRSRow *ms_row) {
   DCHECK_SCHEMA_EQ(schema_, *row.schema());
 
   // Encode the REINSERT mutation
@@ -244,7 +277,8 @@ Status MemRowSet::Reinsert(Timestamp timestamp, const ConstContiguousRow& row, M
   encoder.SetToReinsert(row);
 
   // Move the REINSERT mutation itself into our Arena.
-  Mutation *mut = Mutation::CreateInArena(arena_.get(), timestamp, encoder.as_changelist());
+  Mutation *mut = Mutation::CreateInArena(shard->arena.get(), timestamp,
+                                          encoder.as_changelist());
 
   // Append the mutation into the row's mutation list.
   // This function has "release" semantics which ensures that the memory writes
@@ -264,8 +298,9 @@ Status MemRowSet::MutateRow(Timestamp timestamp,
                             ProbeStats* stats,
                             OperationResultPB *result) {
   {
+    Shard* shard = ShardForKey(probe.encoded_key_slice());
     btree::PreparedMutation<MSBTreeTraits> mutation(probe.encoded_key_slice());
-    mutation.Prepare(&tree_);
+    mutation.Prepare(&shard->tree);
 
     if (!mutation.exists()) {
       return Status::NotFound("not in memrowset");
@@ -281,7 +316,7 @@ Status MemRowSet::MutateRow(Timestamp timestamp,
     }
 
     // Append to the linked list of mutations for this row.
-    Mutation *mut = Mutation::CreateInArena(arena_.get(), timestamp, delta);
+    Mutation *mut = Mutation::CreateInArena(shard->arena.get(), timestamp, delta);
 
     // This function has "release" semantics which ensures that the memory writes
     // for the mutation are fully published before any concurrent reader sees
@@ -313,8 +348,9 @@ Status MemRowSet::CheckRowPresent(const RowSetKeyProbe &probe, const IOContext*
 
   stats->mrs_consulted++;
 
+  Shard* shard = ShardForKey(probe.encoded_key_slice());
   btree::PreparedMutation<MSBTreeTraits> mutation(probe.encoded_key_slice());
-  mutation.Prepare(const_cast<MSBTree *>(&tree_));
+  mutation.Prepare(&shard->tree);
 
   if (!mutation.exists()) {
     *present = false;
@@ -335,7 +371,14 @@ Status MemRowSet::CheckRowPresent(const RowSetKeyProbe &probe, const IOContext*
 }
 
 MemRowSet::Iterator* MemRowSet::NewIterator(const RowIteratorOptions& opts) const {
-  return new MemRowSet::Iterator(shared_from_this(), tree_.NewIterator(), opts);
+  vector<unique_ptr<MSBTIter>> iters;
+  iters.reserve(shards_.size());
+  for (const auto& shard : shards_) {
+    iters.emplace_back(shard->tree.NewIterator());
+  }
+  return new MemRowSet::Iterator(shared_from_this(),
+                                 new MergingTreeIterator(std::move(iters)),
+                                 opts);
 }
 
 MemRowSet::Iterator* MemRowSet::NewIterator() const {
@@ -433,8 +476,43 @@ unique_ptr<MRSRowProjector> GenerateAppropriateProjector(
 
 } // anonymous namespace
 
+MemRowSet::MergingTreeIterator::MergingTreeIterator(vector<unique_ptr<MSBTIter>> iters)
+    : iters_(std::move(iters)),
+      cur_(nullptr) {
+  DCHECK(!iters_.empty());
+}
+
+bool MemRowSet::MergingTreeIterator::SeekToStart() {
+  for (const auto& iter : iters_) {
+    iter->SeekToStart();
+  }
+  UpdateCurrent();
+  return IsValid();
+}
+
+bool MemRowSet::MergingTreeIterator::SeekAtOrAfter(const Slice& key, bool* exact) {
+  *exact = false;
+  for (const auto& iter : iters_) {
+    bool iter_exact = false;
+    iter->SeekAtOrAfter(key, &iter_exact);
+    *exact |= iter_exact;
+  }
+  UpdateCurrent();
+  return IsValid();
+}
+
+void MemRowSet::MergingTreeIterator::UpdateCurrent() {
+  cur_ = nullptr;
+  for (const auto& iter : iters_) {
+    if (iter->IsValid() &&
+        (cur_ == nullptr || iter->GetCurrentKey().compare(cur_->GetCurrentKey()) < 0)) {
+      cur_ = iter.get();
+    }
+  }
+}
+
 MemRowSet::Iterator::Iterator(const std::shared_ptr<const MemRowSet>& mrs,
-                              MemRowSet::MSBTIter* iter,
+                              MemRowSet::MergingTreeIterator* iter,
                               RowIteratorOptions opts)
     : memrowset_(mrs),
       iter_(iter),
@@ -25,6 +25,7 @@
 #include <ostream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <glog/logging.h>
@@ -192,7 +193,10 @@ struct MSBTreeTraits : public btree::BTreeTraits {
 // This is a holding area for inserts, currently held in row form
 // (i.e not columnar)
 //
-// The data is kept sorted.
+// The data is kept sorted. The rows may be spread across several shards by
+// the hash of their keys (see --memrowset_num_shards), each with its own tree
+// and arena, so that concurrent writers contend less on the tree's nodes and
+// on the arena. The iterators merge the shards back into key order.
 class MemRowSet : public RowSet,
                   public std::enable_shared_from_this<MemRowSet>,
                   public enable_make_shared<MemRowSet> {
@@ -245,7 +249,11 @@ class MemRowSet : public RowSet,
   // NOTE: this requires iterating all data, and is thus
   // not very fast.
   uint64_t entry_count() const {
-    return tree_.count();
+    uint64_t count = 0;
+    for (const auto& shard : shards_) {
+      count += shard->tree.count();
+    }
+    return count;
   }
 
   // Conform entry_count to RowSet
@@ -297,7 +305,12 @@ class MemRowSet : public RowSet,
 
   // Return true if there are no entries in the memrowset.
   bool empty() const {
-    return tree_.empty();
+    for (const auto& shard : shards_) {
+      if (!shard->tree.empty()) {
+        return false;
+      }
+    }
+    return true;
   }
 
   // TODO(todd): unit test me
@@ -310,7 +323,11 @@ class MemRowSet : public RowSet,
   // inserted into the memrowset, due to arena and data structure
   // overhead.
   size_t memory_footprint() const {
-    return arena_->memory_footprint();
+    size_t footprint = 0;
+    for (const auto& shard : shards_) {
+      footprint += shard->arena->memory_footprint();
+    }
+    return footprint;
   }
 
   // Return an iterator over the items in this memrowset.
@@ -373,7 +390,9 @@ class MemRowSet : public RowSet,
 
   // Mark the memrowset as frozen. See CBTree::Freeze()
   void Freeze() {
-    tree_.Freeze();
+    for (auto& shard : shards_) {
+      shard->tree.Freeze();
+    }
   }
 
   uint64_t debug_insert_count() const {
@@ -449,17 +468,35 @@ class MemRowSet : public RowSet,
 
  private:
   friend class Iterator;
+  class MergingTreeIterator;
+
+  typedef btree::CBTree<MSBTreeTraits> MSBTree;
+  typedef btree::CBTreeIterator<MSBTreeTraits> MSBTIter;
+
+  // A tree holding the rows whose keys hash to the shard, along with the
+  // arena storing them and their mutations.
+  struct Shard {
+    explicit Shard(std::shared_ptr<ThreadSafeMemoryTrackingArena> a)
+        : arena(std::move(a)),
+          tree(arena) {
+    }
+
+    std::shared_ptr<ThreadSafeMemoryTrackingArena> arena;
+    MSBTree tree;
+  };
+
+  // Return the shard which holds the row with the given encoded key.
+  Shard* ShardForKey(const Slice& encoded_key) const;
 
   // Perform a "Reinsert" -- handle an insertion into a row which was previously
   // inserted and deleted, but still has an entry in the MemRowSet.
   Status Reinsert(Timestamp timestamp,
                   const ConstContiguousRow& row,
+                  Shard* shard,
                   MRSRow *ms_row);
 
   Status DebugDumpImpl(int64_t* rows_left, std::vector<std::string>* lines) override;
 
-  typedef btree::CBTree<MSBTreeTraits> MSBTree;
-
   const int64_t id_;
   const Schema schema_;
 
@@ -468,11 +505,8 @@ class MemRowSet : public RowSet,
   scoped_refptr<TxnMetadata> txn_metadata_;
 
   std::shared_ptr<MemoryTrackingBufferAllocator> allocator_;
-  std::shared_ptr<ThreadSafeMemoryTrackingArena> arena_;
-
-  typedef btree::CBTreeIterator<MSBTreeTraits> MSBTIter;
 
-  MSBTree tree_;
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   // Approximate counts of mutations. This variable is updated non-atomically,
   // so it cannot be relied upon to be in any way accurate. It's only used
@@ -501,6 +535,51 @@ class MemRowSet : public RowSet,
   DISALLOW_COPY_AND_ASSIGN(MemRowSet);
 };
 
+// An iterator over the trees of all the shards of a MemRowSet, which yields
+// their entries in key order by picking the smallest of the current keys of
+// the shards' iterators. The keys of the shards are disjoint, so there are
+// no ties.
+class MemRowSet::MergingTreeIterator {
+ public:
+  explicit MergingTreeIterator(std::vector<std::unique_ptr<MSBTIter>> iters);
+
+  bool SeekToStart();
+
+  bool SeekAtOrAfter(const Slice& key, bool* exact);
+
+  bool IsValid() const {
+    return cur_ != nullptr;
+  }
+
+  bool Next() {
+    DCHECK(IsValid());
+    if (!cur_->Next() || iters_.size() > 1) {
+      UpdateCurrent();
+    }
+    return IsValid();
+  }
+
+  Slice GetCurrentKey() const {
+    DCHECK(IsValid());
+    return cur_->GetCurrentKey();
+  }
+
+  Slice GetCurrentValue() const {
+    DCHECK(IsValid());
+    return cur_->GetCurrentValue();
+  }
+
+ private:
+  // Point 'cur_' at the valid iterator with the smallest current key, or at
+  // null if all the iterators are exhausted.
+  void UpdateCurrent();
+
+  const std::vector<std::unique_ptr<MSBTIter>> iters_;
+  MSBTIter* cur_;
+
+  DISALLOW_COPY_AND_ASSIGN(MergingTreeIterator);
+};
+
 // An iterator through in-memory data stored in a MemRowSet.
 // This holds a reference to the MemRowSet, and so the memrowset
 // must not be freed while this iterator is outstanding.
@@ -532,11 +611,6 @@ class MemRowSet::Iterator : public RowwiseIterator {
     return key >= *exclusive_upper_bound_;
   }
 
-  size_t remaining_in_leaf() const {
-    DCHECK_NE(state_, kUninitialized) << "not initted";
-    return iter_->remaining_in_leaf();
-  }
-
   bool HasNext() const override {
     DCHECK_NE(state_, kUninitialized) << "not initted";
     return state_ != kFinished && iter_->IsValid();
@@ -594,7 +668,7 @@ class MemRowSet::Iterator : public RowwiseIterator {
   DISALLOW_COPY_AND_ASSIGN(Iterator);
 
   Iterator(const std::shared_ptr<const MemRowSet> &mrs,
-           MemRowSet::MSBTIter *iter, RowIteratorOptions opts);
+           MemRowSet::MergingTreeIterator *iter, RowIteratorOptions opts);
 
   // Retrieves a block of dst->nrows() rows from the MemRowSet.
   //
@@ -630,7 +704,7 @@ class MemRowSet::Iterator : public RowwiseIterator {
                                       ApplyStatus* apply_status);
 
   const std::shared_ptr<const MemRowSet> memrowset_;
-  std::unique_ptr<MemRowSet::MSBTIter> iter_;
+  std::unique_ptr<MemRowSet::MergingTreeIterator> iter_;
 
   const RowIteratorOptions opts_;
 
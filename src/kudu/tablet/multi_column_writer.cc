@@ -17,15 +17,21 @@
 
 #include "kudu/tablet/multi_column_writer.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
 
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/rowblock.h"
+#include "kudu/common/rowblock_memory.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/fs/block_id.h"
@@ -33,6 +39,16 @@
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(rowset_column_writer_inject_finish_failure_col_idx, -1,
+             "Index of the column of the rowsets for which finishing the "
+             "column's writer fails with an injected error. If -1, no errors "
+             "are injected. For testing only!");
+TAG_FLAG(rowset_column_writer_inject_finish_failure_col_idx, unsafe);
+TAG_FLAG(rowset_column_writer_inject_finish_failure_col_idx, hidden);
 
 using kudu::cfile::CFileWriter;
 using kudu::fs::BlockCreationTransaction;
@@ -41,23 +57,42 @@ using kudu::fs::WritableBlock;
 using std::map;
 using std::string;
 using std::unique_ptr;
+using std::vector;
 using strings::Substitute;
 
 namespace kudu {
 namespace tablet {
 
+namespace {
+
+// The maximum number of rows buffered to be appended to the columns in
+// parallel, and the maximum size of their indirect data.
+constexpr size_t kMaxBufferedRows = 16 * 1024;
+constexpr size_t kMaxBufferedIndirectBytes = 16 * 1024 * 1024;
+
+} // anonymous namespace
+
 MultiColumnWriter::MultiColumnWriter(FsManager* fs,
                                      const Schema* schema,
-                                     string tablet_id)
+                                     string tablet_id,
+                                     ThreadPool* column_writer_pool)
     : fs_(fs),
       schema_(DCHECK_NOTNULL(schema)),
       tablet_id_(std::move(tablet_id)),
+      column_writer_pool_(column_writer_pool),
       open_(false),
-      finished_(false) {
+      finished_(false),
+      num_buffered_rows_(0) {
   cfile_writers_.reserve(schema_->num_columns());
   block_ids_.reserve(schema_->num_columns());
 }
 
+MultiColumnWriter::~MultiColumnWriter() {
+  if (col_writer_token_) {
+    col_writer_token_->Shutdown();
+  }
+}
+
 Status MultiColumnWriter::Open() {
   DCHECK(!open_) << "already open";
   DCHECK(cfile_writers_.empty()); // this method isn't re-entrant after failures
@@ -73,6 +108,10 @@ Status MultiColumnWriter::Open() {
     // the corresponding rows.
     opts.write_posidx = true;
 
+    // Collect per-block statistics, so scans with predicates on the column
+    // can skip over data blocks.
+    opts.write_zone_map = true;
+
     // Set the column storage attributes.
     opts.storage_attributes = col.attributes();
 
@@ -99,6 +138,11 @@ Status MultiColumnWriter::Open() {
     cfile_writers_.emplace_back(std::move(writer));
     block_ids_.emplace_back(block_id);
   }
+  if (column_writer_pool_ && schema_->num_columns() > 1) {
+    col_writer_token_ = column_writer_pool_->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+    buffer_memory_.reset(new RowBlockMemory());
+    buffer_.reset(new RowBlock(schema_, kMaxBufferedRows, buffer_memory_.get()));
+  }
   open_ = true;
   VLOG(1) << Substitute("Opened CFile writers for $0 column(s)",
                         cfile_writers_.size());
@@ -108,35 +152,113 @@ Status MultiColumnWriter::Open() {
 
 Status MultiColumnWriter::AppendBlock(const RowBlock& block) {
   DCHECK(open_);
-  for (auto i = 0; i < schema_->num_columns(); ++i) {
-    ColumnBlock column = block.column_block(i);
-    if (column.type_info()->is_array()) {
-      RETURN_NOT_OK(cfile_writers_[i]->AppendNullableArrayEntries(
-          column.non_null_bitmap(), column.data(), column.nrows()));
-    } else {
-      if (column.is_nullable()) {
-        RETURN_NOT_OK(cfile_writers_[i]->AppendNullableEntries(
-            column.non_null_bitmap(), column.data(), column.nrows()));
-      } else {
-        RETURN_NOT_OK(cfile_writers_[i]->AppendEntries(column.data(), column.nrows()));
-      }
+  if (!buffer_) {
+    return AppendBlockToColumns(block);
+  }
+
+  // The selection vector is ignored, so copy all of the rows.
+  if (!all_selected_ || all_selected_->nrows() < block.nrows()) {
+    all_selected_.reset(new SelectionVector(block.nrows()));
+    all_selected_->SetAllTrue();
+  }
+  size_t num_copied = 0;
+  while (num_copied < block.nrows()) {
+    const size_t num_rows = std::min(block.nrows() - num_copied,
+                                     kMaxBufferedRows - num_buffered_rows_);
+    for (auto i = 0; i < schema_->num_columns(); ++i) {
+      ColumnBlock dst = buffer_->column_block(i);
+      RETURN_NOT_OK(block.column_block(i).CopyTo(
+          *all_selected_, &dst, num_copied, num_buffered_rows_, num_rows));
+    }
+    num_copied += num_rows;
+    num_buffered_rows_ += num_rows;
+    if (num_buffered_rows_ == kMaxBufferedRows ||
+        buffer_memory_->arena.memory_footprint() > kMaxBufferedIndirectBytes) {
+      RETURN_NOT_OK(FlushBuffer());
+    }
+  }
+  return Status::OK();
+}
+
+Status MultiColumnWriter::FlushBuffer() {
+  if (num_buffered_rows_ == 0) {
+    return Status::OK();
+  }
+  buffer_->Resize(num_buffered_rows_);
+  Status s = AppendBlockToColumns(*buffer_);
+  buffer_->Resize(kMaxBufferedRows);
+  buffer_memory_->Reset();
+  num_buffered_rows_ = 0;
+  return s;
+}
+
+Status MultiColumnWriter::AppendBlockToColumns(const RowBlock& block) {
+  return RunOnColumns([this, &block](size_t col_idx) {
+    return this->AppendBlockToColumn(block, col_idx);
+  });
+}
+
+Status MultiColumnWriter::RunOnColumns(const std::function<Status(size_t)>& f) {
+  if (!col_writer_token_) {
+    for (auto i = 0; i < schema_->num_columns(); ++i) {
+      RETURN_NOT_OK(f(i));
+    }
+    return Status::OK();
+  }
+
+  // Run on the first column on this thread, and on the others on the pool.
+  vector<Status> statuses(schema_->num_columns());
+  for (auto i = 1; i < schema_->num_columns(); ++i) {
+    Status s = col_writer_token_->Submit([&f, &statuses, i]() {
+      statuses[i] = f(i);
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      statuses[i] = f(i);
     }
   }
+  statuses[0] = f(0);
+  col_writer_token_->Wait();
+  for (const auto& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
   return Status::OK();
 }
 
+Status MultiColumnWriter::AppendBlockToColumn(const RowBlock& block, size_t col_idx) {
+  ColumnBlock column = block.column_block(col_idx);
+  if (column.type_info()->is_array()) {
+    return cfile_writers_[col_idx]->AppendNullableArrayEntries(
+        column.non_null_bitmap(), column.data(), column.nrows());
+  }
+  if (column.is_nullable()) {
+    return cfile_writers_[col_idx]->AppendNullableEntries(
+        column.non_null_bitmap(), column.data(), column.nrows());
+  }
+  return cfile_writers_[col_idx]->AppendEntries(column.data(), column.nrows());
+}
+
 Status MultiColumnWriter::FinishAndReleaseBlocks(
     BlockCreationTransaction* transaction) {
   DCHECK(open_);
   DCHECK(!finished_);
-  for (auto i = 0; i < schema_->num_columns(); ++i) {
-    auto s = cfile_writers_[i]->FinishAndReleaseBlock(transaction);
+  if (buffer_) {
+    RETURN_NOT_OK(FlushBuffer());
+  }
+  // Finish the columns in parallel if possible, but release their blocks to
+  // the transaction one at a time, since it isn't thread-safe.
+  RETURN_NOT_OK(RunOnColumns([this](size_t col_idx) {
+    auto s = PREDICT_FALSE(col_idx == FLAGS_rowset_column_writer_inject_finish_failure_col_idx)
+        ? Status::IOError("injected column writer finish failure")
+        : cfile_writers_[col_idx]->FinishAndFinalizeBlock();
     if (PREDICT_FALSE(!s.ok())) {
       LOG(ERROR) << Substitute(
           "tablet $0: unable to finialize writer for column $1",
-          tablet_id_, schema_->column(i).ToString());
-      return s;
+          tablet_id_, schema_->column(col_idx).ToString());
     }
+    return s;
+  }));
+  for (auto& writer : cfile_writers_) {
+    writer->ReleaseBlock(transaction);
   }
   finished_ = true;
   return Status::OK();
@@ -157,6 +279,14 @@ size_t MultiColumnWriter::written_size() const {
   for (const auto& writer: cfile_writers_) {
     size += writer->written_size();
   }
+  // The buffered rows are written to the columns before they're finished, and
+  // rowsets are rolled based on this size, so count them as well.
+  if (num_buffered_rows_ > 0) {
+    for (auto i = 0; i < schema_->num_columns(); ++i) {
+      size += num_buffered_rows_ * schema_->column(i).type_info()->size();
+    }
+    size += buffer_memory_->arena.memory_footprint();
+  }
   return size;
 }
 
@@ -16,6 +16,7 @@
 // under the License.
 
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -33,7 +34,11 @@ namespace kudu {
 class FsManager;
 class RowBlock;
 class Schema;
+class SelectionVector;
+class ThreadPool;
+class ThreadPoolToken;
 struct ColumnId;
+struct RowBlockMemory;
 
 namespace fs {
 class BlockCreationTransaction;
@@ -43,13 +48,20 @@ namespace tablet {
 
 // Wrapper which writes several columns in parallel corresponding to some
 // Schema. Written blocks will fall in the tablet_id's data dir group.
+//
+// If 'column_writer_pool' is set, the appended rows are buffered, and the
+// buffered rows are appended to the columns on that pool, one task per column,
+// so that the encoding, compression and writing of the columns' data blocks
+// run in parallel. The columns are finished in parallel as well. The pool is
+// shared with other writers and must outlive this writer.
 class MultiColumnWriter final {
  public:
   MultiColumnWriter(FsManager* fs,
                     const Schema* schema,
-                    std::string tablet_id);
+                    std::string tablet_id,
+                    ThreadPool* column_writer_pool = nullptr);
 
-  ~MultiColumnWriter() = default;
+  ~MultiColumnWriter();
 
   // Open and start writing the columns.
   Status Open();
@@ -63,7 +75,8 @@ class MultiColumnWriter final {
   // blocks and releasing them to 'transaction'.
   Status FinishAndReleaseBlocks(fs::BlockCreationTransaction* transaction);
 
-  // Return the number of bytes written so far.
+  // Return the number of bytes written so far, including the uncompressed
+  // size of the rows which are buffered to be written in parallel.
   size_t written_size() const;
 
   cfile::CFileWriter* writer_for_col_idx(size_t i) {
@@ -77,15 +90,46 @@ class MultiColumnWriter final {
   void GetFlushedBlocksByColumnId(std::map<ColumnId, BlockId>* ret) const;
 
  private:
+  // Append the given block to the output columns, in parallel if
+  // 'col_writer_token_' is set.
+  Status AppendBlockToColumns(const RowBlock& block);
+
+  // Append the given block to the output column with the given index.
+  Status AppendBlockToColumn(const RowBlock& block, size_t col_idx);
+
+  // Call 'f' with the index of every output column, in parallel if
+  // 'col_writer_token_' is set, and return the first error in column order.
+  Status RunOnColumns(const std::function<Status(size_t)>& f);
+
+  // Append the rows buffered in 'buffer_' to the output columns, and empty
+  // the buffer.
+  Status FlushBuffer();
+
   FsManager* const fs_;
   const Schema* const schema_;
   const std::string tablet_id_;
+  ThreadPool* const column_writer_pool_;
 
   std::vector<std::unique_ptr<cfile::CFileWriter>> cfile_writers_;
   std::vector<BlockId> block_ids_;
   bool open_;
   bool finished_;
 
+  // Used to append to the columns in parallel. Null if the columns are
+  // written sequentially.
+  std::unique_ptr<ThreadPoolToken> col_writer_token_;
+
+  // The rows which are waiting to be appended to the columns in parallel,
+  // and the memory holding their indirect data. Rows are buffered so that
+  // every column task appends many rows.
+  std::unique_ptr<RowBlockMemory> buffer_memory_;
+  std::unique_ptr<RowBlock> buffer_;
+  size_t num_buffered_rows_;
+
+  // A selection vector with all rows selected, to copy every appended row
+  // into 'buffer_'.
+  std::unique_ptr<SelectionVector> all_selected_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiColumnWriter);
 };
 
@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/rowset.h"
 
+#include <cstddef>
 #include <limits>
 #include <memory>
 #include <string>
@@ -47,7 +48,10 @@ RowIteratorOptions::RowIteratorOptions()
     : projection(nullptr),
       snap_to_include(MvccSnapshot::CreateSnapshotIncludingAllOps()),
       order(OrderMode::UNORDERED),
-      include_deleted_rows(false) {}
+      include_deleted_rows(false),
+      scan_pool(nullptr),
+      scan_parallelism(1),
+      readahead_pool(nullptr) {}
 
 Status RowSet::DebugDump(std::vector<std::string>* lines) {
   return DebugDumpImpl(nullptr /* rows_left */, lines);
@@ -73,6 +77,20 @@ Status RowSet::NewRowIteratorWithBounds(const RowIteratorOptions& opts,
   return Status::OK();
 }
 
+Status RowSet::CheckRowsPresent(const vector<const RowSetKeyProbe*>& probes,
+                                const vector<ProbeStats*>& stats,
+                                const IOContext* io_context,
+                                vector<bool>* present) const {
+  DCHECK_EQ(probes.size(), stats.size());
+  present->resize(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    bool row_present;
+    RETURN_NOT_OK(CheckRowPresent(*probes[i], io_context, &row_present, stats[i]));
+    (*present)[i] = row_present;
+  }
+  return Status::OK();
+}
+
 DuplicatingRowSet::DuplicatingRowSet(RowSetVector old_rowsets,
                                      RowSetVector new_rowsets)
     : old_rowsets_(std::move(old_rowsets)),
@@ -47,6 +47,7 @@ class RowChangeList;
 class RowwiseIterator;
 class Schema;
 class Slice;
+class ThreadPool;
 struct ColumnId;
 struct IterWithBounds;
 
@@ -102,6 +103,21 @@ struct RowIteratorOptions {
   //
   // Defaults to false.
   bool include_deleted_rows;
+
+  // The pool on which to scan the rowsets of an UNORDERED iteration in
+  // parallel, reading rows ahead of the caller, and the maximum number of
+  // rowsets to scan concurrently. Rowsets are scanned by the caller's thread
+  // if there is no pool or the parallelism is 1.
+  //
+  // Defaults to nullptr and 1.
+  ThreadPool* scan_pool;
+  int scan_parallelism;
+
+  // The pool on which the data blocks of the rowsets' columns are read ahead
+  // of the scan. See --cfile_readahead_blocks.
+  //
+  // Defaults to nullptr, in which case no blocks are read ahead.
+  ThreadPool* readahead_pool;
 };
 
 class RowSet {
@@ -133,6 +149,18 @@ class RowSet {
   virtual Status CheckRowPresent(const RowSetKeyProbe &probe, const fs::IOContext* io_context,
                                  bool *present, ProbeStats* stats) const = 0;
 
+  // Check if each of the given row keys is present in this rowset, like
+  // CheckRowPresent() does, setting (*present)[i] for 'probes[i]' and
+  // recording the lookups in 'stats[i]'. The probes must be sorted by their
+  // encoded keys, so that implementations may share the work of looking up
+  // consecutive keys.
+  //
+  // The default implementation checks the keys one at a time.
+  virtual Status CheckRowsPresent(const std::vector<const RowSetKeyProbe*>& probes,
+                                  const std::vector<ProbeStats*>& stats,
+                                  const fs::IOContext* io_context,
+                                  std::vector<bool>* present) const;
+
   // Update/delete a row in this rowset.
   // The 'update_schema' is the client schema used to encode the 'update' RowChangeList.
   //
@@ -190,6 +190,33 @@ public:
     }
   }
 
+  // Scan the tablet with an equality predicate on the string column, which
+  // matches a single word of the dictionary.
+  void TestEqualityScanAndFilter(size_t cardinality, size_t value) {
+    if (GetParam() == LARGE && !AllowSlowTests()) {
+      GTEST_SKIP() << "Skipped large test case";
+    }
+    size_t nrows = static_cast<size_t>(GetParam());
+    size_t strlen = std::max(static_cast<size_t>(FLAGS_decoder_eval_test_strlen),
+                             Substitute("$0", cardinality).length());
+    FillTestTablet(nrows, cardinality, strlen, -1);
+
+    Arena arena(128);
+    ScanSpec spec;
+    const string value_string = LeftZeroPadded(value, strlen);
+    Slice value_slice(value_string);
+    spec.AddPredicate(ColumnPredicate::Equality(schema_.column(2), &value_slice));
+    spec.OptimizeScan(schema_, &arena, true);
+    unique_ptr<RowwiseIterator> iter;
+    ASSERT_OK(tablet()->NewRowIterator(client_schema_, &iter));
+    ASSERT_OK(iter->Init(&spec));
+    ASSERT_TRUE(spec.predicates().empty()) << "Should have accepted all predicates";
+
+    int fetched = 0;
+    ASSERT_OK(SilentIterateToStringList(iter.get(), &fetched));
+    ASSERT_EQ(ExpectedCount(nrows, cardinality, value, value + 1), fetched);
+  }
+
   size_t ExpectedCount(size_t nrows, size_t cardinality, size_t lower, size_t upper) {
     if (lower >= upper || lower >= cardinality) {
       return 0;
@@ -299,6 +326,19 @@ TEST_P(TabletDecoderEvalTest, EvaluateEmpty) {
   TestScanAndFilter(50, 50, 55);
 }
 
+TEST_P(TabletDecoderEvalTest, EvaluateAllMatching) {
+  // Predicate [0, 50) matches every word in the dictionary.
+  TestScanAndFilter(50, 0, 50);
+}
+
+TEST_P(TabletDecoderEvalTest, EqualityLowCardinality) {
+  TestEqualityScanAndFilter(50, 17);
+}
+
+TEST_P(TabletDecoderEvalTest, EqualityHighCardinality) {
+  TestEqualityScanAndFilter(50000, 1234);
+}
+
 TEST_P(TabletDecoderEvalTest, NullableLowCardinality) {
   // Fill a tablet with pattern [0, 50) but with values [0, 40) as NULL.
   // Query for values [30, 50).
@@ -1232,7 +1232,15 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
   // RowSet) one at a time. So, the callback itself aggregates results into
   // 'pending_group' and then calls 'ProcessPendingGroup' when the next group
   // begins.
+  //
+  // The keys of each group which haven't been found present in an earlier
+  // group are checked against the RowSet in a single batch, which lets it
+  // share its bloom filter and key index lookups between them.
   vector<pair<RowSet*, int>> pending_group;
+  vector<const RowSetKeyProbe*> group_probes;
+  vector<ProbeStats*> group_stats;
+  vector<RowOp*> group_ops;
+  vector<bool> group_present;
   Status s;
   const auto& ProcessPendingGroup = [&]() {
     if (pending_group.empty() || !s.ok()) return;
@@ -1244,6 +1252,9 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
                             return keys[a.second] < keys[b.second];
                           }));
     RowSet* rs = pending_group[0].first;
+    group_probes.clear();
+    group_stats.clear();
+    group_ops.clear();
     for (auto it = pending_group.begin(); it != pending_group.end(); ++it) {
       DCHECK_EQ(it->first, rs) << "All results within a group should be for the same RowSet";
       int op_idx = keys_and_indexes[it->second].second;
@@ -1252,20 +1263,24 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
         // Already found this op present somewhere.
         continue;
       }
+      group_probes.push_back(op->key_probe);
+      group_stats.push_back(op_state->mutable_op_stats(op_idx));
+      group_ops.push_back(op);
+    }
+    pending_group.clear();
+    if (group_ops.empty()) return;
 
-      bool present = false;
-      s = rs->CheckRowPresent(*op->key_probe, io_context,
-                              &present, op_state->mutable_op_stats(op_idx));
-      if (PREDICT_FALSE(!s.ok())) {
-        LOG(WARNING) << Substitute("Tablet $0 failed to check row presence for op $1: $2",
-            tablet_id(), op->ToString(key_schema_), s.ToString());
-        return;
-      }
-      if (present) {
-        op->present_in_rowset = rs;
+    s = rs->CheckRowsPresent(group_probes, group_stats, io_context, &group_present);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << Substitute("Tablet $0 failed to check row presence in $1: $2",
+          tablet_id(), rs->ToString(), s.ToString());
+      return;
+    }
+    for (int i = 0; i < group_ops.size(); i++) {
+      if (group_present[i]) {
+        group_ops[i]->present_in_rowset = rs;
       }
     }
-    pending_group.clear();
   };
   comps->rowsets->ForEachRowSetContainingKeys(
       keys,
@@ -1516,7 +1531,8 @@ Status Tablet::DoMajorDeltaCompaction(const vector<ColumnId>& col_ids,
                                       const IOContext* io_context) {
   RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
   Status s = down_cast<DiskRowSet*>(input_rs.get())
-      ->MajorCompactDeltaStoresWithColumnIds(col_ids, io_context, GetHistoryGcOpts());
+      ->MajorCompactDeltaStoresWithColumnIds(col_ids, io_context, GetHistoryGcOpts(),
+                                             column_writer_pool_);
   return s;
 }
 
@@ -2079,7 +2095,8 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompactionOrFlush &input,
 
   // Initializing a DRS writer, to be used later for writing REDO, UNDO deltas, delta stats, etc.
   RollingDiskRowSetWriter drsw(metadata_.get(), merge->schema(), DefaultBloomSizing(),
-                               compaction_policy_->target_rowset_size());
+                               compaction_policy_->target_rowset_size(),
+                               column_writer_pool_);
   RETURN_NOT_OK_PREPEND(drsw.Open(), "Failed to open DiskRowSet for flush");
 
   // Get tablet history, to be used later for AHM validation checks.
@@ -2892,7 +2909,8 @@ Status Tablet::MajorCompactAllDeltaStoresForTests() {
     DiskRowSet* drs = down_cast<DiskRowSet*>(rs.get());
     RETURN_NOT_OK(drs->mutable_delta_tracker()->InitAllDeltaStoresForTests(
         DeltaTracker::REDOS_ONLY));
-    RETURN_NOT_OK_PREPEND(drs->MajorCompactDeltaStores(&io_context, GetHistoryGcOpts()),
+    RETURN_NOT_OK_PREPEND(drs->MajorCompactDeltaStores(&io_context, GetHistoryGcOpts(),
+                                                       column_writer_pool_),
                           "Failed major delta compaction on " + rs->ToString());
   }
   return Status::OK();
@@ -2927,7 +2945,8 @@ Status Tablet::CompactWorstDeltas(RowSet::DeltaCompactionType type) {
                           "Failed minor delta compaction on " + rs->ToString());
   } else if (type == RowSet::MAJOR_DELTA_COMPACTION) {
     RETURN_NOT_OK_PREPEND(
-        down_cast<DiskRowSet*>(rs.get())->MajorCompactDeltaStores(&io_context, GetHistoryGcOpts()),
+        down_cast<DiskRowSet*>(rs.get())->MajorCompactDeltaStores(
+            &io_context, GetHistoryGcOpts(), column_writer_pool_),
         "Failed major delta compaction on " + rs->ToString());
   }
   return Status::OK();
@@ -3376,7 +3395,13 @@ Status Tablet::Iterator::Init(ScanSpec *spec) {
       break;
     case UNORDERED:
     default:
-      iter_ = NewUnionIterator(std::move(iters));
+      if (opts_.scan_pool && opts_.scan_parallelism > 1 && iters.size() > 1) {
+        iter_ = NewParallelUnionIterator(
+            ParallelUnionIteratorOptions(opts_.scan_pool, opts_.scan_parallelism),
+            std::move(iters));
+      } else {
+        iter_ = NewUnionIterator(std::move(iters));
+      }
       break;
   }
 
@@ -71,6 +71,7 @@ class RowBlock;
 class ScanSpec;
 class TabletHistoryGcITest;
 class TabletHistoryGcITest_TestUndoDeltaBlockGc_Test;
+class ThreadPool;
 class Throttler;
 class Timestamp;
 struct IterWithBounds;
@@ -477,6 +478,12 @@ class Tablet {
 
   clock::Clock* clock() const { return clock_; }
 
+  // Sets the pool on which flushes and compactions write the columns of their
+  // rowsets in parallel. It's owned by the server, and must be set before the
+  // tablet starts flushing or compacting. If it's never set, the columns are
+  // written one after another.
+  void set_column_writer_pool(ThreadPool* pool) { column_writer_pool_ = pool; }
+
   std::string LogPrefix() const;
 
   // Return 'true' if the tablet's data may be compacted,
@@ -886,6 +893,9 @@ class Tablet {
   // A pointer to the server's clock.
   clock::Clock* clock_;
 
+  // The server's pool for writing rowset columns in parallel, or null.
+  ThreadPool* column_writer_pool_ = nullptr;
+
   MvccManager mvcc_;
 
   LockManager lock_manager_;
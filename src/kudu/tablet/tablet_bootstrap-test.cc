@@ -27,6 +27,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -75,6 +76,8 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_int64(tablet_bootstrap_log_prefetch_bytes);
+
 using kudu::consensus::ConsensusBootstrapInfo;
 using kudu::consensus::ConsensusMetadata;
 using kudu::consensus::ConsensusMetadataManager;
@@ -210,6 +213,28 @@ class BootstrapTest : public LogTestBase {
     }
   }
 
+  // Bootstrap a tablet from a log of several segments of write operations,
+  // and check that all of them are replayed.
+  void BootstrapMultiSegmentLog() {
+    constexpr int kNumSegments = 5;
+    constexpr int kNumEntriesPerSegment = 20;
+    ASSERT_OK(BuildLog());
+    for (int i = 0; i < kNumSegments; i++) {
+      ASSERT_OK(AppendReplicateBatchAndCommitEntryPairsToLog(kNumEntriesPerSegment));
+      ASSERT_OK(RollLog());
+    }
+
+    shared_ptr<Tablet> tablet;
+    ConsensusBootstrapInfo boot_info;
+    ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+    ASSERT_OPID_EQ(MakeOpId(1, current_index_ - 1), boot_info.last_id);
+    ASSERT_TRUE(boot_info.orphaned_replicates.empty());
+
+    vector<string> results;
+    IterateTabletRows(tablet.get(), &results);
+    ASSERT_EQ(kNumSegments * kNumEntriesPerSegment, results.size());
+  }
+
   scoped_refptr<ConsensusMetadataManager> cmeta_manager_;
 };
 
@@ -241,6 +266,20 @@ TEST_F(BootstrapTest, TestBootstrap) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests bootstrapping a log of several segments while reading its entries
+// ahead of their replay, with as little read ahead as possible so that the
+// reading and the replay of the entries interleave.
+TEST_F(BootstrapTest, TestBootstrapWithLogPrefetch) {
+  FLAGS_tablet_bootstrap_log_prefetch_bytes = 1;
+  NO_FATALS(BootstrapMultiSegmentLog());
+}
+
+// Same as the above, but reading the entries as they're replayed.
+TEST_F(BootstrapTest, TestBootstrapWithoutLogPrefetch) {
+  FLAGS_tablet_bootstrap_log_prefetch_bytes = 0;
+  NO_FATALS(BootstrapMultiSegmentLog());
+}
+
 // Test that we don't overflow opids. Regression test for KUDU-1933.
 TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   // Start appending with a log index 3 under the int32 max value.
@@ -83,6 +83,7 @@
 #include "kudu/tablet/tablet_replica.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.pb.h"
+#include "kudu/util/blocking_queue.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/env.h"
 #include "kudu/util/env_util.h"
@@ -95,6 +96,7 @@
 #include "kudu/util/pb_util.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/thread.h"
 
 DECLARE_bool(prevent_kudu_2233_corruption);
 DECLARE_int32(group_commit_queue_size_bytes);
@@ -105,6 +107,16 @@ DEFINE_double(fault_crash_during_log_replay, 0.0,
               "(For testing only!)");
 TAG_FLAG(fault_crash_during_log_replay, unsafe);
 
+DEFINE_int64(tablet_bootstrap_log_prefetch_bytes, 64 * 1024 * 1024,
+             "Maximum number of bytes of log entries which are read ahead of "
+             "the entry being replayed during tablet bootstrap. The entries "
+             "are read, decompressed and decoded on a separate thread, "
+             "concurrently with the replay of the previous entries. If 0, "
+             "the entries are read on the bootstrapping thread as they're "
+             "replayed.");
+TAG_FLAG(tablet_bootstrap_log_prefetch_bytes, advanced);
+TAG_FLAG(tablet_bootstrap_log_prefetch_bytes, experimental);
+
 DECLARE_int32(max_clock_sync_error_usec);
 
 using kudu::clock::Clock;
@@ -184,6 +196,126 @@ class FlushedStoresSnapshot {
   DISALLOW_COPY_AND_ASSIGN(FlushedStoresSnapshot);
 };
 
+// Reads the entries of a sequence of log segments for replay, optionally on a
+// separate thread, so that reading the segments and decompressing and decoding
+// their entries overlaps with the replay of the entries read before them.
+//
+// The entries of every segment are returned in the order of the log, followed
+// by an end-of-segment item.
+class LogEntryPrefetcher {
+ public:
+  // An entry read from the log, or the end of a segment.
+  struct Item {
+    // The index of the segment in the sequence.
+    int segment_idx = 0;
+
+    // The result of reading the entry: EndOfFile at the end of the segment,
+    // or the error which stopped the reading.
+    Status status;
+
+    // The entry, if 'status' is OK.
+    unique_ptr<LogEntryPB> entry;
+
+    // The offsets of the segment's reader after reading the entry.
+    int64_t offset = 0;
+    int64_t read_up_to_offset = 0;
+  };
+
+  // 'segments' must outlive the prefetcher. If 'max_buffered_bytes' is 0,
+  // the entries are read in Next() rather than on a separate thread.
+  LogEntryPrefetcher(const log::SegmentSequence* segments, int64_t max_buffered_bytes)
+      : segments_(segments),
+        queue_(max_buffered_bytes),
+        segment_idx_(0) {
+  }
+
+  ~LogEntryPrefetcher() {
+    queue_.Shutdown();
+    if (thread_) {
+      thread_->Join();
+    }
+  }
+
+  // Start reading ahead, if enabled.
+  Status Start(const string& tablet_id) {
+    if (queue_.max_size() == 0) {
+      return Status::OK();
+    }
+    return Thread::Create("tablet-bootstrap", Substitute("log-prefetch $0", tablet_id),
+                          [this]() { this->RunThread(); }, &thread_);
+  }
+
+  // Get the next item. Returns false once all the segments have been read,
+  // or after an error has been returned.
+  bool Next(Item* item) {
+    if (thread_) {
+      return queue_.BlockingGet(item).ok();
+    }
+    if (segment_idx_ >= segments_->size()) {
+      return false;
+    }
+    ReadNext(item);
+    if (!item->status.ok()) {
+      // Stop after an error, like the prefetching thread does.
+      segment_idx_ = item->status.IsEndOfFile() ? segment_idx_ + 1 : segments_->size();
+    }
+    return true;
+  }
+
+ private:
+  struct ItemLogicalSize {
+    static size_t logical_size(const Item& item) {
+      return item.entry ? item.entry->ByteSizeLong() : 1;
+    }
+  };
+
+  // Read the next entry of the current segment into 'item', starting to read
+  // the segment if needed. At the end of the segment, the reader is reset.
+  void ReadNext(Item* item) {
+    if (!reader_) {
+      reader_.reset(new log::LogEntryReader((*segments_)[segment_idx_].get()));
+    }
+    item->segment_idx = segment_idx_;
+    item->status = reader_->ReadNextEntry(&item->entry);
+    item->offset = reader_->offset();
+    item->read_up_to_offset = reader_->read_up_to_offset();
+    if (!item->status.ok()) {
+      reader_.reset();
+    }
+  }
+
+  void RunThread() {
+    while (segment_idx_ < segments_->size()) {
+      Item item;
+      ReadNext(&item);
+      const Status s = item.status;
+      if (!queue_.BlockingPut(std::move(item)).ok()) {
+        // The consumer is gone.
+        return;
+      }
+      if (!s.ok()) {
+        if (!s.IsEndOfFile()) {
+          break;
+        }
+        segment_idx_++;
+      }
+    }
+    queue_.Shutdown();
+  }
+
+  const log::SegmentSequence* const segments_;
+
+  BlockingQueue<Item, ItemLogicalSize> queue_;
+
+  // The reading position. Only accessed by the reading thread, if there is one.
+  size_t segment_idx_;
+  unique_ptr<log::LogEntryReader> reader_;
+
+  scoped_refptr<Thread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogEntryPrefetcher);
+};
+
 // Bootstraps an existing tablet by opening the metadata from disk, and rebuilding soft
 // state by playing log segments. A bootstrapped tablet can then be added to an existing
 // consensus configuration as a LEARNER, which will bring its state up to date with the
@@ -1243,59 +1375,57 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
   auto last_status_update = MonoTime::Now();
   const auto kStatusUpdateInterval = MonoDelta::FromSeconds(5);
   int segment_count = 0;
-
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    log::LogEntryReader reader(segment.get());
-
-    int entry_count = 0;
-    while (true) {
-      {
-        unique_ptr<LogEntryPB> entry;
-        Status s = reader.ReadNextEntry(&entry);
-        if (PREDICT_FALSE(!s.ok())) {
-          if (s.IsEndOfFile()) {
-            break;
-          }
-          return Status::Corruption(
-              Substitute("Error reading Log Segment of tablet $0: $1 "
-                         "(Read up to entry $2 of segment $3, in path $4)",
-                         tablet_->tablet_id(),
-                         s.ToString(),
-                         entry_count,
-                         segment->header().sequence_number(),
-                         segment->path()));
-        }
-        entry_count++;
-
-        string entry_debug_info;
-        s = HandleEntry(io_context, &state, std::move(entry), &entry_debug_info);
-        if (PREDICT_FALSE(!s.ok())) {
-          DumpReplayStateToLog(state);
-          RETURN_NOT_OK_PREPEND(s, DebugInfo(tablet_->tablet_id(),
-                                             segment->header().sequence_number(),
-                                             entry_count, segment->path(),
-                                             entry_debug_info));
-        }
-      }
-
-      const auto now = MonoTime::Now();
-      if (now - last_status_update > kStatusUpdateInterval) {
-        SetStatusMessage(Substitute("Bootstrap replaying log segment $0/$1 "
-                                    "($2/$3 this segment, stats: $4)",
+  int entry_count = 0;
+
+  // Read the entries ahead of their replay, on a separate thread.
+  LogEntryPrefetcher prefetcher(&segments, FLAGS_tablet_bootstrap_log_prefetch_bytes);
+  RETURN_NOT_OK_PREPEND(prefetcher.Start(tablet_->tablet_id()),
+                        "Couldn't start reading log segments");
+  LogEntryPrefetcher::Item item;
+  while (prefetcher.Next(&item)) {
+    const scoped_refptr<ReadableLogSegment>& segment = segments[item.segment_idx];
+    if (PREDICT_FALSE(!item.status.ok())) {
+      if (item.status.IsEndOfFile()) {
+        SetStatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
+                                    "Stats: $2. Pending: $3 replicates",
                                     segment_count + 1, log_reader_->num_segments(),
-                                    HumanReadableNumBytes::ToString(reader.offset()),
-                                    HumanReadableNumBytes::ToString(reader.read_up_to_offset()),
-                                    stats_.ToString()));
-        last_status_update = now;
+                                    stats_.ToString(),
+                                    state.pending_replicates.size()));
+        segment_count++;
+        entry_count = 0;
+        continue;
       }
+      return Status::Corruption(
+          Substitute("Error reading Log Segment of tablet $0: $1 "
+                     "(Read up to entry $2 of segment $3, in path $4)",
+                     tablet_->tablet_id(),
+                     item.status.ToString(),
+                     entry_count,
+                     segment->header().sequence_number(),
+                     segment->path()));
+    }
+    entry_count++;
+
+    string entry_debug_info;
+    Status s = HandleEntry(io_context, &state, std::move(item.entry), &entry_debug_info);
+    if (PREDICT_FALSE(!s.ok())) {
+      DumpReplayStateToLog(state);
+      RETURN_NOT_OK_PREPEND(s, DebugInfo(tablet_->tablet_id(),
+                                         segment->header().sequence_number(),
+                                         entry_count, segment->path(),
+                                         entry_debug_info));
     }
 
-    SetStatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
-                                "Stats: $2. Pending: $3 replicates",
-                                segment_count + 1, log_reader_->num_segments(),
-                                stats_.ToString(),
-                                state.pending_replicates.size()));
-    segment_count++;
+    const auto now = MonoTime::Now();
+    if (now - last_status_update > kStatusUpdateInterval) {
+      SetStatusMessage(Substitute("Bootstrap replaying log segment $0/$1 "
+                                  "($2/$3 this segment, stats: $4)",
+                                  segment_count + 1, log_reader_->num_segments(),
+                                  HumanReadableNumBytes::ToString(item.offset),
+                                  HumanReadableNumBytes::ToString(item.read_up_to_offset),
+                                  stats_.ToString()));
+      last_status_update = now;
+    }
   }
 
   // If we have non-applied commits they all must belong to pending operations and
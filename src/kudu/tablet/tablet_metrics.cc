@@ -144,6 +144,14 @@ METRIC_DEFINE_counter(tablet, scanner_bytes_scanned_from_disk, "Scanner Bytes Sc
                       "includes both cache misses and cache hits.",
                       kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_counter(tablet, scanner_cells_skipped_from_disk, "Scanner Cells Skipped From Disk",
+                      kudu::MetricUnit::kCells,
+                      "Number of table cells read from disk by scan requests which were "
+                      "never decoded because their rows had already been filtered out by "
+                      "predicates on other columns or by deleted data. This is a subset of "
+                      "the cells counted by the Scanner Cells Scanned From Disk metric.",
+                      kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_counter(tablet, scans_started, "Scans Started",
                       kudu::MetricUnit::kScanners,
                       "Number of scanners which have been started on this tablet",
@@ -474,6 +482,7 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(scanner_rows_scanned),
     MINIT(scanner_cells_scanned_from_disk),
     MINIT(scanner_bytes_scanned_from_disk),
+    MINIT(scanner_cells_skipped_from_disk),
     MINIT(scanner_predicates_disabled),
     MINIT(scans_started),
     GINIT(tablet_active_scanners),
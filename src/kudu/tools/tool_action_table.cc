@@ -222,10 +222,10 @@ DECLARE_bool(strict_column_id);
 
 DEFINE_string(encoding_type, "AUTO_ENCODING",
               "Type of encoding for the column including AUTO_ENCODING, PLAIN_ENCODING, "
-              "PREFIX_ENCODING, RLE, DICT_ENCODING, BIT_SHUFFLE, GROUP_VARINT");
+              "PREFIX_ENCODING, RLE, DICT_ENCODING, BIT_SHUFFLE, FRAME_OF_REFERENCE, GROUP_VARINT");
 DEFINE_string(compression_type, "DEFAULT_COMPRESSION",
               "Type of compression for the column including DEFAULT_COMPRESSION, "
-              "NO_COMPRESSION, SNAPPY, LZ4, ZLIB");
+              "NO_COMPRESSION, SNAPPY, LZ4, ZLIB, ZSTD");
 DEFINE_string(default_value, "", "Default value for this column.");
 DEFINE_string(comment, "", "Comment for this column.");
 DEFINE_int32(column_precision, 0,
@@ -1654,6 +1654,9 @@ Status ToClientEncodingType(
     case ColumnPB::BIT_SHUFFLE :
       *type = KuduColumnStorageAttributes::BIT_SHUFFLE;
       break;
+    case ColumnPB::FRAME_OF_REFERENCE :
+      *type = KuduColumnStorageAttributes::FRAME_OF_REFERENCE;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected encoding type: $0", type_pb));
   }
@@ -1680,6 +1683,9 @@ Status ToClientCompressionType(
     case ColumnPB::ZLIB :
       *type = KuduColumnStorageAttributes::ZLIB;
       break;
+    case ColumnPB::ZSTD :
+      *type = KuduColumnStorageAttributes::ZSTD;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected compression type: $0", type_pb));
   }
@@ -30,8 +30,10 @@
 #include "kudu/common/column_predicate.h"
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/row_aggregator.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
+#include "kudu/common/top_n_selector.h"
 #include "kudu/gutil/dynamic_annotations.h"
 #include "kudu/gutil/hash/string_hash.h"
 #include "kudu/gutil/map-util.h"
@@ -83,6 +85,19 @@ DEFINE_int32(slow_scan_history_count, 10,
              "threshold for a slow scan is defined with --slow_scanner_threshold_ms.");
 TAG_FLAG(slow_scan_history_count, experimental);
 
+DEFINE_int32(scanner_parallel_scan_threads, 0,
+             "Maximum number of threads scanning the rowsets of tablets for scans "
+             "parallelized according to --scanner_max_parallelism, shared by all "
+             "such scans. If 0, the number of CPUs on the system is used.");
+TAG_FLAG(scanner_parallel_scan_threads, advanced);
+TAG_FLAG(scanner_parallel_scan_threads, experimental);
+
+DEFINE_int32(cfile_readahead_threads, 32,
+             "Maximum number of threads reading CFile data blocks ahead of "
+             "scans. See --cfile_readahead_blocks.");
+TAG_FLAG(cfile_readahead_threads, advanced);
+TAG_FLAG(cfile_readahead_threads, experimental);
+
 DECLARE_int32(rpc_default_keepalive_time_ms);
 
 METRIC_DEFINE_gauge_size(server, active_scanners,
@@ -156,6 +171,15 @@ ScannerManager::ScannerManager(const scoped_refptr<MetricEntity>& metric_entity)
   if (FLAGS_slow_scan_history_count > 0) {
     slow_scans_.reserve(FLAGS_slow_scan_history_count);
   }
+
+  ThreadPoolBuilder scan_pool_builder("scan");
+  if (FLAGS_scanner_parallel_scan_threads > 0) {
+    scan_pool_builder.set_max_threads(FLAGS_scanner_parallel_scan_threads);
+  }
+  CHECK_OK(scan_pool_builder.Build(&scan_pool_));
+  CHECK_OK(ThreadPoolBuilder("cfile-readahead")
+           .set_max_threads(FLAGS_cfile_readahead_threads)
+           .Build(&readahead_pool_));
 }
 
 ScannerManager::~ScannerManager() {
@@ -168,6 +192,8 @@ ScannerManager::~ScannerManager() {
     CHECK_OK(ThreadJoiner(removal_thread_.get()).Join());
   }
   STLDeleteElements(&scanner_maps_);
+  scan_pool_->Shutdown();
+  readahead_pool_->Shutdown();
 }
 
 Status ScannerManager::StartCollectAndRemovalThread() {
@@ -46,13 +46,16 @@
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/rw_mutex.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/threadpool.h"
 
 namespace kudu {
 
+class RowAggregator;
 class RowwiseIterator;
 class Schema;
 class Status;
 class Thread;
+class TopNSelector;
 
 namespace tserver {
 
@@ -132,6 +135,14 @@ class ScannerManager {
   // Collect slow scanners whose scan times exceed the threshold.
   void CollectSlowScanners();
 
+  // The pool on which the rowsets of parallel scans are scanned.
+  // See --scanner_max_parallelism.
+  ThreadPool* scan_pool() const { return scan_pool_.get(); }
+
+  // The pool on which scans read CFile data blocks ahead.
+  // See --cfile_readahead_blocks.
+  ThreadPool* readahead_pool() const { return readahead_pool_.get(); }
+
  private:
   FRIEND_TEST(ScannerTest, TestExpire);
 
@@ -193,6 +204,9 @@ class ScannerManager {
   // Thread to remove expired scanners.
   scoped_refptr<kudu::Thread> removal_thread_;
 
+  std::unique_ptr<ThreadPool> scan_pool_;
+  std::unique_ptr<ThreadPool> readahead_pool_;
+
   FunctionGaugeDetacher metric_detacher_;
 
   DISALLOW_COPY_AND_ASSIGN(ScannerManager);
@@ -304,6 +318,33 @@ class Scanner {
     return DCHECK_NOTNULL(iter_.get());
   }
 
+  // Set the aggregator of a scan which aggregates its rows instead of
+  // returning them.
+  void set_aggregator(std::unique_ptr<RowAggregator> aggregator) {
+    lock_.AssertAcquired();
+    aggregator_ = std::move(aggregator);
+  }
+
+  // Return the aggregator of the scan, or nullptr if it returns its rows.
+  RowAggregator* aggregator() {
+    lock_.AssertAcquired();
+    return aggregator_.get();
+  }
+
+  // Set the selector of a scan which returns only the first rows in some
+  // order.
+  void set_top_n_selector(std::unique_ptr<TopNSelector> top_n) {
+    lock_.AssertAcquired();
+    top_n_ = std::move(top_n);
+  }
+
+  // Return the top-N selector of the scan, or nullptr if it returns all its
+  // rows.
+  TopNSelector* top_n_selector() {
+    lock_.AssertAcquired();
+    return top_n_.get();
+  }
+
   // Add the timings in 'elapsed' to the total timings for this scanner.
   void AddTimings(const CpuTimes& elapsed);
 
@@ -451,6 +492,15 @@ class Scanner {
   // Assumed to be set once initted_ is true.
   std::unique_ptr<Schema> client_projection_schema_;
 
+  // Aggregates the rows of the scan if the client requested it. Its state
+  // is reset after every RPC.
+  std::unique_ptr<RowAggregator> aggregator_;
+
+  // Selects the first rows of the scan if the client requested it. Its
+  // state is kept across the RPCs of the scan, and its rows are returned by
+  // the last one.
+  std::unique_ptr<TopNSelector> top_n_;
+
   // The last time that the scanner was accessed.
   // Only modified under lock_ but can be read outside.
   std::atomic<MonoTime> last_access_time_;
@@ -50,6 +50,7 @@
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row_aggregator.h"
 #include "kudu/common/row_operations.h"
 #include "kudu/common/row_operations.pb.h"
 #include "kudu/common/schema.h"
@@ -208,6 +209,7 @@ DECLARE_int32(rpc_service_queue_length);
 DECLARE_int32(scanner_batch_size_rows);
 DECLARE_int32(scanner_gc_check_interval_us);
 DECLARE_int32(scanner_inject_latency_on_each_batch_ms);
+DECLARE_int32(scanner_max_parallelism);
 DECLARE_int32(scanner_ttl_ms);
 DECLARE_int32(slow_scanner_threshold_ms);
 DECLARE_int32(tablet_bootstrap_inject_latency_ms);
@@ -3193,6 +3195,183 @@ TEST_F(ScannerScansTest, TestScanWithStringPredicates) {
   ASSERT_EQ(R"((int32 key=59, int32 int_val=118, string string_val="hello 59"))", results[9]);
 }
 
+TEST_F(ScannerScansTest, TestScanWithAggregation) {
+  InsertTestRowsDirect(0, 100);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+
+  // Compute count(*), sum(int_val) and max(string_val) over 10 <= key < 60.
+  ColumnPredicatePB* pred = scan->add_column_predicates();
+  pred->set_column(schema_.column(0).name());
+  ColumnPredicatePB::Range* range = pred->mutable_range();
+  int32_t lower_bound_inclusive = 10;
+  int32_t upper_bound_exclusive = 60;
+  range->mutable_lower()->append(
+    reinterpret_cast<char*>(&lower_bound_inclusive), sizeof(lower_bound_inclusive));
+  range->mutable_upper()->append(
+    reinterpret_cast<char*>(&upper_bound_exclusive), sizeof(upper_bound_exclusive));
+  AggregationSpecPB* spec = scan->mutable_aggregation();
+  spec->add_aggregates()->set_function(AggregationSpecPB::AggregatePB::COUNT);
+  AggregationSpecPB::AggregatePB* agg = spec->add_aggregates();
+  agg->set_function(AggregationSpecPB::AggregatePB::SUM);
+  agg->set_column("int_val");
+  agg = spec->add_aggregates();
+  agg->set_function(AggregationSpecPB::AggregatePB::MAX);
+  agg->set_column("string_val");
+
+  // Send the call
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+  }
+
+  // The rows scanned by a single call are aggregated together.
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(*spec, schema_, &aggregator));
+  vector<string> results;
+  NO_FATALS(DrainScannerToStrings(resp.scanner_id(), aggregator->result_schema(), &results));
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ(R"((int64 count(*)=50, int64 sum(int_val)=3450, )"
+            R"(string max(string_val)="hello 59"))", results[0]);
+
+  // Aggregating a column outside of the projection isn't allowed.
+  rpc.Reset();
+  scan->clear_projected_columns();
+  ASSERT_OK(SchemaToColumnPBs(schema_.CreateKeyProjection(), scan->mutable_projected_columns()));
+  ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(TabletServerErrorPB::INVALID_SCAN_SPEC, resp.error().code());
+  ASSERT_STR_CONTAINS(resp.error().status().message(),
+                      "aggregated column int_val is not part of the projection");
+}
+
+TEST_F(ScannerScansTest, TestScanWithTopN) {
+  InsertTestRowsDirect(0, 100);
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(schema_, scan->mutable_projected_columns()));
+
+  // Select the rows with the 3 largest values of int_val.
+  TopNSpecPB::SortKeyPB* sort_key = scan->mutable_top_n()->add_order_by();
+  sort_key->set_column("int_val");
+  sort_key->set_descending(true);
+  scan->mutable_top_n()->set_limit(3);
+
+  // Send the call
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+  }
+
+  vector<string> results;
+  NO_FATALS(DrainScannerToStrings(resp.scanner_id(), schema_, &results));
+  ASSERT_EQ(vector<string>({
+      R"((int32 key=99, int32 int_val=198, string string_val="hello 99"))",
+      R"((int32 key=98, int32 int_val=196, string string_val="hello 98"))",
+      R"((int32 key=97, int32 int_val=194, string string_val="hello 97"))" }),
+      results);
+
+  // The rows are selected over the whole scan, even if it takes several
+  // calls, and only the last call returns them.
+  FLAGS_scanner_batch_size_rows = 10;
+  FLAGS_scanner_inject_latency_on_each_batch_ms = 200;
+  rpc.Reset();
+  req.set_batch_size_bytes(10000);
+  ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+  ASSERT_FALSE(resp.has_error());
+  int num_calls = 1;
+  results.clear();
+  while (resp.has_more_results()) {
+    ASSERT_EQ(0, resp.data().num_rows());
+    ScanRequestPB continue_req;
+    continue_req.set_scanner_id(resp.scanner_id());
+    continue_req.set_call_seq_id(num_calls++);
+    continue_req.set_batch_size_bytes(10000);
+    rpc.Reset();
+    ASSERT_OK(proxy_->Scan(continue_req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+  }
+  ASSERT_GT(num_calls, 1);
+  NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+  ASSERT_EQ(vector<string>({
+      R"((int32 key=99, int32 int_val=198, string string_val="hello 99"))",
+      R"((int32 key=98, int32 int_val=196, string string_val="hello 98"))",
+      R"((int32 key=97, int32 int_val=194, string string_val="hello 97"))" }),
+      results);
+  FLAGS_scanner_inject_latency_on_each_batch_ms = 0;
+
+  // If the selected rows don't fit within the batch size, they're returned
+  // across several calls.
+  rpc.Reset();
+  scan->mutable_top_n()->set_limit(50);
+  req.set_batch_size_bytes(100);
+  ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+  ASSERT_FALSE(resp.has_error());
+  num_calls = 1;
+  int num_calls_with_rows = 0;
+  results.clear();
+  while (true) {
+    if (resp.data().num_rows() > 0) {
+      num_calls_with_rows++;
+      NO_FATALS(StringifyRowsFromResponse(schema_, rpc, &resp, &results));
+    }
+    if (!resp.has_more_results()) {
+      break;
+    }
+    ScanRequestPB continue_req;
+    continue_req.set_scanner_id(resp.scanner_id());
+    continue_req.set_call_seq_id(num_calls++);
+    continue_req.set_batch_size_bytes(100);
+    rpc.Reset();
+    ASSERT_OK(proxy_->Scan(continue_req, &resp, &rpc));
+    ASSERT_FALSE(resp.has_error());
+  }
+  ASSERT_GT(num_calls_with_rows, 1);
+  ASSERT_EQ(50, results.size());
+  for (int i = 0; i < results.size(); i++) {
+    ASSERT_EQ(Substitute(R"((int32 key=$0, int32 int_val=$1, string string_val="hello $0"))",
+                         99 - i, (99 - i) * 2),
+              results[i]);
+  }
+  scan->mutable_top_n()->set_limit(3);
+  req.set_batch_size_bytes(0);
+
+  // Combining top-N selection with a limit isn't allowed.
+  rpc.Reset();
+  scan->set_limit(10);
+  ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(TabletServerErrorPB::INVALID_SCAN_SPEC, resp.error().code());
+
+  // Sorting by a column outside of the projection isn't allowed either.
+  rpc.Reset();
+  scan->clear_limit();
+  scan->clear_projected_columns();
+  ASSERT_OK(SchemaToColumnPBs(schema_.CreateKeyProjection(), scan->mutable_projected_columns()));
+  ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+  ASSERT_TRUE(resp.has_error());
+  ASSERT_EQ(TabletServerErrorPB::INVALID_SCAN_SPEC, resp.error().code());
+  ASSERT_STR_CONTAINS(resp.error().status().message(),
+                      "sort key column int_val is not part of the projection");
+}
+
 TEST_F(ScannerScansTest, TestColumnarScan) {
   const int kNumRows = 100;
   InsertTestRowsDirect(0, kNumRows);
@@ -3372,6 +3551,71 @@ TEST_F(ScannerScansTest, TestScanWithPredicates) {
   ASSERT_EQ(50, results.size());
 }
 
+// Test an UNORDERED scan whose rowsets are scanned in parallel, with a
+// projection and predicates on both an integer and a string column.
+TEST_F(ScannerScansTest, TestParallelScan) {
+  FLAGS_scanner_max_parallelism = 4;
+  FLAGS_scanner_batch_size_rows = 10;
+
+  // Spread the rows over several disk rowsets and the MemRowSet.
+  for (int i = 0; i < 3; i++) {
+    InsertTestRowsDirect(i * 100, 100);
+    ASSERT_OK(tablet_replica_->tablet()->Flush());
+  }
+  InsertTestRowsDirect(300, 100);
+
+  // Project the string column without the integer value column.
+  SchemaBuilder sb(schema_);
+  ASSERT_OK(sb.RemoveColumn("int_val"));
+  const Schema projection = sb.BuildWithoutIds();
+
+  ScanRequestPB req;
+  ScanResponsePB resp;
+  RpcController rpc;
+
+  NewScanRequestPB* scan = req.mutable_new_scan_request();
+  scan->set_tablet_id(kTabletId);
+  scan->set_order_mode(UNORDERED);
+  req.set_batch_size_bytes(0); // so it won't return data right away
+  ASSERT_OK(SchemaToColumnPBs(projection, scan->mutable_projected_columns()));
+
+  // Select the rows with 50 <= key < 350 and "hello 1" <= string_val < "hello 3".
+  ColumnPredicatePB* pred = scan->add_column_predicates();
+  pred->set_column("key");
+  int32_t lower_key = 50;
+  int32_t upper_key = 350;
+  pred->mutable_range()->mutable_lower()->append(
+      reinterpret_cast<char*>(&lower_key), sizeof(lower_key));
+  pred->mutable_range()->mutable_upper()->append(
+      reinterpret_cast<char*>(&upper_key), sizeof(upper_key));
+  pred = scan->add_column_predicates();
+  pred->set_column("string_val");
+  pred->mutable_range()->set_lower("hello 1");
+  pred->mutable_range()->set_upper("hello 3");
+
+  {
+    SCOPED_TRACE(SecureDebugString(req));
+    ASSERT_OK(proxy_->Scan(req, &resp, &rpc));
+    SCOPED_TRACE(SecureDebugString(resp));
+    ASSERT_FALSE(resp.has_error());
+  }
+
+  vector<string> results;
+  NO_FATALS(DrainScannerToStrings(resp.scanner_id(), projection, &results));
+
+  vector<string> expected;
+  for (int i = lower_key; i < upper_key; i++) {
+    const string val = Substitute("hello $0", i);
+    if (val >= "hello 1" && val < "hello 3") {
+      expected.emplace_back(Substitute(R"((int32 key=$0, string string_val="$1"))", i, val));
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+  std::sort(results.begin(), results.end());
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(expected, results);
+}
+
 TEST_F(ScannerScansTest, TestScanWithEncodedPredicates) {
   InsertTestRowsDirect(0, 100);
 
@@ -106,6 +106,13 @@ Status TabletServer::Init() {
 
   RETURN_NOT_OK(KuduServer::Init());
 
+  // The blocks in the persistent tier of the block cache are validated
+  // against the block manager, so the tier is opened once the block manager is.
+  RETURN_NOT_OK_PREPEND(cfile::BlockCache::GetSingleton()->OpenPersistentTier(
+                            fs_manager_->GetEnv(), fs_manager_->block_manager().get(),
+                            metric_entity()),
+                        "Could not open the persistent tier of the block cache");
+
   maintenance_manager_ = std::make_shared<MaintenanceManager>(
       MaintenanceManager::kDefaultOptions, fs_manager_->uuid(), metric_entity());
 
@@ -188,6 +195,8 @@ void TabletServer::ShutdownImpl() {
     fs_manager_->UnsetErrorNotificationCb(ErrorHandlerType::CFILE_CORRUPTION);
     fs_manager_->UnsetErrorNotificationCb(ErrorHandlerType::DISK_ERROR);
     tablet_manager_->Shutdown();
+    WARN_NOT_OK(cfile::BlockCache::GetSingleton()->CheckpointPersistentTier(),
+                "Failed to checkpoint the persistent tier of the block cache");
 
     client_initializer_->Shutdown();
 
@@ -44,12 +44,14 @@
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/key_range.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row_aggregator.h"
 #include "kudu/common/row_operations.pb.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/rowblock_memory.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
+#include "kudu/common/top_n_selector.h"
 #include "kudu/common/types.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/common/wire_protocol.pb.h"
@@ -138,6 +140,16 @@ DEFINE_int32(scanner_batch_size_rows, 128,
 TAG_FLAG(scanner_batch_size_rows, advanced);
 TAG_FLAG(scanner_batch_size_rows, runtime);
 
+DEFINE_int32(scanner_max_parallelism, 1,
+             "Maximum number of rowsets of a tablet to scan concurrently for a "
+             "single UNORDERED scan, reading rows ahead of the client's requests "
+             "on a pool of threads shared by all scans (see "
+             "--scanner_parallel_scan_threads). If 1, the rowsets are scanned one "
+             "at a time by the thread serving the scan request.");
+TAG_FLAG(scanner_max_parallelism, advanced);
+TAG_FLAG(scanner_max_parallelism, experimental);
+TAG_FLAG(scanner_max_parallelism, runtime);
+
 DEFINE_bool(scanner_allow_snapshot_scans_with_logical_timestamps, false,
             "If set, the server will support snapshot scans with logical timestamps.");
 TAG_FLAG(scanner_allow_snapshot_scans_with_logical_timestamps, unsafe);
@@ -766,8 +778,23 @@ class TxnWriteCompletionCallback : public RpcOpCompletionCallback<WriteResponseP
 // Generic interface to handle scan results.
 class ScanResultCollector {
  public:
-  virtual void HandleRowBlock(Scanner* scanner,
-                              const RowBlock& row_block) = 0;
+  virtual Status HandleRowBlock(Scanner* scanner,
+                                const RowBlock& row_block) = 0;
+
+  // Called once the rows of a scan call have all been handled, while the
+  // scanner is still locked. 'scan_complete' is true if the scanner has no
+  // more rows to handle.
+  //
+  // Does nothing by default.
+  virtual Status FinishScanCall(Scanner* /* scanner */, bool /* scan_complete */) {
+    return Status::OK();
+  }
+
+  // Whether the collector has results left to return in later calls of the
+  // scan, even though the scanner has no more rows to handle.
+  virtual bool HasMoreResults() const {
+    return false;
+  }
 
   // Returns number of bytes which will be returned in the response.
   virtual int64_t ResponseSize() const = 0;
@@ -983,7 +1010,23 @@ class ScanResultCopier : public ScanResultCollector {
         num_rows_returned_(0) {
   }
 
-  void HandleRowBlock(Scanner* scanner, const RowBlock& row_block) override {
+  Status HandleRowBlock(Scanner* scanner, const RowBlock& row_block) override {
+    if (RowAggregator* aggregator = scanner->aggregator()) {
+      // The rows are aggregated instead, and the aggregates of the rows
+      // handled by this call are serialized in FinishScanCall().
+      aggregator_ = aggregator;
+      RETURN_NOT_OK(aggregator->AddRows(row_block));
+      SetLastRow(row_block, &last_primary_key_);
+      return Status::OK();
+    }
+    if (TopNSelector* top_n = scanner->top_n_selector()) {
+      // Only the first rows of the whole scan are kept, and serialized in
+      // FinishScanCall() once the scan is complete.
+      top_n->AddRows(row_block);
+      SetLastRow(row_block, &last_primary_key_);
+      return Status::OK();
+    }
+
     int num_selected = serializer_->SerializeRowBlock(
         row_block, scanner->client_projection_schema());
 
@@ -992,10 +1035,36 @@ class ScanResultCopier : public ScanResultCollector {
       scanner->add_num_rows_returned(num_selected);
       SetLastRow(row_block, &last_primary_key_);
     }
+    return Status::OK();
+  }
+
+  Status FinishScanCall(Scanner* scanner, bool scan_complete) override {
+    // The aggregator and the selector belong to the scanner, which may be
+    // gone by the time the response is set up, so their results are
+    // serialized now.
+    if (aggregator_) {
+      const Schema& result_schema = aggregator_->result_schema();
+      RETURN_NOT_OK(SerializeResults(aggregator_, result_schema, &result_schema));
+      aggregator_ = nullptr;
+    }
+    // The calls which return the selected rows may not have handled any rows
+    // themselves, so the selector is taken from the scanner.
+    TopNSelector* top_n = scanner->top_n_selector();
+    if (top_n && scan_complete) {
+      RETURN_NOT_OK(SerializeTopNResults(top_n, scanner->client_projection_schema()));
+    }
+    return Status::OK();
+  }
+
+  bool HasMoreResults() const override {
+    return top_n_has_more_results_;
   }
 
   // Returns number of bytes buffered to return.
   int64_t ResponseSize() const override {
+    if (aggregator_) {
+      return aggregator_->memory_footprint();
+    }
     return serializer_->ResponseSize();
   }
 
@@ -1034,11 +1103,55 @@ class ScanResultCopier : public ScanResultCollector {
   }
 
  private:
+  // Serialize all the rows returned by 'source', an aggregator whose rows
+  // are of 'schema', with the given client schema.
+  template<class Source>
+  Status SerializeResults(Source* source, const Schema& schema,
+                          const Schema* client_projection_schema) {
+    RowBlockMemory mem;
+    RowBlock block(&schema, FLAGS_scanner_batch_size_rows, &mem);
+    while (true) {
+      RETURN_NOT_OK(source->NextResults(&block));
+      if (block.nrows() == 0) {
+        return Status::OK();
+      }
+      num_rows_returned_ += serializer_->SerializeRowBlock(block, client_projection_schema);
+      mem.Reset();
+    }
+  }
+
+  // Serialize the next rows selected by 'top_n' with the given client schema,
+  // until the response reaches the batch size. The rest of the rows are
+  // returned by the following calls of the scan.
+  Status SerializeTopNResults(TopNSelector* top_n, const Schema* client_projection_schema) {
+    RowBlockMemory mem;
+    RowBlock block(&top_n->schema(), FLAGS_scanner_batch_size_rows, &mem);
+    top_n_has_more_results_ = true;
+    while (serializer_->ResponseSize() < batch_size_bytes_) {
+      RETURN_NOT_OK(top_n->NextResults(&block));
+      if (block.nrows() == 0) {
+        top_n_has_more_results_ = false;
+        return Status::OK();
+      }
+      num_rows_returned_ += serializer_->SerializeRowBlock(block, client_projection_schema);
+      mem.Reset();
+    }
+    return Status::OK();
+  }
+
   int batch_size_bytes_;
   int64_t num_rows_returned_;
   faststring last_primary_key_;
   unique_ptr<ResultSerializer> serializer_;
 
+  // The aggregator of the scan, if the rows handled by this call were
+  // aggregated and their aggregates are yet to be serialized.
+  RowAggregator* aggregator_ = nullptr;
+
+  // Whether the scan's top-N selector has rows left to return in the
+  // following calls.
+  bool top_n_has_more_results_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(ScanResultCopier);
 };
 
@@ -1051,8 +1164,8 @@ class ScanResultChecksummer : public ScanResultCollector {
         rows_checksummed_(0) {
   }
 
-  void HandleRowBlock(Scanner* scanner,
-                      const RowBlock& row_block) override {
+  Status HandleRowBlock(Scanner* scanner,
+                        const RowBlock& row_block) override {
 
     const Schema* client_projection_schema = scanner->client_projection_schema();
     if (!client_projection_schema) {
@@ -1068,6 +1181,7 @@ class ScanResultChecksummer : public ScanResultCollector {
     }
     // Find the last selected row and save its encoded key.
     SetLastRow(row_block, &encoded_last_row_);
+    return Status::OK();
   }
 
   // Returns a constant -- we only return checksum based on a time budget.
@@ -1589,6 +1703,8 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
                         SecureDebugString(*req), context->requestor_string(),
                         context->request_id() == nullptr ?
                         "" : SecureDebugString(*context->request_id()));
+  // If the replica is still waiting to be opened, open it ahead of the others.
+  server_->tablet_manager()->PrioritizeTabletOpen(tablet_id);
   scoped_refptr<TabletReplica> replica;
   if (!LookupRunningTabletReplicaOrRespond(
         server_->tablet_manager(), tablet_id, resp, context, &replica)) {
@@ -2322,6 +2438,8 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
       return;
     }
     const NewScanRequestPB& scan_pb = req->new_scan_request();
+    // If the replica is still waiting to be opened, open it ahead of the others.
+    server_->tablet_manager()->PrioritizeTabletOpen(scan_pb.tablet_id());
     scoped_refptr<TabletReplica> replica;
     if (!LookupRunningTabletReplicaOrRespond(server_->tablet_manager(), scan_pb.tablet_id(), resp,
                                              context, &replica)) {
@@ -2673,6 +2791,8 @@ bool TabletServiceImpl::SupportsFeature(uint32_t feature) const {
     case TabletServerFeatures::QUIESCING:
     case TabletServerFeatures::BLOOM_FILTER_PREDICATE_V2:
     case TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE:
+    case TabletServerFeatures::SCAN_AGGREGATION:
+    case TabletServerFeatures::SCAN_TOP_N:
       return true;
     case TabletServerFeatures::ARRAY_1D_COLUMN_TYPE:
       return PREDICT_TRUE(FLAGS_tserver_support_1d_array_columns);
@@ -2993,6 +3113,63 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
   projection = projection_builder.BuildWithoutIds();
   VLOG(3) << "Scan projection: " << projection.ToString(Schema::BASE_INFO);
 
+  if (scan_pb.has_aggregation()) {
+    if (scan_pb.has_limit() || scan_pb.row_format_flags() != RowFormatFlags::NO_FLAGS) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument(
+          "aggregation can't be combined with a limit or row format flags");
+    }
+    // The aggregated columns must be part of the client's projection, but the
+    // aggregator is fed rows of the full projection.
+    const AggregationSpecPB& agg_pb = scan_pb.aggregation();
+    for (const auto& col_name : agg_pb.group_by_columns()) {
+      if (client_projection->find_column(col_name) == Schema::kColumnNotFound) {
+        *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+        return Status::InvalidArgument(Substitute(
+            "grouping column $0 is not part of the projection", col_name));
+      }
+    }
+    for (const auto& agg : agg_pb.aggregates()) {
+      if (agg.has_column() &&
+          client_projection->find_column(agg.column()) == Schema::kColumnNotFound) {
+        *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+        return Status::InvalidArgument(Substitute(
+            "aggregated column $0 is not part of the projection", agg.column()));
+      }
+    }
+    unique_ptr<RowAggregator> aggregator;
+    s = RowAggregator::Create(agg_pb, projection, &aggregator);
+    if (PREDICT_FALSE(!s.ok())) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return s;
+    }
+    scanner->set_aggregator(std::move(aggregator));
+  }
+
+  if (scan_pb.has_top_n()) {
+    if (scan_pb.has_limit() || scan_pb.has_aggregation()) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return Status::InvalidArgument(
+          "top-N selection can't be combined with a limit or an aggregation");
+    }
+    // As with aggregation, the sort keys must be part of the client's
+    // projection, but the selector is fed rows of the full projection.
+    for (const auto& sort_key : scan_pb.top_n().order_by()) {
+      if (client_projection->find_column(sort_key.column()) == Schema::kColumnNotFound) {
+        *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+        return Status::InvalidArgument(Substitute(
+            "sort key column $0 is not part of the projection", sort_key.column()));
+      }
+    }
+    unique_ptr<TopNSelector> top_n;
+    s = TopNSelector::Create(scan_pb.top_n(), projection, &top_n);
+    if (PREDICT_FALSE(!s.ok())) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return s;
+    }
+    scanner->set_top_n_selector(std::move(top_n));
+  }
+
   s = result_collector->InitSerializer(scan_pb.row_format_flags(),
                                        projection,
                                        *client_projection);
@@ -3041,7 +3218,13 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
           return Status::InvalidArgument("scan start timestamp is only supported "
                                          "in READ_AT_SNAPSHOT read mode");
         }
-        s = tablet->NewRowIterator(projection, &iter);
+        tablet::RowIteratorOptions opts;
+        opts.projection = &projection;
+        opts.snap_to_include = MvccSnapshot(*tablet->mvcc_manager());
+        opts.scan_pool = server_->scanner_manager()->scan_pool();
+        opts.scan_parallelism = FLAGS_scanner_max_parallelism;
+        opts.readahead_pool = server_->scanner_manager()->readahead_pool();
+        s = tablet->NewRowIterator(std::move(opts), &iter);
         break;
       }
       case READ_YOUR_WRITES: // Fallthrough intended
@@ -3261,7 +3444,15 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
         DCHECK_GT(rows_left, 0);  // Guaranteed by has_fulfilled_limit()
         block.selection_vector()->ClearToSelectAtMost(static_cast<size_t>(rows_left));
       }
-      result_collector->HandleRowBlock(scanner.get(), block);
+      if (auto s = result_collector->HandleRowBlock(scanner.get(), block);
+          PREDICT_FALSE(!s.ok())) {
+        TRACE("Failed handling row data - responding with UNKNOWN_ERROR");
+        LOG(ERROR) << Substitute(
+            "scan '$0': could not handle row data after scanning $1 rows: $2",
+            SecureShortDebugString(*req), rows_scanned, s.ToString());
+        *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+        return s;
+      }
     }
 
     const int64_t response_size = result_collector->ResponseSize();
@@ -3282,6 +3473,16 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
     }
   }
 
+  const bool scan_complete = req->close_scanner() || !iter->HasNext() ||
+      scanner->has_fulfilled_limit();
+  s = result_collector->FinishScanCall(scanner.get(), scan_complete);
+  if (PREDICT_FALSE(!s.ok())) {
+    *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    return s;
+  }
+  *has_more_results = !req->close_scanner() &&
+      (!scan_complete || result_collector->HasMoreResults());
+
   scoped_refptr<TabletReplica> replica = scanner->tablet_replica();
   shared_ptr<Tablet> tablet;
   TabletServerErrorPB::Code tablet_ref_error_code;
@@ -3314,14 +3515,13 @@ Status TabletServiceImpl::HandleContinueScanRequest(const ScanRequestPB* req,
     tablet->metrics()->scanner_rows_scanned->IncrementBy(rows_scanned);
     tablet->metrics()->scanner_cells_scanned_from_disk->IncrementBy(delta_stats.cells_read);
     tablet->metrics()->scanner_bytes_scanned_from_disk->IncrementBy(delta_stats.bytes_read);
+    tablet->metrics()->scanner_cells_skipped_from_disk->IncrementBy(delta_stats.cells_skipped);
     tablet->metrics()->scanner_predicates_disabled->IncrementBy(delta_stats.predicates_disabled);
 
     // Last read timestamp.
     tablet->UpdateLastReadTime();
   }
 
-  *has_more_results = !req->close_scanner() && iter->HasNext() &&
-      !scanner->has_fulfilled_limit();
   if (*has_more_results) {
     unreg_scanner.Cancel();
   } else {
@@ -3434,6 +3634,9 @@ Status TabletServiceImpl::HandleScanAtSnapshot(const NewScanRequestPB& scan_pb,
   opts.projection = &projection;
   opts.snap_to_include = snap;
   opts.order = scan_pb.order_mode();
+  opts.scan_pool = server_->scanner_manager()->scan_pool();
+  opts.scan_parallelism = FLAGS_scanner_max_parallelism;
+  opts.readahead_pool = server_->scanner_manager()->readahead_pool();
 
   optional<Timestamp> tmp_snap_start_timestamp;
   if (scan_pb.has_snap_start_timestamp()) {
@@ -56,6 +56,8 @@
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/scoped_cleanup.h"
+#include "kudu/util/semaphore.h"
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
@@ -458,6 +460,70 @@ TEST_F(TsTabletManagerTest, TestTabletStatsReports) {
   MarkTabletReportAcknowledged(report);
 }
 
+// Tests that a replica which is accessed while it's waiting to be opened at
+// startup is opened before the replicas which haven't been accessed.
+TEST_F(TsTabletManagerTest, TestPrioritizeTabletOpen) {
+  constexpr int kNumTablets = 10;
+  FLAGS_enable_leader_failure_detection = false;
+  vector<string> tablet_ids;
+  for (int i = 0; i < kNumTablets; i++) {
+    tablet_ids.emplace_back(Substitute("tablet-$0", i));
+    ASSERT_OK(CreateNewTablet(tablet_ids.back(), schema_, false, nullopt, nullopt, nullptr));
+  }
+
+  // Hold the replicas back from opening until the accessed one is prioritized:
+  // every open task waits for a permit before picking the replica to open.
+  mini_server_->Shutdown();
+  FLAGS_num_tablets_to_open_simultaneously = 1;
+  Semaphore open_permits(0);
+  TSTabletManager::SetPendingOpenHookForTests([&open_permits]() {
+    open_permits.Acquire();
+  });
+  bool all_permitted = false;
+  SCOPED_CLEANUP({
+    if (!all_permitted) {
+      for (int i = 0; i < kNumTablets; i++) {
+        open_permits.Release();
+      }
+      WARN_NOT_OK(mini_server_->WaitStarted(), "failed to open the replicas");
+    }
+    TSTabletManager::SetPendingOpenHookForTests(nullptr);
+  });
+  ASSERT_OK(mini_server_->Start());
+  tablet_manager_ = mini_server_->server()->tablet_manager();
+
+  const auto count_running = [&]() {
+    int num_running = 0;
+    for (const auto& tablet_id : tablet_ids) {
+      scoped_refptr<TabletReplica> replica;
+      if (tablet_manager_->LookupTablet(tablet_id, &replica) &&
+          replica->state() == tablet::RUNNING) {
+        num_running++;
+      }
+    }
+    return num_running;
+  };
+  const string& accessed_tablet_id = tablet_ids[kNumTablets / 2];
+  tablet_manager_->PrioritizeTabletOpen(accessed_tablet_id);
+
+  // Letting a single replica open opens the accessed one.
+  open_permits.Release();
+  scoped_refptr<TabletReplica> replica;
+  ASSERT_TRUE(tablet_manager_->LookupTablet(accessed_tablet_id, &replica));
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_EQ(tablet::RUNNING, replica->state());
+  });
+  ASSERT_EQ(1, count_running());
+
+  // The other replicas are still opened.
+  for (int i = 1; i < kNumTablets; i++) {
+    open_permits.Release();
+  }
+  all_permitted = true;
+  ASSERT_OK(mini_server_->WaitStarted());
+  ASSERT_EQ(kNumTablets, count_running());
+}
+
 TEST_F(TsTabletManagerTest, StartupBenchmark) {
   const int64_t kTabletCount = FLAGS_startup_benchmark_tablet_count_for_testing;
 
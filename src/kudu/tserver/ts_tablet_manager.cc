@@ -19,6 +19,8 @@
 
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -97,6 +99,14 @@ DEFINE_int32(num_tablets_to_open_simultaneously, 0,
              "may make sense to manually tune this.");
 TAG_FLAG(num_tablets_to_open_simultaneously, advanced);
 
+DEFINE_bool(tablet_open_prioritize_accessed, true,
+            "Whether the tablet replicas which receive write or scan requests "
+            "while they're waiting to be opened during startup are opened "
+            "before the other replicas. Otherwise, the replicas are opened in "
+            "the order in which they were registered.");
+TAG_FLAG(tablet_open_prioritize_accessed, advanced);
+TAG_FLAG(tablet_open_prioritize_accessed, runtime);
+
 DEFINE_int32(num_tablets_to_delete_simultaneously, 0,
              "Number of threads available to delete tablets. If this is set to 0 (the "
              "default), then the number of delete threads will be set based on the number "
@@ -116,6 +126,15 @@ DEFINE_int32(txn_commit_pool_num_threads, 10,
              "Number of threads available for transaction commit tasks.");
 TAG_FLAG(txn_commit_pool_num_threads, advanced);
 
+DEFINE_int32(rowset_column_writer_threads, 0,
+             "Number of threads shared by all tablets to encode, compress and "
+             "write the columns of the rowsets written by flushes and "
+             "compactions in parallel. If 0, the columns of a rowset are "
+             "written one after another by the thread which runs the flush or "
+             "compaction.");
+TAG_FLAG(rowset_column_writer_threads, advanced);
+TAG_FLAG(rowset_column_writer_threads, experimental);
+
 DEFINE_int32(txn_participant_registration_pool_num_threads, 10,
              "Number of threads available for tasks to register tablets as "
              "transaction participants upon receiving write operations "
@@ -466,6 +485,12 @@ Status TSTabletManager::Init(Timer* start_tablets,
                 .set_max_threads(FLAGS_txn_commit_pool_num_threads)
                 .Build(&txn_commit_pool_));
 
+  if (FLAGS_rowset_column_writer_threads > 0) {
+    RETURN_NOT_OK(ThreadPoolBuilder("col-writer")
+                  .set_max_threads(FLAGS_rowset_column_writer_threads)
+                  .Build(&column_writer_pool_));
+  }
+
   // Start the threadpools we'll use to open and delete tablets.
   // This has to be done in Init() instead of the constructor, since the
   // FsManager isn't initialized until this point.
@@ -607,9 +632,18 @@ Status TSTabletManager::Init(Timer* start_tablets,
 
       scoped_refptr<TabletReplica> replica;
       RETURN_NOT_OK(CreateAndRegisterTabletReplica(meta, NEW_REPLICA, &replica));
+      // Every task opens whichever replica is at the front of the pending
+      // list when it runs, so that the replicas which are accessed in the
+      // meantime can be moved ahead of the others.
+      {
+        std::lock_guard l(pending_opens_lock_);
+        pending_opens_.push_back({ replica, deleter });
+        InsertOrDie(&pending_opens_by_id_, meta->tablet_id(), std::prev(pending_opens_.end()));
+        num_pending_opens_++;
+      }
       RETURN_NOT_OK(open_tablet_pool_->Submit(
-          [this, replica, deleter, tablets_processed, tablets_total, start_tablets]() {
-            this->OpenTablet(replica, deleter, tablets_processed, tablets_total, start_tablets);
+          [this, tablets_processed, tablets_total, start_tablets]() {
+            this->OpenNextPendingTablet(tablets_processed, tablets_total, start_tablets);
           }));
       registered_count++;
     }
@@ -1363,6 +1397,44 @@ Status TSTabletManager::OpenTabletMeta(const string& tablet_id,
   return Status::OK();
 }
 
+void TSTabletManager::OpenNextPendingTablet(std::atomic<int>* tablets_processed,
+                                            std::atomic<int>* tablets_total,
+                                            Timer* start_tablets) {
+  if (PREDICT_FALSE(pending_open_hook_for_tests_)) {
+    pending_open_hook_for_tests_();
+  }
+  PendingOpen next;
+  {
+    std::lock_guard l(pending_opens_lock_);
+    CHECK(!pending_opens_.empty());
+    next = std::move(pending_opens_.front());
+    pending_opens_.pop_front();
+    CHECK_EQ(1, pending_opens_by_id_.erase(next.replica->tablet_id()));
+    num_pending_opens_--;
+  }
+  OpenTablet(next.replica, next.deleter, tablets_processed, tablets_total, start_tablets);
+}
+
+std::function<void()> TSTabletManager::pending_open_hook_for_tests_;
+
+void TSTabletManager::SetPendingOpenHookForTests(std::function<void()> hook) {
+  pending_open_hook_for_tests_ = std::move(hook);
+}
+
+void TSTabletManager::PrioritizeTabletOpen(const string& tablet_id) {
+  if (PREDICT_TRUE(num_pending_opens_.load(std::memory_order_relaxed) == 0) ||
+      !FLAGS_tablet_open_prioritize_accessed) {
+    return;
+  }
+  std::lock_guard l(pending_opens_lock_);
+  const auto* pos = FindOrNull(pending_opens_by_id_, tablet_id);
+  if (!pos || *pos == pending_opens_.begin()) {
+    return;
+  }
+  VLOG(1) << LogPrefix(tablet_id) << "Prioritizing opening the accessed tablet";
+  pending_opens_.splice(pending_opens_.begin(), pending_opens_, *pos);
+}
+
 void TSTabletManager::OpenTablet(const scoped_refptr<tablet::TabletReplica>& replica,
                                  const scoped_refptr<TransitionInProgressDeleter>& deleter,
                                  std::atomic<int>* tablets_processed,
@@ -1433,6 +1505,7 @@ void TSTabletManager::OpenTablet(const scoped_refptr<tablet::TabletReplica>& rep
   MonoTime start(MonoTime::Now());
   LOG_TIMING_PREFIX(INFO, LogPrefix(tablet_id), "starting tablet") {
     TRACE("Starting tablet replica");
+    tablet->set_column_writer_pool(column_writer_pool_.get());
     s = replica->Start(bootstrap_info,
                        tablet,
                        server_->clock(),
@@ -1524,6 +1597,16 @@ void TSTabletManager::Shutdown() {
   if (open_tablet_pool_ != nullptr) {
     open_tablet_pool_->Shutdown();
   }
+  // Release the replicas which never started opening; they're shut down with
+  // the others below.
+  std::list<PendingOpen> pending_opens;
+  {
+    std::lock_guard l(pending_opens_lock_);
+    pending_opens_by_id_.clear();
+    pending_opens.swap(pending_opens_);
+    num_pending_opens_ = 0;
+  }
+  pending_opens.clear();
 
   // Shut down the delete pool, so no new tablets are deleted after this point.
   if (delete_tablet_pool_ != nullptr) {
@@ -1570,6 +1653,12 @@ void TSTabletManager::Shutdown() {
     txn_commit_pool_->Shutdown();
   }
 
+  // The replicas are shut down, so no flush or compaction writes rowsets
+  // any longer.
+  if (column_writer_pool_ != nullptr) {
+    column_writer_pool_->Shutdown();
+  }
+
   {
     std::lock_guard l(lock_);
     // We don't expect anyone else to be modifying the map after we start the
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <optional>
@@ -165,6 +166,18 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
                       const std::optional<int64_t>& cas_config_index,
                       TabletServerErrorPB::Code* error_code = nullptr);
 
+  // If the replica of the given tablet is still waiting to be opened at
+  // startup, open it before the replicas which haven't been accessed, so that
+  // the replicas which clients are using become available first.
+  void PrioritizeTabletOpen(const std::string& tablet_id);
+
+  // Set a function which is called by every task opening a replica at startup
+  // before it picks the replica to open, e.g. to hold the task back, or clear
+  // it if 'hook' is empty. It applies to every tablet manager in the process,
+  // so it must be set before the tablet server starts and cleared once the
+  // replicas are opened. Just for tests.
+  static void SetPendingOpenHookForTests(std::function<void()> hook);
+
   // Lookup the given tablet replica by its ID.
   // Returns true if the tablet is found successfully.
   bool LookupTablet(const std::string& tablet_id,
@@ -350,6 +363,12 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
                   std::atomic<int>* tablets_total = nullptr,
                   Timer* bootstrap_tablets = nullptr);
 
+  // Open the replica at the front of 'pending_opens_'. Called once for every
+  // replica registered by Init().
+  void OpenNextPendingTablet(std::atomic<int>* tablets_processed,
+                             std::atomic<int>* tablets_total,
+                             Timer* start_tablets);
+
   // Open a tablet whose metadata has already been loaded.
   void BootstrapAndInitTablet(const scoped_refptr<tablet::TabletMetadata>& meta,
                               scoped_refptr<tablet::TabletReplica>* replica);
@@ -457,6 +476,28 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   // Holds cached tablet states from tablet_map_.
   std::map<tablet::TabletStatePB, int> tablet_state_counts_;
 
+  // A replica registered at startup which is waiting to be opened.
+  struct PendingOpen {
+    scoped_refptr<tablet::TabletReplica> replica;
+    scoped_refptr<TransitionInProgressDeleter> deleter;
+  };
+
+  // Protects 'pending_opens_' and 'pending_opens_by_id_'.
+  simple_spinlock pending_opens_lock_;
+
+  // The replicas registered at startup which haven't started opening yet, in
+  // the order to open them in, and the positions of the replicas in that list
+  // keyed by tablet ID.
+  std::list<PendingOpen> pending_opens_;
+  std::unordered_map<std::string, std::list<PendingOpen>::iterator> pending_opens_by_id_;
+
+  // The number of replicas in 'pending_opens_', to skip taking the lock in
+  // PrioritizeTabletOpen() once all the replicas have started opening.
+  std::atomic<int> num_pending_opens_ = 0;
+
+  // See SetPendingOpenHookForTests().
+  static std::function<void()> pending_open_hook_for_tests_;
+
   // Set of transactions that have a pending call to abort, indicating that
   // further attempts to schedule such a call can be ignored.
   simple_spinlock txn_aborts_lock_;
@@ -479,6 +520,10 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   // Thread pool used to perform background tasks on transactions, e.g. to commit.
   std::unique_ptr<ThreadPool> txn_commit_pool_;
 
+  // Thread pool shared by the tablets' flushes and compactions to write the
+  // columns of their rowsets in parallel. Null if they're written serially.
+  std::unique_ptr<ThreadPool> column_writer_pool_;
+
   // Thread pool to perform preliminary tasks when processing write operations
   // in the context of a multi-row transaction. Such tasks include registering
   // tablet as a participant in the corresponding transaction, etc.
@@ -59,6 +59,46 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage"
                            "Memory consumed by the block cache",
                            kudu::MetricLevel::kInfo);
 
+METRIC_DEFINE_counter(server, block_cache_compressed_inserts,
+                      "Compressed Block Cache Inserts", kudu::MetricUnit::kBlocks,
+                      "Number of compressed blocks inserted in the compressed tier of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_lookups,
+                      "Compressed Block Cache Lookups", kudu::MetricUnit::kBlocks,
+                      "Number of compressed blocks looked up from the compressed tier of the "
+                      "cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_evictions,
+                      "Compressed Block Cache Evictions", kudu::MetricUnit::kBlocks,
+                      "Number of compressed blocks evicted from the compressed tier of the cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_misses,
+                      "Compressed Block Cache Misses", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed tier of the cache that didn't "
+                      "yield a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_misses_caching,
+                      "Compressed Block Cache Misses (Caching)", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed tier of the cache that were "
+                      "expecting a block that didn't yield one",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_hits,
+                      "Compressed Block Cache Hits", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed tier of the cache that found a block",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_compressed_hits_caching,
+                      "Compressed Block Cache Hits (Caching)", kudu::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed tier of the cache that were "
+                      "expecting a block that found one. Every such hit saves reading "
+                      "the block from disk",
+                      kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_gauge_uint64(server, block_cache_compressed_usage,
+                           "Compressed Block Cache Memory Usage",
+                           kudu::MetricUnit::kBytes,
+                           "Memory consumed by the compressed tier of the block cache",
+                           kudu::MetricLevel::kInfo);
+
 METRIC_DEFINE_histogram(server, block_cache_upgrades_stats,
                         "Block Cache Upgrades Stats", kudu::MetricUnit::kBlocks,
                         "Histogram of the number of times an entry has been upgraded",
@@ -95,6 +135,17 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_protected_segment_usage,
                            "Memory consumed by the protected segment of the block cache",
                            kudu::MetricLevel::kInfo);
 
+METRIC_DEFINE_counter(server, block_cache_tinylfu_admissions,
+                      "Block Cache TinyLFU Admissions", kudu::MetricUnit::kBlocks,
+                      "Number of blocks admitted from the window into the main region "
+                      "of the TinyLFU cache",
+                      kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(server, block_cache_tinylfu_rejections,
+                      "Block Cache TinyLFU Rejections", kudu::MetricUnit::kBlocks,
+                      "Number of blocks evicted from the window of the TinyLFU cache because "
+                      "they were accessed less frequently than the blocks of the main region",
+                      kudu::MetricLevel::kDebug);
+
 namespace kudu {
 
 #define MINIT(member, x) member = METRIC_##x.Instantiate(entity)
@@ -110,6 +161,18 @@ BlockCacheMetrics::BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity)
   GINIT(cache_usage, block_cache_usage);
 }
 
+CompressedBlockCacheMetrics::CompressedBlockCacheMetrics(
+    const scoped_refptr<MetricEntity>& entity) {
+  MINIT(inserts, block_cache_compressed_inserts);
+  MINIT(lookups, block_cache_compressed_lookups);
+  MINIT(evictions, block_cache_compressed_evictions);
+  MINIT(cache_hits, block_cache_compressed_hits);
+  MINIT(cache_hits_caching, block_cache_compressed_hits_caching);
+  MINIT(cache_misses, block_cache_compressed_misses);
+  MINIT(cache_misses_caching, block_cache_compressed_misses_caching);
+  GINIT(cache_usage, block_cache_compressed_usage);
+}
+
 SLRUCacheMetrics::SLRUCacheMetrics(const scoped_refptr<MetricEntity>& entity) {
   MINIT(inserts, block_cache_inserts);
   MINIT(lookups, block_cache_lookups);
@@ -130,6 +193,20 @@ SLRUCacheMetrics::SLRUCacheMetrics(const scoped_refptr<MetricEntity>& entity) {
   MINIT(protected_segment_evictions, block_cache_protected_segment_evictions);
   GINIT(protected_segment_cache_usage, block_cache_protected_segment_usage);
 }
+
+TinyLFUCacheMetrics::TinyLFUCacheMetrics(const scoped_refptr<MetricEntity>& entity) {
+  MINIT(inserts, block_cache_inserts);
+  MINIT(lookups, block_cache_lookups);
+  MINIT(evictions, block_cache_evictions);
+  MINIT(cache_hits, block_cache_hits);
+  MINIT(cache_hits_caching, block_cache_hits_caching);
+  MINIT(cache_misses, block_cache_misses);
+  MINIT(cache_misses_caching, block_cache_misses_caching);
+  GINIT(cache_usage, block_cache_usage);
+
+  MINIT(admissions, block_cache_tinylfu_admissions);
+  MINIT(rejections, block_cache_tinylfu_rejections);
+}
 #undef MINIT
 #undef GINIT
 
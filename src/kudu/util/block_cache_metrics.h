@@ -28,4 +28,9 @@ struct BlockCacheMetrics : public CacheMetrics {
   explicit BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
 };
 
+// Metrics of the block cache tier which holds compressed blocks.
+struct CompressedBlockCacheMetrics : public CacheMetrics {
+  explicit CompressedBlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
+};
+
 } // namespace kudu
@@ -89,4 +89,35 @@ TEST(TestBloomFilter, TestInsertAndProbe) {
   ASSERT_NEAR(fp_rate, expected_fp_rate, 0.20*expected_fp_rate);
 }
 
+TEST(TestBloomFilter, TestShrinkToFPRate) {
+  int n_keys = 2000;
+  BloomFilterBuilder bfb(BloomFilterSizing::BySizeAndFPRate(64 * 1024, 0.01));
+  AddRandomKeys(kRandomSeed, n_keys, &bfb);
+
+  // The filter is sized for far more keys than were added, so it should
+  // shrink down to about 9 bits per key, rounded up to a power of two.
+  bfb.ShrinkToFPRate(0.01);
+  ASSERT_LT(bfb.n_bytes(), 64 * 1024);
+  ASSERT_GE(bfb.n_bits(), 9 * n_keys);
+  ASSERT_LE(bfb.n_bits(), 4 * 9 * n_keys);
+
+  // All the inserted keys must still be present.
+  BloomFilter bf(bfb.slice(), bfb.n_hashes());
+  CheckRandomKeys(kRandomSeed, n_keys, bf);
+
+  uint32_t num_queries = 100000;
+  uint32_t num_positives = 0;
+  for (int i = 0; i < num_queries; i++) {
+    uint64_t key = random();
+    Slice key_slice(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+    BloomKeyProbe probe(key_slice);
+    if (bf.MayContainKey(probe)) {
+      num_positives++;
+    }
+  }
+  double fp_rate = static_cast<double>(num_positives) / static_cast<double>(num_queries);
+  LOG(INFO) << "FP rate after shrinking to " << bfb.n_bytes() << " bytes: " << fp_rate;
+  ASSERT_LE(fp_rate, 0.01 * 1.2);
+}
+
 } // namespace kudu
@@ -23,6 +23,8 @@
 
 #include <glog/logging.h>
 
+#include "kudu/gutil/bits.h"
+
 namespace kudu {
 
 static double kNaturalLog2 = 0.69314;
@@ -78,6 +80,27 @@ double BloomFilterBuilder::false_positive_rate() const {
   return pow(1 - exp(-static_cast<double>(n_hashes_) * expected_count_ / n_bits_), n_hashes_);
 }
 
+void BloomFilterBuilder::ShrinkToFPRate(double fp_rate) {
+  // Since bits are picked modulo the filter's size, a key's bit in a filter
+  // of half the size is the key's bit in the full-size filter, modulo the
+  // new size. Folding keeps the filter's size a whole number of bytes.
+  while (n_bytes() % 2 == 0 && n_bytes() > 1) {
+    const int half_bytes = n_bytes() / 2;
+    size_t set_bits = 0;
+    for (int i = 0; i < half_bytes; i++) {
+      set_bits += Bits::CountOnes(bitmap_[i] | bitmap_[i + half_bytes]);
+    }
+    const double fill_ratio = static_cast<double>(set_bits) / (half_bytes * 8);
+    if (pow(fill_ratio, n_hashes_) > fp_rate) {
+      break;
+    }
+    for (int i = 0; i < half_bytes; i++) {
+      bitmap_[i] |= bitmap_[i + half_bytes];
+    }
+    n_bits_ /= 2;
+  }
+}
+
 BloomFilter::BloomFilter(const Slice &data, size_t n_hashes)
   : n_bits_(data.size() * 8),
     bitmap_(reinterpret_cast<const uint8_t *>(data.data())),
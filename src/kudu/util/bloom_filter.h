@@ -147,6 +147,15 @@ class BloomFilterBuilder {
   // Return an estimate of the false positive rate.
   double false_positive_rate() const;
 
+  // Repeatedly halve the size of the filter, folding its upper half onto its
+  // lower half, as long as the fraction of set bits keeps the false positive
+  // rate of the resulting filter at or below 'fp_rate'.
+  //
+  // This allows building a filter for an unknown number of keys by sizing it
+  // generously up front and shrinking it once all keys have been added.
+  // Keys may still be added to the filter after it has been shrunk.
+  void ShrinkToFPRate(double fp_rate);
+
   int n_bytes() const {
     return n_bits_ / 8;
   }
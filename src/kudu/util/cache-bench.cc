@@ -61,7 +61,10 @@ struct BenchSetup {
     UNIFORM,
     // A small number of pre-determined items with small values are frequently looked up
     // while random items with large values are looked up less frequently.
-    PRE_DETERMINED_FREQUENT_LOOKUPS
+    PRE_DETERMINED_FREQUENT_LOOKUPS,
+    // Nearly every lookup is for a new key and misses, so the entry is
+    // inserted, as when scanning data which isn't cached.
+    INSERTS
   };
   Pattern pattern;
 
@@ -70,6 +73,7 @@ struct BenchSetup {
       case Pattern::ZIPFIAN: return "ZIPFIAN";
       case Pattern::UNIFORM: return "UNIFORM";
       case Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS: return "PRE_DETERMINED_FREQUENT_LOOKUPS";
+      case Pattern::INSERTS: return "INSERTS";
       default: LOG(FATAL) << "unexpected benchmark pattern: " << static_cast<int>(pattern); break;
     }
     return "unknown benchmark pattern";
@@ -113,6 +117,8 @@ struct BenchSetup {
     }
     if (eviction_policy == Cache::EvictionPolicy::SLRU) {
       ret += " SLRU";
+    } else if (eviction_policy == Cache::EvictionPolicy::CLOCK) {
+      ret += " CLOCK";
     } else {
       ret += " LRU";
     }
@@ -149,6 +155,9 @@ class CacheBench : public KuduTest,
         setup.params.entry_size = setup.params.probationary_segment_capacity
             / (slru_cache->shards_.size() * 2);
       }
+    } else if (setup.eviction_policy == Cache::EvictionPolicy::CLOCK) {
+      cache_.reset(NewCache<Cache::EvictionPolicy::CLOCK, Cache::MemoryType::DRAM>(
+          setup.params.cache_capacity, "test-cache"));
     } else {
       cache_.reset(NewCache(setup.params.cache_capacity, "test-cache"));
     }
@@ -181,6 +190,9 @@ class CacheBench : public KuduTest,
             int_key = r.Uniform(setup.max_key());
           }
           break;
+        case BenchSetup::Pattern::INSERTS:
+          int_key = r.Next32();
+          break;
         default:
           LOG(FATAL) << "Unsupported benchmark pattern" << setup.ToString(setup.pattern);
       }
@@ -236,29 +248,40 @@ class CacheBench : public KuduTest,
 // fits in the cache and where it is a bit larger.
 INSTANTIATE_TEST_SUITE_P(Patterns, CacheBench, testing::ValuesIn(std::vector<BenchSetup>{
       {BenchSetup::Pattern::ZIPFIAN, 1.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::ZIPFIAN, 1.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::ZIPFIAN, 1.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::ZIPFIAN, 1.0, Cache::EvictionPolicy::SLRU,
        BenchSetup::kTriggerConcurrencyError},
       {BenchSetup::Pattern::ZIPFIAN, 3.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::ZIPFIAN, 3.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::ZIPFIAN, 3.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::ZIPFIAN, 3.0, Cache::EvictionPolicy::SLRU,
        BenchSetup::kTriggerConcurrencyError},
       {BenchSetup::Pattern::UNIFORM, 1.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::UNIFORM, 1.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::UNIFORM, 1.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::UNIFORM, 1.0, Cache::EvictionPolicy::SLRU,
        BenchSetup::kTriggerConcurrencyError},
       {BenchSetup::Pattern::UNIFORM, 3.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::UNIFORM, 3.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::UNIFORM, 3.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::UNIFORM, 3.0, Cache::EvictionPolicy::SLRU,
        BenchSetup::kTriggerConcurrencyError},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 1.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 1.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 1.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 1.0, Cache::EvictionPolicy::SLRU,
        BenchSetup::kTriggerConcurrencyError},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 3.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 3.0, Cache::EvictionPolicy::CLOCK},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 3.0, Cache::EvictionPolicy::SLRU},
       {BenchSetup::Pattern::PRE_DETERMINED_FREQUENT_LOOKUPS, 3.0, Cache::EvictionPolicy::SLRU,
-       BenchSetup::kTriggerConcurrencyError}
+       BenchSetup::kTriggerConcurrencyError},
+      // The inserts and erasures of a CLOCK cache take its per-CPU lock
+      // exclusively, which gets more expensive with the number of CPUs, so
+      // compare it with LRU on a workload of mostly inserts.
+      {BenchSetup::Pattern::INSERTS, 1.0, Cache::EvictionPolicy::LRU},
+      {BenchSetup::Pattern::INSERTS, 1.0, Cache::EvictionPolicy::CLOCK}
     }));
 
 TEST_P(CacheBench, RunBench) {
@@ -4,10 +4,12 @@
 
 #include "kudu/util/cache.h"
 
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -146,6 +148,15 @@ class CacheBaseTest : public KuduTest,
         }
         MemTracker::FindTracker("cache_test-sharded_lru_cache", &mem_tracker_);
         break;
+      case Cache::EvictionPolicy::CLOCK:
+        if (mem_type != Cache::MemoryType::DRAM) {
+          FAIL() << "CLOCK cache can only be of DRAM type";
+        }
+        cache_.reset(NewCache<Cache::EvictionPolicy::CLOCK,
+                              Cache::MemoryType::DRAM>(cache_size(),
+                                                       "cache_test"));
+        MemTracker::FindTracker("cache_test-sharded_clock_cache", &mem_tracker_);
+        break;
       default:
         FAIL() << "unrecognized cache eviction policy";
         break;
@@ -208,6 +219,12 @@ INSTANTIATE_TEST_SUITE_P(
         make_tuple(Cache::MemoryType::DRAM,
                    Cache::EvictionPolicy::LRU,
                    ShardingPolicy::SingleShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
+                   ShardingPolicy::MultiShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
+                   ShardingPolicy::SingleShard),
         make_tuple(Cache::MemoryType::NVM,
                    Cache::EvictionPolicy::LRU,
                    ShardingPolicy::MultiShard),
@@ -533,4 +550,92 @@ TEST_P(LRUCacheTest, EvictionPolicy) {
   ASSERT_EQ(-1, Lookup(200));
 }
 
+// This class is dedicated for scenarios specific for CLOCK cache.
+class ClockCacheTest :
+    public CacheBaseTest,
+    public ::testing::WithParamInterface<ShardingPolicy> {
+ public:
+  ClockCacheTest()
+      : CacheBaseTest(16 * 1024 * 1024) {
+  }
+
+  void SetUp() override {
+    SetupWithParameters(Cache::MemoryType::DRAM,
+                        Cache::EvictionPolicy::CLOCK,
+                        GetParam());
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    CacheTypes, ClockCacheTest,
+    ::testing::Values(ShardingPolicy::MultiShard,
+                      ShardingPolicy::SingleShard));
+
+TEST_P(ClockCacheTest, EvictionPolicy) {
+  static constexpr int kNumElems = 1000;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  Insert(100, 101);
+  Insert(200, 201);
+
+  // Loop adding new entries, but repeatedly accessing key 100. This
+  // frequently-used entry gets another chance every time the eviction
+  // gets to it, so it should not be evicted.
+  for (int i = 0; i < kNumElems + 1000; i++) {
+    Insert(1000+i, 2000+i, size_per_elem);
+    ASSERT_EQ(101, Lookup(100));
+  }
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_EQ(2000 + kNumElems + 999, Lookup(1000 + kNumElems + 999));
+  // Since '200' wasn't accessed in the loop above, it should have
+  // been evicted.
+  ASSERT_EQ(-1, Lookup(200));
+}
+
+// When all the entries have been used since the eviction last passed over
+// them, the eviction mustn't fall back to evicting the entry being inserted.
+TEST_P(ClockCacheTest, NewEntriesAreNotEvicted) {
+  static constexpr int kNumElems = 1000;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  for (int i = 0; i < kNumElems * 2; i++) {
+    Insert(i, 1000+i, size_per_elem);
+    ASSERT_EQ(1000+i, Lookup(i));
+  }
+}
+
+// Look up the same entries from many threads while other threads insert
+// and erase entries.
+TEST_P(ClockCacheTest, ConcurrentLookups) {
+  static constexpr int kNumReaders = 8;
+  static constexpr int kNumKeys = 100;
+  static constexpr int kNumLookups = 10000;
+  for (int i = 0; i < kNumKeys; i++) {
+    Insert(i, i);
+  }
+  std::atomic<bool> done(false);
+  vector<std::thread> threads;
+  for (int t = 0; t < kNumReaders; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumLookups; i++) {
+        const int key = (t + i) % kNumKeys;
+        auto handle(cache_->Lookup(EncodeInt(key), Cache::EXPECT_IN_CACHE));
+        CHECK(handle);
+        CHECK_EQ(key, DecodeInt(cache_->Value(handle)));
+      }
+    });
+  }
+  threads.emplace_back([&]() {
+    for (int i = kNumKeys; !done; i++) {
+      Insert(i, i);
+      Erase(i);
+    }
+  });
+  for (int t = 0; t < kNumReaders; t++) {
+    threads[t].join();
+  }
+  done = true;
+  threads.back().join();
+}
+
 }  // namespace kudu
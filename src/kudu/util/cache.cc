@@ -8,7 +8,9 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -76,6 +78,10 @@ string ToString(Cache::EvictionPolicy p) {
       return "lru";
     case Cache::EvictionPolicy::SLRU:
       return "slru";
+    case Cache::EvictionPolicy::CLOCK:
+      return "clock";
+    case Cache::EvictionPolicy::TINYLFU:
+      return "tinylfu";
     default:
       LOG(FATAL) << "unexpected cache eviction policy: " << static_cast<int>(p);
       break;
@@ -83,6 +89,27 @@ string ToString(Cache::EvictionPolicy p) {
   return "unknown";
 }
 
+// The type of the lock protecting the state of a cache shard. The lookups of
+// a CLOCK cache don't modify the recency list, so they only need to share
+// the lock, and a per-CPU reader-writer lock keeps them from contending with
+// each other. The price is paid by inserts and erasures, which acquire the
+// lock of every CPU, so their cost grows with the number of CPUs.
+template<Cache::EvictionPolicy policy>
+struct CacheShardLock {
+  typedef simple_spinlock type;
+};
+
+template<>
+struct CacheShardLock<Cache::EvictionPolicy::CLOCK> {
+  typedef percpu_rwlock type;
+};
+
+// The usage count which lookups set the entries of a CLOCK cache to.
+// Entries which are looked up are passed over by the eviction this many
+// times before they're evicted unless they're looked up again, while
+// entries which are inserted but never looked up are passed over once.
+constexpr uint8_t kMaxUsageCount = 3;
+
 // A single shard of sharded cache.
 template<Cache::EvictionPolicy policy>
 class CacheShard {
@@ -110,6 +137,10 @@ class CacheShard {
   void RL_Append(RLHandle* e);
   // Update the recency list after a lookup operation.
   void RL_UpdateAfterLookup(RLHandle* e);
+  // Return true if the oldest entry 'e' gets another chance to stay in the
+  // cache instead of being evicted to make room for 'inserted', in which case
+  // it's moved to the end of the recency list.
+  bool RL_GiveAnotherChance(RLHandle* e, const RLHandle* inserted);
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(RLHandle* e);
@@ -144,7 +175,7 @@ class CacheShard {
   size_t capacity_;
 
   // mutex_ protects the following state.
-  simple_spinlock mutex_;
+  typename CacheShardLock<policy>::type mutex_;
   size_t usage_;
 
   // Dummy head of recency list.
@@ -267,6 +298,32 @@ void CacheShard<Cache::EvictionPolicy::LRU>::RL_UpdateAfterLookup(RLHandle* e) {
   RL_Append(e);
 }
 
+template<Cache::EvictionPolicy policy>
+bool CacheShard<policy>::RL_GiveAnotherChance(RLHandle* /* e */,
+                                              const RLHandle* /* inserted */) {
+  return false;
+}
+
+template<>
+bool CacheShard<Cache::EvictionPolicy::CLOCK>::RL_GiveAnotherChance(
+    RLHandle* e, const RLHandle* inserted) {
+  // Lookups can't reset the usage counts while the eviction holds the lock
+  // exclusively, so the eviction goes around the recency list at most
+  // kMaxUsageCount + 1 times before finding an entry to evict.
+  const uint8_t usage_count = e->usage_count.load(std::memory_order_relaxed);
+  if (usage_count > 0) {
+    e->usage_count.store(usage_count - 1, std::memory_order_relaxed);
+  } else if (e != inserted || rl_.prev == e) {
+    // Like the LRU cache, evict the entry being inserted only if it's the
+    // only entry left, even if all the older entries have been used since
+    // the eviction last passed over them.
+    return false;
+  }
+  RL_Remove(e);
+  RL_Append(e);
+  return true;
+}
+
 template<Cache::EvictionPolicy policy>
 Cache::Handle* CacheShard<policy>::Lookup(const Slice& key,
                                           uint32_t hash,
@@ -287,6 +344,34 @@ Cache::Handle* CacheShard<policy>::Lookup(const Slice& key,
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+template<>
+Cache::Handle* CacheShard<Cache::EvictionPolicy::CLOCK>::Lookup(const Slice& key,
+                                                               uint32_t hash,
+                                                               bool caching) {
+  RLHandle* e;
+  {
+    // Lookups only mark the entry as used, so they share the lock.
+    // Entries are removed from the table only while the lock is held
+    // exclusively, so the entry can't be freed before its reference
+    // count is incremented.
+    std::shared_lock l(mutex_.get_lock());
+    e = table_.Lookup(key, hash);
+    if (e != nullptr) {
+      e->refs.fetch_add(1, std::memory_order_relaxed);
+      // Avoid dirtying the cache line of a frequently accessed entry
+      // once it's marked.
+      if (e->usage_count.load(std::memory_order_relaxed) != kMaxUsageCount) {
+        e->usage_count.store(kMaxUsageCount, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Do the metrics outside the lock.
+  UpdateMetricsLookup(e != nullptr, caching);
+
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
 template<Cache::EvictionPolicy policy>
 void CacheShard<policy>::Release(Cache::Handle* handle) {
   RLHandle* e = reinterpret_cast<RLHandle*>(handle);
@@ -304,6 +389,10 @@ Cache::Handle* CacheShard<policy>::Insert(
   handle->eviction_callback = eviction_callback;
   // Two refs for the handle: one from CacheShard, one for the returned handle.
   handle->refs.store(2, std::memory_order_relaxed);
+  // With the CLOCK eviction policy, a new entry gets one more chance to stay
+  // in the cache than the entries which have been passed over since they
+  // were last used.
+  handle->usage_count.store(1, std::memory_order_relaxed);
   UpdateMemTracker(handle->charge);
   if (PREDICT_TRUE(metrics_)) {
     metrics_->cache_usage->IncrementBy(handle->charge);
@@ -327,6 +416,9 @@ Cache::Handle* CacheShard<policy>::Insert(
 
     while (usage_ > capacity_ && rl_.next != &rl_) {
       RLHandle* old = rl_.next;
+      if (RL_GiveAnotherChance(old, handle)) {
+        continue;
+      }
       RL_Remove(old);
       table_.Remove(old->key(), old->hash);
       if (Unref(old)) {
@@ -571,6 +663,12 @@ Cache* NewCache<Cache::EvictionPolicy::LRU,
   return new ShardedCache<Cache::EvictionPolicy::LRU>(capacity, id);
 }
 
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id) {
+  return new ShardedCache<Cache::EvictionPolicy::CLOCK>(capacity, id);
+}
+
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type) {
   switch (mem_type) {
     case Cache::MemoryType::DRAM:
@@ -56,6 +56,20 @@ class Cache {
 
     // Segmented version of LRU.
     SLRU,
+
+    // An approximation of LRU: lookups only mark the entries as used, and
+    // the eviction gives the recently used entries more chances to stay in
+    // the cache. Unlike the LRU cache, lookups don't reorder the entries,
+    // so concurrent lookups don't exclude each other. They still take a
+    // per-CPU shared lock, though, and inserts and erasures take it
+    // exclusively, which costs more the more CPUs there are: with workloads
+    // of mostly inserts, the LRU cache may perform better (see cache-bench).
+    CLOCK,
+
+    // Segmented LRU behind a small window LRU, admitting entries from the
+    // window only if their keys are accessed more frequently than those of
+    // the entries they'd displace (W-TinyLFU).
+    TINYLFU,
   };
 
   // Callback interface which is called when an entry is evicted from the cache.
@@ -81,6 +95,12 @@ class Cache {
     std::atomic<int32_t> refs;
     uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
 
+    // The number of times the eviction may pass over the entry before evicting
+    // it. Set when the entry is inserted or looked up, and decremented every
+    // time the eviction gives the entry another chance to stay in the cache.
+    // Used by the CLOCK eviction policy.
+    std::atomic<uint8_t> usage_count;
+
     // The storage for the key/value pair itself. The data is stored as:
     //   [key bytes ...] [padding up to 8-byte boundary] [value bytes ...]
     uint8_t kv_data[1];   // Beginning of key/value pair
@@ -503,6 +523,14 @@ template<>
 Cache* NewCache<Cache::EvictionPolicy::LRU,
                 Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
 
+// Create a new CLOCK cache with a fixed size capacity. This implementation
+// of Cache uses the CLOCK eviction policy and stored in DRAM.
+// Its lookups share the lock of the cache shard, so they scale with
+// the number of concurrent readers better than the LRU cache's lookups.
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
+
 // A helper method to output cache memory type into ostream.
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type);
 
@@ -55,4 +55,13 @@ struct SLRUCacheMetrics : public CacheMetrics {
   scoped_refptr<AtomicGauge<uint64_t>> protected_segment_cache_usage;
 };
 
+struct TinyLFUCacheMetrics : public CacheMetrics {
+  explicit TinyLFUCacheMetrics(const scoped_refptr<MetricEntity>& entity);
+
+  // Entries moved from the window into the main region of the cache, and
+  // entries evicted from the window instead by the admission policy.
+  scoped_refptr<Counter> admissions;
+  scoped_refptr<Counter> rejections;
+};
+
 } // namespace kudu
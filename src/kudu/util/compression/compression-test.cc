@@ -30,6 +30,7 @@
 
 #include "kudu/util/compression/compression.pb.h"
 #include "kudu/util/compression/compression_codec.h"
+#include "kudu/util/faststring.h"
 #include "kudu/util/random.h"
 #include "kudu/util/random_util.h"
 #include "kudu/util/slice.h"
@@ -152,16 +153,84 @@ TEST_F(TestCompression, TestNoCompressionCodec) {
 }
 
 TEST_F(TestCompression, TestSnappyCompressionCodec) {
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     NO_FATALS(TestCompressionCodec(type));
   }
 }
 
 TEST_F(TestCompression, TestSimpleBenchmark) {
   Random r(SeedRandom());
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     ASSERT_OK(Benchmark(r, type));
   }
 }
 
+TEST_F(TestCompression, TestZstdDictionary) {
+  constexpr int kNumSamples = 1000;
+  constexpr size_t kMaxDictSize = 4 * 1024;
+
+  // Generate samples which share a lot of content, like cells of a string column.
+  Random r(SeedRandom());
+  vector<string> words;
+  for (int i = 0; i < 64; ++i) {
+    words.emplace_back(RandomString(8 + r.Uniform(8), &r));
+  }
+  vector<string> sample_strs;
+  for (int i = 0; i < kNumSamples; ++i) {
+    string sample;
+    for (int j = 0; j < 16; ++j) {
+      sample += words[r.Uniform(words.size())];
+    }
+    sample_strs.emplace_back(std::move(sample));
+  }
+  vector<Slice> samples(sample_strs.begin(), sample_strs.end());
+
+  // Only ZSTD supports dictionaries.
+  faststring dict;
+  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+    Status s = TrainCompressionDictionary(type, samples, kMaxDictSize, &dict);
+    ASSERT_TRUE(s.IsNotSupported()) << s.ToString();
+    unique_ptr<CompressionCodec> codec;
+    s = NewCompressionCodecWithDictionary(type, Slice("dict"), &codec);
+    ASSERT_TRUE(s.IsNotSupported()) << s.ToString();
+  }
+
+  ASSERT_OK(TrainCompressionDictionary(ZSTD, samples, kMaxDictSize, &dict));
+  ASSERT_GT(dict.size(), 0);
+  ASSERT_LE(dict.size(), kMaxDictSize);
+
+  unique_ptr<CompressionCodec> dict_codec;
+  ASSERT_OK(NewCompressionCodecWithDictionary(ZSTD, Slice(dict), &dict_codec));
+  ASSERT_EQ(ZSTD, dict_codec->type());
+  const CompressionCodec* plain_codec;
+  ASSERT_OK(GetCompressionCodec(ZSTD, &plain_codec));
+
+  // Small inputs compress better with the dictionary, and round-trip
+  // only through a codec using the same dictionary.
+  size_t dict_total = 0;
+  size_t plain_total = 0;
+  for (int i = 0; i < 100; ++i) {
+    const Slice input(sample_strs[r.Uniform(kNumSamples)]);
+    unique_ptr<uint8_t[]> cbuffer(new uint8_t[dict_codec->MaxCompressedLength(input.size())]);
+    unique_ptr<uint8_t[]> ubuffer(new uint8_t[input.size()]);
+    size_t compressed;
+    ASSERT_OK(plain_codec->Compress(input, cbuffer.get(), &compressed));
+    plain_total += compressed;
+
+    ASSERT_OK(dict_codec->Compress(input, cbuffer.get(), &compressed));
+    dict_total += compressed;
+    ASSERT_OK(dict_codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                     ubuffer.get(), input.size()));
+    ASSERT_EQ(0, memcmp(input.data(), ubuffer.get(), input.size()));
+    Status s = plain_codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                       ubuffer.get(), input.size());
+    ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+  }
+  ASSERT_LT(dict_total, plain_total);
+
+  // Training fails if there isn't enough sample data.
+  Status s = TrainCompressionDictionary(ZSTD, { Slice("too little data") }, kMaxDictSize, &dict);
+  ASSERT_TRUE(s.IsRuntimeError()) << s.ToString();
+}
+
 } // namespace kudu
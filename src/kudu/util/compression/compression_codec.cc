@@ -17,25 +17,46 @@
 
 #include "kudu/util/compression/compression_codec.h"
 
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <lz4.h>
 #include <snappy-sinksource.h>
 #include <snappy.h>
+#include <zdict.h>
 #include <zlib.h>
+// For ZSTD_createDDict_byReference().
+#define ZSTD_STATIC_LINKING_ONLY
+#include <zstd.h>
 
 #include "kudu/gutil/singleton.h"
 #include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/string_case.h"
 
+DEFINE_int32(zstd_compression_level, 3,
+             "Compression level used by the ZSTD codec. Higher levels compress "
+             "better at the expense of compression speed; decompression speed "
+             "is roughly the same for all levels.");
+TAG_FLAG(zstd_compression_level, advanced);
+DEFINE_validator(zstd_compression_level, [](const char* /*n*/, int32 v) {
+  return v >= ZSTD_minCLevel() && v <= ZSTD_maxCLevel();
+});
+
 namespace kudu {
 
+using std::unique_ptr;
 using std::vector;
+using strings::Substitute;
 
 CompressionCodec::CompressionCodec() {
 }
@@ -243,6 +264,178 @@ class ZlibCodec : public CompressionCodec {
   }
 };
 
+// ZSTD contexts are expensive to create and aren't thread-safe, so each thread
+// keeps its own pair and reuses them for all the calls it makes into the codec.
+struct ZstdCCtxDeleter {
+  void operator()(ZSTD_CCtx* cctx) const {
+    ZSTD_freeCCtx(cctx);
+  }
+};
+
+struct ZstdDCtxDeleter {
+  void operator()(ZSTD_DCtx* dctx) const {
+    ZSTD_freeDCtx(dctx);
+  }
+};
+
+struct ZstdCDictDeleter {
+  void operator()(ZSTD_CDict* cdict) const {
+    ZSTD_freeCDict(cdict);
+  }
+};
+
+struct ZstdDDictDeleter {
+  void operator()(ZSTD_DDict* ddict) const {
+    ZSTD_freeDDict(ddict);
+  }
+};
+
+static ZSTD_CCtx* ThreadLocalZstdCCtx() {
+  static thread_local unique_ptr<ZSTD_CCtx, ZstdCCtxDeleter> cctx(ZSTD_createCCtx());
+  return cctx.get();
+}
+
+static ZSTD_DCtx* ThreadLocalZstdDCtx() {
+  static thread_local unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter> dctx(ZSTD_createDCtx());
+  return dctx.get();
+}
+
+class ZstdCodec : public CompressionCodec {
+ public:
+  static ZstdCodec *GetSingleton() {
+    return Singleton<ZstdCodec>::get();
+  }
+
+  ZstdCodec() = default;
+
+  // Creates a codec which compresses and uncompresses using the given
+  // dictionary. The dictionary is copied, so 'dict' needn't outlive the codec.
+  // The digested dictionaries refer to the codec's copy rather than keeping
+  // copies of their own.
+  explicit ZstdCodec(const Slice& dict)
+      : dict_(dict.ToString()),
+        ddict_(ZSTD_createDDict_byReference(dict_.data(), dict_.size())) {
+  }
+
+  bool has_dictionary() const {
+    return ddict_ != nullptr;
+  }
+
+  Status Compress(const Slice& input,
+                  uint8_t *compressed, size_t *compressed_length) const override {
+    return CompressSlices(&input, 1, compressed, compressed_length);
+  }
+
+  Status Compress(const vector<Slice>& input_slices,
+                  uint8_t *compressed, size_t *compressed_length) const override {
+    if (input_slices.empty()) {
+      return Compress(Slice(), compressed, compressed_length);
+    }
+    return CompressSlices(input_slices.data(), input_slices.size(),
+                          compressed, compressed_length);
+  }
+
+  Status Uncompress(const Slice& compressed,
+                    uint8_t *uncompressed, size_t uncompressed_length) const override {
+    ZSTD_DCtx* dctx = ThreadLocalZstdDCtx();
+    const size_t n = ddict_
+        ? ZSTD_decompress_usingDDict(dctx, uncompressed, uncompressed_length,
+                                     compressed.data(), compressed.size(), ddict_.get())
+        : ZSTD_decompressDCtx(dctx, uncompressed, uncompressed_length,
+                              compressed.data(), compressed.size());
+    if (PREDICT_FALSE(ZSTD_isError(n))) {
+      return Status::Corruption(
+          Substitute("unable to uncompress the buffer: $0", ZSTD_getErrorName(n)),
+          KUDU_REDACT(compressed.ToDebugString(100)));
+    }
+    if (PREDICT_FALSE(n != uncompressed_length)) {
+      return Status::Corruption(
+          Substitute("uncompressed size $0 does not match the expected size $1",
+                     n, uncompressed_length));
+    }
+    return Status::OK();
+  }
+
+  size_t MaxCompressedLength(size_t source_bytes) const override {
+    return ZSTD_compressBound(source_bytes);
+  }
+
+  CompressionType type() const override {
+    return ZSTD;
+  }
+
+ private:
+  // Compresses the concatenation of 'slices' into a single ZSTD frame,
+  // streaming them through the compressor to avoid copying the input
+  // into a contiguous buffer.
+  Status CompressSlices(const Slice* slices, size_t num_slices,
+                        uint8_t *compressed, size_t *compressed_length) const {
+    size_t total_size = 0;
+    for (size_t i = 0; i < num_slices; ++i) {
+      total_size += slices[i].size();
+    }
+
+    ZSTD_CCtx* cctx = ThreadLocalZstdCCtx();
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    size_t rc;
+    if (has_dictionary()) {
+      ZSTD_CDict* cdict = GetCDict();
+      if (PREDICT_FALSE(!cdict)) {
+        return Status::RuntimeError("unable to load ZSTD dictionary for compression");
+      }
+      rc = ZSTD_CCtx_refCDict(cctx, cdict);
+    } else {
+      rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, FLAGS_zstd_compression_level);
+    }
+    if (!ZSTD_isError(rc)) {
+      // Storing the content size in the frame header lets the compressor pick
+      // better parameters for small inputs, such as CFile blocks.
+      rc = ZSTD_CCtx_setPledgedSrcSize(cctx, total_size);
+    }
+    if (PREDICT_FALSE(ZSTD_isError(rc))) {
+      return Status::RuntimeError(
+          Substitute("unable to initialize the compressor: $0", ZSTD_getErrorName(rc)));
+    }
+
+    ZSTD_outBuffer out = { compressed, MaxCompressedLength(total_size), 0 };
+    for (size_t i = 0; i < num_slices; ++i) {
+      const bool last = i + 1 == num_slices;
+      ZSTD_inBuffer in = { slices[i].data(), slices[i].size(), 0 };
+      size_t remaining;
+      do {
+        remaining = ZSTD_compressStream2(cctx, &out, &in, last ? ZSTD_e_end : ZSTD_e_continue);
+        if (PREDICT_FALSE(ZSTD_isError(remaining))) {
+          return Status::RuntimeError(
+              Substitute("unable to compress the buffer: $0", ZSTD_getErrorName(remaining)));
+        }
+        // The output buffer is sized by ZSTD_compressBound(), so running out
+        // of space here means something is very wrong.
+        if (PREDICT_FALSE(out.pos == out.size && remaining != 0)) {
+          return Status::RuntimeError("unable to compress the buffer: output buffer is full");
+        }
+      } while (last ? remaining != 0 : in.pos < in.size);
+    }
+    *compressed_length = out.pos;
+    return Status::OK();
+  }
+
+  // The digested dictionary for compression is much larger than the one for
+  // decompression, and codecs created when reading data never compress, so
+  // it's built on first use.
+  ZSTD_CDict* GetCDict() const {
+    std::call_once(cdict_once_, [this]() {
+      cdict_.reset(ZSTD_createCDict_byReference(
+          dict_.data(), dict_.size(), FLAGS_zstd_compression_level));
+    });
+    return cdict_.get();
+  }
+
+  const std::string dict_;
+  const unique_ptr<ZSTD_DDict, ZstdDDictDeleter> ddict_;
+  mutable std::once_flag cdict_once_;
+  mutable unique_ptr<ZSTD_CDict, ZstdCDictDeleter> cdict_;
+};
+
 Status GetCompressionCodec(CompressionType compression,
                            const CompressionCodec** codec) {
   switch (compression) {
@@ -258,12 +451,63 @@ Status GetCompressionCodec(CompressionType compression,
     case ZLIB:
       *codec = ZlibCodec::GetSingleton();
       break;
+    case ZSTD:
+      *codec = ZstdCodec::GetSingleton();
+      break;
     default:
       return Status::NotFound("bad compression type");
   }
   return Status::OK();
 }
 
+Status TrainCompressionDictionary(CompressionType compression,
+                                  const vector<Slice>& samples,
+                                  size_t max_dict_size,
+                                  faststring* dict) {
+  if (compression != ZSTD) {
+    return Status::NotSupported(Substitute(
+        "$0 codec doesn't support dictionaries", CompressionType_Name(compression)));
+  }
+
+  // ZDICT expects the samples to be laid out back-to-back in a single buffer.
+  faststring samples_buf;
+  vector<size_t> sample_sizes;
+  sample_sizes.reserve(samples.size());
+  for (const Slice& sample : samples) {
+    samples_buf.append(sample.data(), sample.size());
+    sample_sizes.push_back(sample.size());
+  }
+
+  dict->resize(max_dict_size);
+  const size_t n = ZDICT_trainFromBuffer(dict->data(), max_dict_size,
+                                         samples_buf.data(), sample_sizes.data(),
+                                         sample_sizes.size());
+  if (ZDICT_isError(n)) {
+    dict->clear();
+    return Status::RuntimeError(Substitute(
+        "unable to train a dictionary out of $0 samples ($1 bytes): $2",
+        sample_sizes.size(), samples_buf.size(), ZDICT_getErrorName(n)));
+  }
+  dict->resize(n);
+  return Status::OK();
+}
+
+Status NewCompressionCodecWithDictionary(CompressionType compression,
+                                         const Slice& dict,
+                                         unique_ptr<CompressionCodec>* codec) {
+  if (compression != ZSTD) {
+    return Status::NotSupported(Substitute(
+        "$0 codec doesn't support dictionaries", CompressionType_Name(compression)));
+  }
+  unique_ptr<ZstdCodec> zstd(new ZstdCodec(dict));
+  if (!zstd->has_dictionary()) {
+    return Status::Corruption("unable to load ZSTD dictionary",
+                              KUDU_REDACT(dict.ToDebugString(100)));
+  }
+  *codec = std::move(zstd);
+  return Status::OK();
+}
+
 CompressionType GetCompressionCodecType(const std::string& name) {
   std::string uname;
   ToUpperCase(name, &uname);
@@ -274,6 +518,8 @@ CompressionType GetCompressionCodecType(const std::string& name) {
     return LZ4;
   if (uname == "ZLIB")
     return ZLIB;
+  if (uname == "ZSTD")
+    return ZSTD;
   if (uname == "NO_COMPRESSION")
     return NO_COMPRESSION;
 
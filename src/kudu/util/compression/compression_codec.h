@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,8 @@
 
 namespace kudu {
 
+class faststring;
+
 class CompressionCodec {
  public:
   CompressionCodec();
@@ -70,6 +73,26 @@ class CompressionCodec {
 Status GetCompressionCodec(CompressionType compression,
                            const CompressionCodec** codec);
 
+// Trains a compression dictionary for the specified codec type out of the
+// given 'samples'. The result, at most 'max_dict_size' bytes long, is stored
+// in 'dict'.
+//
+// Returns NotSupported if the codec doesn't support dictionaries, or
+// RuntimeError if training failed (e.g. the samples are too few or too small).
+Status TrainCompressionDictionary(CompressionType compression,
+                                  const std::vector<Slice>& samples,
+                                  size_t max_dict_size,
+                                  faststring* dict);
+
+// Creates a new codec of the specified type which uses 'dict' (as produced by
+// TrainCompressionDictionary()) to compress and uncompress data.
+//
+// Unlike the codecs returned by GetCompressionCodec(), the returned codec is
+// owned by the caller. It doesn't reference 'dict' after this call returns.
+Status NewCompressionCodecWithDictionary(CompressionType compression,
+                                         const Slice& dict,
+                                         std::unique_ptr<CompressionCodec>* codec);
+
 // Returns the compression codec type given the name
 CompressionType GetCompressionCodecType(const std::string& name);
 
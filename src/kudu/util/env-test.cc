@@ -60,6 +60,7 @@
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/strings/util.h"
+#include "kudu/util/alignment.h"
 #include "kudu/util/array_view.h" // IWYU pragma: keep
 #include "kudu/util/env_util.h"
 #include "kudu/util/errno.h"
@@ -590,6 +591,85 @@ TEST_F(TestEnv, TestAppendV) {
   }
 }
 
+// Reads which bypass the page cache return the same data at any offset, and
+// see data which was just written through it.
+TEST_F(TestEnv, TestDirectReads) {
+  const string kTestPath = GetTestPath("test");
+  const size_t kFileSize = 64 * 1024 + 123;
+  NO_FATALS(WriteTestFile(env_, kTestPath, kFileSize));
+
+  RandomAccessFileOptions opts;
+  opts.direct_reads = true;
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(opts, kTestPath, &file));
+  uint8_t scratch[10000];
+  for (size_t offset : { 0UL, 1UL, 4095UL, 4096UL, 12345UL, kFileSize - 10000 }) {
+    Slice s(scratch, sizeof(scratch));
+    ASSERT_OK(file->Read(offset, s));
+    NO_FATALS(VerifyTestData(s, offset));
+  }
+  uint8_t scratch1[3000];
+  uint8_t scratch2[5000];
+  vector<Slice> results = { Slice(scratch1, sizeof(scratch1)), Slice(scratch2, sizeof(scratch2)) };
+  ASSERT_OK(file->ReadV(777, results));
+  NO_FATALS(VerifyTestData(results[0], 777));
+  NO_FATALS(VerifyTestData(results[1], 777 + sizeof(scratch1)));
+  Status s = file->Read(kFileSize - 100, Slice(scratch, 200));
+  ASSERT_TRUE(s.IsEndOfFile()) << s.ToString();
+
+  RWFileOptions rw_opts;
+  rw_opts.direct_reads = true;
+  unique_ptr<RWFile> rw_file;
+  ASSERT_OK(env_->NewRWFile(rw_opts, GetTestPath("rw"), &rw_file));
+  ASSERT_OK(rw_file->Write(0, "abcde12345"));
+  uint8_t rw_scratch[5];
+  Slice rw_result(rw_scratch, sizeof(rw_scratch));
+  ASSERT_OK(rw_file->Read(3, rw_result));
+  ASSERT_EQ("de123", rw_result);
+}
+
+// Direct reads into memory at the same offset within a page as the data is
+// within a page of the file go straight into that memory; the others go
+// through a bounce buffer. Both must produce the same data.
+TEST_F(TestEnv, TestDirectReadsIntoAlignedMemory) {
+  const string kTestPath = GetTestPath("test");
+  const size_t kFileSize = 64 * 1024 + 123;
+  NO_FATALS(WriteTestFile(env_, kTestPath, kFileSize));
+
+  RandomAccessFileOptions opts;
+  opts.direct_reads = true;
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(opts, kTestPath, &file));
+
+  unique_ptr<uint8_t[]> backing(new uint8_t[kFileSize + 2 * kDirectReadAlignment]);
+  uint8_t* aligned = reinterpret_cast<uint8_t*>(
+      KUDU_ALIGN_UP(reinterpret_cast<uintptr_t>(backing.get()), kDirectReadAlignment));
+  for (size_t offset : { 0UL, 1UL, 4095UL, 4096UL, 12345UL }) {
+    for (size_t size : { 100UL, 4096UL, 3 * 4096UL + 7, kFileSize - offset }) {
+      SCOPED_TRACE(Substitute("offset $0, size $1", offset, size));
+      Slice s(aligned + offset % kDirectReadAlignment, size);
+      ASSERT_OK(file->Read(offset, s));
+      NO_FATALS(VerifyTestData(s, offset));
+    }
+  }
+
+  // An aligned slice read after an unaligned one.
+  const size_t kOffset = 1000;
+  uint8_t unaligned_scratch[5000];
+  Slice unaligned(unaligned_scratch, sizeof(unaligned_scratch));
+  Slice phase_aligned(aligned + (kOffset + unaligned.size()) % kDirectReadAlignment,
+                      10 * 4096);
+  vector<Slice> results = { unaligned, phase_aligned };
+  ASSERT_OK(file->ReadV(kOffset, results));
+  NO_FATALS(VerifyTestData(results[0], kOffset));
+  NO_FATALS(VerifyTestData(results[1], kOffset + unaligned.size()));
+
+  // Reads past the end of the file fail, even if their pages up to the end of
+  // the file are read straight into the result.
+  Status s = file->Read(4096, Slice(aligned, kFileSize));
+  ASSERT_TRUE(s.IsEndOfFile()) << s.ToString();
+}
+
 TEST_F(TestEnv, TestGetExecutablePath) {
   string p;
   ASSERT_OK(Env::Default()->GetExecutablePath(&p));
@@ -574,13 +574,26 @@ struct WritableFileOptions {
       : sync_on_close(false), mode(Env::CREATE_OR_OPEN_WITH_TRUNCATE), is_sensitive(false) {}
 };
 
+// The alignment of the file offsets and memory of reads which bypass the page
+// cache. It's a multiple of the logical block size of all devices.
+constexpr size_t kDirectReadAlignment = 4096;
+
 // Options specified when a file is opened for random access.
 struct RandomAccessFileOptions {
   // Whether the file contains sensitive information. If true, the file is
   // encrypted if encryption is enabled.
   bool is_sensitive;
 
-  RandomAccessFileOptions() : is_sensitive(false) {}
+  // Whether reads bypass the page cache, for files whose contents are cached
+  // by their readers. Falls back to reading through the page cache if the
+  // file system doesn't support it.
+  //
+  // Such reads are done in units of kDirectReadAlignment bytes. Pages of the
+  // file which are read into memory aligned to kDirectReadAlignment are read
+  // straight into it; the others go through an intermediate buffer.
+  bool direct_reads;
+
+  RandomAccessFileOptions() : is_sensitive(false), direct_reads(false) {}
 };
 
 // A file abstraction for sequential writing.  The implementation
@@ -644,8 +657,15 @@ struct RWFileOptions {
   // encrypted if encryption is enabled.
   bool is_sensitive;
 
+  // Whether reads bypass the page cache. Writes still go through it. See
+  // RandomAccessFileOptions::direct_reads.
+  bool direct_reads;
+
   RWFileOptions()
-      : sync_on_close(false), mode(Env::CREATE_OR_OPEN_WITH_TRUNCATE), is_sensitive(false) {}
+      : sync_on_close(false),
+        mode(Env::CREATE_OR_OPEN_WITH_TRUNCATE),
+        is_sensitive(false),
+        direct_reads(false) {}
 };
 
 // A file abstraction for both reading and writing. No notion of a built-in
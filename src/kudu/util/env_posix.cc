@@ -55,6 +55,7 @@
 #include "kudu/gutil/strings/split.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/strings/util.h"
+#include "kudu/util/alignment.h"
 #include "kudu/util/array_view.h"
 #include "kudu/util/coding-inl.h"
 #include "kudu/util/debug/trace_event.h"
@@ -776,6 +777,212 @@ Status DoWriteV(
   return Status::OK();
 }
 
+// Opens 'filename' for reads which bypass the page cache, setting 'fd' to -1
+// if that isn't supported, in which case the file should be read through the
+// page cache.
+Status DoOpenForDirectReads(const string& filename, int* fd) {
+#if defined(__APPLE__)
+  *fd = -1;
+  return Status::OK();
+#else
+  int f;
+  RETRY_ON_EINTR(f, open(filename.c_str(), O_RDONLY | O_DIRECT));
+  if (f < 0) {
+    if (errno == EINVAL) {
+      KLOG_FIRST_N(WARNING, 1) << "The filesystem does not support O_DIRECT, "
+                               << "reading through the page cache: " << filename;
+      *fd = -1;
+      return Status::OK();
+    }
+    return IOError(filename, errno);
+  }
+  *fd = f;
+  return Status::OK();
+#endif
+}
+
+struct FreeDeleter {
+  void operator()(uint8_t* p) const {
+    free(p);
+  }
+};
+
+// Direct reads which need a larger bounce buffer than this allocate one of
+// their own rather than keep it around for the next reads of the thread.
+constexpr size_t kMaxRetainedBounceBufferSize = 1024 * 1024;
+
+// Returns a buffer aligned to kDirectReadAlignment with room for 'size'
+// bytes. The buffer of the calling thread is reused, unless 'size' is larger
+// than kMaxRetainedBounceBufferSize, in which case 'owned' is set to a buffer
+// of its own.
+Status GetBounceBuffer(size_t size,
+                       unique_ptr<uint8_t, FreeDeleter>* owned,
+                       uint8_t** buf) {
+  static thread_local unique_ptr<uint8_t, FreeDeleter> thread_buf;
+  static thread_local size_t thread_buf_size = 0;
+  const bool retain = size <= kMaxRetainedBounceBufferSize;
+  if (retain && size <= thread_buf_size) {
+    *buf = thread_buf.get();
+    return Status::OK();
+  }
+  void* p;
+  int err = posix_memalign(&p, kDirectReadAlignment, size);
+  if (PREDICT_FALSE(err != 0)) {
+    return Status::RuntimeError("could not allocate a direct read buffer",
+                                ErrnoToString(err), err);
+  }
+  *buf = static_cast<uint8_t*>(p);
+  if (retain) {
+    thread_buf.reset(*buf);
+    thread_buf_size = size;
+  } else {
+    owned->reset(*buf);
+  }
+  return Status::OK();
+}
+
+// Like DoReadV(), but for a file descriptor opened by DoOpenForDirectReads().
+//
+// The pages of the file covering the requested bytes are read with a single
+// preadv(2) call. A page is read straight into 'results' if it lies within
+// one of them and that result's memory is aligned at that point, which is the
+// case for every page but the first and the last one if the result's memory
+// is at the same offset within a page of memory as the data within a page of
+// the file. The other pages are read into a bounce buffer, and then copied
+// into 'results'.
+Status DoDirectReadV(
+    int fd,
+    const string& filename,
+    uint64_t offset,
+    ArrayView<Slice> results,
+    const EncryptionHeader* eh) {
+  MAYBE_RETURN_EIO(filename, IOError(Env::kInjectedFailureStatusMsg, EIO));
+  ThreadRestrictions::AssertIOAllowed();
+
+  size_t bytes_req = 0;
+  for (const auto& result : results) {
+    bytes_req += result.size();
+  }
+  if (PREDICT_FALSE(bytes_req == 0)) {
+    return Status::OK();
+  }
+  const uint64_t aligned_offset = KUDU_ALIGN_DOWN(offset, kDirectReadAlignment);
+  const uint64_t aligned_end = KUDU_ALIGN_UP(offset + bytes_req, kDirectReadAlignment);
+
+  // Group the pages into runs of consecutive pages which are read either into
+  // consecutive memory of the same result, or into the bounce buffer.
+  struct Run {
+    // Where the run is read to in 'results', or nullptr if it's read into
+    // the bounce buffer.
+    uint8_t* dst;
+    size_t bounce_offset;
+    uint64_t file_offset;
+    size_t size;
+  };
+  static thread_local vector<Run> runs;
+  runs.clear();
+  size_t bounce_size = 0;
+  size_t result_idx = 0;
+  uint64_t result_offset = offset;
+  for (uint64_t page = aligned_offset; page < aligned_end; page += kDirectReadAlignment) {
+    while (result_idx < results.size() &&
+           result_offset + results[result_idx].size() <= page) {
+      result_offset += results[result_idx].size();
+      result_idx++;
+    }
+    uint8_t* dst = nullptr;
+    if (page >= offset && result_idx < results.size() &&
+        page + kDirectReadAlignment <= result_offset + results[result_idx].size()) {
+      uint8_t* p = results[result_idx].mutable_data() + (page - result_offset);
+      if (reinterpret_cast<uintptr_t>(p) % kDirectReadAlignment == 0) {
+        dst = p;
+      }
+    }
+    if (!runs.empty()) {
+      Run* last = &runs.back();
+      if (dst ? last->dst && last->dst + last->size == dst : !last->dst) {
+        last->size += kDirectReadAlignment;
+        bounce_size += dst ? 0 : kDirectReadAlignment;
+        continue;
+      }
+    }
+    runs.push_back({ dst, bounce_size, page, kDirectReadAlignment });
+    bounce_size += dst ? 0 : kDirectReadAlignment;
+  }
+
+  unique_ptr<uint8_t, FreeDeleter> owned_bounce;
+  uint8_t* bounce = nullptr;
+  if (bounce_size > 0) {
+    RETURN_NOT_OK_PREPEND(GetBounceBuffer(bounce_size, &owned_bounce, &bounce), filename);
+  }
+  static thread_local vector<struct iovec> iov;
+  iov.clear();
+  for (const auto& run : runs) {
+    iov.push_back({ run.dst ? run.dst : bounce + run.bounce_offset, run.size });
+  }
+
+  const uint64_t bytes_needed = offset + bytes_req - aligned_offset;
+  uint64_t bytes_read = 0;
+  size_t completed_iov = 0;
+  while (bytes_read < bytes_needed && completed_iov < iov.size()) {
+    const int iov_count = static_cast<int>(
+        std::min(iov.size() - completed_iov, static_cast<size_t>(IOV_MAX)));
+    ssize_t r;
+#if defined(__APPLE__)
+    RETRY_ON_EINTR(r, preadvsim(fd, &iov[completed_iov], iov_count,
+                                aligned_offset + bytes_read));
+#else
+    RETRY_ON_EINTR(r, preadv(fd, &iov[completed_iov], iov_count,
+                             aligned_offset + bytes_read));
+#endif
+    if (PREDICT_FALSE(r < 0)) {
+      return IOError(filename, errno);
+    }
+    if (r == 0) {
+      break;
+    }
+    bytes_read += r;
+    size_t rem = r;
+    while (rem > 0 && rem >= iov[completed_iov].iov_len) {
+      rem -= iov[completed_iov].iov_len;
+      completed_iov++;
+    }
+    if (rem > 0) {
+      iov[completed_iov].iov_base = static_cast<uint8_t*>(iov[completed_iov].iov_base) + rem;
+      iov[completed_iov].iov_len -= rem;
+    }
+    // Reads are only short at the end of the file, past which reading at an
+    // unaligned offset would fail.
+    if (r % kDirectReadAlignment != 0) {
+      break;
+    }
+  }
+  if (PREDICT_FALSE(bytes_read < bytes_needed)) {
+    return Status::EndOfFile(
+        Substitute("EOF trying to read $0 bytes at offset $1", bytes_req, offset));
+  }
+
+  for (const auto& run : runs) {
+    if (run.dst) {
+      continue;
+    }
+    uint64_t result_start = offset;
+    for (auto& result : results) {
+      const uint64_t from = std::max(result_start, run.file_offset);
+      const uint64_t to = std::min(result_start + result.size(), run.file_offset + run.size);
+      if (from < to) {
+        memcpy(result.mutable_data() + (from - result_start),
+               bounce + run.bounce_offset + (from - run.file_offset), to - from);
+      }
+      result_start += result.size();
+    }
+  }
+  if (eh) {
+    RETURN_NOT_OK(DoDecryptV(eh, offset, results));
+  }
+  return Status::OK();
+}
+
 Status GenerateHeader(EncryptionHeader* eh) {
   switch (FLAGS_encryption_key_length) {
     case 128:
@@ -1040,13 +1247,17 @@ class PosixRandomAccessFile: public RandomAccessFile {
  private:
   const string filename_;
   const int fd_;
+  // Whether 'fd_' was opened by DoOpenForDirectReads().
+  const bool direct_;
   const bool encrypted_;
   const EncryptionHeader encryption_header_;
 
  public:
-  PosixRandomAccessFile(string fname, int fd, bool encrypted, EncryptionHeader eh)
+  PosixRandomAccessFile(string fname, int fd, bool direct, bool encrypted,
+                        EncryptionHeader eh)
       : filename_(std::move(fname)),
         fd_(fd),
+        direct_(direct),
         encrypted_(encrypted),
         encryption_header_(eh) {}
   ~PosixRandomAccessFile() {
@@ -1054,13 +1265,15 @@ class PosixRandomAccessFile: public RandomAccessFile {
   }
 
   Status Read(uint64_t offset, Slice result) const override {
-    DCHECK_GE(offset, GetEncryptionHeaderSize());
-    return DoReadV(fd_, filename_, offset, ArrayView<Slice>(&result, 1),
-                   encrypted_ ? &encryption_header_ : nullptr);
+    return ReadV(offset, ArrayView<Slice>(&result, 1));
   }
 
   Status ReadV(uint64_t offset, ArrayView<Slice> results) const override {
     DCHECK_GE(offset, GetEncryptionHeaderSize());
+    if (direct_) {
+      return DoDirectReadV(fd_, filename_, offset, results,
+                           encrypted_ ? &encryption_header_ : nullptr);
+    }
     return DoReadV(fd_, filename_, offset, results,
                    encrypted_ ? &encryption_header_ : nullptr);
   }
@@ -1071,6 +1284,10 @@ class PosixRandomAccessFile: public RandomAccessFile {
     // particular at offset 0). No decryption is applied; the caller is
     // expected to feed the result back through Decrypt() at the appropriate
     // logical offset(s) when needed.
+    if (direct_) {
+      return DoDirectReadV(fd_, filename_, raw_offset, ArrayView<Slice>(&result, 1),
+                           /*eh=*/nullptr);
+    }
     return DoReadV(fd_, filename_, raw_offset, ArrayView<Slice>(&result, 1),
                    /*eh=*/nullptr);
   }
@@ -1268,10 +1485,11 @@ class PosixWritableFile : public WritableFile {
 
 class PosixRWFile : public RWFile {
  public:
-  PosixRWFile(string fname, int fd, bool sync_on_close, bool encrypted,
-              EncryptionHeader eh)
+  PosixRWFile(string fname, int fd, int direct_fd, bool sync_on_close,
+              bool encrypted, EncryptionHeader eh)
       : filename_(std::move(fname)),
         fd_(fd),
+        direct_fd_(direct_fd),
         sync_on_close_(sync_on_close),
         is_on_xfs_(false),
         closed_(false),
@@ -1283,13 +1501,17 @@ class PosixRWFile : public RWFile {
   }
 
   Status Read(uint64_t offset, Slice result) const override {
-    DCHECK_GE(offset, GetEncryptionHeaderSize());
-    return DoReadV(fd_, filename_, offset, ArrayView<Slice>(&result, 1),
-                   encrypted_ ? &encryption_header_ : nullptr);
+    return ReadV(offset, ArrayView<Slice>(&result, 1));
   }
 
   Status ReadV(uint64_t offset, ArrayView<Slice> results) const override {
     DCHECK_GE(offset, GetEncryptionHeaderSize());
+    // Direct reads of data which was just written through the page cache
+    // are coherent: the kernel writes back the dirty pages they cover first.
+    if (direct_fd_ >= 0) {
+      return DoDirectReadV(direct_fd_, filename_, offset, results,
+                           encrypted_ ? &encryption_header_ : nullptr);
+    }
     return DoReadV(fd_, filename_, offset, results,
                    encrypted_ ? &encryption_header_ : nullptr);
   }
@@ -1436,6 +1658,9 @@ class PosixRWFile : public RWFile {
         s = std::move(err_status);
       }
     }
+    if (direct_fd_ >= 0) {
+      DoClose(direct_fd_);
+    }
 
     closed_ = true;
     return s;
@@ -1539,6 +1764,10 @@ class PosixRWFile : public RWFile {
 
   const string filename_;
   const int fd_;
+  // The descriptor used for reads if the file was opened for direct reads on
+  // a file system which supports them, or -1. Writes go through 'fd_', since
+  // writes through an O_DIRECT descriptor would have to be aligned.
+  const int direct_fd_;
   const bool sync_on_close_;
 
   GoogleOnceDynamic once_;
@@ -1643,7 +1872,19 @@ class PosixEnv : public Env {
       DCHECK(encryption_key_);
       RETURN_NOT_OK_EVAL(ReadEncryptionHeader(fd, fname, *encryption_key_, &header), DoClose(fd));
     }
-    result->reset(new PosixRandomAccessFile(fname, fd,
+    // All the reads of a file opened for direct reads go through the O_DIRECT
+    // descriptor, so it's the only one kept open.
+    bool direct = false;
+    if (opts.direct_reads) {
+      int direct_fd;
+      RETURN_NOT_OK_EVAL(DoOpenForDirectReads(fname, &direct_fd), DoClose(fd));
+      if (direct_fd >= 0) {
+        DoClose(fd);
+        fd = direct_fd;
+        direct = true;
+      }
+    }
+    result->reset(new PosixRandomAccessFile(fname, fd, direct,
                   encrypted, header));
     return Status::OK();
   }
@@ -1723,7 +1964,11 @@ class PosixEnv : public Env {
       }
       cleanup.cancel();
     }
-    result->reset(new PosixRWFile(fname, fd, opts.sync_on_close,
+    int direct_fd = -1;
+    if (opts.direct_reads) {
+      RETURN_NOT_OK_EVAL(DoOpenForDirectReads(fname, &direct_fd), DoClose(fd));
+    }
+    result->reset(new PosixRWFile(fname, fd, direct_fd, opts.sync_on_close,
                                   encrypt, eh));
     return Status::OK();
   }
@@ -1746,7 +1991,11 @@ class PosixEnv : public Env {
       RETURN_NOT_OK(WriteEncryptionHeader(fd, *created_filename, *encryption_key_, eh));
       cleanup.cancel();
     }
-    res->reset(new PosixRWFile(*created_filename, fd, opts.sync_on_close,
+    int direct_fd = -1;
+    if (opts.direct_reads) {
+      RETURN_NOT_OK_EVAL(DoOpenForDirectReads(*created_filename, &direct_fd), DoClose(fd));
+    }
+    res->reset(new PosixRWFile(*created_filename, fd, direct_fd, opts.sync_on_close,
                                encrypt, eh));
     return Status::OK();
   }
@@ -429,6 +429,28 @@ TEST_P(RWFileCacheTest, TestOpenCreateOrOpen) {
   ASSERT_TRUE(rwf1->Sync().IsNotFound());
 }
 
+TEST_P(RWFileCacheTest, TestDirectReadsChargeBothFds) {
+  const string kFile1 = this->GetTestPath("foo");
+  const string kFile2 = this->GetTestPath("bar");
+  const string kData = "test data";
+  ASSERT_OK(this->WriteTestFile(kFile1, kData));
+  ASSERT_OK(this->WriteTestFile(kFile2, kData));
+
+  // An RWFile opened for direct reads keeps two fds open where the file
+  // system supports O_DIRECT, so a cache of two fds can only hold one of them.
+  ASSERT_OK(ReinitCache(2));
+  shared_ptr<RWFile> rwf1;
+  ASSERT_OK(cache_->OpenFile<Env::MUST_EXIST>(kFile1, &rwf1, /*direct_reads=*/true));
+  uint64_t size;
+  ASSERT_OK(rwf1->Size(&size));
+  const int fds_per_file = CountOpenFds() - initial_open_fds_;
+
+  shared_ptr<RWFile> rwf2;
+  ASSERT_OK(cache_->OpenFile<Env::MUST_EXIST>(kFile2, &rwf2, /*direct_reads=*/true));
+  ASSERT_OK(rwf2->Size(&size));
+  NO_FATALS(AssertFdsAndDescriptors(fds_per_file, 2));
+}
+
 class MixedFileCacheTest :
   public KuduTest,
   public ::testing::WithParamInterface<bool> {
@@ -127,10 +127,12 @@ class BaseDescriptor {
   // Returns a handle to the inserted entry. The handle always contains an open
   // file.
   ScopedOpenedDescriptor<FileType> InsertIntoCache(void* file_ptr) const {
-    // The allocated charge is always one byte. This is incorrect with respect
+    // The allocated charge is one byte per fd. This is incorrect with respect
     // to memory tracking, but it's necessary if the cache capacity is to be
-    // equivalent to the max number of fds.
-    auto pending(cache()->Allocate(filename(), sizeof(file_ptr), 1));
+    // equivalent to the max number of fds. An RWFile opened for direct reads
+    // keeps a second fd for them.
+    const int charge = std::is_same<FileType, RWFile>::value && direct_reads() ? 2 : 1;
+    auto pending(cache()->Allocate(filename(), sizeof(file_ptr), charge));
     CHECK(pending);
     memcpy(cache()->MutableValue(&pending), &file_ptr, sizeof(file_ptr));
     return ScopedOpenedDescriptor<FileType>(
@@ -157,6 +159,14 @@ class BaseDescriptor {
     }
   }
 
+  // Mark this descriptor's file to be read bypassing the page cache.
+  void MarkDirectReads() {
+    while (true) {
+      auto v = flags_.load();
+      if (flags_.compare_exchange_weak(v, v | DIRECT_READS)) return;
+    }
+  }
+
   // Mark this descriptor as invalidated. No further access is allowed
   // to this file.
   void MarkInvalidated() {
@@ -175,13 +185,15 @@ class BaseDescriptor {
 
   bool deleted() const { return flags_.load() & FILE_DELETED; }
   bool invalidated() const { return flags_.load() & INVALIDATED; }
+  bool direct_reads() const { return flags_.load() & DIRECT_READS; }
 
  private:
   FileCache* file_cache_;
   const string file_name_;
   enum Flags {
     FILE_DELETED = 1 << 0,
-    INVALIDATED = 1 << 1
+    INVALIDATED = 1 << 1,
+    DIRECT_READS = 1 << 2
   };
   std::atomic<uint8_t> flags_ {0};
 
@@ -351,6 +363,7 @@ class Descriptor<RWFile> : public RWFile {
     RWFileOptions opts;
     opts.mode = Mode;
     opts.is_sensitive = true;
+    opts.direct_reads = base_.direct_reads();
     unique_ptr<RWFile> f;
     RETURN_NOT_OK(base_.env()->NewRWFile(opts, base_.filename(), &f));
 
@@ -467,6 +480,7 @@ class Descriptor<RandomAccessFile> : public RandomAccessFile {
     unique_ptr<RandomAccessFile> f;
     RandomAccessFileOptions opts;
     opts.is_sensitive = true;
+    opts.direct_reads = base_.direct_reads();
     RETURN_NOT_OK(base_.env()->NewRandomAccessFile(opts, base_.filename(), &f));
 
     // The cache will take ownership of the newly opened file.
@@ -520,6 +534,7 @@ Status FileCache::Init() {
 
 template <>
 Status FileCache::DoOpenFile(const string& file_name,
+                             bool direct_reads,
                              shared_ptr<internal::Descriptor<RWFile>>* file,
                              bool* created_desc) {
   shared_ptr<internal::Descriptor<RWFile>> d;
@@ -529,6 +544,9 @@ Status FileCache::DoOpenFile(const string& file_name,
     d = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
                                &rwf_descs_, &cd);
     DCHECK(d);
+    if (cd && direct_reads) {
+      d->base_.MarkDirectReads();
+    }
 
 #ifndef NDEBUG
     // Enforce the invariant that a particular file name may only be used by one
@@ -548,6 +566,7 @@ Status FileCache::DoOpenFile(const string& file_name,
 
 template <>
 Status FileCache::DoOpenFile(const string& file_name,
+                             bool direct_reads,
                              shared_ptr<internal::Descriptor<RandomAccessFile>>* file,
                              bool* created_desc) {
   shared_ptr<internal::Descriptor<RandomAccessFile>> d;
@@ -557,6 +576,9 @@ Status FileCache::DoOpenFile(const string& file_name,
     d = FindDescriptorUnlocked(file_name, FindMode::CREATE_IF_NOT_EXIST,
                                &raf_descs_, &cd);
     DCHECK(d);
+    if (cd && direct_reads) {
+      d->base_.MarkDirectReads();
+    }
 
 #ifndef NDEBUG
     // Enforce the invariant that a particular file name may only be used by one
@@ -576,10 +598,11 @@ Status FileCache::DoOpenFile(const string& file_name,
 
 template <>
 Status FileCache::OpenFile<Env::CREATE_OR_OPEN>(const string& file_name,
-                                                shared_ptr<RWFile>* file) {
+                                                shared_ptr<RWFile>* file,
+                                                bool direct_reads) {
   shared_ptr<internal::Descriptor<RWFile>> d;
   bool ignored;
-  RETURN_NOT_OK(DoOpenFile(file_name, &d, &ignored));
+  RETURN_NOT_OK(DoOpenFile(file_name, direct_reads, &d, &ignored));
 
   // Check that the underlying file can be opened (no-op for found descriptors).
   RETURN_NOT_OK(d->Init<Env::CREATE_OR_OPEN>());
@@ -589,10 +612,11 @@ Status FileCache::OpenFile<Env::CREATE_OR_OPEN>(const string& file_name,
 
 template <>
 Status FileCache::OpenFile<Env::MUST_CREATE>(const string& file_name,
-                                             shared_ptr<RWFile>* file) {
+                                             shared_ptr<RWFile>* file,
+                                             bool direct_reads) {
   shared_ptr<internal::Descriptor<RWFile>> d;
   bool created_desc;
-  RETURN_NOT_OK(DoOpenFile(file_name, &d, &created_desc));
+  RETURN_NOT_OK(DoOpenFile(file_name, direct_reads, &d, &created_desc));
 
   if (!created_desc) {
     return Status::AlreadyPresent("file already exists", file_name);
@@ -606,10 +630,11 @@ Status FileCache::OpenFile<Env::MUST_CREATE>(const string& file_name,
 
 template <>
 Status FileCache::OpenFile<Env::MUST_EXIST>(const string& file_name,
-                                            shared_ptr<RWFile>* file) {
+                                            shared_ptr<RWFile>* file,
+                                            bool direct_reads) {
   shared_ptr<internal::Descriptor<RWFile>> d;
   bool ignored;
-  RETURN_NOT_OK(DoOpenFile(file_name, &d, &ignored));
+  RETURN_NOT_OK(DoOpenFile(file_name, direct_reads, &d, &ignored));
 
   // Check that the underlying file can be opened (no-op for found descriptors).
   RETURN_NOT_OK(d->Init<Env::MUST_EXIST>());
@@ -619,10 +644,11 @@ Status FileCache::OpenFile<Env::MUST_EXIST>(const string& file_name,
 
 template <>
 Status FileCache::OpenFile<Env::MUST_EXIST>(const string& file_name,
-                                            shared_ptr<RandomAccessFile>* file) {
+                                            shared_ptr<RandomAccessFile>* file,
+                                            bool direct_reads) {
   shared_ptr<internal::Descriptor<RandomAccessFile>> d;
   bool ignored;
-  RETURN_NOT_OK(DoOpenFile(file_name, &d, &ignored));
+  RETURN_NOT_OK(DoOpenFile(file_name, direct_reads, &d, &ignored));
 
   // Check that the underlying file can be opened (no-op for found descriptors).
   RETURN_NOT_OK(d->Init());
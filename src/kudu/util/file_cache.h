@@ -133,9 +133,14 @@ class FileCache {
   // recreated, and truncate it so it's empty for the second client, but the
   // truncation would corrupt the file for the first client. In short, take
   // great care when using any mode apart from MUST_EXIST.
+  //
+  // If 'direct_reads' is true and there's no descriptor for the file yet, the
+  // file is read bypassing the page cache whenever it's opened (see
+  // RandomAccessFileOptions::direct_reads). It's ignored otherwise.
   template <Env::OpenMode Mode, class FileType>
   Status OpenFile(const std::string& file_name,
-                  std::shared_ptr<FileType>* file);
+                  std::shared_ptr<FileType>* file,
+                  bool direct_reads = false);
 
   // Deletes a file by name through the cache.
   //
@@ -222,6 +227,7 @@ class FileCache {
   // OpenFile because C++ prohibits partial specialization of template functions.
   template <class FileType>
   Status DoOpenFile(const std::string& file_name,
+                    bool direct_reads,
                     std::shared_ptr<FileType>* file,
                     bool* created_desc);
 
@@ -0,0 +1,314 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/tinylfu_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/cache_metrics.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/mem_tracker.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_bool(cache_force_single_shard);
+DECLARE_double(cache_memtracker_approximation_ratio);
+
+namespace kudu {
+
+// Conversions between numeric keys/values and the types expected by Cache.
+static std::string EncodeInt(int k) {
+  faststring result;
+  PutFixed32(&result, k);
+  return result.ToString();
+}
+static int DecodeInt(const Slice& k) {
+  CHECK_EQ(4, k.size());
+  return DecodeFixed32(k.data());
+}
+
+TEST(FrequencySketchTest, TestEstimates) {
+  FrequencySketch sketch;
+  sketch.EnsureCapacity(1024);
+  ASSERT_EQ(0, sketch.Frequency(1));
+  for (int i = 0; i < 5; ++i) {
+    sketch.Increment(1);
+  }
+  ASSERT_EQ(5, sketch.Frequency(1));
+
+  // The estimates saturate.
+  for (int i = 0; i < 100; ++i) {
+    sketch.Increment(2);
+  }
+  ASSERT_EQ(FrequencySketch::kMaxFrequency, sketch.Frequency(2));
+
+  // Recording enough accesses to other keys halves the estimates. Count-min
+  // sketches never underestimate, so only check the upper bounds of the
+  // estimates of the keys which collide with the others.
+  for (uint32_t hash = 1000; hash < 1000 + 10 * 1024; ++hash) {
+    sketch.Increment(hash);
+  }
+  ASSERT_LE(sketch.Frequency(1), 3);
+  ASSERT_LE(sketch.Frequency(2), 8);
+}
+
+// Tests that growing a sketch keeps the estimates learned so far.
+TEST(FrequencySketchTest, TestGrowKeepsEstimates) {
+  FrequencySketch sketch;
+  for (int i = 0; i < 5; ++i) {
+    sketch.Increment(1);
+  }
+  sketch.Increment(2);
+  sketch.EnsureCapacity(1024);
+  ASSERT_EQ(5, sketch.Frequency(1));
+  ASSERT_EQ(1, sketch.Frequency(2));
+  sketch.EnsureCapacity(1 << 16);
+  ASSERT_EQ(5, sketch.Frequency(1));
+  ASSERT_EQ(1, sketch.Frequency(2));
+}
+
+class TinyLFUCacheTest : public KuduTest,
+                         public Cache::EvictionCallback {
+ public:
+  // Cache shards of a window of 10 and a main region of 100 unit-charged
+  // entries, of which 80 are in the protected segment.
+  static constexpr int kWindowCapacity = 10;
+  static constexpr int kMainCapacity = 100;
+
+  void SetUp() override {
+    KuduTest::SetUp();
+    FLAGS_cache_force_single_shard = true;
+    cache_.reset(NewTinyLFUCache(kWindowCapacity, kMainCapacity, "tinylfu_cache_test"));
+    scoped_refptr<MetricEntity> entity = METRIC_ENTITY_server.Instantiate(
+        &metric_registry_, "test");
+    std::unique_ptr<TinyLFUCacheMetrics> metrics(new TinyLFUCacheMetrics(entity));
+    metrics_ = metrics.get();
+    cache_->SetMetrics(std::move(metrics), Cache::ExistingMetricsPolicy::kKeep);
+  }
+
+  void EvictedEntry(Slice key, Slice val) override {
+    evicted_keys_.push_back(DecodeInt(key));
+    evicted_values_.push_back(DecodeInt(val));
+  }
+
+  // Returns -1 if no key is found in cache.
+  int Lookup(int key) {
+    auto handle(cache_->Lookup(EncodeInt(key), Cache::EXPECT_IN_CACHE));
+    return handle ? DecodeInt(cache_->Value(handle)) : -1;
+  }
+
+  void Insert(int key, int value, int charge = 1) {
+    std::string key_str = EncodeInt(key);
+    std::string val_str = EncodeInt(value);
+    auto handle(cache_->Allocate(key_str, val_str.size(), charge));
+    CHECK(handle);
+    memcpy(cache_->MutableValue(&handle), val_str.data(), val_str.size());
+    cache_->Insert(std::move(handle), this);
+  }
+
+  // Look the key up, and insert it if it's missing, like a user of the cache would.
+  void Access(int key) {
+    if (Lookup(key) == -1) {
+      Insert(key, key + 1000000);
+    }
+  }
+
+  // Returns true if the cache has the key, setting 'region' to the region holding it.
+  bool Contains(int key, TinyLFURegion* region) {
+    const std::string key_str = EncodeInt(key);
+    const uint32_t hash = cache_->HashSlice(key_str);
+    return cache_->shards_[cache_->Shard(hash)]->Contains(key_str, hash, region);
+  }
+
+ protected:
+  std::vector<int> evicted_keys_;
+  std::vector<int> evicted_values_;
+  MetricRegistry metric_registry_;
+  TinyLFUCacheMetrics* metrics_;
+  std::unique_ptr<ShardedTinyLFUCache> cache_;
+};
+
+TEST_F(TinyLFUCacheTest, TestHitAndMiss) {
+  ASSERT_EQ(-1, Lookup(100));
+
+  Insert(100, 101);
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_EQ(-1,  Lookup(200));
+  ASSERT_EQ(-1,  Lookup(300));
+
+  Insert(200, 201);
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_EQ(201, Lookup(200));
+  ASSERT_EQ(-1,  Lookup(300));
+
+  Insert(100, 102);
+  ASSERT_EQ(102, Lookup(100));
+  ASSERT_EQ(201, Lookup(200));
+  ASSERT_EQ(-1,  Lookup(300));
+
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_EQ(100, evicted_keys_[0]);
+  ASSERT_EQ(101, evicted_values_[0]);
+
+  ASSERT_EQ(5, metrics_->cache_hits_caching->value());
+  ASSERT_EQ(5, metrics_->cache_misses_caching->value());
+}
+
+TEST_F(TinyLFUCacheTest, TestErase) {
+  Insert(100, 101);
+  Insert(200, 201);
+  cache_->Erase(EncodeInt(200));
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_EQ(-1, Lookup(200));
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_EQ(200, evicted_keys_[0]);
+
+  // Erasing a missing key is a no-op.
+  cache_->Erase(EncodeInt(300));
+  ASSERT_EQ(1, evicted_keys_.size());
+}
+
+TEST_F(TinyLFUCacheTest, TestEntriesArePinned) {
+  Insert(100, 101);
+  auto h1 = cache_->Lookup(EncodeInt(100), Cache::EXPECT_IN_CACHE);
+  ASSERT_EQ(101, DecodeInt(cache_->Value(h1)));
+
+  Insert(100, 102);
+  auto h2 = cache_->Lookup(EncodeInt(100), Cache::EXPECT_IN_CACHE);
+  ASSERT_EQ(102, DecodeInt(cache_->Value(h2)));
+  ASSERT_EQ(0, evicted_keys_.size());
+
+  h1.reset();
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_EQ(100, evicted_keys_[0]);
+  ASSERT_EQ(101, evicted_values_[0]);
+
+  cache_->Erase(EncodeInt(100));
+  ASSERT_EQ(-1, Lookup(100));
+  ASSERT_EQ(1, evicted_keys_.size());
+
+  h2.reset();
+  ASSERT_EQ(2, evicted_keys_.size());
+  ASSERT_EQ(100, evicted_keys_[1]);
+  ASSERT_EQ(102, evicted_values_[1]);
+}
+
+// Tests the movement of entries between the regions of the cache.
+TEST_F(TinyLFUCacheTest, TestRegions) {
+  TinyLFURegion region;
+  Insert(0, 0);
+  ASSERT_TRUE(Contains(0, &region));
+  ASSERT_EQ(TinyLFURegion::kWindow, region);
+
+  // Overflowing the window moves its oldest entries into the main region,
+  // which admits them while it has room.
+  for (int i = 1; i <= kWindowCapacity; ++i) {
+    Insert(i, i);
+  }
+  ASSERT_TRUE(Contains(0, &region));
+  ASSERT_EQ(TinyLFURegion::kProbationary, region);
+  ASSERT_EQ(1, metrics_->admissions->value());
+  ASSERT_TRUE(Contains(1, &region));
+  ASSERT_EQ(TinyLFURegion::kWindow, region);
+
+  // Accessing an entry of the probationary segment promotes it.
+  ASSERT_EQ(0, Lookup(0));
+  ASSERT_TRUE(Contains(0, &region));
+  ASSERT_EQ(TinyLFURegion::kProtected, region);
+}
+
+// Tests that a scan of keys which are accessed only once doesn't evict the
+// entries which are accessed frequently.
+TEST_F(TinyLFUCacheTest, TestScanResistance) {
+  constexpr int kNumHotKeys = 50;
+  for (int pass = 0; pass < 5; ++pass) {
+    for (int key = 0; key < kNumHotKeys; ++key) {
+      Access(key);
+    }
+  }
+  for (int key = 0; key < kNumHotKeys; ++key) {
+    ASSERT_NE(-1, Lookup(key)) << key;
+  }
+
+  // Scan through many more keys than the cache can hold, still accessing
+  // the hot keys at a lower rate in the meantime.
+  constexpr int kNumScanKeys = 10000;
+  for (int i = 0; i < kNumScanKeys; ++i) {
+    Access(kNumHotKeys + i);
+    if (i % 5 == 0) {
+      Access((i / 5) % kNumHotKeys);
+    }
+  }
+  int num_hot_keys_cached = 0;
+  for (int key = 0; key < kNumHotKeys; ++key) {
+    TinyLFURegion region;
+    if (Contains(key, &region)) {
+      ++num_hot_keys_cached;
+    }
+  }
+  // Allow for a few of the hot keys to be evicted because of collisions in
+  // the frequency sketch.
+  ASSERT_GE(num_hot_keys_cached, kNumHotKeys * 9 / 10);
+  ASSERT_GT(metrics_->rejections->value(), kNumScanKeys / 2);
+}
+
+// Tests that entries larger than the main region are never admitted into it.
+TEST_F(TinyLFUCacheTest, TestLargeEntries) {
+  Insert(1, 1, kMainCapacity + 1);
+  ASSERT_EQ(-1, Lookup(1));
+  ASSERT_EQ(1, evicted_keys_.size());
+  ASSERT_EQ(1, metrics_->rejections->value());
+
+  // An entry larger than the window is moved to the main region right away.
+  Insert(2, 2, kWindowCapacity + 1);
+  ASSERT_EQ(2, Lookup(2));
+  TinyLFURegion region;
+  ASSERT_TRUE(Contains(2, &region));
+  ASSERT_EQ(TinyLFURegion::kProtected, region);
+}
+
+TEST_F(TinyLFUCacheTest, TestMemTracker) {
+  FLAGS_cache_memtracker_approximation_ratio = 0;
+  std::unique_ptr<ShardedTinyLFUCache> cache(
+      NewTinyLFUCache(kWindowCapacity, kMainCapacity, "tinylfu_mem_tracker_test"));
+  std::shared_ptr<MemTracker> mem_tracker;
+  ASSERT_TRUE(MemTracker::FindTracker("tinylfu_mem_tracker_test-sharded_tinylfu_cache",
+                                      &mem_tracker));
+  for (int i = 0; i < 1000; ++i) {
+    auto handle(cache->Allocate(EncodeInt(i), 0, 1));
+    cache->Insert(std::move(handle), nullptr);
+  }
+  ASSERT_LE(mem_tracker->consumption(), kWindowCapacity + kMainCapacity);
+  ASSERT_GT(mem_tracker->consumption(), 0);
+  cache.reset();
+  ASSERT_EQ(0, mem_tracker->consumption());
+}
+
+} // namespace kudu
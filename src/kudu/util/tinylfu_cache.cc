@@ -0,0 +1,568 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/util/tinylfu_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+
+#include "kudu/gutil/bits.h"
+#include "kudu/gutil/hash/city.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/sysinfo.h"
+#include "kudu/util/alignment.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/cache_metrics.h"
+#include "kudu/util/malloc.h"
+#include "kudu/util/mem_tracker.h"
+#include "kudu/util/metrics.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/test_util_prod.h"
+
+DECLARE_bool(cache_force_single_shard);
+DECLARE_double(cache_memtracker_approximation_ratio);
+
+namespace kudu {
+
+namespace {
+
+// The minimum and maximum number of entries a frequency sketch is sized for.
+constexpr size_t kMinSketchEntries = 16;
+constexpr size_t kMaxSketchEntries = 1 << 24;
+
+// The number of counters per entry in each row of a frequency sketch. Sizing
+// the rows for more keys than the entries in the cache accounts for the keys
+// which are accessed but not cached, keeping the collisions in check.
+constexpr size_t kSketchCountersPerEntry = 4;
+
+// The counters are halved once the number of recorded accesses reaches
+// this many times the number of entries the sketch is sized for.
+constexpr size_t kSketchSampleFactor = 10;
+
+// The multipliers used to derive the counter index for each row of a
+// frequency sketch from the hash of a key.
+constexpr uint64_t kSketchSeeds[] = {
+  0xc3a5c85c97cb3127ULL,
+  0xb492b66fbe98f273ULL,
+  0x9ae16a3b2f90404fULL,
+  0xcbf29ce484222325ULL,
+};
+
+// The fraction of the main region of a cache shard that's the capacity
+// of the protected segment.
+constexpr double kProtectedRatio = 0.8;
+
+} // anonymous namespace
+
+FrequencySketch::FrequencySketch()
+    : width_(0),
+      num_increments_(0),
+      sample_size_(0) {
+  EnsureCapacity(kMinSketchEntries);
+}
+
+void FrequencySketch::EnsureCapacity(size_t num_entries) {
+  const size_t capacity = std::min(
+      kMaxSketchEntries,
+      std::max(kMinSketchEntries, size_t{1} << Bits::Log2Ceiling64(num_entries)));
+  const size_t new_width = capacity * kSketchCountersPerEntry;
+  if (new_width <= width_) {
+    return;
+  }
+  // The widths are powers of two, and a counter's index within its row is
+  // the low bits of the mixed hash, so the counter of a key in the wider row
+  // is at an index with the same low bits as before. Copying each row over
+  // the wider one as many times as it fits keeps all the estimates.
+  std::vector<uint8_t> table(kDepth * new_width);
+  for (int row = 0; row < kDepth; ++row) {
+    for (size_t i = 0; i < new_width; ++i) {
+      table[row * new_width + i] = width_ == 0 ? 0 : table_[row * width_ + (i & (width_ - 1))];
+    }
+  }
+  table_.swap(table);
+  width_ = new_width;
+  sample_size_ = kSketchSampleFactor * capacity;
+}
+
+size_t FrequencySketch::Index(uint32_t hash, int row) const {
+  // All the keys of a cache shard share the high bits of their hashes, so
+  // mix the bits of the hash before picking a counter.
+  uint64_t h = (static_cast<uint64_t>(hash) + kSketchSeeds[row]) * kSketchSeeds[row];
+  h += h >> 32;
+  return row * width_ + (h & (width_ - 1));
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  // Only increment the smallest of the key's counters: the others already
+  // overestimate the key's frequency because of collisions with other keys,
+  // and leaving them be keeps the overestimates of those keys smaller.
+  const uint8_t frequency = Frequency(hash);
+  if (frequency < kMaxFrequency) {
+    for (int row = 0; row < kDepth; ++row) {
+      uint8_t& counter = table_[Index(hash, row)];
+      if (counter == frequency) {
+        ++counter;
+      }
+    }
+  }
+  if (++num_increments_ >= sample_size_) {
+    Age();
+  }
+}
+
+uint8_t FrequencySketch::Frequency(uint32_t hash) const {
+  uint8_t frequency = kMaxFrequency;
+  for (int row = 0; row < kDepth; ++row) {
+    frequency = std::min(frequency, table_[Index(hash, row)]);
+  }
+  return frequency;
+}
+
+void FrequencySketch::Age() {
+  for (auto& counter : table_) {
+    counter >>= 1;
+  }
+  num_increments_ /= 2;
+}
+
+TinyLFUCacheShard::RecencyList::RecencyList()
+    : capacity(0),
+      usage(0) {
+  // Make empty circular linked list.
+  head.next = &head;
+  head.prev = &head;
+}
+
+TinyLFUCacheShard::TinyLFUCacheShard(MemTracker* tracker,
+                                     size_t window_capacity,
+                                     size_t main_capacity)
+    : main_capacity_(main_capacity),
+      num_entries_(0),
+      mem_tracker_(tracker),
+      metrics_(nullptr) {
+  window_.capacity = window_capacity;
+  protected_.capacity = static_cast<size_t>(main_capacity * kProtectedRatio);
+  probationary_.capacity = main_capacity - protected_.capacity;
+  max_deferred_consumption_ =
+      (window_capacity + main_capacity) * FLAGS_cache_memtracker_approximation_ratio;
+}
+
+TinyLFUCacheShard::~TinyLFUCacheShard() {
+  for (auto* list : { &window_, &probationary_, &protected_ }) {
+    for (TinyLFUHandle* e = list->head.next; e != &list->head; ) {
+      TinyLFUHandle* next = e->next;
+      DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 1)
+          << "caller has an unreleased handle";
+      if (Unref(e)) {
+        FreeEntry(e);
+      }
+      e = next;
+    }
+  }
+  mem_tracker_->Consume(deferred_consumption_);
+}
+
+void TinyLFUCacheShard::SetMetrics(TinyLFUCacheMetrics* metrics) {
+  std::lock_guard l(mutex_);
+  metrics_ = metrics;
+}
+
+bool TinyLFUCacheShard::Unref(TinyLFUHandle* e) {
+  DCHECK_GT(e->refs.load(std::memory_order_relaxed), 0);
+  return e->refs.fetch_sub(1) == 1;
+}
+
+void TinyLFUCacheShard::FreeEntry(TinyLFUHandle* e) {
+  DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 0);
+  if (e->eviction_callback) {
+    e->eviction_callback->EvictedEntry(e->key(), e->value());
+  }
+  UpdateMemTracker(-static_cast<int64_t>(e->charge));
+  if (PREDICT_TRUE(metrics_)) {
+    metrics_->cache_usage->DecrementBy(e->charge);
+    metrics_->evictions->Increment();
+  }
+  delete [] e;
+}
+
+void TinyLFUCacheShard::FreeEntries(TinyLFUHandle* free_entries) {
+  while (free_entries != nullptr) {
+    auto* next = free_entries->next;
+    FreeEntry(free_entries);
+    free_entries = next;
+  }
+}
+
+void TinyLFUCacheShard::UpdateMemTracker(int64_t delta) {
+  int64_t old_deferred = deferred_consumption_.fetch_add(delta);
+  int64_t new_deferred = old_deferred + delta;
+
+  if (new_deferred > max_deferred_consumption_ ||
+      new_deferred < -max_deferred_consumption_) {
+    int64_t to_propagate = deferred_consumption_.exchange(0, std::memory_order_relaxed);
+    mem_tracker_->Consume(to_propagate);
+  }
+}
+
+void TinyLFUCacheShard::UpdateMetricsLookup(bool was_hit, bool caching) {
+  if (PREDICT_TRUE(metrics_)) {
+    metrics_->lookups->Increment();
+    if (was_hit) {
+      if (caching) {
+        metrics_->cache_hits_caching->Increment();
+      } else {
+        metrics_->cache_hits->Increment();
+      }
+    } else {
+      if (caching) {
+        metrics_->cache_misses_caching->Increment();
+      } else {
+        metrics_->cache_misses->Increment();
+      }
+    }
+  }
+}
+
+TinyLFUCacheShard::RecencyList* TinyLFUCacheShard::List(TinyLFURegion region) {
+  switch (region) {
+    case TinyLFURegion::kWindow:
+      return &window_;
+    case TinyLFURegion::kProbationary:
+      return &probationary_;
+    case TinyLFURegion::kProtected:
+      return &protected_;
+  }
+  LOG(FATAL) << "unexpected cache region: " << static_cast<int>(region);
+  return nullptr;
+}
+
+void TinyLFUCacheShard::RL_Remove(RecencyList* list, TinyLFUHandle* e) {
+  e->next->prev = e->prev;
+  e->prev->next = e->next;
+  DCHECK_GE(list->usage, e->charge);
+  list->usage -= e->charge;
+}
+
+void TinyLFUCacheShard::RL_Append(RecencyList* list, TinyLFUHandle* e) {
+  // Make "e" newest entry by inserting just before the list's head.
+  e->next = &list->head;
+  e->prev = list->head.prev;
+  e->prev->next = e;
+  e->next->prev = e;
+  list->usage += e->charge;
+}
+
+void TinyLFUCacheShard::MoveTo(TinyLFUHandle* e, TinyLFURegion region) {
+  RL_Remove(List(e->region), e);
+  e->region = region;
+  RL_Append(List(region), e);
+}
+
+void TinyLFUCacheShard::Evict(TinyLFUHandle* e, TinyLFUHandle** free_entries) {
+  RL_Remove(List(e->region), e);
+  table_.Remove(e->key(), e->hash);
+  --num_entries_;
+  if (Unref(e)) {
+    e->next = *free_entries;
+    *free_entries = e;
+  }
+}
+
+void TinyLFUCacheShard::EvictFromWindow(TinyLFUHandle** free_entries) {
+  while (window_.usage > window_.capacity && !window_.empty()) {
+    Admit(window_.head.next, free_entries);
+  }
+}
+
+void TinyLFUCacheShard::Admit(TinyLFUHandle* candidate, TinyLFUHandle** free_entries) {
+  DCHECK(candidate->region == TinyLFURegion::kWindow);
+  if (candidate->charge > main_capacity_) {
+    if (PREDICT_TRUE(metrics_)) {
+      metrics_->rejections->Increment();
+    }
+    Evict(candidate, free_entries);
+    return;
+  }
+  // Make room for the candidate by evicting the oldest entries of the main
+  // region, as long as the candidate has been accessed more frequently than
+  // each of them. Ties are resolved in favor of the entries already in the
+  // main region, so a scan of keys accessed once doesn't displace them.
+  const uint8_t candidate_frequency = sketch_.Frequency(candidate->hash);
+  while (probationary_.usage + protected_.usage + candidate->charge > main_capacity_) {
+    TinyLFUHandle* victim = !probationary_.empty() ? probationary_.head.next
+                                                   : protected_.head.next;
+    if (candidate_frequency <= sketch_.Frequency(victim->hash)) {
+      if (PREDICT_TRUE(metrics_)) {
+        metrics_->rejections->Increment();
+      }
+      Evict(candidate, free_entries);
+      return;
+    }
+    Evict(victim, free_entries);
+  }
+  if (PREDICT_TRUE(metrics_)) {
+    metrics_->admissions->Increment();
+  }
+  MoveTo(candidate, TinyLFURegion::kProbationary);
+}
+
+void TinyLFUCacheShard::DemoteFromProtected() {
+  while (protected_.usage > protected_.capacity && !protected_.empty()) {
+    MoveTo(protected_.head.next, TinyLFURegion::kProbationary);
+  }
+}
+
+Cache::Handle* TinyLFUCacheShard::Insert(TinyLFUHandle* handle,
+                                         Cache::EvictionCallback* eviction_callback) {
+  // Set the remaining TinyLFUHandle members which were not already allocated during Allocate().
+  handle->eviction_callback = eviction_callback;
+  // Two refs for the handle: one from TinyLFUCacheShard, one for the returned handle.
+  handle->refs.store(2, std::memory_order_relaxed);
+  handle->region = TinyLFURegion::kWindow;
+  UpdateMemTracker(handle->charge);
+  if (PREDICT_TRUE(metrics_)) {
+    metrics_->cache_usage->IncrementBy(handle->charge);
+    metrics_->inserts->Increment();
+  }
+
+  TinyLFUHandle* free_entries = nullptr;
+  {
+    std::lock_guard l(mutex_);
+    // The access which led to the insertion was already recorded by the
+    // lookup which missed, so it isn't recorded again.
+    RL_Append(&window_, handle);
+    TinyLFUHandle* old_entry = table_.Insert(handle);
+    if (old_entry != nullptr) {
+      RL_Remove(List(old_entry->region), old_entry);
+      if (Unref(old_entry)) {
+        old_entry->next = free_entries;
+        free_entries = old_entry;
+      }
+    } else {
+      ++num_entries_;
+      sketch_.EnsureCapacity(num_entries_);
+    }
+    EvictFromWindow(&free_entries);
+  }
+
+  // Free entries outside lock for performance reasons.
+  FreeEntries(free_entries);
+  return reinterpret_cast<Cache::Handle*>(handle);
+}
+
+Cache::Handle* TinyLFUCacheShard::Lookup(const Slice& key, uint32_t hash, bool caching) {
+  TinyLFUHandle* e;
+  {
+    std::lock_guard l(mutex_);
+    // Record the access even if the key isn't in the cache: that's what lets
+    // a frequently accessed entry be admitted once it's inserted again.
+    sketch_.Increment(hash);
+    e = table_.Lookup(key, hash);
+    if (e != nullptr) {
+      e->refs.fetch_add(1, std::memory_order_relaxed);
+      switch (e->region) {
+        case TinyLFURegion::kWindow:
+          MoveTo(e, TinyLFURegion::kWindow);
+          break;
+        case TinyLFURegion::kProbationary:
+          // Promote the entry to the protected segment unless it's larger than
+          // the whole segment.
+          if (e->charge <= protected_.capacity) {
+            MoveTo(e, TinyLFURegion::kProtected);
+            DemoteFromProtected();
+          } else {
+            MoveTo(e, TinyLFURegion::kProbationary);
+          }
+          break;
+        case TinyLFURegion::kProtected:
+          MoveTo(e, TinyLFURegion::kProtected);
+          break;
+      }
+    }
+    UpdateMetricsLookup(e != nullptr, caching);
+  }
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+void TinyLFUCacheShard::Release(Cache::Handle* handle) {
+  TinyLFUHandle* e = reinterpret_cast<TinyLFUHandle*>(handle);
+  // If this is the last reference of the handle, the entry will be freed.
+  if (Unref(e)) {
+    FreeEntry(e);
+  }
+}
+
+void TinyLFUCacheShard::Erase(const Slice& key, uint32_t hash) {
+  TinyLFUHandle* free_entry = nullptr;
+  {
+    std::lock_guard l(mutex_);
+    TinyLFUHandle* e = table_.Remove(key, hash);
+    if (e != nullptr) {
+      RL_Remove(List(e->region), e);
+      --num_entries_;
+      if (Unref(e)) {
+        free_entry = e;
+      }
+    }
+  }
+
+  // Free entry outside lock for performance reasons.
+  if (free_entry) {
+    FreeEntry(free_entry);
+  }
+}
+
+bool TinyLFUCacheShard::Contains(const Slice& key, uint32_t hash, TinyLFURegion* region) {
+  std::lock_guard l(mutex_);
+  TinyLFUHandle* e = table_.Lookup(key, hash);
+  if (e == nullptr) {
+    return false;
+  }
+  *region = e->region;
+  return true;
+}
+
+ShardedTinyLFUCache::ShardedTinyLFUCache(size_t window_capacity, size_t main_capacity,
+                                         const std::string& id)
+    : shard_bits_(DetermineShardBits()) {
+  // A cache is often a singleton, so:
+  // 1. We reuse its MemTracker if one already exists, and
+  // 2. It is directly parented to the root MemTracker.
+  mem_tracker_ = MemTracker::FindOrCreateGlobalTracker(
+      -1, strings::Substitute("$0-sharded_tinylfu_cache", id));
+
+  int num_shards = 1 << shard_bits_;
+  const size_t per_shard_window = (window_capacity + (num_shards - 1)) / num_shards;
+  const size_t per_shard_main = (main_capacity + (num_shards - 1)) / num_shards;
+  for (auto s = 0; s < num_shards; ++s) {
+    shards_.emplace_back(new TinyLFUCacheShard(mem_tracker_.get(),
+                                               per_shard_window,
+                                               per_shard_main));
+  }
+}
+
+Cache::UniquePendingHandle ShardedTinyLFUCache::Allocate(Slice key, int val_len, int charge) {
+  int key_len = key.size();
+  DCHECK_GE(key_len, 0);
+  DCHECK_GE(val_len, 0);
+  int key_len_padded = KUDU_ALIGN_UP(key_len, sizeof(void*));
+  UniquePendingHandle h(reinterpret_cast<PendingHandle*>(
+                            new uint8_t[sizeof(TinyLFUHandle)
+                                + key_len_padded + val_len // the kv_data VLA data
+                                - 1 // (the VLA has a 1-byte placeholder)
+                            ]),
+                        PendingHandleDeleter(this));
+  TinyLFUHandle* handle = reinterpret_cast<TinyLFUHandle*>(h.get());
+  handle->key_length = key_len;
+  handle->val_length = val_len;
+  handle->charge = (charge == kAutomaticCharge) ? kudu_malloc_usable_size(h.get()) : charge;
+  handle->hash = HashSlice(key);
+  memcpy(handle->kv_data, key.data(), key_len);
+
+  return h;
+}
+
+Cache::UniqueHandle ShardedTinyLFUCache::Lookup(const Slice& key, CacheBehavior caching) {
+  const uint32_t hash = HashSlice(key);
+  return UniqueHandle(
+      shards_[Shard(hash)]->Lookup(key, hash, caching == EXPECT_IN_CACHE),
+      HandleDeleter(this));
+}
+
+void ShardedTinyLFUCache::Erase(const Slice& key) {
+  const uint32_t hash = HashSlice(key);
+  shards_[Shard(hash)]->Erase(key, hash);
+}
+
+Slice ShardedTinyLFUCache::Value(const UniqueHandle& handle) const {
+  return reinterpret_cast<const TinyLFUHandle*>(handle.get())->value();
+}
+
+uint8_t* ShardedTinyLFUCache::MutableValue(UniquePendingHandle* handle) {
+  return reinterpret_cast<TinyLFUHandle*>(handle->get())->mutable_val_ptr();
+}
+
+Cache::UniqueHandle ShardedTinyLFUCache::Insert(UniquePendingHandle handle,
+                                                EvictionCallback* eviction_callback) {
+  TinyLFUHandle* h = reinterpret_cast<TinyLFUHandle*>(DCHECK_NOTNULL(handle.release()));
+  return UniqueHandle(shards_[Shard(h->hash)]->Insert(h, eviction_callback),
+                      HandleDeleter(this));
+}
+
+void ShardedTinyLFUCache::SetMetrics(std::unique_ptr<CacheMetrics> metrics,
+                                     ExistingMetricsPolicy metrics_policy) {
+  std::lock_guard l(metrics_lock_);
+  if (metrics_ && metrics_policy == ExistingMetricsPolicy::kKeep) {
+    CHECK(IsGTest()) << "Metrics should only be set once per Cache";
+    return;
+  }
+  metrics_ = std::move(metrics);
+  auto* metrics_ptr = dynamic_cast<TinyLFUCacheMetrics*>(metrics_.get());
+  DCHECK(metrics_ptr != nullptr);
+  for (auto& shard : shards_) {
+    shard->SetMetrics(metrics_ptr);
+  }
+}
+
+void ShardedTinyLFUCache::Release(Handle* handle) {
+  TinyLFUHandle* h = reinterpret_cast<TinyLFUHandle*>(handle);
+  shards_[Shard(h->hash)]->Release(handle);
+}
+
+void ShardedTinyLFUCache::Free(PendingHandle* h) {
+  delete [] reinterpret_cast<uint8_t*>(h);
+}
+
+// Determine the number of bits of the hash that should be used to determine
+// the cache shard. This, in turn, determines the number of shards.
+int ShardedTinyLFUCache::DetermineShardBits() {
+  int bits = PREDICT_FALSE(FLAGS_cache_force_single_shard) ?
+             0 : Bits::Log2Ceiling(base::NumCPUs());
+  VLOG(1) << "Will use " << (1 << bits) << " shards for W-TinyLFU cache.";
+  return bits;
+}
+
+uint32_t ShardedTinyLFUCache::HashSlice(const Slice& s) {
+  return util_hash::CityHash64(reinterpret_cast<const char *>(s.data()), s.size());
+}
+
+uint32_t ShardedTinyLFUCache::Shard(uint32_t hash) const {
+  // Widen to uint64 before shifting, or else on a single CPU,
+  // we would try to shift a uint32_t by 32 bits, which is undefined.
+  return static_cast<uint64_t>(hash) >> (32 - shard_bits_);
+}
+
+template<>
+ShardedTinyLFUCache* NewTinyLFUCache<Cache::MemoryType::DRAM>(size_t window_capacity,
+                                                              size_t main_capacity,
+                                                              const std::string& id) {
+  return new ShardedTinyLFUCache(window_capacity, main_capacity, id);
+}
+
+} // namespace kudu
@@ -0,0 +1,294 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/alignment.h"
+#include "kudu/util/cache.h"
+#include "kudu/util/cache_metrics.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/slice.h"
+
+namespace kudu {
+
+// A W-TinyLFU cache admits new entries based on how often their keys have
+// been accessed recently rather than unconditionally, which protects the
+// frequently accessed entries from being flushed by scans and other one-off
+// accesses.
+//
+// Every cache shard is split into three regions:
+//   - a small window LRU which every new entry is inserted into, so that
+//     entries with bursts of accesses get a chance to build up a frequency,
+//   - a probationary LRU segment, and
+//   - a protected LRU segment, which entries of the probationary segment are
+//     promoted to on their next access.
+// The probationary and protected segments make up the main region, like an
+// SLRU cache. When an entry overflows from the window, it's admitted into the
+// main region only if it's been accessed more frequently than the entry which
+// the main region would evict to accommodate it; otherwise it's evicted.
+// The access frequencies are estimated with a count-min sketch which is aged
+// periodically, so the estimates reflect the recent accesses. Accesses are
+// recorded by lookups, hits and misses alike.
+
+class MemTracker;
+
+// Estimates the access frequencies of keys with a count-min sketch of 4 rows
+// of saturating counters, which are updated conservatively. Once the number
+// of recorded accesses reaches 10 times the number of entries the sketch is
+// sized for, all the counters are halved so that the estimates favor the
+// recent accesses.
+//
+// This class is not thread-safe.
+class FrequencySketch {
+ public:
+  // The maximum value of a counter, and so of an estimate.
+  static constexpr uint8_t kMaxFrequency = 15;
+
+  FrequencySketch();
+
+  // Resize the sketch for a cache of about 'num_entries' entries, if it's
+  // sized for fewer. Resizing keeps the estimates of all the keys.
+  void EnsureCapacity(size_t num_entries);
+
+  // Record an access to the key with the given hash.
+  void Increment(uint32_t hash);
+
+  // Return the estimated number of recent accesses to the key with the given hash.
+  uint8_t Frequency(uint32_t hash) const;
+
+ private:
+  static constexpr int kDepth = 4;
+
+  // Return the index of the counter for 'hash' in row 'row'.
+  size_t Index(uint32_t hash, int row) const;
+
+  // Halve all the counters.
+  void Age();
+
+  // The counters, 'width_' for each of the 'kDepth' rows.
+  std::vector<uint8_t> table_;
+  size_t width_;
+
+  // The number of accesses recorded since the counters were last halved,
+  // and the number which triggers halving them.
+  size_t num_increments_;
+  size_t sample_size_;
+};
+
+// The regions of a W-TinyLFU cache shard.
+enum class TinyLFURegion : uint8_t {
+  kWindow,
+  kProbationary,
+  kProtected,
+};
+
+struct TinyLFUHandle {
+  Cache::EvictionCallback* eviction_callback;
+  TinyLFUHandle* next_hash;
+  TinyLFUHandle* next;
+  TinyLFUHandle* prev;
+  size_t charge;
+  uint32_t key_length;
+  uint32_t val_length;
+  std::atomic<int32_t> refs;
+  uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
+
+  // The region of the cache shard which holds the entry.
+  // Only accessed under the shard's lock.
+  TinyLFURegion region;
+
+  // The storage for the key/value pair itself. The data is stored as:
+  //   [key bytes ...] [padding up to 8-byte boundary] [value bytes ...]
+  uint8_t kv_data[1];   // Beginning of key/value pair
+
+  Slice key() const {
+    return Slice(kv_data, key_length);
+  }
+
+  uint8_t* mutable_val_ptr() {
+    int val_offset = KUDU_ALIGN_UP(key_length, sizeof(void*));
+    return &kv_data[val_offset];
+  }
+
+  const uint8_t* val_ptr() const {
+    return const_cast<TinyLFUHandle*>(this)->mutable_val_ptr();
+  }
+
+  Slice value() const {
+    return Slice(val_ptr(), val_length);
+  }
+};
+
+// A single shard of sharded W-TinyLFU cache.
+class TinyLFUCacheShard {
+ public:
+  TinyLFUCacheShard(MemTracker* tracker, size_t window_capacity, size_t main_capacity);
+  ~TinyLFUCacheShard();
+
+  void SetMetrics(TinyLFUCacheMetrics* metrics);
+
+  // Insert the handle into the window region, and move the entries which
+  // overflow the window into the main region if they're admitted.
+  Cache::Handle* Insert(TinyLFUHandle* handle, Cache::EvictionCallback* eviction_callback);
+  // Like Cache::Lookup, but with an extra "hash" parameter.
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash, bool caching);
+  // Reduce the entry's ref by one, freeing the entry if no refs are remaining.
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+  // Return the region holding the entry for the key, if any.
+  bool Contains(const Slice& key, uint32_t hash, TinyLFURegion* region);
+
+ private:
+  // A recency list of entries. 'head.prev' is the newest entry,
+  // 'head.next' is the oldest one.
+  struct RecencyList {
+    RecencyList();
+
+    bool empty() const { return head.next == &head; }
+
+    size_t capacity;
+    size_t usage;
+    TinyLFUHandle head;
+  };
+
+  RecencyList* List(TinyLFURegion region);
+  static void RL_Remove(RecencyList* list, TinyLFUHandle* e);
+  static void RL_Append(RecencyList* list, TinyLFUHandle* e);
+
+  // Move the entry to the given region, making it the newest entry there.
+  void MoveTo(TinyLFUHandle* e, TinyLFURegion region);
+
+  // Remove the entry from its region and the hash table, and add it to
+  // 'free_entries' to be freed outside the lock if no refs are remaining.
+  void Evict(TinyLFUHandle* e, TinyLFUHandle** free_entries);
+
+  // Move the oldest entries of the window into the main region until the
+  // window fits its capacity, evicting either them or the main region's
+  // oldest entries as decided by the admission policy.
+  void EvictFromWindow(TinyLFUHandle** free_entries);
+
+  // Move 'candidate', the oldest entry of the window, into the main region
+  // if it's admitted, evicting it otherwise.
+  void Admit(TinyLFUHandle* candidate, TinyLFUHandle** free_entries);
+
+  // Demote the oldest entries of the protected segment to the probationary
+  // segment until the protected segment fits its capacity.
+  void DemoteFromProtected();
+
+  static bool Unref(TinyLFUHandle* e);
+  // Call the user's eviction callback, if it exists, and free the entry.
+  void FreeEntry(TinyLFUHandle* e);
+  // Free the entries linked through their 'next' pointers.
+  void FreeEntries(TinyLFUHandle* free_entries);
+
+  void UpdateMetricsLookup(bool was_hit, bool caching);
+
+  // Update the memtracker's consumption by the given amount, deferring the
+  // updates like the LRU and SLRU cache shards do.
+  void UpdateMemTracker(int64_t delta);
+
+  // Protects all the fields below except for the memtracker consumption.
+  simple_spinlock mutex_;
+
+  RecencyList window_;
+  RecencyList probationary_;
+  RecencyList protected_;
+
+  // The capacity of the main region, shared by the probationary and
+  // protected segments.
+  const size_t main_capacity_;
+
+  Cache::HandleTable<TinyLFUHandle> table_;
+  size_t num_entries_;
+
+  FrequencySketch sketch_;
+
+  MemTracker* mem_tracker_;
+  std::atomic<int64_t> deferred_consumption_ { 0 };
+  int64_t max_deferred_consumption_;
+
+  TinyLFUCacheMetrics* metrics_;
+
+  DISALLOW_COPY_AND_ASSIGN(TinyLFUCacheShard);
+};
+
+class ShardedTinyLFUCache : public Cache {
+ public:
+  ShardedTinyLFUCache(size_t window_capacity, size_t main_capacity, const std::string& id);
+
+  ~ShardedTinyLFUCache() override = default;
+
+  UniquePendingHandle Allocate(Slice key, int val_len, int charge) override;
+
+  UniqueHandle Lookup(const Slice& key, CacheBehavior caching) override;
+
+  void Erase(const Slice& key) override;
+
+  Slice Value(const UniqueHandle& handle) const override;
+
+  uint8_t* MutableValue(UniquePendingHandle* handle) override;
+
+  UniqueHandle Insert(UniquePendingHandle handle,
+                      EvictionCallback* eviction_callback) override;
+
+  void SetMetrics(std::unique_ptr<CacheMetrics> metrics,
+                  ExistingMetricsPolicy metrics_policy) override;
+
+  size_t Invalidate(const InvalidationControl& ctl) override { return 0; }
+
+ protected:
+  void Release(Handle* handle) override;
+
+  void Free(PendingHandle* h) override;
+
+ private:
+  friend class TinyLFUCacheTest;
+  static int DetermineShardBits();
+
+  static uint32_t HashSlice(const Slice& s);
+
+  uint32_t Shard(uint32_t hash) const;
+
+  // Needs to be declared before 'shards_' so the destructor for 'shards_' is called first.
+  std::shared_ptr<MemTracker> mem_tracker_;
+
+  std::unique_ptr<CacheMetrics> metrics_;
+
+  std::vector<std::unique_ptr<TinyLFUCacheShard>> shards_;
+
+  // Number of bits of hash used to determine the shard.
+  const int shard_bits_;
+
+  // Used only when metrics are set to ensure that they are set only once in test environments.
+  simple_spinlock metrics_lock_;
+};
+
+// Creates a new W-TinyLFU cache with 'window_capacity' being the capacity of
+// the window region in bytes, 'main_capacity' being the capacity of the main
+// region in bytes, and 'id' specifying the identifier.
+template <Cache::MemoryType memory_type = Cache::MemoryType::DRAM>
+ShardedTinyLFUCache* NewTinyLFUCache(size_t window_capacity, size_t main_capacity,
+                                     const std::string& id);
+
+} // namespace kudu